@@ -121,6 +121,21 @@ enum spdk_bdev_status {
  */
 struct spdk_bdev_desc;
 
+/**
+ * bdev I/O priority class
+ *
+ * Bdev modules that can schedule I/O of different classes independently (e.g.
+ * NVMe controllers using weighted round robin arbitration) use it to let
+ * latency sensitive I/O bypass bulk I/O. Other modules ignore it.
+ */
+enum spdk_bdev_io_priority {
+	SPDK_BDEV_IO_PRIORITY_DEFAULT = 0,
+	SPDK_BDEV_IO_PRIORITY_LOW,
+	SPDK_BDEV_IO_PRIORITY_HIGH,
+	SPDK_BDEV_IO_PRIORITY_URGENT,
+	SPDK_BDEV_NUM_IO_PRIORITIES
+};
+
 /** bdev I/O type */
 enum spdk_bdev_io_type {
 	SPDK_BDEV_IO_TYPE_INVALID = 0,
@@ -343,6 +358,29 @@ void spdk_bdev_close(struct spdk_bdev_desc *desc);
  */
 struct spdk_bdev *spdk_bdev_desc_get_bdev(struct spdk_bdev_desc *desc);
 
+/**
+ * Set the priority class of the I/O submitted through a bdev descriptor.
+ *
+ * The new priority applies to I/O submitted after this call. Open several
+ * descriptors of the same bdev to submit I/O with different priorities.
+ *
+ * \param desc Block device descriptor.
+ * \param priority Priority class of the I/O.
+ *
+ * \return 0 on success, -EINVAL if the priority is invalid.
+ */
+int spdk_bdev_desc_set_io_priority(struct spdk_bdev_desc *desc,
+				   enum spdk_bdev_io_priority priority);
+
+/**
+ * Get the priority class of the I/O submitted through a bdev descriptor.
+ *
+ * \param desc Block device descriptor.
+ *
+ * \return priority class of the I/O.
+ */
+enum spdk_bdev_io_priority spdk_bdev_desc_get_io_priority(struct spdk_bdev_desc *desc);
+
 /**
  * Set a time limit for the timeout IO of the bdev and timeout callback.
  * We can use this function to enable/disable the timeout handler. If
@@ -513,6 +551,17 @@ const struct spdk_uuid *spdk_bdev_get_uuid(const struct spdk_bdev *bdev);
  */
 uint16_t spdk_bdev_get_acwu(const struct spdk_bdev *bdev);
 
+/**
+ * Get block device atomic write unit.
+ *
+ * Writes of up to this many blocks are never observed partially written by
+ * other I/O to the same blocks.
+ *
+ * \param bdev Block device to query.
+ * \return Atomic write unit for this bdev in blocks.
+ */
+uint16_t spdk_bdev_get_awun(const struct spdk_bdev *bdev);
+
 /**
  * Get block device metadata size.
  *
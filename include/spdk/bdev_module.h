@@ -275,6 +275,9 @@ struct spdk_bdev {
 	/** Atomic compare & write unit */
 	uint16_t acwu;
 
+	/** Atomic write unit: largest write, in blocks, that is never observed partially written */
+	uint16_t awun;
+
 	/**
 	 * Specifies an alignment requirement for data buffers associated with an spdk_bdev_io.
 	 * 0 = no alignment requirement
@@ -477,6 +480,9 @@ struct spdk_bdev_io {
 	/** Enumerated value representing the I/O type. */
 	uint8_t type;
 
+	/** Priority class (enum spdk_bdev_io_priority), inherited from the descriptor. */
+	uint8_t priority;
+
 	/** Number of IO submission retries */
 	uint16_t num_retries;
 
@@ -102,6 +102,20 @@ uint32_t spdk_crc32_ieee_update(const void *buf, size_t len, uint32_t crc);
  */
 uint32_t spdk_crc32c_update(const void *buf, size_t len, uint32_t crc);
 
+/**
+ * Calculate partial CRC-32C checksums of several independent buffers.
+ *
+ * This is equivalent to calling spdk_crc32c_update() for each buffer, but the
+ * buffers are processed in an interleaved fashion where the CPU allows it.
+ *
+ * \param bufs Array of data buffers to checksum.
+ * \param lens Array of lengths of the buffers in bytes.
+ * \param crcs Array of previous CRC-32C values. Updated with the new values on return.
+ * \param num Number of buffers.
+ */
+void spdk_crc32c_update_multi(const void *const *bufs, const size_t *lens, uint32_t *crcs,
+			      int num);
+
 #ifdef __cplusplus
 }
 #endif
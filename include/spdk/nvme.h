@@ -184,8 +184,10 @@ struct spdk_nvme_ctrlr_opts {
 	 * The I/O command set to select.
 	 *
 	 * If the requested command set is not supported, the controller
-	 * initialization process will not proceed. By default, the NVM
-	 * command set is used.
+	 * initialization process will not proceed. By default, all I/O
+	 * command sets supported by the controller are selected, falling
+	 * back to the NVM command set on controllers that do not support
+	 * I/O command sets.
 	 */
 	enum spdk_nvme_cc_css command_set;
 
@@ -220,6 +222,16 @@ struct spdk_nvme_ctrlr_opts {
 	 * Defaults to 'false' (errors are logged).
 	 */
 	bool disable_error_logging;
+
+	/**
+	 * Fall back to round robin arbitration if the controller doesn't support
+	 * the mechanism requested in arb_mechanism, instead of failing the
+	 * initialization. The mechanism actually enabled is reported in the
+	 * options provided during the attach callback.
+	 *
+	 * Defaults to 'false'.
+	 */
+	bool arb_mechanism_fallback;
 };
 
 /**
@@ -736,11 +748,16 @@ struct spdk_nvme_probe_ctx *spdk_nvme_probe_async(const struct spdk_nvme_transpo
  *
  * \param probe_ctx Context used to track probe actions.
  *
+ * All controllers found by the probe are initialized in parallel, and attach_cb
+ * is called for each of them as soon as it is ready. A controller that fails to
+ * initialize does not interrupt the initialization of the other controllers.
+ *
  * \return 0 if all probe operations are complete; the probe_ctx
  * is also freed and no longer valid.
  * \return -EAGAIN if there are still pending probe operations; user must call
  * spdk_nvme_probe_poll_async again to continue progress.
- * \return value other than 0 and -EAGAIN probe error with one controller.
+ * \return -EIO if all probe operations are complete, but at least one controller
+ * failed to initialize; the probe_ctx is also freed and no longer valid.
  */
 int spdk_nvme_probe_poll_async(struct spdk_nvme_probe_ctx *probe_ctx);
 
@@ -788,6 +805,12 @@ int spdk_nvme_ctrlr_set_trid(struct spdk_nvme_ctrlr *ctrlr, struct spdk_nvme_tra
  * may be invalidated by calling this function. The number of namespaces as returned
  * by spdk_nvme_ctrlr_get_num_ns() may also change.
  *
+ * I/O qpairs allocated on the controller are not freed by the reset. PCIe qpairs
+ * are recreated on the controller as part of the reset, while fabrics qpairs are
+ * left disconnected and must be reconnected by calling
+ * spdk_nvme_ctrlr_reconnect_io_qpair() from the thread that owns them. Requests
+ * submitted in the meantime are queued and resubmitted once the qpair is enabled.
+ *
  * \param ctrlr Opaque handle to NVMe controller.
  *
  * \return 0 on success, -1 on failure.
@@ -1127,6 +1150,20 @@ struct spdk_nvme_io_qpair_opts {
 		uint64_t paddr;
 		uint64_t buffer_size;
 	} cq;
+
+	/**
+	 * Allow the qpair to share its completion queue and receive buffers with the
+	 * other I/O qpairs of the calling thread that have this option set. This cuts
+	 * down on the memory registered for receive buffers and lets a single poll
+	 * reap completions for all of those qpairs.
+	 *
+	 * All qpairs sharing resources must be created, polled, reconnected and freed
+	 * on the same thread. If the device can't share resources, the qpair silently
+	 * falls back to dedicated ones.
+	 *
+	 * This only applies to the RDMA transport.
+	 */
+	bool share_transport_resources;
 };
 
 /**
@@ -2026,6 +2063,15 @@ uint32_t spdk_nvme_ns_get_optimal_io_boundary(struct spdk_nvme_ns *ns);
  */
 const struct spdk_uuid *spdk_nvme_ns_get_uuid(const struct spdk_nvme_ns *ns);
 
+/**
+ * Get the Command Set Identifier for the given namespace.
+ *
+ * \param ns Namespace to query.
+ *
+ * \return the namespace Command Set Identifier.
+ */
+enum spdk_nvme_csi spdk_nvme_ns_get_csi(const struct spdk_nvme_ns *ns);
+
 /**
  * \brief Namespace command support flags.
  */
@@ -116,14 +116,25 @@ SPDK_STATIC_ASSERT(sizeof(union spdk_nvme_cap_register) == 8, "Incorrect size");
 
 /**
  * I/O Command Set Selected
- *
- * Only a single command set is defined as of NVMe 1.3 (NVM).
  */
 enum spdk_nvme_cc_css {
 	SPDK_NVME_CC_CSS_NVM		= 0x0,	/**< NVM command set */
+	SPDK_NVME_CC_CSS_IOCS		= 0x6,	/**< All supported I/O command sets */
+	SPDK_NVME_CC_CSS_NOIO		= 0x7,	/**< Admin command set only */
 };
 
 #define SPDK_NVME_CAP_CSS_NVM (1u << SPDK_NVME_CC_CSS_NVM) /**< NVM command set supported */
+#define SPDK_NVME_CAP_CSS_IOCS (1u << SPDK_NVME_CC_CSS_IOCS) /**< One or more I/O command sets supported */
+#define SPDK_NVME_CAP_CSS_NOIO (1u << SPDK_NVME_CC_CSS_NOIO) /**< No I/O, only admin */
+
+/**
+ * Command Set Identifier (CSI)
+ */
+enum spdk_nvme_csi {
+	SPDK_NVME_CSI_NVM	= 0x0,	/**< NVM command set */
+	SPDK_NVME_CSI_KV	= 0x1,	/**< Key Value command set */
+	SPDK_NVME_CSI_ZNS	= 0x2,	/**< Zoned Namespace command set */
+};
 
 union spdk_nvme_cc_register {
 	uint32_t	raw;
@@ -669,7 +680,8 @@ union spdk_nvme_feat_async_event_configuration {
 		uint32_t ns_attr_notice		: 1;
 		uint32_t fw_activation_notice	: 1;
 		uint32_t telemetry_log_notice	: 1;
-		uint32_t reserved		: 21;
+		uint32_t ana_change_notice	: 1;
+		uint32_t reserved		: 20;
 	} bits;
 };
 SPDK_STATIC_ASSERT(sizeof(union spdk_nvme_feat_async_event_configuration) == 4, "Incorrect size");
@@ -933,6 +945,14 @@ SPDK_STATIC_ASSERT(sizeof(union spdk_nvme_cmd_cdw10) == 4, "Incorrect size");
 union spdk_nvme_cmd_cdw11 {
 	uint32_t raw;
 
+	struct {
+		/* NVM Set Identifier */
+		uint32_t nvmsetid : 16;
+		uint32_t reserved : 8;
+		/* Command Set Identifier */
+		uint32_t csi      : 8;
+	} identify;
+
 	struct {
 		/* Physically Contiguous */
 		uint32_t pc       : 1;
@@ -1214,6 +1234,9 @@ enum spdk_nvme_media_error_status_code {
  */
 enum spdk_nvme_path_status_code {
 	SPDK_NVME_SC_INTERNAL_PATH_ERROR		= 0x00,
+	SPDK_NVME_SC_ASYMMETRIC_ACCESS_PERSISTENT_LOSS	= 0x01,
+	SPDK_NVME_SC_ASYMMETRIC_ACCESS_INACCESSIBLE	= 0x02,
+	SPDK_NVME_SC_ASYMMETRIC_ACCESS_TRANSITION	= 0x03,
 
 	SPDK_NVME_SC_CONTROLLER_PATH_ERROR		= 0x60,
 
@@ -1421,6 +1444,12 @@ enum spdk_nvme_identify_cns {
 	/** List namespace identification descriptors */
 	SPDK_NVME_IDENTIFY_NS_ID_DESCRIPTOR_LIST	= 0x03,
 
+	/** Identify namespace data specific to the I/O command set in CDW11.CSI */
+	SPDK_NVME_IDENTIFY_NS_IOCS			= 0x05,
+
+	/** Identify controller data specific to the I/O command set in CDW11.CSI */
+	SPDK_NVME_IDENTIFY_CTRLR_IOCS			= 0x06,
+
 	/** List allocated NSIDs greater than CDW1.NSID */
 	SPDK_NVME_IDENTIFY_ALLOCATED_NS_LIST		= 0x10,
 
@@ -1510,7 +1539,8 @@ struct __attribute__((packed)) __attribute__((aligned)) spdk_nvme_ctrlr_data {
 		uint8_t multi_port	: 1;
 		uint8_t multi_host	: 1;
 		uint8_t sr_iov		: 1;
-		uint8_t reserved	: 5;
+		uint8_t ana_reporting	: 1;
+		uint8_t reserved	: 4;
 	} cmic;
 
 	/** maximum data transfer size */
@@ -1538,7 +1568,12 @@ struct __attribute__((packed)) __attribute__((aligned)) spdk_nvme_ctrlr_data {
 		/** Supports sending Firmware Activation Notices. */
 		uint32_t	fw_activation_notices : 1;
 
-		uint32_t	reserved2 : 22;
+		uint32_t	reserved2 : 1;
+
+		/** Supports sending Asymmetric Namespace Access Change Notices. */
+		uint32_t	ana_change_notices : 1;
+
+		uint32_t	reserved3 : 20;
 	} oaes;
 
 	/** controller attributes */
@@ -1741,7 +1776,34 @@ struct __attribute__((packed)) __attribute__((aligned)) spdk_nvme_ctrlr_data {
 		} bits;
 	} sanicap;
 
-	uint8_t			reserved3[180];
+	uint8_t			reserved3[10];
+
+	/** ANA transition time */
+	uint8_t			anatt;
+
+	/** Asymmetric namespace access capabilities */
+	struct {
+		uint8_t		ana_optimized_state : 1;
+		uint8_t		ana_non_optimized_state : 1;
+		uint8_t		ana_inaccessible_state : 1;
+		uint8_t		ana_persistent_loss_state : 1;
+		uint8_t		ana_change_state : 1;
+		uint8_t		reserved : 1;
+
+		/** ANAGRPID field in the Identify Namespace data structure does not change */
+		uint8_t		no_change_anagrpid : 1;
+
+		/** Non-zero ANAGRPID field in the Identify Namespace data structure is supported */
+		uint8_t		non_zero_anagrpid : 1;
+	} anacap;
+
+	/** ANA group identifier maximum */
+	uint32_t		anagrpmax;
+
+	/** Number of ANA group identifiers */
+	uint32_t		nanagrpid;
+
+	uint8_t			reserved352[160];
 
 	/* bytes 512-703: nvm command set attributes */
 
@@ -2106,7 +2168,12 @@ struct spdk_nvme_ns_data {
 	/** NVM capacity */
 	uint64_t		nvmcap[2];
 
-	uint8_t			reserved64[40];
+	uint8_t			reserved64[28];
+
+	/** ANA group identifier */
+	uint32_t		anagrpid;
+
+	uint8_t			reserved96[8];
 
 	/** namespace globally unique identifier */
 	uint8_t			nguid[16];
@@ -2350,7 +2417,12 @@ enum spdk_nvme_log_page {
 	/** Controller initiated telemetry log (optional) */
 	SPDK_NVME_LOG_TELEMETRY_CTRLR_INITIATED	= 0x08,
 
-	/* 0x09-0x6F - reserved */
+	/* 0x09-0x0B - reserved */
+
+	/** Asymmetric namespace access log (optional) - \ref spdk_nvme_ana_page */
+	SPDK_NVME_LOG_ASYMMETRIC_NAMESPACE_ACCESS	= 0x0C,
+
+	/* 0x0D-0x6F - reserved */
 
 	/** Discovery(refer to the NVMe over Fabrics specification) */
 	SPDK_NVME_LOG_DISCOVERY		= 0x70,
@@ -2536,6 +2608,58 @@ struct spdk_nvme_sanitize_status_log_page {
 };
 SPDK_STATIC_ASSERT(sizeof(struct spdk_nvme_sanitize_status_log_page) == 512, "Incorrect size");
 
+/**
+ * Asymmetric Namespace Access states
+ */
+enum spdk_nvme_ana_state {
+	SPDK_NVME_ANA_OPTIMIZED_STATE		= 0x1,
+	SPDK_NVME_ANA_NON_OPTIMIZED_STATE	= 0x2,
+	SPDK_NVME_ANA_INACCESSIBLE_STATE	= 0x3,
+	SPDK_NVME_ANA_PERSISTENT_LOSS_STATE	= 0x4,
+	SPDK_NVME_ANA_CHANGE_STATE		= 0xF,
+};
+
+/**
+ * ANA group descriptor of the asymmetric namespace access log page
+ */
+struct spdk_nvme_ana_group_descriptor {
+	/** ANA group identifier */
+	uint32_t	ana_group_id;
+
+	/** Number of NSID values in this descriptor */
+	uint32_t	num_of_nsid;
+
+	/** Change count */
+	uint64_t	change_count;
+
+	/** ANA state */
+	uint8_t		ana_state : 4;
+	uint8_t		reserved0 : 4;
+
+	uint8_t		reserved1[15];
+
+	/** Namespace identifiers in this ANA group */
+	uint32_t	nsid[];
+};
+SPDK_STATIC_ASSERT(sizeof(struct spdk_nvme_ana_group_descriptor) == 32, "Incorrect size");
+
+/**
+ * Asymmetric namespace access log page (\ref SPDK_NVME_LOG_ASYMMETRIC_NAMESPACE_ACCESS)
+ *
+ * The header is followed by num_ana_group_desc ANA group descriptors, each of
+ * which is followed by its list of namespace identifiers.
+ */
+struct spdk_nvme_ana_page {
+	/** Change count */
+	uint64_t	change_count;
+
+	/** Number of ANA group descriptors */
+	uint16_t	num_ana_group_desc;
+
+	uint8_t		reserved[6];
+};
+SPDK_STATIC_ASSERT(sizeof(struct spdk_nvme_ana_page) == 16, "Incorrect size");
+
 /**
  * Asynchronous Event Type
  */
@@ -2598,8 +2722,10 @@ enum spdk_nvme_async_event_info_notice {
 	SPDK_NVME_ASYNC_EVENT_FW_ACTIVATION_START	= 0x1,
 	/* Telemetry Log Changed */
 	SPDK_NVME_ASYNC_EVENT_TELEMETRY_LOG_CHANGED	= 0x2,
+	/* Asymmetric Namespace Access Change */
+	SPDK_NVME_ASYNC_EVENT_ANA_CHANGE		= 0x3,
 
-	/* 0x3 - 0xFF Reserved */
+	/* 0x4 - 0xFF Reserved */
 };
 
 /**
@@ -2691,6 +2817,9 @@ enum spdk_nvme_nidt {
 
 	/** Namespace UUID */
 	SPDK_NVME_NIDT_UUID		= 0x03,
+
+	/** Namespace Command Set Identifier */
+	SPDK_NVME_NIDT_CSI		= 0x04,
 };
 
 struct spdk_nvme_ns_id_desc {
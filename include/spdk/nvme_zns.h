@@ -0,0 +1,402 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) Intel Corporation.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * NVMe driver public API extension for Zoned Namespaces
+ */
+
+#ifndef SPDK_NVME_ZNS_H
+#define SPDK_NVME_ZNS_H
+
+#include "spdk/stdinc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "spdk/nvme.h"
+#include "spdk/nvme_zns_spec.h"
+
+/**
+ * \brief Get the Zoned Namespace Command Set Specific Identify Namespace data
+ * as defined by the NVMe Zoned Namespace Command Set Specification.
+ *
+ * This function is thread safe and can be called at any point while the controller
+ * is attached to the SPDK NVMe driver.
+ *
+ * \param ns Namespace.
+ *
+ * \return a pointer to the namespace data, or NULL if the namespace is not
+ * a Zoned Namespace.
+ */
+const struct spdk_nvme_zns_ns_data *spdk_nvme_zns_ns_get_data(struct spdk_nvme_ns *ns);
+
+/**
+ * \brief Get the zone size, in number of sectors, of the given namespace.
+ *
+ * This function is thread safe and can be called at any point while the controller
+ * is attached to the SPDK NVMe driver.
+ *
+ * \param ns Namespace to query.
+ *
+ * \return the zone size of the given namespace in number of sectors.
+ */
+uint64_t spdk_nvme_zns_ns_get_zone_size_sectors(struct spdk_nvme_ns *ns);
+
+/**
+ * \brief Get the zone size, in bytes, of the given namespace.
+ *
+ * This function is thread safe and can be called at any point while the controller
+ * is attached to the SPDK NVMe driver.
+ *
+ * \param ns Namespace to query.
+ *
+ * \return the zone size of the given namespace in bytes.
+ */
+uint64_t spdk_nvme_zns_ns_get_zone_size(struct spdk_nvme_ns *ns);
+
+/**
+ * \brief Get the number of zones for the given namespace.
+ *
+ * This function is thread safe and can be called at any point while the controller
+ * is attached to the SPDK NVMe driver.
+ *
+ * \param ns Namespace to query.
+ *
+ * \return the number of zones.
+ */
+uint64_t spdk_nvme_zns_ns_get_num_zones(struct spdk_nvme_ns *ns);
+
+/**
+ * \brief Get the maximum number of open zones for the given namespace.
+ *
+ * An open zone is a zone in any of the zone states:
+ * EXPLICIT OPEN or IMPLICIT OPEN.
+ *
+ * This function is thread safe and can be called at any point while the controller
+ * is attached to the SPDK NVMe driver.
+ *
+ * \param ns Namespace to query.
+ *
+ * \return the maximum number of open zones, or 0 if there is no limit.
+ */
+uint32_t spdk_nvme_zns_ns_get_max_open_zones(struct spdk_nvme_ns *ns);
+
+/**
+ * \brief Get the maximum number of active zones for the given namespace.
+ *
+ * An active zone is a zone in any of the zone states:
+ * EXPLICIT OPEN, IMPLICIT OPEN or CLOSED.
+ *
+ * This function is thread safe and can be called at any point while the controller
+ * is attached to the SPDK NVMe driver.
+ *
+ * \param ns Namespace to query.
+ *
+ * \return the maximum number of active zones, or 0 if there is no limit.
+ */
+uint32_t spdk_nvme_zns_ns_get_max_active_zones(struct spdk_nvme_ns *ns);
+
+/**
+ * \brief Get the Zoned Namespace Command Set Specific Identify Controller data
+ * as defined by the NVMe Zoned Namespace Command Set Specification.
+ *
+ * This function is thread safe and can be called at any point while the controller
+ * is attached to the SPDK NVMe driver.
+ *
+ * \param ctrlr Opaque handle to NVMe controller.
+ *
+ * \return a pointer to the controller data, or NULL if the controller does not
+ * support the Zoned Namespace Command Set.
+ */
+const struct spdk_nvme_zns_ctrlr_data *spdk_nvme_zns_ctrlr_get_data(struct spdk_nvme_ctrlr *ctrlr);
+
+/**
+ * \brief Get the maximum zone append size for the given NVMe controller.
+ *
+ * This function is thread safe and can be called at any point while the controller
+ * is attached to the SPDK NVMe driver.
+ *
+ * \param ctrlr Opaque handle to NVMe controller.
+ *
+ * \return the maximum zone append size in bytes, or 0 if the controller does not
+ * support the Zoned Namespace Command Set.
+ */
+uint32_t spdk_nvme_zns_ctrlr_get_max_zone_append_size(const struct spdk_nvme_ctrlr *ctrlr);
+
+/**
+ * \brief Submit a zone append I/O to the specified NVMe namespace.
+ *
+ * The controller writes the data at the current write pointer of the zone and
+ * returns the LBA it was written at in dwords 0 and 1 of the completion.
+ * A zone append is never split, so the data must fit within the limit reported
+ * by spdk_nvme_zns_ctrlr_get_max_zone_append_size().
+ *
+ * The command is submitted to a qpair allocated by spdk_nvme_ctrlr_alloc_io_qpair().
+ * The user must ensure that only one thread submits I/O on a given qpair at any
+ * given time.
+ *
+ * \param ns NVMe namespace to submit the zone append I/O.
+ * \param qpair I/O queue pair to submit the request.
+ * \param buffer Virtual address pointer to the data payload buffer.
+ * \param zslba Zone Start LBA of the zone that we are appending to.
+ * \param lba_count Length (in sectors) for the zone append operation.
+ * \param cb_fn Callback function to invoke when the I/O is completed.
+ * \param cb_arg Argument to pass to the callback function.
+ * \param io_flags Set flags, defined by the SPDK_NVME_IO_FLAGS_* entries in
+ * spdk/nvme_spec.h, for this I/O.
+ *
+ * \return 0 if successfully submitted, negated errnos on the following error conditions:
+ * -EINVAL: The request is malformed or exceeds the maximum zone append size.
+ * -ENOMEM: The request cannot be allocated.
+ * -ENXIO: The qpair is failed at the transport level.
+ */
+int spdk_nvme_zns_zone_append(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+			      void *buffer, uint64_t zslba,
+			      uint32_t lba_count, spdk_nvme_cmd_cb cb_fn, void *cb_arg,
+			      uint32_t io_flags);
+
+/**
+ * \brief Submit a zone append I/O with metadata to the specified NVMe namespace.
+ *
+ * See spdk_nvme_zns_zone_append() for the zone append semantics.
+ *
+ * \param ns NVMe namespace to submit the zone append I/O.
+ * \param qpair I/O queue pair to submit the request.
+ * \param buffer Virtual address pointer to the data payload buffer.
+ * \param metadata Virtual address pointer to the metadata payload, the length
+ * of metadata is specified by spdk_nvme_ns_get_md_size().
+ * \param zslba Zone Start LBA of the zone that we are appending to.
+ * \param lba_count Length (in sectors) for the zone append operation.
+ * \param cb_fn Callback function to invoke when the I/O is completed.
+ * \param cb_arg Argument to pass to the callback function.
+ * \param io_flags Set flags, defined by the SPDK_NVME_IO_FLAGS_* entries in
+ * spdk/nvme_spec.h, for this I/O.
+ * \param apptag_mask Application tag mask.
+ * \param apptag Application tag to use end-to-end protection information.
+ *
+ * \return 0 if successfully submitted, negated errnos on the following error conditions:
+ * -EINVAL: The request is malformed or exceeds the maximum zone append size.
+ * -ENOMEM: The request cannot be allocated.
+ * -ENXIO: The qpair is failed at the transport level.
+ */
+int spdk_nvme_zns_zone_append_with_md(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+				      void *buffer, void *metadata, uint64_t zslba,
+				      uint32_t lba_count, spdk_nvme_cmd_cb cb_fn, void *cb_arg,
+				      uint32_t io_flags, uint16_t apptag_mask, uint16_t apptag);
+
+/**
+ * \brief Submit a zone append I/O with a scattered payload to the specified NVMe
+ * namespace.
+ *
+ * See spdk_nvme_zns_zone_append() for the zone append semantics.
+ *
+ * \param ns NVMe namespace to submit the zone append I/O.
+ * \param qpair I/O queue pair to submit the request.
+ * \param zslba Zone Start LBA of the zone that we are appending to.
+ * \param lba_count Length (in sectors) for the zone append operation.
+ * \param cb_fn Callback function to invoke when the I/O is completed.
+ * \param cb_arg Argument to pass to the callback function.
+ * \param io_flags Set flags, defined by the SPDK_NVME_IO_FLAGS_* entries in
+ * spdk/nvme_spec.h, for this I/O.
+ * \param reset_sgl_fn Callback function to reset scattered payload.
+ * \param next_sge_fn Callback function to iterate each scattered payload memory
+ * segment.
+ *
+ * \return 0 if successfully submitted, negated errnos on the following error conditions:
+ * -EINVAL: The request is malformed or exceeds the maximum zone append size.
+ * -ENOMEM: The request cannot be allocated.
+ * -ENXIO: The qpair is failed at the transport level.
+ */
+int spdk_nvme_zns_zone_appendv(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+			       uint64_t zslba, uint32_t lba_count,
+			       spdk_nvme_cmd_cb cb_fn, void *cb_arg, uint32_t io_flags,
+			       spdk_nvme_req_reset_sgl_cb reset_sgl_fn,
+			       spdk_nvme_req_next_sge_cb next_sge_fn);
+
+/**
+ * \brief Submit a zone append I/O with a scattered payload and metadata to the
+ * specified NVMe namespace.
+ *
+ * See spdk_nvme_zns_zone_append() for the zone append semantics.
+ *
+ * \param ns NVMe namespace to submit the zone append I/O.
+ * \param qpair I/O queue pair to submit the request.
+ * \param zslba Zone Start LBA of the zone that we are appending to.
+ * \param lba_count Length (in sectors) for the zone append operation.
+ * \param cb_fn Callback function to invoke when the I/O is completed.
+ * \param cb_arg Argument to pass to the callback function.
+ * \param io_flags Set flags, defined by the SPDK_NVME_IO_FLAGS_* entries in
+ * spdk/nvme_spec.h, for this I/O.
+ * \param reset_sgl_fn Callback function to reset scattered payload.
+ * \param next_sge_fn Callback function to iterate each scattered payload memory
+ * segment.
+ * \param metadata Virtual address pointer to the metadata payload, the length
+ * of metadata is specified by spdk_nvme_ns_get_md_size().
+ * \param apptag_mask Application tag mask.
+ * \param apptag Application tag to use end-to-end protection information.
+ *
+ * \return 0 if successfully submitted, negated errnos on the following error conditions:
+ * -EINVAL: The request is malformed or exceeds the maximum zone append size.
+ * -ENOMEM: The request cannot be allocated.
+ * -ENXIO: The qpair is failed at the transport level.
+ */
+int spdk_nvme_zns_zone_appendv_with_md(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+				       uint64_t zslba, uint32_t lba_count,
+				       spdk_nvme_cmd_cb cb_fn, void *cb_arg, uint32_t io_flags,
+				       spdk_nvme_req_reset_sgl_cb reset_sgl_fn,
+				       spdk_nvme_req_next_sge_cb next_sge_fn, void *metadata,
+				       uint16_t apptag_mask, uint16_t apptag);
+
+/**
+ * \brief Submit a Close Zone operation to the specified NVMe namespace.
+ *
+ * \param ns Namespace.
+ * \param qpair I/O queue pair to submit the request.
+ * \param slba Start Logical Block Address of the zone.
+ * \param select_all Set to true if the operation should be applied to all zones
+ * that are eligible for the operation, ignoring slba.
+ * \param cb_fn Callback function to invoke when the I/O is completed.
+ * \param cb_arg Argument to pass to the callback function.
+ *
+ * \return 0 if successfully submitted, negated errnos on the following error conditions:
+ * -ENOMEM: The request cannot be allocated.
+ * -ENXIO: The qpair is failed at the transport level.
+ */
+int spdk_nvme_zns_close_zone(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair, uint64_t slba,
+			     bool select_all, spdk_nvme_cmd_cb cb_fn, void *cb_arg);
+
+/**
+ * \brief Submit a Finish Zone operation to the specified NVMe namespace.
+ *
+ * \param ns Namespace.
+ * \param qpair I/O queue pair to submit the request.
+ * \param slba Start Logical Block Address of the zone.
+ * \param select_all Set to true if the operation should be applied to all zones
+ * that are eligible for the operation, ignoring slba.
+ * \param cb_fn Callback function to invoke when the I/O is completed.
+ * \param cb_arg Argument to pass to the callback function.
+ *
+ * \return 0 if successfully submitted, negated errnos on the following error conditions:
+ * -ENOMEM: The request cannot be allocated.
+ * -ENXIO: The qpair is failed at the transport level.
+ */
+int spdk_nvme_zns_finish_zone(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair, uint64_t slba,
+			      bool select_all, spdk_nvme_cmd_cb cb_fn, void *cb_arg);
+
+/**
+ * \brief Submit an Open Zone operation to the specified NVMe namespace.
+ *
+ * \param ns Namespace.
+ * \param qpair I/O queue pair to submit the request.
+ * \param slba Start Logical Block Address of the zone.
+ * \param select_all Set to true if the operation should be applied to all zones
+ * that are eligible for the operation, ignoring slba.
+ * \param cb_fn Callback function to invoke when the I/O is completed.
+ * \param cb_arg Argument to pass to the callback function.
+ *
+ * \return 0 if successfully submitted, negated errnos on the following error conditions:
+ * -ENOMEM: The request cannot be allocated.
+ * -ENXIO: The qpair is failed at the transport level.
+ */
+int spdk_nvme_zns_open_zone(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair, uint64_t slba,
+			    bool select_all, spdk_nvme_cmd_cb cb_fn, void *cb_arg);
+
+/**
+ * \brief Submit a Reset Zone operation to the specified NVMe namespace.
+ *
+ * \param ns Namespace.
+ * \param qpair I/O queue pair to submit the request.
+ * \param slba Start Logical Block Address of the zone.
+ * \param select_all Set to true if the operation should be applied to all zones
+ * that are eligible for the operation, ignoring slba.
+ * \param cb_fn Callback function to invoke when the I/O is completed.
+ * \param cb_arg Argument to pass to the callback function.
+ *
+ * \return 0 if successfully submitted, negated errnos on the following error conditions:
+ * -ENOMEM: The request cannot be allocated.
+ * -ENXIO: The qpair is failed at the transport level.
+ */
+int spdk_nvme_zns_reset_zone(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair, uint64_t slba,
+			     bool select_all, spdk_nvme_cmd_cb cb_fn, void *cb_arg);
+
+/**
+ * \brief Submit an Offline Zone operation to the specified NVMe namespace.
+ *
+ * \param ns Namespace.
+ * \param qpair I/O queue pair to submit the request.
+ * \param slba Start Logical Block Address of the zone.
+ * \param select_all Set to true if the operation should be applied to all zones
+ * that are eligible for the operation, ignoring slba.
+ * \param cb_fn Callback function to invoke when the I/O is completed.
+ * \param cb_arg Argument to pass to the callback function.
+ *
+ * \return 0 if successfully submitted, negated errnos on the following error conditions:
+ * -ENOMEM: The request cannot be allocated.
+ * -ENXIO: The qpair is failed at the transport level.
+ */
+int spdk_nvme_zns_offline_zone(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair, uint64_t slba,
+			       bool select_all, spdk_nvme_cmd_cb cb_fn, void *cb_arg);
+
+/**
+ * \brief Get a zone report from the specified NVMe namespace.
+ *
+ * \param ns Namespace.
+ * \param qpair I/O queue pair to submit the request.
+ * \param payload The pointer to the payload buffer, filled with a struct
+ * spdk_nvme_zns_zone_report followed by the zone descriptors.
+ * \param payload_size The size of the payload buffer. Shall be a multiple of 4 bytes.
+ * \param slba Start Logical Block Address of the first zone to report on.
+ * \param report_opts Filter on which zone states to include in the zone report.
+ * \param partial_report If true, nr_zones field in the zone report indicates the number of zone
+ * descriptors that were successfully written to the zone report. If false, nr_zones field in the
+ * zone report indicates the number of zone descriptors that match the report_opts criteria.
+ * \param cb_fn Callback function to invoke when the I/O is completed.
+ * \param cb_arg Argument to pass to the callback function.
+ *
+ * \return 0 if successfully submitted, negated errnos on the following error conditions:
+ * -EINVAL: The payload size is invalid.
+ * -ENOMEM: The request cannot be allocated.
+ * -ENXIO: The qpair is failed at the transport level.
+ */
+int spdk_nvme_zns_report_zones(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+			       void *payload, uint32_t payload_size, uint64_t slba,
+			       enum spdk_nvme_zns_zra_report_opts report_opts, bool partial_report,
+			       spdk_nvme_cmd_cb cb_fn, void *cb_arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
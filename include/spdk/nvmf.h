@@ -85,11 +85,13 @@ struct spdk_nvmf_transport_opts {
 	bool		dif_insert_or_strip;
 	bool            wr_batching;
 	uint32_t	sock_priority;
+	bool		zcopy;
 };
 
 struct spdk_nvmf_poll_group_stat {
 	uint32_t admin_qpairs;
 	uint32_t io_qpairs;
+	uint32_t current_qpairs;
 	uint64_t pending_bdev_io;
 };
 
@@ -429,6 +431,19 @@ int spdk_nvmf_poll_group_add(struct spdk_nvmf_poll_group *group,
 int spdk_nvmf_poll_group_get_stat(struct spdk_nvmf_tgt *tgt,
 				  struct spdk_nvmf_poll_group_stat *stat);
 
+/**
+ * Get the number of qpairs currently assigned to a poll group.
+ *
+ * Unlike spdk_nvmf_poll_group_get_stat(), this may be called from any thread.
+ * The value is read without synchronization, so it is only suitable as a
+ * load hint (e.g. for choosing a poll group for a new connection).
+ *
+ * \param group The poll group.
+ *
+ * \return the number of qpairs in the poll group.
+ */
+uint32_t spdk_nvmf_poll_group_get_num_qpairs(struct spdk_nvmf_poll_group *group);
+
 typedef void (*nvmf_qpair_disconnect_cb)(void *ctx);
 
 /**
@@ -550,7 +565,13 @@ int spdk_nvmf_subsystem_stop(struct spdk_nvmf_subsystem *subsystem,
 /**
  * Transition an NVMe-oF subsystem from Active to Paused state.
  *
+ * Admin commands are held back while the subsystem is paused. I/O is only held
+ * back for the namespace given by nsid, so I/O to the other namespaces of the
+ * subsystem keeps being processed.
+ *
  * \param subsystem The NVMe-oF subsystem.
+ * \param nsid The namespace to pause, 0 to pause no namespace (for example to add
+ * a new one), or SPDK_NVME_GLOBAL_NS_TAG to pause all namespaces.
  * \param cb_fn A function that will be called once the subsystem has changed state.
  * \param cb_arg Argument passed to cb_fn.
  *
@@ -558,6 +579,7 @@ int spdk_nvmf_subsystem_stop(struct spdk_nvmf_subsystem *subsystem,
  * be called on success.
  */
 int spdk_nvmf_subsystem_pause(struct spdk_nvmf_subsystem *subsystem,
+			      uint32_t nsid,
 			      spdk_nvmf_subsystem_state_change_done cb_fn,
 			      void *cb_arg);
 
@@ -793,6 +815,70 @@ void spdk_nvmf_subsystem_allow_any_listener(
 bool spdk_nvmf_subsytem_any_listener_allowed(
 	struct spdk_nvmf_subsystem *subsystem);
 
+/**
+ * Set whether a subsystem reports Asymmetric Namespace Access (ANA) states.
+ *
+ * When enabled, each namespace belongs to an ANA group and each listener of the
+ * subsystem keeps its own ANA state for every ANA group. Hosts can then use
+ * the ANA log page to pick the optimized path to a namespace.
+ *
+ * May only be performed on subsystems in the INACTIVE state.
+ *
+ * \param subsystem Subsystem to modify.
+ * \param ana_reporting true to enable ANA reporting, false to disable it.
+ *
+ * \return 0 on success, or negated errno value on failure.
+ */
+int spdk_nvmf_subsystem_set_ana_reporting(struct spdk_nvmf_subsystem *subsystem,
+		bool ana_reporting);
+
+/**
+ * Check whether a subsystem reports Asymmetric Namespace Access (ANA) states.
+ *
+ * \param subsystem Subsystem to query.
+ *
+ * \return true if ANA reporting is enabled, false otherwise.
+ */
+bool spdk_nvmf_subsystem_get_ana_reporting(const struct spdk_nvmf_subsystem *subsystem);
+
+/**
+ * Function to be called once the ANA state of a listener has been changed.
+ *
+ * \param cb_arg Callback argument passed to spdk_nvmf_subsystem_set_ana_state().
+ * \param status 0 if it completed successfully, or negative errno if it failed.
+ */
+typedef void (*spdk_nvmf_subsystem_set_ana_state_done_fn)(void *cb_arg, int status);
+
+/**
+ * Change the ANA state that a listener of the subsystem reports for an ANA group.
+ *
+ * Controllers connected through the listener are notified of the change with an
+ * Asymmetric Namespace Access Change asynchronous event.
+ *
+ * \param subsystem Subsystem the listener belongs to.
+ * \param trid The address of the listener.
+ * \param ana_state The new ANA state. Only SPDK_NVME_ANA_OPTIMIZED_STATE,
+ * SPDK_NVME_ANA_NON_OPTIMIZED_STATE and SPDK_NVME_ANA_INACCESSIBLE_STATE are supported.
+ * \param anagrpid The ANA group ID to change, or 0 to change all ANA groups.
+ * \param cb_fn Function to call once the change has been made.
+ * \param cb_arg Argument passed to cb_fn.
+ */
+void spdk_nvmf_subsystem_set_ana_state(struct spdk_nvmf_subsystem *subsystem,
+				       const struct spdk_nvme_transport_id *trid,
+				       enum spdk_nvme_ana_state ana_state, uint32_t anagrpid,
+				       spdk_nvmf_subsystem_set_ana_state_done_fn cb_fn, void *cb_arg);
+
+/**
+ * Get the ANA state that a listener reports for an ANA group.
+ *
+ * \param listener The listener to query.
+ * \param anagrpid The ANA group ID.
+ *
+ * \return the ANA state, or 0 if the ANA group ID is not valid for the listener.
+ */
+enum spdk_nvme_ana_state spdk_nvmf_listener_get_ana_state(struct spdk_nvmf_listener *listener,
+		uint32_t anagrpid);
+
 /** NVMe-oF target namespace creation options */
 struct spdk_nvmf_ns_opts {
 	/**
@@ -822,6 +908,13 @@ struct spdk_nvmf_ns_opts {
 	 * Fill with 0s if not specified.
 	 */
 	struct spdk_uuid uuid;
+
+	/**
+	 * ANA group ID
+	 *
+	 * Set to 0 to use the namespace ID as the ANA group ID.
+	 */
+	uint32_t anagrpid;
 };
 
 /**
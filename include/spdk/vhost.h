@@ -313,11 +313,13 @@ int spdk_vhost_scsi_dev_remove_tgt(struct spdk_vhost_dev *vdev, unsigned scsi_tg
  * \param dev_name bdev name to associate with this vhost device
  * \param readonly if set, all writes to the device will fail with
  * \c VIRTIO_BLK_S_IOERR error code.
+ * \param merge_requests if set, adjacent read or write requests taken
+ * from a virtqueue at once will be submitted to the bdev as a single I/O.
  *
  * \return 0 on success, negative errno on error.
  */
 int spdk_vhost_blk_construct(const char *name, const char *cpumask, const char *dev_name,
-			     bool readonly);
+			     bool readonly, bool merge_requests);
 
 /**
  * Remove a vhost device. The device must not have any open connections on it's socket.
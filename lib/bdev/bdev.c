@@ -322,6 +322,8 @@ struct spdk_bdev_desc {
 	struct media_event_entry	*media_events_buffer;
 	TAILQ_ENTRY(spdk_bdev_desc)	link;
 
+	enum spdk_bdev_io_priority	io_priority;
+
 	uint64_t		timeout_in_sec;
 	spdk_bdev_io_timeout_cb	cb_fn;
 	void			*cb_arg;
@@ -2115,6 +2117,7 @@ bdev_io_init(struct spdk_bdev_io *bdev_io,
 	bdev_io->internal.orig_iovcnt = 0;
 	bdev_io->internal.orig_md_buf = NULL;
 	bdev_io->internal.error.nvme.cdw0 = 0;
+	bdev_io->priority = bdev_io->internal.desc->io_priority;
 	bdev_io->num_retries = 0;
 	bdev_io->internal.get_buf_cb = NULL;
 	bdev_io->internal.get_aux_buf_cb = NULL;
@@ -2872,6 +2875,12 @@ spdk_bdev_get_acwu(const struct spdk_bdev *bdev)
 	return bdev->acwu;
 }
 
+uint16_t
+spdk_bdev_get_awun(const struct spdk_bdev *bdev)
+{
+	return bdev->awun;
+}
+
 uint32_t
 spdk_bdev_get_md_size(const struct spdk_bdev *bdev)
 {
@@ -4914,6 +4923,12 @@ bdev_init(struct spdk_bdev *bdev)
 		bdev->acwu = 1;
 	}
 
+	/* A single block write is always atomic. Writes may be split on the optimal I/O
+	 * boundary though, so larger ones are only atomic if they are never split. */
+	if (bdev->awun == 0 || bdev->split_on_optimal_io_boundary) {
+		bdev->awun = 1;
+	}
+
 	TAILQ_INIT(&bdev->internal.open_descs);
 	TAILQ_INIT(&bdev->internal.locked_ranges);
 	TAILQ_INIT(&bdev->internal.pending_locked_ranges);
@@ -5390,6 +5405,26 @@ spdk_bdev_desc_get_bdev(struct spdk_bdev_desc *desc)
 	return desc->bdev;
 }
 
+int
+spdk_bdev_desc_set_io_priority(struct spdk_bdev_desc *desc, enum spdk_bdev_io_priority priority)
+{
+	assert(desc != NULL);
+
+	if ((uint32_t)priority >= SPDK_BDEV_NUM_IO_PRIORITIES) {
+		return -EINVAL;
+	}
+
+	desc->io_priority = priority;
+	return 0;
+}
+
+enum spdk_bdev_io_priority
+spdk_bdev_desc_get_io_priority(struct spdk_bdev_desc *desc)
+{
+	assert(desc != NULL);
+	return desc->io_priority;
+}
+
 void
 spdk_bdev_io_get_iovec(struct spdk_bdev_io *bdev_io, struct iovec **iovp, int *iovcntp)
 {
@@ -52,12 +52,6 @@
 #include "iscsi/tgt_node.h"
 #include "iscsi/portal_grp.h"
 
-#define MAKE_DIGEST_WORD(BUF, CRC32C) \
-        (   ((*((uint8_t *)(BUF)+0)) = (uint8_t)((uint32_t)(CRC32C) >> 0)), \
-            ((*((uint8_t *)(BUF)+1)) = (uint8_t)((uint32_t)(CRC32C) >> 8)), \
-            ((*((uint8_t *)(BUF)+2)) = (uint8_t)((uint32_t)(CRC32C) >> 16)), \
-            ((*((uint8_t *)(BUF)+3)) = (uint8_t)((uint32_t)(CRC32C) >> 24)))
-
 #define SPDK_ISCSI_CONNECTION_MEMSET(conn)		\
 	memset(&(conn)->portal, 0, sizeof(*(conn)) -	\
 		offsetof(struct spdk_iscsi_conn, portal));
@@ -183,11 +177,19 @@ iscsi_poll_group_add_conn(struct spdk_iscsi_poll_group *pg, struct spdk_iscsi_co
 	STAILQ_INSERT_TAIL(&pg->connections, conn, link);
 }
 
+static void iscsi_conn_flush_digests(struct spdk_iscsi_conn *conn);
+
 static void
 iscsi_poll_group_remove_conn(struct spdk_iscsi_poll_group *pg, struct spdk_iscsi_conn *conn)
 {
 	int rc;
 
+	/* Sending PDUs may complete others and queue new ones. */
+	while (conn->digest_pdu != NULL) {
+		STAILQ_REMOVE(&pg->digest_conns, conn, spdk_iscsi_conn, digest_link);
+		iscsi_conn_flush_digests(conn);
+	}
+
 	rc = spdk_sock_group_remove_sock(pg->sock_group, conn->sock);
 	if (rc < 0) {
 		SPDK_ERRLOG("Failed to remove sock=%p of conn=%p\n", conn->sock, conn);
@@ -343,6 +345,7 @@ iscsi_conn_free_tasks(struct spdk_iscsi_conn *conn)
 	 *  and may stack some PDUs to conn->write_pdu_list.  Hence when we come here, we
 	 *  have to ensure there is no associated task in conn->queued_datain_tasks.
 	 */
+	assert(conn->digest_pdu == NULL);
 	TAILQ_FOREACH_SAFE(pdu, &conn->write_pdu_list, tailq, tmp_pdu) {
 		TAILQ_REMOVE(&conn->write_pdu_list, pdu, tailq);
 		spdk_iscsi_conn_free_pdu(conn, pdu);
@@ -616,9 +619,14 @@ iscsi_conn_stop(struct spdk_iscsi_conn *conn)
 	    conn->sess->session_type == SESSION_TYPE_NORMAL &&
 	    conn->full_feature) {
 		target = conn->sess->target;
+		pthread_mutex_lock(&g_spdk_iscsi.mutex);
 		pthread_mutex_lock(&target->mutex);
 		target->num_active_conns--;
+		if (target->num_active_conns == 0) {
+			target->pg->num_targets--;
+		}
 		pthread_mutex_unlock(&target->mutex);
+		pthread_mutex_unlock(&g_spdk_iscsi.mutex);
 
 		iscsi_conn_close_luns(conn);
 	}
@@ -707,7 +715,10 @@ spdk_iscsi_conn_destruct(struct spdk_iscsi_conn *conn)
 	if (pdu) {
 		/* remove the task left in the PDU too. */
 		task = pdu->task;
-		if (task) {
+		if (task && pdu->data_in_task_buf) {
+			/* Only the primary task is referenced while reading into its buffer. */
+			spdk_iscsi_task_put(task);
+		} else if (task) {
 			opcode = pdu->bhs.opcode;
 			switch (opcode) {
 			case ISCSI_OP_SCSI:
@@ -1457,12 +1468,120 @@ _iscsi_conn_pdu_write_done(void *cb_arg, int err)
 	}
 }
 
+static void
+iscsi_conn_pdu_writev(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *pdu)
+{
+	spdk_trace_record(TRACE_ISCSI_FLUSH_WRITEBUF_START, conn->id, pdu->mapped_length,
+			  (uintptr_t)pdu, pdu->sock_req.iovcnt);
+	spdk_sock_writev_async(conn->sock, &pdu->sock_req);
+}
+
+/* Send the PDUs whose digests have been calculated. */
+static int
+iscsi_conn_send_digest_pdus(struct spdk_iscsi_conn *conn)
+{
+	struct spdk_iscsi_pdu *pdu, *next_pdu;
+	uint32_t num_pdus = conn->num_digest_pdus;
+
+	pdu = conn->digest_pdu;
+	conn->digest_pdu = NULL;
+	conn->num_digest_pdus = 0;
+
+	/*
+	 * Writing a PDU may complete earlier ones and queue new PDUs behind, so
+	 *  look up the next PDU first and stop after the ones counted above.
+	 */
+	while (num_pdus-- > 0) {
+		if (spdk_unlikely(conn->state >= ISCSI_CONN_STATE_EXITING)) {
+			/* The remaining PDUs are freed with the connection. */
+			return 0;
+		}
+		next_pdu = TAILQ_NEXT(pdu, tailq);
+		iscsi_conn_pdu_writev(conn, pdu);
+		pdu = next_pdu;
+	}
+
+	return 1;
+}
+
+static int
+iscsi_conn_gather_digest_pdus(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu **pdus,
+			      int num_pdus)
+{
+	struct spdk_iscsi_pdu *pdu;
+	uint32_t i;
+
+	if (spdk_unlikely(conn->state >= ISCSI_CONN_STATE_EXITING)) {
+		return num_pdus;
+	}
+
+	pdu = conn->digest_pdu;
+	for (i = 0; i < conn->num_digest_pdus; i++) {
+		pdus[num_pdus++] = pdu;
+		if (num_pdus == ISCSI_DIGEST_BATCH_SIZE) {
+			spdk_iscsi_pdus_calc_digests(pdus, num_pdus);
+			num_pdus = 0;
+		}
+		pdu = TAILQ_NEXT(pdu, tailq);
+	}
+
+	return num_pdus;
+}
+
+static void
+iscsi_conn_flush_digests(struct spdk_iscsi_conn *conn)
+{
+	struct spdk_iscsi_pdu *pdus[ISCSI_DIGEST_BATCH_SIZE];
+	int num_pdus;
+
+	num_pdus = iscsi_conn_gather_digest_pdus(conn, pdus, 0);
+	if (num_pdus > 0) {
+		spdk_iscsi_pdus_calc_digests(pdus, num_pdus);
+	}
+
+	iscsi_conn_send_digest_pdus(conn);
+}
+
+/*
+ * Calculate the digests of the PDUs queued since the last poll on all connections
+ *  of the poll group together, and send them. Returns the number of connections
+ *  whose PDUs were sent.
+ */
+int
+spdk_iscsi_poll_group_flush_digests(struct spdk_iscsi_poll_group *pg)
+{
+	STAILQ_HEAD(, spdk_iscsi_conn) conns = STAILQ_HEAD_INITIALIZER(conns);
+	struct spdk_iscsi_pdu *pdus[ISCSI_DIGEST_BATCH_SIZE];
+	struct spdk_iscsi_conn *conn;
+	int num_pdus = 0, count = 0;
+
+	if (spdk_likely(STAILQ_EMPTY(&pg->digest_conns))) {
+		return 0;
+	}
+
+	/* PDUs queued while sending are left for the next poll. */
+	STAILQ_SWAP(&pg->digest_conns, &conns, spdk_iscsi_conn);
+
+	STAILQ_FOREACH(conn, &conns, digest_link) {
+		num_pdus = iscsi_conn_gather_digest_pdus(conn, pdus, num_pdus);
+	}
+	if (num_pdus > 0) {
+		spdk_iscsi_pdus_calc_digests(pdus, num_pdus);
+	}
+
+	while ((conn = STAILQ_FIRST(&conns)) != NULL) {
+		STAILQ_REMOVE_HEAD(&conns, digest_link);
+		count += iscsi_conn_send_digest_pdus(conn);
+	}
+
+	return count;
+}
+
 void
 spdk_iscsi_conn_write_pdu(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *pdu,
 			  iscsi_conn_xfer_complete_cb cb_fn,
 			  void *cb_arg)
 {
-	uint32_t crc32c;
 	ssize_t rc;
 
 	if (spdk_unlikely(pdu->dif_insert_or_strip)) {
@@ -1474,20 +1593,6 @@ spdk_iscsi_conn_write_pdu(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *p
 		}
 	}
 
-	if (pdu->bhs.opcode != ISCSI_OP_LOGIN_RSP) {
-		/* Header Digest */
-		if (conn->header_digest) {
-			crc32c = spdk_iscsi_pdu_calc_header_digest(pdu);
-			MAKE_DIGEST_WORD(pdu->header_digest, crc32c);
-		}
-
-		/* Data Digest */
-		if (conn->data_digest && DGET24(pdu->bhs.data_segment_len) != 0) {
-			crc32c = spdk_iscsi_pdu_calc_data_digest(pdu);
-			MAKE_DIGEST_WORD(pdu->data_digest, crc32c);
-		}
-	}
-
 	pdu->cb_fn = cb_fn;
 	pdu->cb_arg = cb_arg;
 	TAILQ_INSERT_TAIL(&conn->write_pdu_list, pdu, tailq);
@@ -1500,15 +1605,29 @@ spdk_iscsi_conn_write_pdu(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *p
 	pdu->sock_req.cb_fn = _iscsi_conn_pdu_write_done;
 	pdu->sock_req.cb_arg = pdu;
 
-	spdk_trace_record(TRACE_ISCSI_FLUSH_WRITEBUF_START, conn->id, pdu->mapped_length, (uintptr_t)pdu,
-			  pdu->sock_req.iovcnt);
-	spdk_sock_writev_async(conn->sock, &pdu->sock_req);
+	/*
+	 * Digests are calculated for all PDUs of the poll group at once right before
+	 *  the sockets are flushed. PDUs sent without digests have to wait behind them
+	 *  to keep the order.
+	 */
+	if ((pdu->bhs.opcode != ISCSI_OP_LOGIN_RSP && (conn->header_digest || conn->data_digest)) ||
+	    conn->digest_pdu != NULL) {
+		if (conn->digest_pdu == NULL) {
+			conn->digest_pdu = pdu;
+			STAILQ_INSERT_TAIL(&conn->pg->digest_conns, conn, digest_link);
+		}
+		conn->num_digest_pdus++;
+		return;
+	}
+
+	iscsi_conn_pdu_writev(conn, pdu);
 }
 
 static void
 iscsi_conn_sock_cb(void *arg, struct spdk_sock_group *group, struct spdk_sock *sock)
 {
 	struct spdk_iscsi_conn *conn = arg;
+	uint64_t tsc;
 	int rc;
 
 	assert(conn != NULL);
@@ -1519,18 +1638,39 @@ iscsi_conn_sock_cb(void *arg, struct spdk_sock_group *group, struct spdk_sock *s
 	}
 
 	/* Handle incoming PDUs */
+	tsc = spdk_get_ticks();
 	rc = spdk_iscsi_handle_incoming_pdus(conn);
 	if (rc < 0) {
 		conn->state = ISCSI_CONN_STATE_EXITING;
 	}
+
+	if (conn->full_feature && conn->target != NULL) {
+		conn->target->busy_tsc += spdk_get_ticks() - tsc;
+	}
 }
 
 static void
 iscsi_conn_full_feature_migrate(void *arg)
 {
 	struct spdk_iscsi_conn *conn = arg;
+	struct spdk_iscsi_tgt_node *target;
+	struct spdk_iscsi_poll_group *pg;
 
 	if (conn->sess->session_type == SESSION_TYPE_NORMAL) {
+		/* The target node may have been migrated while this message was in flight. */
+		target = conn->sess->target;
+		pthread_mutex_lock(&target->mutex);
+		pg = target->pg;
+		pthread_mutex_unlock(&target->mutex);
+
+		if (pg != conn->pg) {
+			conn->pg = pg;
+			spdk_thread_send_msg(
+				spdk_io_channel_get_thread(spdk_io_channel_from_ctx(pg)),
+				iscsi_conn_full_feature_migrate, conn);
+			return;
+		}
+
 		iscsi_conn_open_luns(conn);
 	}
 
@@ -1540,6 +1680,44 @@ iscsi_conn_full_feature_migrate(void *arg)
 
 static struct spdk_iscsi_poll_group *g_next_pg = NULL;
 
+/* Poll groups whose load differs by less than this (per-mille) are considered equally busy */
+#define ISCSI_PG_LOAD_TOLERANCE		50
+
+/*
+ * Pick the least busy poll group. Among equally busy ones, prefer the one hosting the
+ *  fewest target nodes, and start the search after the previous pick so that ties are
+ *  broken round-robin. Must be called with g_spdk_iscsi.mutex held.
+ */
+static struct spdk_iscsi_poll_group *
+iscsi_conn_get_idlest_pg(void)
+{
+	struct spdk_iscsi_poll_group *pg, *idlest = NULL;
+
+	if (g_next_pg == NULL) {
+		g_next_pg = TAILQ_FIRST(&g_spdk_iscsi.poll_group_head);
+		assert(g_next_pg != NULL);
+	}
+
+	pg = g_next_pg;
+	do {
+		if (idlest == NULL ||
+		    pg->load + ISCSI_PG_LOAD_TOLERANCE < idlest->load ||
+		    (pg->load < idlest->load + ISCSI_PG_LOAD_TOLERANCE &&
+		     pg->num_targets < idlest->num_targets)) {
+			idlest = pg;
+		}
+
+		pg = TAILQ_NEXT(pg, link);
+		if (pg == NULL) {
+			pg = TAILQ_FIRST(&g_spdk_iscsi.poll_group_head);
+		}
+	} while (pg != g_next_pg);
+
+	g_next_pg = TAILQ_NEXT(idlest, link);
+
+	return idlest;
+}
+
 void
 spdk_iscsi_conn_schedule(struct spdk_iscsi_conn *conn)
 {
@@ -1559,15 +1737,10 @@ spdk_iscsi_conn_schedule(struct spdk_iscsi_conn *conn)
 	if (target->num_active_conns == 1) {
 		/**
 		 * This is the only active connection for this target node.
-		 *  Pick a poll group using round-robin.
+		 *  Pick the least busy poll group.
 		 */
-		if (g_next_pg == NULL) {
-			g_next_pg = TAILQ_FIRST(&g_spdk_iscsi.poll_group_head);
-			assert(g_next_pg != NULL);
-		}
-
-		pg = g_next_pg;
-		g_next_pg = TAILQ_NEXT(g_next_pg, link);
+		pg = iscsi_conn_get_idlest_pg();
+		pg->num_targets++;
 
 		/* Save the pg in the target node so it can be used for any other connections to this target node. */
 		target->pg = pg;
@@ -1594,6 +1767,231 @@ spdk_iscsi_conn_schedule(struct spdk_iscsi_conn *conn)
 			     iscsi_conn_full_feature_migrate, conn);
 }
 
+/* Only move a target node when the busiest poll group is this much (per-mille) busier */
+#define ISCSI_REBALANCE_LOAD_GAP	200
+#define ISCSI_MIGRATION_POLL_US		100
+#define ISCSI_MIGRATION_TIMEOUT_US	(1000 * 1000)
+
+/*
+ * All connections of a target node share the I/O channels of its LUNs, so they are
+ *  moved together. The connections stop reading new PDUs once no Data-Out is expected,
+ *  and are moved as soon as all of their tasks have completed. Connections with a logout
+ *  or shutdown timer armed are not moved, since pollers run on the thread that registered them.
+ */
+struct iscsi_conn_migration {
+	struct spdk_iscsi_tgt_node	*target;
+	struct spdk_iscsi_poll_group	*src;
+	struct spdk_iscsi_poll_group	*dst;
+	struct spdk_thread		*thread;
+	uint64_t			deadline;
+	struct spdk_poller		*poller;
+};
+
+/* Only accessed from the thread running the rebalancer */
+static bool g_migration_in_progress = false;
+static uint64_t g_last_rebalance_tsc = 0;
+
+static void
+iscsi_conn_migration_done(void *ctx)
+{
+	g_migration_in_progress = false;
+}
+
+static void
+iscsi_conn_migration_finish(struct iscsi_conn_migration *migration)
+{
+	struct spdk_iscsi_tgt_node *target = migration->target;
+
+	pthread_mutex_lock(&target->mutex);
+	target->migrating = false;
+	pthread_mutex_unlock(&target->mutex);
+
+	migration->src->migration = NULL;
+	spdk_poller_unregister(&migration->poller);
+	spdk_thread_send_msg(migration->thread, iscsi_conn_migration_done, NULL);
+	free(migration);
+}
+
+static bool
+iscsi_conn_is_quiesced(struct spdk_iscsi_conn *conn)
+{
+	return conn->state == ISCSI_CONN_STATE_RUNNING &&
+	       conn->pending_task_cnt == 0 &&
+	       TAILQ_EMPTY(&conn->write_pdu_list) &&
+	       conn->pdu_recv_state == ISCSI_PDU_RECV_STATE_AWAIT_PDU_READY &&
+	       conn->logout_request_timer == NULL &&
+	       conn->logout_timer == NULL &&
+	       conn->shutdown_timer == NULL;
+}
+
+static int
+iscsi_conn_migration_poll(void *arg)
+{
+	struct iscsi_conn_migration *migration = arg;
+	struct spdk_iscsi_tgt_node *target = migration->target;
+	struct spdk_iscsi_poll_group *src = migration->src;
+	struct spdk_iscsi_poll_group *dst = migration->dst;
+	struct spdk_iscsi_conn *conn, *tmp;
+	uint32_t num_conns = 0;
+	bool quiesced = true;
+
+	STAILQ_FOREACH(conn, &src->connections, link) {
+		if (conn->target != target || !conn->full_feature) {
+			continue;
+		}
+		if (conn->state >= ISCSI_CONN_STATE_EXITING) {
+			/* Leave it to a later rebalance */
+			iscsi_conn_migration_finish(migration);
+			return -1;
+		}
+		quiesced = quiesced && iscsi_conn_is_quiesced(conn);
+		num_conns++;
+	}
+
+	pthread_mutex_lock(&g_spdk_iscsi.mutex);
+	pthread_mutex_lock(&target->mutex);
+	if (target->destructed || target->num_active_conns == 0 ||
+	    spdk_get_ticks() > migration->deadline) {
+		pthread_mutex_unlock(&target->mutex);
+		pthread_mutex_unlock(&g_spdk_iscsi.mutex);
+		iscsi_conn_migration_finish(migration);
+		return -1;
+	}
+
+	/* Connections may still be on their way to this poll group */
+	if (!quiesced || num_conns != target->num_active_conns) {
+		pthread_mutex_unlock(&target->mutex);
+		pthread_mutex_unlock(&g_spdk_iscsi.mutex);
+		return -1;
+	}
+
+	/* From now on new connections go directly to the new poll group */
+	target->pg = dst;
+	src->num_targets--;
+	dst->num_targets++;
+	pthread_mutex_unlock(&target->mutex);
+	pthread_mutex_unlock(&g_spdk_iscsi.mutex);
+
+	/*
+	 * Release the LUN I/O channels of all connections before any of them
+	 *  reopens them on the new poll group.
+	 */
+	STAILQ_FOREACH_SAFE(conn, &src->connections, link, tmp) {
+		if (conn->target != target || !conn->full_feature) {
+			continue;
+		}
+		iscsi_poll_group_remove_conn(src, conn);
+		iscsi_conn_close_luns(conn);
+		conn->pg = dst;
+		spdk_thread_send_msg(spdk_io_channel_get_thread(spdk_io_channel_from_ctx(dst)),
+				     iscsi_conn_full_feature_migrate, conn);
+	}
+
+	SPDK_DEBUGLOG(SPDK_LOG_ISCSI, "Migrated %u connections of %s\n", num_conns, target->name);
+	iscsi_conn_migration_finish(migration);
+
+	return -1;
+}
+
+static void
+iscsi_conn_migration_start(void *arg)
+{
+	struct iscsi_conn_migration *migration = arg;
+
+	migration->deadline = spdk_get_ticks() +
+			      ISCSI_MIGRATION_TIMEOUT_US * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
+	migration->src->migration = migration;
+	migration->poller = spdk_poller_register(iscsi_conn_migration_poll, migration,
+			    ISCSI_MIGRATION_POLL_US);
+}
+
+void
+spdk_iscsi_poll_group_cancel_migration(struct spdk_iscsi_poll_group *pg)
+{
+	if (pg->migration != NULL) {
+		iscsi_conn_migration_finish(pg->migration);
+	}
+}
+
+/*
+ * Move one target node from the busiest to the idlest poll group when their loads
+ *  differ by at least ISCSI_REBALANCE_LOAD_GAP. The busiest target node whose own
+ *  load is at most half of the gap is picked, so that the move narrows the gap
+ *  without reversing it.
+ */
+void
+spdk_iscsi_conns_rebalance(void)
+{
+	struct spdk_iscsi_poll_group *pg, *busiest = NULL, *idlest = NULL;
+	struct spdk_iscsi_tgt_node *target, *victim = NULL;
+	struct iscsi_conn_migration *migration;
+	uint64_t now, period, busy;
+	uint32_t load, victim_load = 0, gap = 0;
+
+	now = spdk_get_ticks();
+	period = now - g_last_rebalance_tsc;
+	g_last_rebalance_tsc = now;
+
+	pthread_mutex_lock(&g_spdk_iscsi.mutex);
+
+	TAILQ_FOREACH(pg, &g_spdk_iscsi.poll_group_head, link) {
+		if (busiest == NULL || pg->load > busiest->load) {
+			busiest = pg;
+		}
+		if (idlest == NULL || pg->load < idlest->load) {
+			idlest = pg;
+		}
+	}
+	if (busiest != NULL) {
+		gap = busiest->load - idlest->load;
+	}
+
+	TAILQ_FOREACH(target, &g_spdk_iscsi.target_head, tailq) {
+		busy = target->busy_tsc;
+		load = (busy - target->last_busy_tsc) * 1000 / period;
+		target->last_busy_tsc = busy;
+
+		if (g_migration_in_progress || gap < ISCSI_REBALANCE_LOAD_GAP ||
+		    load <= victim_load || load > gap / 2) {
+			continue;
+		}
+
+		pthread_mutex_lock(&target->mutex);
+		if (target->pg == busiest && target->num_active_conns > 0 &&
+		    !target->migrating && !target->destructed) {
+			victim = target;
+			victim_load = load;
+		}
+		pthread_mutex_unlock(&target->mutex);
+	}
+
+	if (victim == NULL) {
+		goto unlock;
+	}
+
+	migration = calloc(1, sizeof(*migration));
+	if (migration == NULL) {
+		goto unlock;
+	}
+	migration->target = victim;
+	migration->src = busiest;
+	migration->dst = idlest;
+	migration->thread = spdk_get_thread();
+
+	pthread_mutex_lock(&victim->mutex);
+	victim->migrating = true;
+	pthread_mutex_unlock(&victim->mutex);
+	g_migration_in_progress = true;
+
+	SPDK_DEBUGLOG(SPDK_LOG_ISCSI, "Migrating %s (load %u) from poll group load %u to %u\n",
+		      victim->name, victim_load, busiest->load, idlest->load);
+	spdk_thread_send_msg(spdk_io_channel_get_thread(spdk_io_channel_from_ctx(busiest)),
+			     iscsi_conn_migration_start, migration);
+
+unlock:
+	pthread_mutex_unlock(&g_spdk_iscsi.mutex);
+}
+
 static int
 logout_timeout(void *arg)
 {
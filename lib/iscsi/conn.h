@@ -137,6 +137,14 @@ struct spdk_iscsi_conn {
 	TAILQ_HEAD(, spdk_iscsi_pdu) write_pdu_list;
 	TAILQ_HEAD(, spdk_iscsi_pdu) snack_pdu_list;
 
+	/*
+	 * The last num_digest_pdus PDUs of write_pdu_list, starting at digest_pdu, wait
+	 *  for their digests to be calculated by the poll group before being sent.
+	 */
+	struct spdk_iscsi_pdu		*digest_pdu;
+	uint32_t			num_digest_pdus;
+	STAILQ_ENTRY(spdk_iscsi_conn)	digest_link;
+
 	int pending_r2t;
 	struct spdk_iscsi_task *outstanding_r2t_tasks[DEFAULT_MAXR2T];
 
@@ -212,6 +220,9 @@ int spdk_iscsi_conn_construct(struct spdk_iscsi_portal *portal, struct spdk_sock
 void spdk_iscsi_conn_destruct(struct spdk_iscsi_conn *conn);
 void spdk_iscsi_conn_handle_nop(struct spdk_iscsi_conn *conn);
 void spdk_iscsi_conn_schedule(struct spdk_iscsi_conn *conn);
+void spdk_iscsi_conns_rebalance(void);
+int spdk_iscsi_poll_group_flush_digests(struct spdk_iscsi_poll_group *pg);
+void spdk_iscsi_poll_group_cancel_migration(struct spdk_iscsi_poll_group *pg);
 void spdk_iscsi_conn_logout(struct spdk_iscsi_conn *conn);
 int spdk_iscsi_drop_conns(struct spdk_iscsi_conn *conn,
 			  const char *conn_match, int drop_all);
@@ -315,6 +315,50 @@ spdk_iscsi_pdu_calc_header_digest(struct spdk_iscsi_pdu *pdu)
 	return crc32c;
 }
 
+/*
+ * Get the first piece of the data segment of a PDU whose data is described by
+ *  data_iovs, and return the index of the iovec it was taken from.
+ */
+static int
+iscsi_pdu_data_iov_first(struct spdk_iscsi_pdu *pdu, uint32_t data_len, struct iovec *piece)
+{
+	uint32_t offset = pdu->data_iov_offset;
+	int i;
+
+	for (i = 0; i < pdu->data_iovcnt; i++) {
+		if (offset < pdu->data_iovs[i].iov_len) {
+			break;
+		}
+		offset -= pdu->data_iovs[i].iov_len;
+	}
+
+	assert(i < pdu->data_iovcnt);
+	piece->iov_base = (uint8_t *)pdu->data_iovs[i].iov_base + offset;
+	piece->iov_len = spdk_min(pdu->data_iovs[i].iov_len - offset, data_len);
+
+	return i;
+}
+
+/*
+ * Continue a CRC-32C over the rest of the data segment described by data_iovs,
+ *  starting after the first piece returned by iscsi_pdu_data_iov_first().
+ */
+static uint32_t
+iscsi_pdu_data_iovs_crc32c(struct spdk_iscsi_pdu *pdu, int i, uint32_t remaining,
+			   uint32_t crc32c)
+{
+	uint32_t len;
+
+	for (i++; remaining > 0 && i < pdu->data_iovcnt; i++) {
+		len = spdk_min(pdu->data_iovs[i].iov_len, remaining);
+		crc32c = spdk_crc32c_update(pdu->data_iovs[i].iov_base, len, crc32c);
+		remaining -= len;
+	}
+
+	assert(remaining == 0);
+	return crc32c;
+}
+
 uint32_t
 spdk_iscsi_pdu_calc_data_digest(struct spdk_iscsi_pdu *pdu)
 {
@@ -323,9 +367,14 @@ spdk_iscsi_pdu_calc_data_digest(struct spdk_iscsi_pdu *pdu)
 	uint32_t mod;
 	struct iovec iov;
 	uint32_t num_blocks;
+	int i;
 
 	crc32c = SPDK_CRC32C_INITIAL;
-	if (spdk_likely(!pdu->dif_insert_or_strip)) {
+	if (pdu->data_iovs != NULL) {
+		i = iscsi_pdu_data_iov_first(pdu, data_len, &iov);
+		crc32c = spdk_crc32c_update(iov.iov_base, iov.iov_len, crc32c);
+		crc32c = iscsi_pdu_data_iovs_crc32c(pdu, i, data_len - iov.iov_len, crc32c);
+	} else if (spdk_likely(!pdu->dif_insert_or_strip)) {
 		crc32c = spdk_crc32c_update(pdu->data, data_len, crc32c);
 	} else {
 		iov.iov_base = pdu->data_buf;
@@ -349,6 +398,109 @@ spdk_iscsi_pdu_calc_data_digest(struct spdk_iscsi_pdu *pdu)
 	return crc32c;
 }
 
+static bool
+iscsi_pdu_needs_header_digest(struct spdk_iscsi_pdu *pdu)
+{
+	return pdu->conn->header_digest && pdu->bhs.opcode != ISCSI_OP_LOGIN_RSP;
+}
+
+static bool
+iscsi_pdu_needs_data_digest(struct spdk_iscsi_pdu *pdu)
+{
+	return pdu->conn->data_digest && pdu->bhs.opcode != ISCSI_OP_LOGIN_RSP &&
+	       DGET24(pdu->bhs.data_segment_len) != 0;
+}
+
+/*
+ * Fill in the header and data digests of outgoing PDUs. Same as calling
+ *  spdk_iscsi_pdu_calc_header_digest() and spdk_iscsi_pdu_calc_data_digest()
+ *  for each PDU, but the CRC-32C of the BHSs and of the data segments are
+ *  calculated together so that several buffers are checksummed in parallel.
+ */
+void
+spdk_iscsi_pdus_calc_digests(struct spdk_iscsi_pdu **pdus, int num_pdus)
+{
+	struct spdk_iscsi_pdu *pdu, *lane_pdus[ISCSI_DIGEST_BATCH_SIZE] = {NULL};
+	/* Only the first num_lanes entries are used, but zero the rest for the compiler */
+	const void *bufs[ISCSI_DIGEST_BATCH_SIZE] = {NULL};
+	size_t lens[ISCSI_DIGEST_BATCH_SIZE] = {0};
+	uint32_t crcs[ISCSI_DIGEST_BATCH_SIZE] = {0};
+	int first_iovs[ISCSI_DIGEST_BATCH_SIZE] = {0};
+	uint32_t ahs_len_bytes, data_len, mod;
+	uint8_t pad[3] = {0, 0, 0};
+	struct iovec piece;
+	int i, num_lanes;
+
+	assert(num_pdus <= ISCSI_DIGEST_BATCH_SIZE);
+
+	/* Header digests */
+	num_lanes = 0;
+	for (i = 0; i < num_pdus; i++) {
+		pdu = pdus[i];
+		if (!iscsi_pdu_needs_header_digest(pdu)) {
+			continue;
+		}
+		lane_pdus[num_lanes] = pdu;
+		bufs[num_lanes] = &pdu->bhs;
+		lens[num_lanes] = ISCSI_BHS_LEN;
+		crcs[num_lanes] = SPDK_CRC32C_INITIAL;
+		num_lanes++;
+	}
+
+	spdk_crc32c_update_multi(bufs, lens, crcs, num_lanes);
+
+	for (i = 0; i < num_lanes; i++) {
+		pdu = lane_pdus[i];
+		ahs_len_bytes = pdu->bhs.total_ahs_len * 4;
+		if (ahs_len_bytes) {
+			crcs[i] = spdk_crc32c_update(pdu->ahs, ahs_len_bytes, crcs[i]);
+		}
+		MAKE_DIGEST_WORD(pdu->header_digest, crcs[i] ^ SPDK_CRC32C_XOR);
+	}
+
+	/* Data digests */
+	num_lanes = 0;
+	for (i = 0; i < num_pdus; i++) {
+		pdu = pdus[i];
+		if (!iscsi_pdu_needs_data_digest(pdu)) {
+			continue;
+		}
+		if (spdk_unlikely(pdu->dif_insert_or_strip)) {
+			MAKE_DIGEST_WORD(pdu->data_digest, spdk_iscsi_pdu_calc_data_digest(pdu));
+			continue;
+		}
+		lane_pdus[num_lanes] = pdu;
+		data_len = DGET24(pdu->bhs.data_segment_len);
+		if (pdu->data_iovs != NULL) {
+			/* Only the first piece goes in the lane, the rest is continued below. */
+			first_iovs[num_lanes] = iscsi_pdu_data_iov_first(pdu, data_len, &piece);
+			bufs[num_lanes] = piece.iov_base;
+			lens[num_lanes] = piece.iov_len;
+		} else {
+			bufs[num_lanes] = pdu->data;
+			lens[num_lanes] = data_len;
+		}
+		crcs[num_lanes] = SPDK_CRC32C_INITIAL;
+		num_lanes++;
+	}
+
+	spdk_crc32c_update_multi(bufs, lens, crcs, num_lanes);
+
+	for (i = 0; i < num_lanes; i++) {
+		pdu = lane_pdus[i];
+		data_len = DGET24(pdu->bhs.data_segment_len);
+		if (pdu->data_iovs != NULL && lens[i] < data_len) {
+			crcs[i] = iscsi_pdu_data_iovs_crc32c(pdu, first_iovs[i], data_len - lens[i],
+							     crcs[i]);
+		}
+		mod = data_len % ISCSI_ALIGNMENT;
+		if (mod != 0) {
+			crcs[i] = spdk_crc32c_update(pad, ISCSI_ALIGNMENT - mod, crcs[i]);
+		}
+		MAKE_DIGEST_WORD(pdu->data_digest, crcs[i] ^ SPDK_CRC32C_XOR);
+	}
+}
+
 static int
 iscsi_conn_read_data_segment(struct spdk_iscsi_conn *conn,
 			     struct spdk_iscsi_pdu *pdu,
@@ -424,6 +576,32 @@ _iscsi_sgl_append(struct _iscsi_sgl *s, uint8_t *data, uint32_t data_len)
 	return true;
 }
 
+/* Append the data segment of a PDU which is described by data_iovs. */
+static inline bool
+_iscsi_sgl_append_data_iovs(struct _iscsi_sgl *s, struct spdk_iscsi_pdu *pdu,
+			    uint32_t data_len)
+{
+	struct iovec piece;
+	uint32_t len;
+	int i;
+
+	i = iscsi_pdu_data_iov_first(pdu, data_len, &piece);
+	if (!_iscsi_sgl_append(s, piece.iov_base, piece.iov_len)) {
+		return false;
+	}
+	data_len -= piece.iov_len;
+
+	for (i++; data_len > 0 && i < pdu->data_iovcnt; i++) {
+		len = spdk_min(pdu->data_iovs[i].iov_len, data_len);
+		if (!_iscsi_sgl_append(s, pdu->data_iovs[i].iov_base, len)) {
+			return false;
+		}
+		data_len -= len;
+	}
+
+	return true;
+}
+
 /* Build iovec array to leave metadata space for every data block
  * when reading data segment from socket.
  */
@@ -471,6 +649,7 @@ spdk_iscsi_build_iovs(struct spdk_iscsi_conn *conn, struct iovec *iovs, int iovc
 	int enable_digest;
 	uint32_t total_ahs_len;
 	uint32_t data_len;
+	static uint8_t zero_pad[ISCSI_ALIGNMENT];
 
 	if (iovcnt == 0) {
 		return 0;
@@ -478,7 +657,6 @@ spdk_iscsi_build_iovs(struct spdk_iscsi_conn *conn, struct iovec *iovs, int iovc
 
 	total_ahs_len = pdu->bhs.total_ahs_len;
 	data_len = DGET24(pdu->bhs.data_segment_len);
-	data_len = ISCSI_ALIGN(data_len);
 
 	enable_digest = 1;
 	if (pdu->bhs.opcode == ISCSI_OP_LOGIN_RSP) {
@@ -508,13 +686,28 @@ spdk_iscsi_build_iovs(struct spdk_iscsi_conn *conn, struct iovec *iovs, int iovc
 
 	/* Data Segment */
 	if (data_len > 0) {
-		if (!pdu->dif_insert_or_strip) {
-			if (!_iscsi_sgl_append(&sgl, pdu->data, data_len)) {
+		if (pdu->data_iovs != NULL) {
+			if (!_iscsi_sgl_append_data_iovs(&sgl, pdu, data_len)) {
+				/* Data-In PDUs span at most SPDK_ISCSI_MAX_DATA_IOVS task buffers,
+				 * so their data segment is never cut short.
+				 */
+				assert(false);
+				goto end;
+			}
+			/* The task buffers may not be padded, so pad from a separate buffer. */
+			if (ISCSI_ALIGN(data_len) != data_len) {
+				if (!_iscsi_sgl_append(&sgl, zero_pad,
+						       ISCSI_ALIGN(data_len) - data_len)) {
+					goto end;
+				}
+			}
+		} else if (!pdu->dif_insert_or_strip) {
+			if (!_iscsi_sgl_append(&sgl, pdu->data, ISCSI_ALIGN(data_len))) {
 				goto end;
 			}
 		} else {
 			if (!_iscsi_sgl_append_with_md(&sgl, pdu->data, pdu->data_buf_len,
-						       data_len, &pdu->dif_ctx)) {
+						       ISCSI_ALIGN(data_len), &pdu->dif_ctx)) {
 				goto end;
 			}
 		}
@@ -2917,15 +3110,14 @@ iscsi_send_datain(struct spdk_iscsi_conn *conn,
 	int F_bit, U_bit, O_bit, S_bit;
 	struct spdk_iscsi_task *primary;
 	struct spdk_scsi_lun *lun_dev;
+	uint32_t buf_offset;
 
 	primary = spdk_iscsi_task_get_primary(task);
 
 	/* DATA PDU */
 	rsp_pdu = spdk_get_pdu(conn);
 	rsph = (struct iscsi_bhs_data_in *)&rsp_pdu->bhs;
-	rsp_pdu->data = task->scsi.iovs[0].iov_base + offset;
-	rsp_pdu->data_buf_len = task->scsi.iovs[0].iov_len - offset;
-	rsp_pdu->data_from_mempool = true;
+	buf_offset = offset;
 
 	task_tag = task->tag;
 	transfer_tag = 0xffffffffU;
@@ -3007,11 +3199,46 @@ iscsi_send_datain(struct spdk_iscsi_conn *conn,
 		}
 	}
 
+	if (spdk_likely(!rsp_pdu->dif_insert_or_strip)) {
+		/* Send the data segment straight from the task buffers, however they are split. */
+		rsp_pdu->data_iovs = task->scsi.iovs;
+		rsp_pdu->data_iovcnt = task->scsi.iovcnt;
+		rsp_pdu->data_iov_offset = buf_offset;
+	} else {
+		rsp_pdu->data = task->scsi.iovs[0].iov_base + buf_offset;
+		rsp_pdu->data_buf_len = task->scsi.iovs[0].iov_len - buf_offset;
+	}
+	rsp_pdu->data_from_mempool = true;
+
 	spdk_iscsi_conn_write_pdu(conn, rsp_pdu, spdk_iscsi_conn_datain_pdu_complete, conn);
 
 	return DataSN;
 }
 
+/*
+ * Return the number of bytes of the task buffers, starting at offset, which
+ *  a Data-In PDU can send, i.e. which are covered by SPDK_ISCSI_MAX_DATA_IOVS
+ *  buffer elements.
+ */
+static uint32_t
+iscsi_datain_max_len(struct spdk_iscsi_task *task, uint32_t offset)
+{
+	struct iovec *iovs = task->scsi.iovs;
+	uint32_t len = 0;
+	int i, n;
+
+	for (i = 0; i < task->scsi.iovcnt && offset >= iovs[i].iov_len; i++) {
+		offset -= iovs[i].iov_len;
+	}
+
+	for (n = 0; i < task->scsi.iovcnt && n < SPDK_ISCSI_MAX_DATA_IOVS; i++, n++) {
+		len += iovs[i].iov_len - offset;
+		offset = 0;
+	}
+
+	return len;
+}
+
 static int
 iscsi_transfer_in(struct spdk_iscsi_conn *conn, struct spdk_iscsi_task *task)
 {
@@ -3065,8 +3292,12 @@ iscsi_transfer_in(struct spdk_iscsi_conn *conn, struct spdk_iscsi_task *task)
 					transfer_len);
 
 		/* send data splitted by segment_len */
-		for (; offset < sequence_end; offset += segment_len) {
+		for (; offset < sequence_end; offset += len) {
 			len = spdk_min(segment_len, (sequence_end - offset));
+			if (task->scsi.iovcnt > SPDK_ISCSI_MAX_DATA_IOVS) {
+				len = spdk_min(len, iscsi_datain_max_len(task, offset));
+				assert(len > 0);
+			}
 
 			datain_flag &= ~ISCSI_FLAG_FINAL;
 			datain_flag &= ~ISCSI_DATAIN_STATUS;
@@ -4191,6 +4422,83 @@ iscsi_pdu_hdr_op_snack(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *pdu)
 	return rc;
 }
 
+/* Submit the data collected in the Data-Out buffer of the primary task as a single subtask. */
+static void
+iscsi_task_submit_data_out_buf(struct spdk_iscsi_conn *conn, struct spdk_iscsi_task *task)
+{
+	struct spdk_iscsi_task *subtask;
+
+	subtask = spdk_iscsi_task_get(conn, task, spdk_iscsi_task_cpl);
+	assert(subtask != NULL);
+	subtask->scsi.offset = task->mobj_offset;
+	subtask->scsi.length = task->mobj_len;
+	subtask->mobj = task->mobj;
+	spdk_scsi_task_set_data(&subtask->scsi, task->mobj->buf, task->mobj_len);
+	task->mobj = NULL;
+	task->mobj_len = 0;
+
+	if (spdk_scsi_dev_get_lun(conn->dev, subtask->lun_id) == NULL) {
+		SPDK_DEBUGLOG(SPDK_LOG_ISCSI, "LUN %d is removed, complete the task immediately\n",
+			      subtask->lun_id);
+		subtask->scsi.transfer_len = subtask->scsi.length;
+		spdk_scsi_task_process_null_lun(&subtask->scsi);
+		spdk_iscsi_task_cpl(&subtask->scsi);
+		return;
+	}
+
+	spdk_iscsi_queue_task(conn, subtask);
+}
+
+/*
+ * Let the data segment of a Data-Out PDU be read directly into the Data-Out buffer of
+ *  the primary task, so that consecutive PDUs end up in a single buffer and a single
+ *  write. Returns false if the PDU has to be handled by a subtask of its own.
+ */
+static bool
+iscsi_task_set_data_out_buf(struct spdk_iscsi_conn *conn, struct spdk_iscsi_task *task,
+			    struct spdk_iscsi_pdu *pdu, uint32_t buffer_offset)
+{
+	struct spdk_scsi_lun *lun_dev;
+	struct spdk_dif_ctx dif_ctx;
+
+	/* DIF insert/strip needs per-PDU buffers with space for the metadata. */
+	lun_dev = spdk_scsi_dev_get_lun(conn->dev, task->lun_id);
+	if (pdu->data_segment_len == 0 || lun_dev == NULL ||
+	    spdk_scsi_lun_get_dif_ctx(lun_dev, &task->scsi, &dif_ctx)) {
+		/* Data collected so far has to be written before this PDU's. */
+		if (task->mobj != NULL) {
+			iscsi_task_submit_data_out_buf(conn, task);
+		}
+		return false;
+	}
+
+	if (task->mobj != NULL &&
+	    (task->mobj_offset + task->mobj_len != buffer_offset ||
+	     task->mobj_len + pdu->data_segment_len > SPDK_ISCSI_MAX_RECV_DATA_SEGMENT_LENGTH)) {
+		iscsi_task_submit_data_out_buf(conn, task);
+	}
+
+	if (task->mobj == NULL) {
+		task->mobj = spdk_mempool_get(g_spdk_iscsi.pdu_data_out_pool);
+		if (task->mobj == NULL) {
+			return false;
+		}
+		task->mobj_offset = buffer_offset;
+		task->mobj_len = 0;
+	}
+
+	pdu->data_buf = (uint8_t *)task->mobj->buf + task->mobj_len;
+	pdu->data = pdu->data_buf;
+	pdu->data_buf_len = SPDK_ISCSI_MAX_RECV_DATA_SEGMENT_LENGTH - task->mobj_len;
+	pdu->data_from_mempool = true;
+	pdu->data_in_task_buf = true;
+
+	/* Hold the primary task, and so the buffer, until the data segment is read. */
+	task->scsi.ref++;
+	pdu->task = task;
+	return true;
+}
+
 static int
 iscsi_pdu_hdr_op_data(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *pdu)
 {
@@ -4278,14 +4586,18 @@ iscsi_pdu_hdr_op_data(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *pdu)
 		task->current_r2t_length = 0;
 	}
 
-	subtask = spdk_iscsi_task_get(conn, task, spdk_iscsi_task_cpl);
-	if (subtask == NULL) {
-		SPDK_ERRLOG("Unable to acquire subtask\n");
-		return SPDK_ISCSI_CONNECTION_FATAL;
+	if (iscsi_task_set_data_out_buf(conn, task, pdu, buffer_offset)) {
+		subtask = NULL;
+	} else {
+		subtask = spdk_iscsi_task_get(conn, task, spdk_iscsi_task_cpl);
+		if (subtask == NULL) {
+			SPDK_ERRLOG("Unable to acquire subtask\n");
+			return SPDK_ISCSI_CONNECTION_FATAL;
+		}
+		subtask->scsi.offset = buffer_offset;
+		subtask->scsi.length = pdu->data_segment_len;
+		spdk_iscsi_task_associate_pdu(subtask, pdu);
 	}
-	subtask->scsi.offset = buffer_offset;
-	subtask->scsi.length = pdu->data_segment_len;
-	spdk_iscsi_task_associate_pdu(subtask, pdu);
 
 	if (task->next_expected_r2t_offset == transfer_len) {
 		task->acked_r2tsn++;
@@ -4301,6 +4613,11 @@ iscsi_pdu_hdr_op_data(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *pdu)
 		task->next_r2t_offset += len;
 	}
 
+	if (subtask == NULL) {
+		/* The data segment is read into the buffer of the primary task. */
+		return 0;
+	}
+
 	if (lun_dev == NULL) {
 		SPDK_DEBUGLOG(SPDK_LOG_ISCSI, "LUN %d is removed, complete the task immediately\n",
 			      task->lun_id);
@@ -4330,7 +4647,7 @@ reject_return:
 static int
 iscsi_pdu_payload_op_data(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *pdu)
 {
-	struct spdk_iscsi_task *subtask;
+	struct spdk_iscsi_task *task, *subtask;
 	struct iscsi_bhs_data_out *reqh;
 	uint32_t transfer_tag;
 
@@ -4338,11 +4655,28 @@ iscsi_pdu_payload_op_data(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *p
 		return 0;
 	}
 
-	subtask = pdu->task;
-
 	reqh = (struct iscsi_bhs_data_out *)&pdu->bhs;
 	transfer_tag = from_be32(&reqh->ttt);
 
+	if (pdu->data_in_task_buf) {
+		task = pdu->task;
+		pdu->task = NULL;
+
+		/* Data for a transfer which was cleared meanwhile is dropped with the task. */
+		if (get_transfer_task(conn, transfer_tag) == task) {
+			task->mobj_len += DGET24(pdu->bhs.data_segment_len);
+			if ((reqh->flags & ISCSI_FLAG_FINAL) ||
+			    task->mobj_len == SPDK_ISCSI_MAX_RECV_DATA_SEGMENT_LENGTH) {
+				iscsi_task_submit_data_out_buf(conn, task);
+			}
+		}
+
+		spdk_iscsi_task_put(task);
+		return 0;
+	}
+
+	subtask = pdu->task;
+
 	if (get_transfer_task(conn, transfer_tag) == NULL) {
 		SPDK_ERRLOG("Not found for transfer_tag=%x\n", transfer_tag);
 		subtask->scsi.transfer_len = subtask->scsi.length;
@@ -4817,6 +5151,17 @@ spdk_iscsi_handle_incoming_pdus(struct spdk_iscsi_conn *conn)
 
 	/* Read new PDUs from network */
 	for (i = 0; i < GET_PDU_LOOP_COUNT; i++) {
+		/*
+		 * Stop at a PDU boundary while the target node is being moved to another
+		 *  poll group, unless the initiator still has solicited Data-Out to send.
+		 */
+		if (conn->target != NULL && conn->target->migrating &&
+		    conn->pdu_recv_state == ISCSI_PDU_RECV_STATE_AWAIT_PDU_READY &&
+		    TAILQ_EMPTY(&conn->active_r2t_tasks) &&
+		    TAILQ_EMPTY(&conn->queued_r2t_tasks)) {
+			break;
+		}
+
 		rc = iscsi_read_pdu(conn);
 		if (rc == 0) {
 			break;
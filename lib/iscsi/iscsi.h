@@ -78,6 +78,7 @@
 #define DEFAULT_TIMEOUT 60
 #define MAX_NOPININTERVAL 60
 #define DEFAULT_NOPININTERVAL 30
+#define DEFAULT_CONN_REBALANCE_PERIOD 0
 
 /*
  * SPDK iSCSI target currently only supports 64KB as the maximum data segment length
@@ -162,11 +163,16 @@ struct spdk_mobj {
 	void *buf;
 };
 
+/*
+ * Maximum number of task buffer elements a single Data-In PDU may span.
+ */
+#define SPDK_ISCSI_MAX_DATA_IOVS	(4)
+
 /*
  * Maximum number of SGL elements, i.e.,
- * BHS, AHS, Header Digest, Data Segment and Data Digest.
+ * BHS, AHS, Header Digest, Data Segment, Data Segment padding and Data Digest.
  */
-#define SPDK_ISCSI_MAX_SGL_DESCRIPTORS	(5)
+#define SPDK_ISCSI_MAX_SGL_DESCRIPTORS	(5 + SPDK_ISCSI_MAX_DATA_IOVS)
 
 typedef void (*iscsi_conn_xfer_complete_cb)(void *cb_arg);
 
@@ -186,6 +192,7 @@ struct spdk_iscsi_pdu {
 	int ddigest_valid_bytes;
 	int ref;
 	bool data_from_mempool;  /* indicate whether the data buffer is allocated from mempool */
+	bool data_in_task_buf;   /* data segment is read into the Data-Out buffer of task */
 	struct spdk_iscsi_task *task; /* data tied to a task buffer */
 	uint32_t cmd_sn;
 	uint32_t writev_offset;
@@ -194,6 +201,14 @@ struct spdk_iscsi_pdu {
 	struct spdk_dif_ctx dif_ctx;
 	struct spdk_iscsi_conn *conn;
 
+	/*
+	 * If set, the data segment is taken from these iovecs, starting data_iov_offset
+	 *  bytes in, instead of from data. Used by Data-In to send from the task buffers.
+	 */
+	struct iovec *data_iovs;
+	int data_iovcnt;
+	uint32_t data_iov_offset;
+
 	iscsi_conn_xfer_complete_cb		cb_fn;
 	void					*cb_arg;
 
@@ -315,6 +330,22 @@ struct spdk_iscsi_poll_group {
 	STAILQ_HEAD(connections, spdk_iscsi_conn)	connections;
 	struct spdk_sock_group				*sock_group;
 	TAILQ_ENTRY(spdk_iscsi_poll_group)		link;
+
+	/*
+	 * Ticks spent handling socket events, and the busy ratio over the last
+	 *  sampling period in per-mille. Other threads read the ratio as a hint.
+	 */
+	uint64_t					busy_tsc;
+	uint64_t					last_busy_tsc;
+	uint64_t					last_sample_tsc;
+	uint32_t					load;
+
+	/* Number of target nodes placed on this poll group, protected by g_spdk_iscsi.mutex */
+	uint32_t					num_targets;
+	/* Target node whose connections are being moved away from this poll group */
+	struct iscsi_conn_migration			*migration;
+	/* Connections with PDUs waiting for their digests */
+	STAILQ_HEAD(, spdk_iscsi_conn)			digest_conns;
 };
 
 struct spdk_iscsi_opts {
@@ -336,6 +367,7 @@ struct spdk_iscsi_opts {
 	bool ImmediateData;
 	uint32_t ErrorRecoveryLevel;
 	bool AllowDuplicateIsid;
+	uint32_t conn_rebalance_period;
 };
 
 struct spdk_iscsi_globals {
@@ -366,6 +398,8 @@ struct spdk_iscsi_globals {
 	bool ImmediateData;
 	uint32_t ErrorRecoveryLevel;
 	bool AllowDuplicateIsid;
+	uint32_t conn_rebalance_period;
+	struct spdk_poller *rebalance_poller;
 
 	struct spdk_mempool *pdu_pool;
 	struct spdk_mempool *pdu_immediate_data_pool;
@@ -450,8 +484,18 @@ void spdk_clear_all_transfer_task(struct spdk_iscsi_conn *conn,
 				  struct spdk_iscsi_pdu *pdu);
 bool spdk_del_transfer_task(struct spdk_iscsi_conn *conn, uint32_t CmdSN);
 
+#define MAKE_DIGEST_WORD(BUF, CRC32C) \
+        (   ((*((uint8_t *)(BUF)+0)) = (uint8_t)((uint32_t)(CRC32C) >> 0)), \
+            ((*((uint8_t *)(BUF)+1)) = (uint8_t)((uint32_t)(CRC32C) >> 8)), \
+            ((*((uint8_t *)(BUF)+2)) = (uint8_t)((uint32_t)(CRC32C) >> 16)), \
+            ((*((uint8_t *)(BUF)+3)) = (uint8_t)((uint32_t)(CRC32C) >> 24)))
+
+/* Maximum number of PDUs passed to spdk_iscsi_pdus_calc_digests() at once */
+#define ISCSI_DIGEST_BATCH_SIZE	32
+
 uint32_t spdk_iscsi_pdu_calc_header_digest(struct spdk_iscsi_pdu *pdu);
 uint32_t spdk_iscsi_pdu_calc_data_digest(struct spdk_iscsi_pdu *pdu);
+void spdk_iscsi_pdus_calc_digests(struct spdk_iscsi_pdu **pdus, int num_pdus);
 
 /* Memory management */
 void spdk_put_pdu(struct spdk_iscsi_pdu *pdu);
@@ -354,6 +354,8 @@ iscsi_log_globals(void)
 	SPDK_DEBUGLOG(SPDK_LOG_ISCSI, "Timeout %d\n", g_spdk_iscsi.timeout);
 	SPDK_DEBUGLOG(SPDK_LOG_ISCSI, "NopInInterval %d\n",
 		      g_spdk_iscsi.nopininterval);
+	SPDK_DEBUGLOG(SPDK_LOG_ISCSI, "ConnRebalancePeriod %u\n",
+		      g_spdk_iscsi.conn_rebalance_period);
 	if (g_spdk_iscsi.disable_chap) {
 		SPDK_DEBUGLOG(SPDK_LOG_ISCSI,
 			      "DiscoveryAuthMethod None\n");
@@ -391,6 +393,7 @@ iscsi_opts_init(struct spdk_iscsi_opts *opts)
 	opts->ErrorRecoveryLevel = DEFAULT_ERRORRECOVERYLEVEL;
 	opts->timeout = DEFAULT_TIMEOUT;
 	opts->nopininterval = DEFAULT_NOPININTERVAL;
+	opts->conn_rebalance_period = DEFAULT_CONN_REBALANCE_PERIOD;
 	opts->disable_chap = false;
 	opts->require_chap = false;
 	opts->mutual_chap = false;
@@ -465,6 +468,7 @@ spdk_iscsi_opts_copy(struct spdk_iscsi_opts *src)
 	dst->ErrorRecoveryLevel = src->ErrorRecoveryLevel;
 	dst->timeout = src->timeout;
 	dst->nopininterval = src->nopininterval;
+	dst->conn_rebalance_period = src->conn_rebalance_period;
 	dst->disable_chap = src->disable_chap;
 	dst->require_chap = src->require_chap;
 	dst->mutual_chap = src->mutual_chap;
@@ -487,6 +491,7 @@ iscsi_read_config_file_params(struct spdk_conf_section *sp,
 	int ErrorRecoveryLevel;
 	int timeout;
 	int nopininterval;
+	int conn_rebalance_period;
 	const char *ag_tag;
 	int ag_tag_i;
 	int i;
@@ -567,6 +572,10 @@ iscsi_read_config_file_params(struct spdk_conf_section *sp,
 	if (nopininterval >= 0) {
 		opts->nopininterval = nopininterval;
 	}
+	conn_rebalance_period = spdk_conf_section_get_intval(sp, "ConnRebalancePeriod");
+	if (conn_rebalance_period >= 0) {
+		opts->conn_rebalance_period = conn_rebalance_period;
+	}
 	val = spdk_conf_section_get_val(sp, "DiscoveryAuthMethod");
 	if (val != NULL) {
 		for (i = 0; ; i++) {
@@ -762,6 +771,7 @@ iscsi_set_global_params(struct spdk_iscsi_opts *opts)
 	g_spdk_iscsi.ErrorRecoveryLevel = opts->ErrorRecoveryLevel;
 	g_spdk_iscsi.timeout = opts->timeout;
 	g_spdk_iscsi.nopininterval = opts->nopininterval;
+	g_spdk_iscsi.conn_rebalance_period = opts->conn_rebalance_period;
 	g_spdk_iscsi.disable_chap = opts->disable_chap;
 	g_spdk_iscsi.require_chap = opts->require_chap;
 	g_spdk_iscsi.mutual_chap = opts->mutual_chap;
@@ -1130,6 +1140,14 @@ iscsi_initialize_global_params(void)
 	return rc;
 }
 
+static int
+iscsi_rebalance_poll(void *ctx)
+{
+	spdk_iscsi_conns_rebalance();
+
+	return -1;
+}
+
 static void
 iscsi_init_complete(int rc)
 {
@@ -1139,6 +1157,11 @@ iscsi_init_complete(int rc)
 	g_init_cb_fn = NULL;
 	g_init_cb_arg = NULL;
 
+	if (rc == 0 && g_spdk_iscsi.conn_rebalance_period != 0) {
+		g_spdk_iscsi.rebalance_poller = spdk_poller_register(iscsi_rebalance_poll, NULL,
+						g_spdk_iscsi.conn_rebalance_period * 1000000ULL);
+	}
+
 	cb_fn(cb_arg, rc);
 }
 
@@ -1147,15 +1170,20 @@ iscsi_poll_group_poll(void *ctx)
 {
 	struct spdk_iscsi_poll_group *group = ctx;
 	struct spdk_iscsi_conn *conn, *tmp;
-	int rc;
+	uint64_t tsc;
+	int num_flushed, rc;
 
 	if (spdk_unlikely(STAILQ_EMPTY(&group->connections))) {
 		return 0;
 	}
 
+	tsc = spdk_get_ticks();
+	num_flushed = spdk_iscsi_poll_group_flush_digests(group);
 	rc = spdk_sock_group_poll(group->sock_group);
 	if (rc < 0) {
 		SPDK_ERRLOG("Failed to poll sock_group=%p\n", group->sock_group);
+	} else if (rc > 0 || num_flushed > 0) {
+		group->busy_tsc += spdk_get_ticks() - tsc;
 	}
 
 	STAILQ_FOREACH_SAFE(conn, &group->connections, link, tmp) {
@@ -1172,11 +1200,20 @@ iscsi_poll_group_handle_nop(void *ctx)
 {
 	struct spdk_iscsi_poll_group *group = ctx;
 	struct spdk_iscsi_conn *conn, *tmp;
+	uint64_t now, busy;
 
 	STAILQ_FOREACH_SAFE(conn, &group->connections, link, tmp) {
 		spdk_iscsi_conn_handle_nop(conn);
 	}
 
+	/* Sample the share of time spent on I/O, smoothed over the previous samples. */
+	now = spdk_get_ticks();
+	busy = group->busy_tsc;
+	group->load = (group->load + (busy - group->last_busy_tsc) * 1000 /
+		       (now - group->last_sample_tsc)) / 2;
+	group->last_busy_tsc = busy;
+	group->last_sample_tsc = now;
+
 	return -1;
 }
 
@@ -1186,9 +1223,11 @@ iscsi_poll_group_create(void *io_device, void *ctx_buf)
 	struct spdk_iscsi_poll_group *pg = ctx_buf;
 
 	STAILQ_INIT(&pg->connections);
+	STAILQ_INIT(&pg->digest_conns);
 	pg->sock_group = spdk_sock_group_create(NULL);
 	assert(pg->sock_group != NULL);
 
+	pg->last_sample_tsc = spdk_get_ticks();
 	pg->poller = spdk_poller_register(iscsi_poll_group_poll, pg, 0);
 	/* set the period to 1 sec */
 	pg->nop_poller = spdk_poller_register(iscsi_poll_group_handle_nop, pg, 1000000);
@@ -1344,6 +1383,7 @@ spdk_iscsi_fini(spdk_iscsi_fini_cb cb_fn, void *cb_arg)
 	g_fini_cb_fn = cb_fn;
 	g_fini_cb_arg = cb_arg;
 
+	spdk_poller_unregister(&g_spdk_iscsi.rebalance_poller);
 	spdk_iscsi_portal_grp_close_all();
 	spdk_shutdown_iscsi_conns();
 	free(g_spdk_iscsi.session);
@@ -1388,6 +1428,7 @@ _iscsi_fini_thread(struct spdk_io_channel_iter *i)
 	TAILQ_REMOVE(&g_spdk_iscsi.poll_group_head, pg, link);
 	pthread_mutex_unlock(&g_spdk_iscsi.mutex);
 
+	spdk_iscsi_poll_group_cancel_migration(pg);
 	spdk_put_io_channel(ch);
 
 	spdk_for_each_channel_continue(i, 0);
@@ -1437,6 +1478,7 @@ spdk_iscsi_opts_info_json(struct spdk_json_write_ctx *w)
 
 	spdk_json_write_named_int32(w, "nop_timeout", g_spdk_iscsi.timeout);
 	spdk_json_write_named_int32(w, "nop_in_interval", g_spdk_iscsi.nopininterval);
+	spdk_json_write_named_uint32(w, "conn_rebalance_period", g_spdk_iscsi.conn_rebalance_period);
 
 	spdk_json_write_named_bool(w, "disable_chap", g_spdk_iscsi.disable_chap);
 	spdk_json_write_named_bool(w, "require_chap", g_spdk_iscsi.require_chap);
@@ -52,6 +52,10 @@ iscsi_task_free(struct spdk_scsi_task *scsi_task)
 		task->parent = NULL;
 	}
 
+	if (task->mobj) {
+		spdk_mempool_put(task->mobj->mp, (void *)task->mobj);
+	}
+
 	spdk_iscsi_task_disassociate_pdu(task);
 	assert(task->conn->pending_task_cnt > 0);
 	task->conn->pending_task_cnt--;
@@ -100,6 +100,16 @@ struct spdk_iscsi_task {
 
 	struct spdk_poller *mgmt_poller;
 
+	/*
+	 * Buffer which Data-Out PDUs of a large write are read into directly.
+	 *  It holds mobj_len bytes starting at buffer offset mobj_offset, and is
+	 *  submitted as a single subtask when it is full or an R2T burst ends.
+	 *  A subtask owns the buffer it was submitted with.
+	 */
+	struct spdk_mobj *mobj;
+	uint32_t mobj_offset;
+	uint32_t mobj_len;
+
 	TAILQ_ENTRY(spdk_iscsi_task) link;
 
 	TAILQ_HEAD(subtask_list, spdk_iscsi_task) subtask_list;
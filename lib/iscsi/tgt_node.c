@@ -650,12 +650,25 @@ _iscsi_tgt_node_destruct(void *cb_arg, int rc)
 	}
 }
 
+static bool
+iscsi_tgt_node_is_busy(struct spdk_iscsi_tgt_node *target)
+{
+	bool migrating;
+
+	/* A migration in flight still refers to the target node. */
+	pthread_mutex_lock(&target->mutex);
+	migrating = target->migrating;
+	pthread_mutex_unlock(&target->mutex);
+
+	return migrating || spdk_iscsi_get_active_conns(target) != 0;
+}
+
 static int
 iscsi_tgt_node_check_active_conns(void *arg)
 {
 	struct spdk_iscsi_tgt_node *target = arg;
 
-	if (spdk_iscsi_get_active_conns(target) != 0) {
+	if (iscsi_tgt_node_is_busy(target)) {
 		return 1;
 	}
 
@@ -691,7 +704,7 @@ iscsi_tgt_node_destruct(struct spdk_iscsi_tgt_node *target,
 
 	spdk_iscsi_conns_request_logout(target);
 
-	if (spdk_iscsi_get_active_conns(target) != 0) {
+	if (iscsi_tgt_node_is_busy(target)) {
 		target->destruct_poller = spdk_poller_register(iscsi_tgt_node_check_active_conns,
 					  target, 10);
 	} else {
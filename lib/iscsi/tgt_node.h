@@ -84,6 +84,11 @@ struct spdk_iscsi_tgt_node {
 	 */
 	uint32_t num_active_conns;
 	struct spdk_iscsi_poll_group *pg;
+	/* The connections are being moved to another poll group */
+	bool migrating;
+	/* Ticks spent handling PDUs of the connections, and its value at the last rebalance */
+	uint64_t busy_tsc;
+	uint64_t last_busy_tsc;
 
 	int num_pg_maps;
 	TAILQ_HEAD(, spdk_iscsi_pg_map) pg_map_head;
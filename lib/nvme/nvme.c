@@ -661,6 +661,7 @@ spdk_nvme_probe_ctx_init(struct spdk_nvme_probe_ctx *probe_ctx,
 	probe_ctx->attach_cb = attach_cb;
 	probe_ctx->remove_cb = remove_cb;
 	TAILQ_INIT(&probe_ctx->init_ctrlrs);
+	probe_ctx->init_failed = false;
 }
 
 int
@@ -1222,18 +1223,22 @@ spdk_nvme_probe_poll_async(struct spdk_nvme_probe_ctx *probe_ctx)
 		return 0;
 	}
 
+	/*
+	 * Step every controller's initialization state machine once, so that
+	 *  all of them make progress in parallel. A controller that fails to
+	 *  initialize is destroyed, but doesn't hold back the others.
+	 */
 	TAILQ_FOREACH_SAFE(ctrlr, &probe_ctx->init_ctrlrs, tailq, ctrlr_tmp) {
-		rc = nvme_ctrlr_poll_internal(ctrlr, probe_ctx);
-		if (rc != 0) {
-			rc = -EIO;
-			break;
+		if (nvme_ctrlr_poll_internal(ctrlr, probe_ctx) != 0) {
+			probe_ctx->init_failed = true;
 		}
 	}
 
-	if (rc != 0 || TAILQ_EMPTY(&probe_ctx->init_ctrlrs)) {
+	if (TAILQ_EMPTY(&probe_ctx->init_ctrlrs)) {
 		nvme_robust_mutex_lock(&g_spdk_nvme_driver->lock);
 		g_spdk_nvme_driver->initialized = true;
 		nvme_robust_mutex_unlock(&g_spdk_nvme_driver->lock);
+		rc = probe_ctx->init_failed ? -EIO : 0;
 		free(probe_ctx);
 		return rc;
 	}
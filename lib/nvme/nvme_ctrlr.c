@@ -43,6 +43,7 @@ static int nvme_ctrlr_construct_and_submit_aer(struct spdk_nvme_ctrlr *ctrlr,
 		struct nvme_async_event_request *aer);
 static int nvme_ctrlr_identify_ns_async(struct spdk_nvme_ns *ns);
 static int nvme_ctrlr_identify_id_desc_async(struct spdk_nvme_ns *ns);
+static void nvme_ctrlr_destruct_namespaces(struct spdk_nvme_ctrlr *ctrlr);
 
 static int
 nvme_ctrlr_get_cc(struct spdk_nvme_ctrlr *ctrlr, union spdk_nvme_cc_register *cc)
@@ -162,7 +163,7 @@ spdk_nvme_ctrlr_get_default_ctrlr_opts(struct spdk_nvme_ctrlr_opts *opts, size_t
 	}
 
 	if (FIELD_OK(command_set)) {
-		opts->command_set = SPDK_NVME_CC_CSS_NVM;
+		opts->command_set = SPDK_NVME_CC_CSS_IOCS;
 	}
 
 	if (FIELD_OK(admin_timeout_ms)) {
@@ -180,6 +181,10 @@ spdk_nvme_ctrlr_get_default_ctrlr_opts(struct spdk_nvme_ctrlr_opts *opts, size_t
 	if (FIELD_OK(disable_error_logging)) {
 		opts->disable_error_logging = false;
 	}
+
+	if (FIELD_OK(arb_mechanism_fallback)) {
+		opts->arb_mechanism_fallback = false;
+	}
 #undef FIELD_OK
 }
 
@@ -281,6 +286,10 @@ spdk_nvme_ctrlr_get_default_io_qpair_opts(struct spdk_nvme_ctrlr *ctrlr,
 		opts->cq.buffer_size = 0;
 	}
 
+	if (FIELD_OK(share_transport_resources)) {
+		opts->share_transport_resources = false;
+	}
+
 #undef FIELD_OK
 }
 
@@ -772,6 +781,21 @@ nvme_ctrlr_shutdown(struct spdk_nvme_ctrlr *ctrlr)
 	}
 }
 
+static bool
+nvme_ctrlr_arb_mechanism_supported(struct spdk_nvme_ctrlr *ctrlr, enum spdk_nvme_cc_ams ams)
+{
+	switch (ams) {
+	case SPDK_NVME_CC_AMS_RR:
+		return true;
+	case SPDK_NVME_CC_AMS_WRR:
+		return ctrlr->cap.bits.ams & SPDK_NVME_CAP_AMS_WRR;
+	case SPDK_NVME_CC_AMS_VS:
+		return ctrlr->cap.bits.ams & SPDK_NVME_CAP_AMS_VS;
+	default:
+		return false;
+	}
+}
+
 static int
 nvme_ctrlr_enable(struct spdk_nvme_ctrlr *ctrlr)
 {
@@ -809,6 +833,16 @@ nvme_ctrlr_enable(struct spdk_nvme_ctrlr *ctrlr)
 		ctrlr->cap.bits.css = SPDK_NVME_CAP_CSS_NVM;
 	}
 
+	/*
+	 * Selecting all supported I/O command sets is only a preference. Controllers
+	 *  that predate I/O command sets are simply enabled with the NVM command set.
+	 */
+	if (ctrlr->opts.command_set == SPDK_NVME_CC_CSS_IOCS &&
+	    !(ctrlr->cap.bits.css & SPDK_NVME_CAP_CSS_IOCS)) {
+		SPDK_DEBUGLOG(SPDK_LOG_NVME, "I/O command sets not supported, falling back to NVM\n");
+		ctrlr->opts.command_set = SPDK_NVME_CC_CSS_NVM;
+	}
+
 	if (!(ctrlr->cap.bits.css & (1u << ctrlr->opts.command_set))) {
 		SPDK_DEBUGLOG(SPDK_LOG_NVME, "Requested I/O command set %u but supported mask is 0x%x\n",
 			      ctrlr->opts.command_set, ctrlr->cap.bits.css);
@@ -817,21 +851,14 @@ nvme_ctrlr_enable(struct spdk_nvme_ctrlr *ctrlr)
 
 	cc.bits.css = ctrlr->opts.command_set;
 
-	switch (ctrlr->opts.arb_mechanism) {
-	case SPDK_NVME_CC_AMS_RR:
-		break;
-	case SPDK_NVME_CC_AMS_WRR:
-		if (SPDK_NVME_CAP_AMS_WRR & ctrlr->cap.bits.ams) {
-			break;
-		}
-		return -EINVAL;
-	case SPDK_NVME_CC_AMS_VS:
-		if (SPDK_NVME_CAP_AMS_VS & ctrlr->cap.bits.ams) {
-			break;
+	if (!nvme_ctrlr_arb_mechanism_supported(ctrlr, ctrlr->opts.arb_mechanism)) {
+		if (!ctrlr->opts.arb_mechanism_fallback) {
+			return -EINVAL;
 		}
-		return -EINVAL;
-	default:
-		return -EINVAL;
+
+		SPDK_DEBUGLOG(SPDK_LOG_NVME, "Arbitration mechanism %u not supported, using RR\n",
+			      ctrlr->opts.arb_mechanism);
+		ctrlr->opts.arb_mechanism = SPDK_NVME_CC_AMS_RR;
 	}
 
 	cc.bits.ams = ctrlr->opts.arb_mechanism;
@@ -891,6 +918,10 @@ nvme_ctrlr_state_string(enum nvme_ctrlr_state state)
 		return "identify controller";
 	case NVME_CTRLR_STATE_WAIT_FOR_IDENTIFY:
 		return "wait for identify controller";
+	case NVME_CTRLR_STATE_IDENTIFY_IOCS_SPECIFIC:
+		return "identify controller iocs specific";
+	case NVME_CTRLR_STATE_WAIT_FOR_IDENTIFY_IOCS_SPECIFIC:
+		return "wait for identify controller iocs specific";
 	case NVME_CTRLR_STATE_SET_NUM_QUEUES:
 		return "set number of queues";
 	case NVME_CTRLR_STATE_WAIT_FOR_SET_NUM_QUEUES:
@@ -903,6 +934,8 @@ nvme_ctrlr_state_string(enum nvme_ctrlr_state state)
 		return "construct namespaces";
 	case NVME_CTRLR_STATE_IDENTIFY_ACTIVE_NS:
 		return "identify active ns";
+	case NVME_CTRLR_STATE_WAIT_FOR_IDENTIFY_ACTIVE_NS:
+		return "wait for identify active ns";
 	case NVME_CTRLR_STATE_IDENTIFY_NS:
 		return "identify ns";
 	case NVME_CTRLR_STATE_WAIT_FOR_IDENTIFY_NS:
@@ -911,6 +944,10 @@ nvme_ctrlr_state_string(enum nvme_ctrlr_state state)
 		return "identify namespace id descriptors";
 	case NVME_CTRLR_STATE_WAIT_FOR_IDENTIFY_ID_DESCS:
 		return "wait for identify namespace id descriptors";
+	case NVME_CTRLR_STATE_IDENTIFY_NS_IOCS_SPECIFIC:
+		return "identify ns iocs specific";
+	case NVME_CTRLR_STATE_WAIT_FOR_IDENTIFY_NS_IOCS_SPECIFIC:
+		return "wait for identify ns iocs specific";
 	case NVME_CTRLR_STATE_CONFIGURE_AER:
 		return "configure AER";
 	case NVME_CTRLR_STATE_WAIT_FOR_CONFIGURE_AER:
@@ -1261,10 +1298,75 @@ nvme_ctrlr_identify_done(void *arg, const struct spdk_nvme_cpl *cpl)
 		ctrlr->flags |= SPDK_NVME_CTRLR_COMPARE_AND_WRITE_SUPPORTED;
 	}
 
+	nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_IDENTIFY_IOCS_SPECIFIC,
+			     ctrlr->opts.admin_timeout_ms);
+}
+
+static void
+nvme_ctrlr_free_iocs_specific_data(struct spdk_nvme_ctrlr *ctrlr)
+{
+	spdk_free(ctrlr->cdata_zns);
+	ctrlr->cdata_zns = NULL;
+}
+
+static void
+nvme_ctrlr_identify_zns_specific_done(void *arg, const struct spdk_nvme_cpl *cpl)
+{
+	struct spdk_nvme_ctrlr *ctrlr = (struct spdk_nvme_ctrlr *)arg;
+
+	if (spdk_nvme_cpl_is_error(cpl)) {
+		/* The controller doesn't implement the Zoned Namespace Command Set. */
+		SPDK_DEBUGLOG(SPDK_LOG_NVME, "Zoned Namespace Command Set not supported\n");
+		nvme_ctrlr_free_iocs_specific_data(ctrlr);
+	} else {
+		/* A ZASL of 0 means that the zone append size is limited by MDTS. */
+		ctrlr->max_zone_append_size = ctrlr->max_xfer_size;
+		if (ctrlr->cdata_zns->zasl) {
+			ctrlr->max_zone_append_size = spdk_min(ctrlr->max_zone_append_size,
+							       ctrlr->min_page_size << ctrlr->cdata_zns->zasl);
+		}
+		SPDK_DEBUGLOG(SPDK_LOG_NVME, "max_zone_append_size %u\n", ctrlr->max_zone_append_size);
+	}
+
 	nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_SET_NUM_QUEUES,
 			     ctrlr->opts.admin_timeout_ms);
 }
 
+static int
+nvme_ctrlr_identify_iocs_specific(struct spdk_nvme_ctrlr *ctrlr)
+{
+	int	rc;
+
+	if (ctrlr->opts.command_set != SPDK_NVME_CC_CSS_IOCS) {
+		nvme_ctrlr_free_iocs_specific_data(ctrlr);
+		nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_SET_NUM_QUEUES,
+				     ctrlr->opts.admin_timeout_ms);
+		return 0;
+	}
+
+	if (ctrlr->cdata_zns == NULL) {
+		ctrlr->cdata_zns = spdk_zmalloc(sizeof(*ctrlr->cdata_zns), 64, NULL,
+						SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_SHARE);
+		if (ctrlr->cdata_zns == NULL) {
+			nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_ERROR, NVME_TIMEOUT_INFINITE);
+			return -ENOMEM;
+		}
+	}
+
+	nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_WAIT_FOR_IDENTIFY_IOCS_SPECIFIC,
+			     ctrlr->opts.admin_timeout_ms);
+
+	rc = nvme_ctrlr_cmd_identify(ctrlr, SPDK_NVME_IDENTIFY_CTRLR_IOCS, 0, 0,
+				     SPDK_NVME_CSI_ZNS, ctrlr->cdata_zns, sizeof(*ctrlr->cdata_zns),
+				     nvme_ctrlr_identify_zns_specific_done, ctrlr);
+	if (rc != 0) {
+		nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_ERROR, NVME_TIMEOUT_INFINITE);
+		return rc;
+	}
+
+	return 0;
+}
+
 static int
 nvme_ctrlr_identify(struct spdk_nvme_ctrlr *ctrlr)
 {
@@ -1274,7 +1376,7 @@ nvme_ctrlr_identify(struct spdk_nvme_ctrlr *ctrlr)
 			     ctrlr->opts.admin_timeout_ms);
 
 	rc = nvme_ctrlr_cmd_identify(ctrlr, SPDK_NVME_IDENTIFY_CTRLR, 0, 0,
-				     &ctrlr->cdata, sizeof(ctrlr->cdata),
+				     SPDK_NVME_CSI_NVM, &ctrlr->cdata, sizeof(ctrlr->cdata),
 				     nvme_ctrlr_identify_done, ctrlr);
 	if (rc != 0) {
 		nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_ERROR, NVME_TIMEOUT_INFINITE);
@@ -1325,7 +1427,8 @@ nvme_ctrlr_identify_active_ns(struct spdk_nvme_ctrlr *ctrlr)
 		 */
 		for (i = 0; i < num_pages; i++) {
 			rc = nvme_ctrlr_cmd_identify(ctrlr, SPDK_NVME_IDENTIFY_ACTIVE_NS_LIST, 0, next_nsid,
-						     &new_ns_list[1024 * i], sizeof(struct spdk_nvme_ns_list),
+						     SPDK_NVME_CSI_NVM, &new_ns_list[1024 * i],
+						     sizeof(struct spdk_nvme_ns_list),
 						     nvme_completion_poll_cb, status);
 			if (rc != 0) {
 				goto fail;
@@ -1371,6 +1474,127 @@ fail:
 	return rc;
 }
 
+struct nvme_active_ns_ctx {
+	struct spdk_nvme_ctrlr *ctrlr;
+	uint32_t *new_ns_list;
+	uint32_t page;
+	uint32_t num_pages;
+};
+
+static void
+nvme_ctrlr_identify_active_ns_async_finish(struct nvme_active_ns_ctx *ctx, int rc)
+{
+	struct spdk_nvme_ctrlr *ctrlr = ctx->ctrlr;
+
+	if (rc == 0) {
+		spdk_free(ctrlr->active_ns_list);
+		ctrlr->active_ns_list = ctx->new_ns_list;
+	} else {
+		SPDK_ERRLOG("nvme_ctrlr_cmd_identify_active_ns_list failed!\n");
+		spdk_free(ctx->new_ns_list);
+		nvme_ctrlr_destruct_namespaces(ctrlr);
+	}
+
+	free(ctx);
+	nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_IDENTIFY_NS,
+			     ctrlr->opts.admin_timeout_ms);
+}
+
+static int nvme_ctrlr_identify_active_ns_async_page(struct nvme_active_ns_ctx *ctx,
+		uint32_t next_nsid);
+
+static void
+nvme_ctrlr_identify_active_ns_async_done(void *arg, const struct spdk_nvme_cpl *cpl)
+{
+	struct nvme_active_ns_ctx *ctx = arg;
+	uint32_t next_nsid;
+	int rc;
+
+	if (spdk_nvme_cpl_is_error(cpl)) {
+		nvme_ctrlr_identify_active_ns_async_finish(ctx, -ENXIO);
+		return;
+	}
+
+	next_nsid = ctx->new_ns_list[1024 * ctx->page + 1023];
+	ctx->page++;
+	if (next_nsid == 0 || ctx->page == ctx->num_pages) {
+		/* No more active namespaces found, no need to fetch additional chunks */
+		nvme_ctrlr_identify_active_ns_async_finish(ctx, 0);
+		return;
+	}
+
+	rc = nvme_ctrlr_identify_active_ns_async_page(ctx, next_nsid);
+	if (rc != 0) {
+		nvme_ctrlr_identify_active_ns_async_finish(ctx, rc);
+	}
+}
+
+static int
+nvme_ctrlr_identify_active_ns_async_page(struct nvme_active_ns_ctx *ctx, uint32_t next_nsid)
+{
+	return nvme_ctrlr_cmd_identify(ctx->ctrlr, SPDK_NVME_IDENTIFY_ACTIVE_NS_LIST, 0, next_nsid,
+				       SPDK_NVME_CSI_NVM, &ctx->new_ns_list[1024 * ctx->page],
+				       sizeof(struct spdk_nvme_ns_list),
+				       nvme_ctrlr_identify_active_ns_async_done, ctx);
+}
+
+/*
+ * Non-blocking variant of nvme_ctrlr_identify_active_ns() used by the
+ *  initialization state machine, so that controllers probed together
+ *  don't serialize on each other's admin queue round trips.
+ */
+static int
+nvme_ctrlr_identify_active_ns_async(struct spdk_nvme_ctrlr *ctrlr)
+{
+	struct nvme_active_ns_ctx	*ctx;
+	int				rc;
+
+	if (ctrlr->num_ns == 0 ||
+	    ctrlr->vs.raw < SPDK_NVME_VERSION(1, 1, 0) || (ctrlr->quirks & NVME_QUIRK_IDENTIFY_CNS)) {
+		/* Nothing to wait for, the list can be built without a command */
+		rc = nvme_ctrlr_identify_active_ns(ctrlr);
+		if (rc < 0) {
+			nvme_ctrlr_destruct_namespaces(ctrlr);
+		}
+		nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_IDENTIFY_NS,
+				     ctrlr->opts.admin_timeout_ms);
+		return 0;
+	}
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_ERROR, NVME_TIMEOUT_INFINITE);
+		return -ENOMEM;
+	}
+
+	ctx->ctrlr = ctrlr;
+	/* The allocated size must be a multiple of sizeof(struct spdk_nvme_ns_list) */
+	ctx->num_pages = (ctrlr->num_ns * sizeof(ctx->new_ns_list[0]) - 1) /
+			 sizeof(struct spdk_nvme_ns_list) + 1;
+	ctx->new_ns_list = spdk_zmalloc(ctx->num_pages * sizeof(struct spdk_nvme_ns_list),
+					ctrlr->page_size, NULL, SPDK_ENV_LCORE_ID_ANY,
+					SPDK_MALLOC_DMA | SPDK_MALLOC_SHARE);
+	if (ctx->new_ns_list == NULL) {
+		SPDK_ERRLOG("Failed to allocate active_ns_list!\n");
+		free(ctx);
+		nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_ERROR, NVME_TIMEOUT_INFINITE);
+		return -ENOMEM;
+	}
+
+	nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_WAIT_FOR_IDENTIFY_ACTIVE_NS,
+			     ctrlr->opts.admin_timeout_ms);
+
+	rc = nvme_ctrlr_identify_active_ns_async_page(ctx, 0);
+	if (rc != 0) {
+		spdk_free(ctx->new_ns_list);
+		free(ctx);
+		nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_ERROR, NVME_TIMEOUT_INFINITE);
+		return rc;
+	}
+
+	return 0;
+}
+
 static void
 nvme_ctrlr_identify_ns_async_done(void *arg, const struct spdk_nvme_cpl *cpl)
 {
@@ -1414,7 +1638,7 @@ nvme_ctrlr_identify_ns_async(struct spdk_nvme_ns *ns)
 	nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_WAIT_FOR_IDENTIFY_NS,
 			     ctrlr->opts.admin_timeout_ms);
 	return nvme_ctrlr_cmd_identify(ns->ctrlr, SPDK_NVME_IDENTIFY_NS, 0, ns->id,
-				       nsdata, sizeof(*nsdata),
+				       SPDK_NVME_CSI_NVM, nsdata, sizeof(*nsdata),
 				       nvme_ctrlr_identify_ns_async_done, ns);
 }
 
@@ -1454,16 +1678,18 @@ nvme_ctrlr_identify_id_desc_async_done(void *arg, const struct spdk_nvme_cpl *cp
 	int rc;
 
 	if (spdk_nvme_cpl_is_error(cpl)) {
-		nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_CONFIGURE_AER,
+		nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_IDENTIFY_NS_IOCS_SPECIFIC,
 				     ctrlr->opts.admin_timeout_ms);
 		return;
 	}
 
+	nvme_ns_set_id_desc_list_data(ns);
+
 	/* move on to the next active NS */
 	nsid = spdk_nvme_ctrlr_get_next_active_ns(ctrlr, ns->id);
 	ns = spdk_nvme_ctrlr_get_ns(ctrlr, nsid);
 	if (ns == NULL) {
-		nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_CONFIGURE_AER,
+		nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_IDENTIFY_NS_IOCS_SPECIFIC,
 				     ctrlr->opts.admin_timeout_ms);
 		return;
 	}
@@ -1484,7 +1710,8 @@ nvme_ctrlr_identify_id_desc_async(struct spdk_nvme_ns *ns)
 	nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_WAIT_FOR_IDENTIFY_ID_DESCS,
 			     ctrlr->opts.admin_timeout_ms);
 	return nvme_ctrlr_cmd_identify(ns->ctrlr, SPDK_NVME_IDENTIFY_NS_ID_DESCRIPTOR_LIST,
-				       0, ns->id, ns->id_desc_list, sizeof(ns->id_desc_list),
+				       0, ns->id, SPDK_NVME_CSI_NVM,
+				       ns->id_desc_list, sizeof(ns->id_desc_list),
 				       nvme_ctrlr_identify_id_desc_async_done, ns);
 }
 
@@ -1498,6 +1725,7 @@ nvme_ctrlr_identify_id_desc_namespaces(struct spdk_nvme_ctrlr *ctrlr)
 	if (ctrlr->vs.raw < SPDK_NVME_VERSION(1, 3, 0) ||
 	    (ctrlr->quirks & NVME_QUIRK_IDENTIFY_CNS)) {
 		SPDK_DEBUGLOG(SPDK_LOG_NVME, "Version < 1.3; not attempting to retrieve NS ID Descriptor List\n");
+		/* I/O Command Set Specific Namespace data can't be retrieved without a CSI either */
 		nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_CONFIGURE_AER,
 				     ctrlr->opts.admin_timeout_ms);
 		return 0;
@@ -1520,6 +1748,104 @@ nvme_ctrlr_identify_id_desc_namespaces(struct spdk_nvme_ctrlr *ctrlr)
 	return rc;
 }
 
+static uint32_t
+nvme_ctrlr_get_next_iocs_specific_ns(struct spdk_nvme_ctrlr *ctrlr, uint32_t prev_nsid)
+{
+	uint32_t nsid;
+	struct spdk_nvme_ns *ns;
+
+	if (prev_nsid == 0) {
+		nsid = spdk_nvme_ctrlr_get_first_active_ns(ctrlr);
+	} else {
+		nsid = spdk_nvme_ctrlr_get_next_active_ns(ctrlr, prev_nsid);
+	}
+
+	while (nsid != 0) {
+		ns = spdk_nvme_ctrlr_get_ns(ctrlr, nsid);
+		if (ns->csi == SPDK_NVME_CSI_ZNS && ctrlr->cdata_zns != NULL) {
+			return nsid;
+		}
+
+		/* Namespaces of other command sets have no specific data to retrieve */
+		nvme_ns_free_iocs_specific_data(ns);
+		nsid = spdk_nvme_ctrlr_get_next_active_ns(ctrlr, nsid);
+	}
+
+	return 0;
+}
+
+static int nvme_ctrlr_identify_ns_iocs_specific_async(struct spdk_nvme_ns *ns);
+
+static void
+nvme_ctrlr_identify_ns_iocs_specific_async_done(void *arg, const struct spdk_nvme_cpl *cpl)
+{
+	struct spdk_nvme_ns *ns = (struct spdk_nvme_ns *)arg;
+	struct spdk_nvme_ctrlr *ctrlr = ns->ctrlr;
+	uint32_t nsid;
+	int rc;
+
+	if (spdk_nvme_cpl_is_error(cpl)) {
+		nvme_ns_free_iocs_specific_data(ns);
+		nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_ERROR, NVME_TIMEOUT_INFINITE);
+		return;
+	}
+
+	/* move on to the next active NS */
+	nsid = nvme_ctrlr_get_next_iocs_specific_ns(ctrlr, ns->id);
+	if (nsid == 0) {
+		nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_CONFIGURE_AER,
+				     ctrlr->opts.admin_timeout_ms);
+		return;
+	}
+
+	rc = nvme_ctrlr_identify_ns_iocs_specific_async(spdk_nvme_ctrlr_get_ns(ctrlr, nsid));
+	if (rc) {
+		nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_ERROR, NVME_TIMEOUT_INFINITE);
+	}
+}
+
+static int
+nvme_ctrlr_identify_ns_iocs_specific_async(struct spdk_nvme_ns *ns)
+{
+	struct spdk_nvme_ctrlr *ctrlr = ns->ctrlr;
+
+	if (ns->nsdata_zns == NULL) {
+		ns->nsdata_zns = spdk_zmalloc(sizeof(*ns->nsdata_zns), 64, NULL,
+					      SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_SHARE);
+		if (ns->nsdata_zns == NULL) {
+			return -ENOMEM;
+		}
+	}
+
+	nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_WAIT_FOR_IDENTIFY_NS_IOCS_SPECIFIC,
+			     ctrlr->opts.admin_timeout_ms);
+	return nvme_ctrlr_cmd_identify(ctrlr, SPDK_NVME_IDENTIFY_NS_IOCS, 0, ns->id,
+				       ns->csi, ns->nsdata_zns, sizeof(*ns->nsdata_zns),
+				       nvme_ctrlr_identify_ns_iocs_specific_async_done, ns);
+}
+
+static int
+nvme_ctrlr_identify_namespaces_iocs_specific(struct spdk_nvme_ctrlr *ctrlr)
+{
+	uint32_t nsid;
+	int rc;
+
+	nsid = nvme_ctrlr_get_next_iocs_specific_ns(ctrlr, 0);
+	if (nsid == 0) {
+		/* No namespace with I/O Command Set specific data, move on to the next state */
+		nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_CONFIGURE_AER,
+				     ctrlr->opts.admin_timeout_ms);
+		return 0;
+	}
+
+	rc = nvme_ctrlr_identify_ns_iocs_specific_async(spdk_nvme_ctrlr_get_ns(ctrlr, nsid));
+	if (rc) {
+		nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_ERROR, NVME_TIMEOUT_INFINITE);
+	}
+
+	return rc;
+}
+
 static void
 nvme_ctrlr_set_num_queues_done(void *arg, const struct spdk_nvme_cpl *cpl)
 {
@@ -2415,6 +2741,14 @@ nvme_ctrlr_process_init(struct spdk_nvme_ctrlr *ctrlr)
 		spdk_nvme_qpair_process_completions(ctrlr->adminq, 0);
 		break;
 
+	case NVME_CTRLR_STATE_IDENTIFY_IOCS_SPECIFIC:
+		rc = nvme_ctrlr_identify_iocs_specific(ctrlr);
+		break;
+
+	case NVME_CTRLR_STATE_WAIT_FOR_IDENTIFY_IOCS_SPECIFIC:
+		spdk_nvme_qpair_process_completions(ctrlr->adminq, 0);
+		break;
+
 	case NVME_CTRLR_STATE_SET_NUM_QUEUES:
 		rc = nvme_ctrlr_set_num_queues(ctrlr);
 		break;
@@ -2438,12 +2772,11 @@ nvme_ctrlr_process_init(struct spdk_nvme_ctrlr *ctrlr)
 		break;
 
 	case NVME_CTRLR_STATE_IDENTIFY_ACTIVE_NS:
-		rc = nvme_ctrlr_identify_active_ns(ctrlr);
-		if (rc < 0) {
-			nvme_ctrlr_destruct_namespaces(ctrlr);
-		}
-		nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_IDENTIFY_NS,
-				     ctrlr->opts.admin_timeout_ms);
+		rc = nvme_ctrlr_identify_active_ns_async(ctrlr);
+		break;
+
+	case NVME_CTRLR_STATE_WAIT_FOR_IDENTIFY_ACTIVE_NS:
+		spdk_nvme_qpair_process_completions(ctrlr->adminq, 0);
 		break;
 
 	case NVME_CTRLR_STATE_IDENTIFY_NS:
@@ -2462,6 +2795,14 @@ nvme_ctrlr_process_init(struct spdk_nvme_ctrlr *ctrlr)
 		spdk_nvme_qpair_process_completions(ctrlr->adminq, 0);
 		break;
 
+	case NVME_CTRLR_STATE_IDENTIFY_NS_IOCS_SPECIFIC:
+		rc = nvme_ctrlr_identify_namespaces_iocs_specific(ctrlr);
+		break;
+
+	case NVME_CTRLR_STATE_WAIT_FOR_IDENTIFY_NS_IOCS_SPECIFIC:
+		spdk_nvme_qpair_process_completions(ctrlr->adminq, 0);
+		break;
+
 	case NVME_CTRLR_STATE_CONFIGURE_AER:
 		rc = nvme_ctrlr_configure_aer(ctrlr);
 		break;
@@ -2635,6 +2976,7 @@ nvme_ctrlr_destruct(struct spdk_nvme_ctrlr *ctrlr)
 	}
 
 	nvme_ctrlr_destruct_namespaces(ctrlr);
+	nvme_ctrlr_free_iocs_specific_data(ctrlr);
 
 	spdk_bit_array_free(&ctrlr->free_io_qids);
 
@@ -51,6 +51,7 @@
 #include "spdk/pci_ids.h"
 #include "spdk/util.h"
 #include "spdk/nvme_intel.h"
+#include "spdk/nvme_zns_spec.h"
 #include "spdk/nvmf_spec.h"
 #include "spdk/uuid.h"
 
@@ -431,8 +432,14 @@ struct spdk_nvme_ns {
 	uint32_t			id;
 	uint16_t			flags;
 
+	/* Command Set Identifier */
+	enum spdk_nvme_csi		csi;
+
 	/* Namespace Identification Descriptor List (CNS = 03h) */
 	uint8_t				id_desc_list[4096];
+
+	/* Zoned Namespace Command Set specific Identify Namespace data (CNS = 05h, CSI = 02h) */
+	struct spdk_nvme_zns_ns_data	*nsdata_zns;
 };
 
 /**
@@ -484,6 +491,16 @@ enum nvme_ctrlr_state {
 	 */
 	NVME_CTRLR_STATE_WAIT_FOR_IDENTIFY,
 
+	/**
+	 * Get Identify I/O Command Set Specific Controller data structure.
+	 */
+	NVME_CTRLR_STATE_IDENTIFY_IOCS_SPECIFIC,
+
+	/**
+	 * Waiting for Identify I/O Command Set Specific Controller command to be completed.
+	 */
+	NVME_CTRLR_STATE_WAIT_FOR_IDENTIFY_IOCS_SPECIFIC,
+
 	/**
 	 * Set Number of Queues of the controller.
 	 */
@@ -514,6 +531,11 @@ enum nvme_ctrlr_state {
 	 */
 	NVME_CTRLR_STATE_IDENTIFY_ACTIVE_NS,
 
+	/**
+	 * Waiting for the Identify Active Namespace List commands to be completed.
+	 */
+	NVME_CTRLR_STATE_WAIT_FOR_IDENTIFY_ACTIVE_NS,
+
 	/**
 	 * Get Identify Namespace Data structure for each NS.
 	 */
@@ -535,6 +557,16 @@ enum nvme_ctrlr_state {
 	 */
 	NVME_CTRLR_STATE_WAIT_FOR_IDENTIFY_ID_DESCS,
 
+	/**
+	 * Get Identify I/O Command Set Specific Namespace data structure for each NS.
+	 */
+	NVME_CTRLR_STATE_IDENTIFY_NS_IOCS_SPECIFIC,
+
+	/**
+	 * Waiting for the Identify I/O Command Set Specific Namespace commands to be completed.
+	 */
+	NVME_CTRLR_STATE_WAIT_FOR_IDENTIFY_NS_IOCS_SPECIFIC,
+
 	/**
 	 * Configure AER of the controller.
 	 */
@@ -710,6 +742,14 @@ struct spdk_nvme_ctrlr {
 	 */
 	struct spdk_nvme_ctrlr_data	cdata;
 
+	/**
+	 * Zoned Namespace Command Set specific Identify Controller data.
+	 */
+	struct spdk_nvme_zns_ctrlr_data	*cdata_zns;
+
+	/** maximum zone append size in bytes */
+	uint32_t			max_zone_append_size;
+
 	/**
 	 * Keep track of active namespaces
 	 */
@@ -757,6 +797,8 @@ struct spdk_nvme_probe_ctx {
 	spdk_nvme_attach_cb			attach_cb;
 	spdk_nvme_remove_cb			remove_cb;
 	TAILQ_HEAD(, spdk_nvme_ctrlr)		init_ctrlrs;
+	/* Set when any of the probed controllers failed to initialize */
+	bool					init_failed;
 };
 
 struct nvme_driver {
@@ -810,7 +852,7 @@ nvme_robust_mutex_unlock(pthread_mutex_t *mtx)
 /* Admin functions */
 int	nvme_ctrlr_cmd_identify(struct spdk_nvme_ctrlr *ctrlr,
 				uint8_t cns, uint16_t cntid, uint32_t nsid,
-				void *payload, size_t payload_size,
+				uint8_t csi, void *payload, size_t payload_size,
 				spdk_nvme_cmd_cb cb_fn, void *cb_arg);
 int	nvme_ctrlr_cmd_set_num_queues(struct spdk_nvme_ctrlr *ctrlr,
 				      uint32_t num_queues, spdk_nvme_cmd_cb cb_fn,
@@ -898,9 +940,21 @@ int	nvme_qpair_submit_request(struct spdk_nvme_qpair *qpair,
 
 int	nvme_ctrlr_identify_active_ns(struct spdk_nvme_ctrlr *ctrlr);
 void	nvme_ns_set_identify_data(struct spdk_nvme_ns *ns);
+void	nvme_ns_set_id_desc_list_data(struct spdk_nvme_ns *ns);
+void	nvme_ns_free_iocs_specific_data(struct spdk_nvme_ns *ns);
 int	nvme_ns_construct(struct spdk_nvme_ns *ns, uint32_t id,
 			  struct spdk_nvme_ctrlr *ctrlr);
 void	nvme_ns_destruct(struct spdk_nvme_ns *ns);
+int	nvme_ns_cmd_zone_append_with_md(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+					void *buffer, void *metadata, uint64_t zslba,
+					uint32_t lba_count, spdk_nvme_cmd_cb cb_fn, void *cb_arg,
+					uint32_t io_flags, uint16_t apptag_mask, uint16_t apptag);
+int	nvme_ns_cmd_zone_appendv_with_md(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+		uint64_t zslba, uint32_t lba_count,
+		spdk_nvme_cmd_cb cb_fn, void *cb_arg, uint32_t io_flags,
+		spdk_nvme_req_reset_sgl_cb reset_sgl_fn,
+		spdk_nvme_req_next_sge_cb next_sge_fn, void *metadata,
+		uint16_t apptag_mask, uint16_t apptag);
 
 int	nvme_fabric_ctrlr_set_reg_4(struct spdk_nvme_ctrlr *ctrlr, uint32_t offset, uint32_t value);
 int	nvme_fabric_ctrlr_set_reg_8(struct spdk_nvme_ctrlr *ctrlr, uint32_t offset, uint64_t value);
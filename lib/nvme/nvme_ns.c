@@ -125,7 +125,7 @@ nvme_ctrlr_identify_ns(struct spdk_nvme_ns *ns)
 
 	nsdata = _nvme_ns_get_data(ns);
 	rc = nvme_ctrlr_cmd_identify(ns->ctrlr, SPDK_NVME_IDENTIFY_NS, 0, ns->id,
-				     nsdata, sizeof(*nsdata),
+				     SPDK_NVME_CSI_NVM, nsdata, sizeof(*nsdata),
 				     nvme_completion_poll_cb, status);
 	if (rc != 0) {
 		free(status);
@@ -149,6 +149,52 @@ nvme_ctrlr_identify_ns(struct spdk_nvme_ns *ns)
 	return 0;
 }
 
+static int
+nvme_ctrlr_identify_ns_iocs_specific(struct spdk_nvme_ns *ns)
+{
+	struct nvme_completion_poll_status	*status;
+	int					rc;
+
+	if (ns->csi != SPDK_NVME_CSI_ZNS) {
+		nvme_ns_free_iocs_specific_data(ns);
+		return 0;
+	}
+
+	if (ns->nsdata_zns == NULL) {
+		ns->nsdata_zns = spdk_zmalloc(sizeof(*ns->nsdata_zns), 64, NULL,
+					      SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_SHARE);
+		if (ns->nsdata_zns == NULL) {
+			return -ENOMEM;
+		}
+	}
+
+	status = malloc(sizeof(*status));
+	if (!status) {
+		SPDK_ERRLOG("Failed to allocate status tracker\n");
+		return -ENOMEM;
+	}
+
+	rc = nvme_ctrlr_cmd_identify(ns->ctrlr, SPDK_NVME_IDENTIFY_NS_IOCS, 0, ns->id,
+				     ns->csi, ns->nsdata_zns, sizeof(*ns->nsdata_zns),
+				     nvme_completion_poll_cb, status);
+	if (rc != 0) {
+		free(status);
+		return rc;
+	}
+
+	rc = spdk_nvme_wait_for_completion_robust_lock(ns->ctrlr->adminq, status, &ns->ctrlr->ctrlr_lock);
+	if (rc != 0) {
+		SPDK_ERRLOG("Failed to retrieve Identify I/O Command Set Specific Namespace Data\n");
+		nvme_ns_free_iocs_specific_data(ns);
+	}
+
+	if (!status->timed_out) {
+		free(status);
+	}
+
+	return rc;
+}
+
 static int
 nvme_ctrlr_identify_id_desc(struct spdk_nvme_ns *ns)
 {
@@ -160,6 +206,7 @@ nvme_ctrlr_identify_id_desc(struct spdk_nvme_ns *ns)
 	if (ns->ctrlr->vs.raw < SPDK_NVME_VERSION(1, 3, 0) ||
 	    (ns->ctrlr->quirks & NVME_QUIRK_IDENTIFY_CNS)) {
 		SPDK_DEBUGLOG(SPDK_LOG_NVME, "Version < 1.3; not attempting to retrieve NS ID Descriptor List\n");
+		nvme_ns_set_id_desc_list_data(ns);
 		return 0;
 	}
 
@@ -171,7 +218,7 @@ nvme_ctrlr_identify_id_desc(struct spdk_nvme_ns *ns)
 
 	SPDK_DEBUGLOG(SPDK_LOG_NVME, "Attempting to retrieve NS ID Descriptor List\n");
 	rc = nvme_ctrlr_cmd_identify(ns->ctrlr, SPDK_NVME_IDENTIFY_NS_ID_DESCRIPTOR_LIST, 0, ns->id,
-				     ns->id_desc_list, sizeof(ns->id_desc_list),
+				     SPDK_NVME_CSI_NVM, ns->id_desc_list, sizeof(ns->id_desc_list),
 				     nvme_completion_poll_cb, status);
 	if (rc < 0) {
 		free(status);
@@ -188,6 +235,8 @@ nvme_ctrlr_identify_id_desc(struct spdk_nvme_ns *ns)
 		free(status);
 	}
 
+	nvme_ns_set_id_desc_list_data(ns);
+
 	return rc;
 }
 
@@ -358,6 +407,37 @@ spdk_nvme_ns_get_uuid(const struct spdk_nvme_ns *ns)
 	return uuid;
 }
 
+/**
+ * Update the Namespace Command Set Identifier based on the
+ * Namespace Identification Descriptor List.
+ */
+void
+nvme_ns_set_id_desc_list_data(struct spdk_nvme_ns *ns)
+{
+	const uint8_t *csi;
+	size_t csi_size;
+
+	csi = _spdk_nvme_ns_find_id_desc(ns, SPDK_NVME_NIDT_CSI, &csi_size);
+	if (csi == NULL || csi_size != sizeof(*csi)) {
+		ns->csi = SPDK_NVME_CSI_NVM;
+		return;
+	}
+
+	ns->csi = (enum spdk_nvme_csi)*csi;
+}
+
+enum spdk_nvme_csi
+spdk_nvme_ns_get_csi(const struct spdk_nvme_ns *ns) {
+	return ns->csi;
+}
+
+void
+nvme_ns_free_iocs_specific_data(struct spdk_nvme_ns *ns)
+{
+	spdk_free(ns->nsdata_zns);
+	ns->nsdata_zns = NULL;
+}
+
 int nvme_ns_construct(struct spdk_nvme_ns *ns, uint32_t id,
 		      struct spdk_nvme_ctrlr *ctrlr)
 {
@@ -373,7 +453,12 @@ int nvme_ns_construct(struct spdk_nvme_ns *ns, uint32_t id,
 		return rc;
 	}
 
-	return nvme_ctrlr_identify_id_desc(ns);
+	rc = nvme_ctrlr_identify_id_desc(ns);
+	if (rc != 0) {
+		return rc;
+	}
+
+	return nvme_ctrlr_identify_ns_iocs_specific(ns);
 }
 
 void nvme_ns_destruct(struct spdk_nvme_ns *ns)
@@ -393,4 +478,7 @@ void nvme_ns_destruct(struct spdk_nvme_ns *ns)
 	ns->sectors_per_max_io = 0;
 	ns->sectors_per_stripe = 0;
 	ns->flags = 0;
+	ns->csi = SPDK_NVME_CSI_NVM;
+
+	nvme_ns_free_iocs_specific_data(ns);
 }
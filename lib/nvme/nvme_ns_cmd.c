@@ -835,6 +835,75 @@ spdk_nvme_ns_cmd_writev_with_md(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair
 	}
 }
 
+static int
+nvme_ns_cmd_submit_zone_append(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+			       const struct nvme_payload *payload, uint64_t zslba, uint32_t lba_count,
+			       spdk_nvme_cmd_cb cb_fn, void *cb_arg, uint32_t io_flags,
+			       uint16_t apptag_mask, uint16_t apptag)
+{
+	struct nvme_request *req;
+
+	if (!_is_io_flags_valid(io_flags)) {
+		return -EINVAL;
+	}
+
+	if ((uint64_t)lba_count * ns->extended_lba_size > qpair->ctrlr->max_zone_append_size) {
+		return -EINVAL;
+	}
+
+	req = _nvme_ns_cmd_rw(ns, qpair, payload, 0, 0, zslba, lba_count, cb_fn, cb_arg,
+			      SPDK_NVME_OPC_ZONE_APPEND, io_flags, apptag_mask, apptag, true);
+	if (req == NULL) {
+		return -ENOMEM;
+	}
+
+	/*
+	 * The controller picks the LBA a zone append is written at, so the command
+	 *  can never be split into child requests.
+	 */
+	if (req->num_children) {
+		nvme_request_free_children(req);
+		nvme_free_request(req);
+		return -EINVAL;
+	}
+
+	return nvme_qpair_submit_request(qpair, req);
+}
+
+int
+nvme_ns_cmd_zone_append_with_md(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+				void *buffer, void *metadata, uint64_t zslba,
+				uint32_t lba_count, spdk_nvme_cmd_cb cb_fn, void *cb_arg,
+				uint32_t io_flags, uint16_t apptag_mask, uint16_t apptag)
+{
+	struct nvme_payload payload;
+
+	payload = NVME_PAYLOAD_CONTIG(buffer, metadata);
+
+	return nvme_ns_cmd_submit_zone_append(ns, qpair, &payload, zslba, lba_count, cb_fn, cb_arg,
+					      io_flags, apptag_mask, apptag);
+}
+
+int
+nvme_ns_cmd_zone_appendv_with_md(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+				 uint64_t zslba, uint32_t lba_count,
+				 spdk_nvme_cmd_cb cb_fn, void *cb_arg, uint32_t io_flags,
+				 spdk_nvme_req_reset_sgl_cb reset_sgl_fn,
+				 spdk_nvme_req_next_sge_cb next_sge_fn, void *metadata,
+				 uint16_t apptag_mask, uint16_t apptag)
+{
+	struct nvme_payload payload;
+
+	if (reset_sgl_fn == NULL || next_sge_fn == NULL) {
+		return -EINVAL;
+	}
+
+	payload = NVME_PAYLOAD_SGL(reset_sgl_fn, next_sge_fn, cb_arg, metadata);
+
+	return nvme_ns_cmd_submit_zone_append(ns, qpair, &payload, zslba, lba_count, cb_fn, cb_arg,
+					      io_flags, apptag_mask, apptag);
+}
+
 int
 spdk_nvme_ns_cmd_write_zeroes(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
 			      uint64_t lba, uint32_t lba_count,
@@ -84,6 +84,9 @@
  */
 #define NVME_RDMA_CTRLR_MAX_TRANSPORT_RETRY_COUNT	7
 
+/* Number of receive buffers posted to a shared receive queue */
+#define NVME_RDMA_SHARED_SRQ_DEPTH		4096
+
 struct spdk_nvmf_cmd {
 	struct spdk_nvme_cmd cmd;
 	struct spdk_nvme_sgl_descriptor sgl[NVME_RDMA_MAX_SGL_DESCRIPTORS];
@@ -132,6 +135,43 @@ struct spdk_nvme_recv_wr_list {
 	struct ibv_recv_wr	*last;
 };
 
+struct nvme_rdma_qpair;
+
+/*
+ * Completion queue and shared receive queue used by all the I/O qpairs of a
+ * thread that were created with share_transport_resources and are connected
+ * through the same protection domain.
+ */
+struct nvme_rdma_shared_rsrc {
+	struct ibv_pd				*pd;
+
+	struct ibv_cq				*cq;
+
+	/* Number of CQ entries needed by the qpairs using this CQ */
+	uint32_t				cq_entries;
+
+	struct ibv_srq				*srq;
+
+	uint32_t				srq_depth;
+
+	/* Parallel arrays of response buffers + response SGLs of size srq_depth */
+	struct ibv_sge				*rsp_sgls;
+	struct spdk_nvme_cpl			*rsps;
+
+	struct ibv_recv_wr			*rsp_recv_wrs;
+
+	struct spdk_nvme_recv_wr_list		recvs_to_post;
+
+	/* Memory region describing all rsps of the SRQ */
+	struct ibv_mr				*rsp_mr;
+
+	/* Qpairs using this CQ, used to find the owner of each completion */
+	struct nvme_rdma_qpair			**qpairs;
+	uint32_t				num_qpairs;
+
+	struct nvme_rdma_shared_rsrc		*next;
+};
+
 /* NVMe RDMA qpair extensions for spdk_nvme_qpair */
 struct nvme_rdma_qpair {
 	struct spdk_nvme_qpair			qpair;
@@ -161,6 +201,20 @@ struct nvme_rdma_qpair {
 	/* Memory region describing all rsps for this qpair */
 	struct ibv_mr				*rsp_mr;
 
+	/* Share the CQ and the receive queue with the other qpairs of the thread */
+	bool					share_rsrc;
+
+	/* Shared CQ and SRQ in use, NULL if the qpair has dedicated ones */
+	struct nvme_rdma_shared_rsrc		*shared_rsrc;
+
+	uint32_t				qp_num;
+
+	/* Completions reaped from the shared CQ on behalf of this qpair */
+	struct ibv_wc				*pending_wcs;
+	uint32_t				pending_wcs_size;
+	uint32_t				pending_wcs_head;
+	uint32_t				pending_wcs_count;
+
 	/*
 	 * Array of num_entries NVMe commands registered as RDMA message buffers.
 	 * Indexed by rdma_req->id.
@@ -215,6 +269,9 @@ static const char *rdma_cm_event_str[] = {
 static LIST_HEAD(, spdk_nvme_rdma_mr_map) g_rdma_mr_maps = LIST_HEAD_INITIALIZER(&g_rdma_mr_maps);
 static pthread_mutex_t g_rdma_mr_maps_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+/* Shared CQs and SRQs of the calling thread */
+static __thread struct nvme_rdma_shared_rsrc *g_nvme_rdma_shared_rsrcs;
+
 int nvme_rdma_ctrlr_delete_io_qpair(struct spdk_nvme_ctrlr *ctrlr,
 				    struct spdk_nvme_qpair *qpair);
 
@@ -456,6 +513,281 @@ nvme_rdma_process_event(struct nvme_rdma_qpair *rqpair,
 	return rc == 0 ? rc2 : rc;
 }
 
+static int
+nvme_rdma_shared_rsrc_submit_recvs(struct nvme_rdma_shared_rsrc *rsrc)
+{
+	struct ibv_recv_wr *bad_recv_wr;
+	int rc;
+
+	if (rsrc->recvs_to_post.first) {
+		rc = ibv_post_srq_recv(rsrc->srq, rsrc->recvs_to_post.first, &bad_recv_wr);
+		if (spdk_unlikely(rc)) {
+			SPDK_ERRLOG("Failed to post WRs on shared receive queue, errno %d (%s), bad_wr %p\n",
+				    rc, spdk_strerror(rc), bad_recv_wr);
+			rsrc->recvs_to_post.first = bad_recv_wr;
+			return -1;
+		}
+		rsrc->recvs_to_post.first = NULL;
+	}
+	return 0;
+}
+
+/*
+ * Receive buffers of the SRQ are always reposted in batches, from the
+ *  completion processing of any of the qpairs sharing it.
+ */
+static void
+nvme_rdma_shared_rsrc_post_recv(struct nvme_rdma_shared_rsrc *rsrc, uint64_t rsp_idx)
+{
+	struct ibv_recv_wr *wr;
+
+	assert(rsp_idx < rsrc->srq_depth);
+	wr = &rsrc->rsp_recv_wrs[rsp_idx];
+	wr->next = NULL;
+
+	if (rsrc->recvs_to_post.first == NULL) {
+		rsrc->recvs_to_post.first = wr;
+	} else {
+		rsrc->recvs_to_post.last->next = wr;
+	}
+
+	rsrc->recvs_to_post.last = wr;
+}
+
+static void
+nvme_rdma_shared_rsrc_destroy(struct nvme_rdma_shared_rsrc *rsrc)
+{
+	if (rsrc->rsp_mr && ibv_dereg_mr(rsrc->rsp_mr)) {
+		SPDK_ERRLOG("Unable to de-register shared rsp_mr\n");
+	}
+
+	if (rsrc->srq && ibv_destroy_srq(rsrc->srq)) {
+		SPDK_ERRLOG("Unable to destroy shared receive queue\n");
+	}
+
+	if (rsrc->cq && ibv_destroy_cq(rsrc->cq)) {
+		SPDK_ERRLOG("Unable to destroy shared completion queue\n");
+	}
+
+	free(rsrc->rsps);
+	free(rsrc->rsp_sgls);
+	free(rsrc->rsp_recv_wrs);
+	free(rsrc->qpairs);
+	free(rsrc);
+}
+
+static struct nvme_rdma_shared_rsrc *
+nvme_rdma_shared_rsrc_create(struct ibv_pd *pd, const struct ibv_device_attr *dev_attr,
+			     uint32_t cq_entries)
+{
+	struct nvme_rdma_shared_rsrc	*rsrc;
+	struct ibv_srq_init_attr	srq_attr;
+	uint32_t			i;
+
+	if (dev_attr->max_srq == 0) {
+		SPDK_DEBUGLOG(SPDK_LOG_NVME, "RDMA device does not support SRQ\n");
+		return NULL;
+	}
+
+	rsrc = calloc(1, sizeof(*rsrc));
+	if (rsrc == NULL) {
+		SPDK_ERRLOG("Failed to allocate shared RDMA resources\n");
+		return NULL;
+	}
+
+	rsrc->pd = pd;
+	rsrc->srq_depth = spdk_min(NVME_RDMA_SHARED_SRQ_DEPTH, (uint32_t)dev_attr->max_srq_wr);
+
+	rsrc->cq = ibv_create_cq(pd->context, cq_entries, rsrc, NULL, 0);
+	if (rsrc->cq == NULL) {
+		SPDK_ERRLOG("Unable to create shared completion queue: errno %d: %s\n",
+			    errno, spdk_strerror(errno));
+		goto fail;
+	}
+
+	memset(&srq_attr, 0, sizeof(srq_attr));
+	srq_attr.attr.max_wr = rsrc->srq_depth;
+	srq_attr.attr.max_sge = spdk_min(NVME_RDMA_DEFAULT_RX_SGE, dev_attr->max_srq_sge);
+
+	rsrc->srq = ibv_create_srq(pd, &srq_attr);
+	if (rsrc->srq == NULL) {
+		SPDK_ERRLOG("Unable to create shared receive queue: errno %d: %s\n",
+			    errno, spdk_strerror(errno));
+		goto fail;
+	}
+
+	rsrc->rsps = calloc(rsrc->srq_depth, sizeof(*rsrc->rsps));
+	rsrc->rsp_sgls = calloc(rsrc->srq_depth, sizeof(*rsrc->rsp_sgls));
+	rsrc->rsp_recv_wrs = calloc(rsrc->srq_depth, sizeof(*rsrc->rsp_recv_wrs));
+	if (!rsrc->rsps || !rsrc->rsp_sgls || !rsrc->rsp_recv_wrs) {
+		SPDK_ERRLOG("Failed to allocate shared rsps\n");
+		goto fail;
+	}
+
+	rsrc->rsp_mr = ibv_reg_mr(pd, rsrc->rsps, rsrc->srq_depth * sizeof(*rsrc->rsps),
+				  IBV_ACCESS_LOCAL_WRITE);
+	if (rsrc->rsp_mr == NULL) {
+		SPDK_ERRLOG("Unable to register shared rsp_mr: %s (%d)\n", spdk_strerror(errno), errno);
+		goto fail;
+	}
+
+	for (i = 0; i < rsrc->srq_depth; i++) {
+		struct ibv_sge *rsp_sgl = &rsrc->rsp_sgls[i];
+
+		rsp_sgl->addr = (uint64_t)&rsrc->rsps[i];
+		rsp_sgl->length = sizeof(rsrc->rsps[i]);
+		rsp_sgl->lkey = rsrc->rsp_mr->lkey;
+
+		rsrc->rsp_recv_wrs[i].wr_id = i;
+		rsrc->rsp_recv_wrs[i].sg_list = rsp_sgl;
+		rsrc->rsp_recv_wrs[i].num_sge = 1;
+
+		nvme_rdma_shared_rsrc_post_recv(rsrc, i);
+	}
+
+	if (nvme_rdma_shared_rsrc_submit_recvs(rsrc)) {
+		goto fail;
+	}
+
+	return rsrc;
+
+fail:
+	nvme_rdma_shared_rsrc_destroy(rsrc);
+	return NULL;
+}
+
+static void
+nvme_rdma_shared_rsrc_put(struct nvme_rdma_shared_rsrc *rsrc)
+{
+	struct nvme_rdma_shared_rsrc **prev;
+
+	if (rsrc->num_qpairs > 0) {
+		return;
+	}
+
+	for (prev = &g_nvme_rdma_shared_rsrcs; *prev != NULL; prev = &(*prev)->next) {
+		if (*prev == rsrc) {
+			*prev = rsrc->next;
+			break;
+		}
+	}
+
+	nvme_rdma_shared_rsrc_destroy(rsrc);
+}
+
+/* Return the SRQ buffers held by completions that will never be processed. */
+static void
+nvme_rdma_qpair_flush_pending_wcs(struct nvme_rdma_qpair *rqpair)
+{
+	struct nvme_rdma_shared_rsrc *rsrc = rqpair->shared_rsrc;
+	struct ibv_wc *wc;
+
+	while (rqpair->pending_wcs_count > 0) {
+		wc = &rqpair->pending_wcs[rqpair->pending_wcs_head];
+		if (wc->status == IBV_WC_SUCCESS && wc->wr_id < rsrc->srq_depth) {
+			nvme_rdma_shared_rsrc_post_recv(rsrc, wc->wr_id);
+		}
+		rqpair->pending_wcs_head = (rqpair->pending_wcs_head + 1) % rqpair->pending_wcs_size;
+		rqpair->pending_wcs_count--;
+	}
+	rqpair->pending_wcs_head = 0;
+}
+
+static int
+nvme_rdma_qpair_attach_shared_rsrc(struct nvme_rdma_qpair *rqpair, struct ibv_pd *pd,
+				   const struct ibv_device_attr *dev_attr)
+{
+	struct nvme_rdma_shared_rsrc	*rsrc;
+	struct nvme_rdma_qpair		**qpairs;
+	uint32_t			cq_entries = rqpair->num_entries * 2;
+	bool				created = false;
+
+	if (rqpair->shared_rsrc != NULL) {
+		/* Reconnecting, keep using the resources the qpair was attached to */
+		nvme_rdma_qpair_flush_pending_wcs(rqpair);
+		return rqpair->shared_rsrc->pd == pd ? 0 : -EINVAL;
+	}
+
+	/* Only qpairs using the same protection domain can share a receive queue */
+	if (pd == NULL || pd->context != rqpair->cm_id->verbs) {
+		return -EINVAL;
+	}
+
+	for (rsrc = g_nvme_rdma_shared_rsrcs; rsrc != NULL; rsrc = rsrc->next) {
+		if (rsrc->pd == pd) {
+			break;
+		}
+	}
+
+	if (rsrc == NULL) {
+		rsrc = nvme_rdma_shared_rsrc_create(pd, dev_attr, cq_entries);
+		if (rsrc == NULL) {
+			return -ENOMEM;
+		}
+		rsrc->next = g_nvme_rdma_shared_rsrcs;
+		g_nvme_rdma_shared_rsrcs = rsrc;
+		created = true;
+	} else if (rsrc->cq_entries + cq_entries > (uint32_t)rsrc->cq->cqe) {
+		if (ibv_resize_cq(rsrc->cq, rsrc->cq_entries + cq_entries)) {
+			SPDK_DEBUGLOG(SPDK_LOG_NVME, "Unable to resize shared completion queue\n");
+			return -ENOSPC;
+		}
+	}
+
+	rqpair->pending_wcs = calloc(cq_entries, sizeof(*rqpair->pending_wcs));
+	qpairs = realloc(rsrc->qpairs, (rsrc->num_qpairs + 1) * sizeof(*qpairs));
+	if (rqpair->pending_wcs == NULL || qpairs == NULL) {
+		SPDK_ERRLOG("Failed to attach qpair to shared RDMA resources\n");
+		free(rqpair->pending_wcs);
+		rqpair->pending_wcs = NULL;
+		if (qpairs != NULL) {
+			rsrc->qpairs = qpairs;
+		}
+		if (created) {
+			nvme_rdma_shared_rsrc_put(rsrc);
+		}
+		return -ENOMEM;
+	}
+
+	rsrc->qpairs = qpairs;
+	rsrc->qpairs[rsrc->num_qpairs++] = rqpair;
+	rsrc->cq_entries += cq_entries;
+
+	rqpair->pending_wcs_size = cq_entries;
+	rqpair->pending_wcs_head = 0;
+	rqpair->pending_wcs_count = 0;
+	rqpair->shared_rsrc = rsrc;
+
+	return 0;
+}
+
+static void
+nvme_rdma_qpair_detach_shared_rsrc(struct nvme_rdma_qpair *rqpair)
+{
+	struct nvme_rdma_shared_rsrc *rsrc = rqpair->shared_rsrc;
+	uint32_t i;
+
+	if (rsrc == NULL) {
+		return;
+	}
+
+	nvme_rdma_qpair_flush_pending_wcs(rqpair);
+
+	for (i = 0; i < rsrc->num_qpairs; i++) {
+		if (rsrc->qpairs[i] == rqpair) {
+			rsrc->qpairs[i] = rsrc->qpairs[--rsrc->num_qpairs];
+			break;
+		}
+	}
+	rsrc->cq_entries -= rqpair->pending_wcs_size;
+
+	free(rqpair->pending_wcs);
+	rqpair->pending_wcs = NULL;
+	rqpair->shared_rsrc = NULL;
+
+	nvme_rdma_shared_rsrc_put(rsrc);
+}
+
 static int
 nvme_rdma_qpair_init(struct nvme_rdma_qpair *rqpair)
 {
@@ -463,6 +795,7 @@ nvme_rdma_qpair_init(struct nvme_rdma_qpair *rqpair)
 	struct ibv_qp_init_attr	attr;
 	struct ibv_device_attr	dev_attr;
 	struct nvme_rdma_ctrlr	*rctrlr;
+	struct ibv_pd		*pd;
 
 	rc = ibv_query_device(rqpair->cm_id->verbs, &dev_attr);
 	if (rc != 0) {
@@ -470,13 +803,37 @@ nvme_rdma_qpair_init(struct nvme_rdma_qpair *rqpair)
 		return -1;
 	}
 
-	rqpair->cq = ibv_create_cq(rqpair->cm_id->verbs, rqpair->num_entries * 2, rqpair, NULL, 0);
-	if (!rqpair->cq) {
-		SPDK_ERRLOG("Unable to create completion queue: errno %d: %s\n", errno, spdk_strerror(errno));
-		return -1;
+	rctrlr = nvme_rdma_ctrlr(rqpair->qpair.ctrlr);
+
+	if (rqpair->share_rsrc) {
+		/*
+		 * Without a pd hook, use the pd the admin qpair got from librdmacm. It is
+		 *  the default pd of the device, so all the controllers on it share it.
+		 */
+		if (g_nvme_hooks.get_ibv_pd) {
+			pd = g_nvme_hooks.get_ibv_pd(&rctrlr->ctrlr.trid, rqpair->cm_id->verbs);
+		} else {
+			pd = rctrlr->pd;
+		}
+
+		rc = nvme_rdma_qpair_attach_shared_rsrc(rqpair, pd, &dev_attr);
+		if (rc != 0) {
+			if (rqpair->shared_rsrc != NULL) {
+				SPDK_ERRLOG("Unable to reconnect qpair to its shared RDMA resources\n");
+				return -1;
+			}
+			SPDK_DEBUGLOG(SPDK_LOG_NVME, "Using dedicated CQ and RQ for qpair %p\n", rqpair);
+		}
+	}
+
+	if (rqpair->shared_rsrc == NULL) {
+		rqpair->cq = ibv_create_cq(rqpair->cm_id->verbs, rqpair->num_entries * 2, rqpair, NULL, 0);
+		if (!rqpair->cq) {
+			SPDK_ERRLOG("Unable to create completion queue: errno %d: %s\n", errno, spdk_strerror(errno));
+			return -1;
+		}
 	}
 
-	rctrlr = nvme_rdma_ctrlr(rqpair->qpair.ctrlr);
 	if (g_nvme_hooks.get_ibv_pd) {
 		rctrlr->pd = g_nvme_hooks.get_ibv_pd(&rctrlr->ctrlr.trid, rqpair->cm_id->verbs);
 	} else {
@@ -485,14 +842,22 @@ nvme_rdma_qpair_init(struct nvme_rdma_qpair *rqpair)
 
 	memset(&attr, 0, sizeof(struct ibv_qp_init_attr));
 	attr.qp_type		= IBV_QPT_RC;
-	attr.send_cq		= rqpair->cq;
-	attr.recv_cq		= rqpair->cq;
 	attr.cap.max_send_wr	= rqpair->num_entries; /* SEND operations */
-	attr.cap.max_recv_wr	= rqpair->num_entries; /* RECV operations */
 	attr.cap.max_send_sge	= spdk_min(NVME_RDMA_DEFAULT_TX_SGE, dev_attr.max_sge);
-	attr.cap.max_recv_sge	= spdk_min(NVME_RDMA_DEFAULT_RX_SGE, dev_attr.max_sge);
+	if (rqpair->shared_rsrc) {
+		attr.send_cq		= rqpair->shared_rsrc->cq;
+		attr.recv_cq		= rqpair->shared_rsrc->cq;
+		attr.srq		= rqpair->shared_rsrc->srq;
+		pd			= rqpair->shared_rsrc->pd;
+	} else {
+		attr.send_cq		= rqpair->cq;
+		attr.recv_cq		= rqpair->cq;
+		attr.cap.max_recv_wr	= rqpair->num_entries; /* RECV operations */
+		attr.cap.max_recv_sge	= spdk_min(NVME_RDMA_DEFAULT_RX_SGE, dev_attr.max_sge);
+		pd			= rctrlr->pd;
+	}
 
-	rc = rdma_create_qp(rqpair->cm_id, rctrlr->pd, &attr);
+	rc = rdma_create_qp(rqpair->cm_id, pd, &attr);
 
 	if (rc) {
 		SPDK_ERRLOG("rdma_create_qp failed\n");
@@ -504,6 +869,7 @@ nvme_rdma_qpair_init(struct nvme_rdma_qpair *rqpair)
 	rqpair->max_recv_sge = spdk_min(NVME_RDMA_DEFAULT_RX_SGE, attr.cap.max_recv_sge);
 
 	rctrlr->pd = rqpair->cm_id->qp->pd;
+	rqpair->qp_num = rqpair->cm_id->qp->qp_num;
 
 	rqpair->cm_id->context = &rqpair->qpair;
 
@@ -816,8 +1182,13 @@ nvme_rdma_recv(struct nvme_rdma_qpair *rqpair, uint64_t rsp_idx, int *reaped)
 	struct spdk_nvme_cpl *rsp;
 	struct nvme_request *req;
 
-	assert(rsp_idx < rqpair->num_entries);
-	rsp = &rqpair->rsps[rsp_idx];
+	if (rqpair->shared_rsrc) {
+		assert(rsp_idx < rqpair->shared_rsrc->srq_depth);
+		rsp = &rqpair->shared_rsrc->rsps[rsp_idx];
+	} else {
+		assert(rsp_idx < rqpair->num_entries);
+		rsp = &rqpair->rsps[rsp_idx];
+	}
 	rdma_req = &rqpair->rdma_reqs[rsp->cid];
 
 	req = rdma_req->req;
@@ -830,7 +1201,9 @@ nvme_rdma_recv(struct nvme_rdma_qpair *rqpair, uint64_t rsp_idx, int *reaped)
 		rdma_req->request_ready_to_put = true;
 	}
 
-	if (nvme_rdma_post_recv(rqpair, rsp_idx)) {
+	if (rqpair->shared_rsrc) {
+		nvme_rdma_shared_rsrc_post_recv(rqpair->shared_rsrc, rsp_idx);
+	} else if (nvme_rdma_post_recv(rqpair, rsp_idx)) {
 		SPDK_ERRLOG("Unable to re-post rx descriptor\n");
 		return -1;
 	}
@@ -1162,13 +1535,16 @@ nvme_rdma_ctrlr_connect_qpair(struct spdk_nvme_ctrlr *ctrlr, struct spdk_nvme_qp
 	}
 	SPDK_DEBUGLOG(SPDK_LOG_NVME, "RDMA requests registered\n");
 
-	rc = nvme_rdma_register_rsps(rqpair);
-	SPDK_DEBUGLOG(SPDK_LOG_NVME, "rc =%d\n", rc);
-	if (rc < 0) {
-		SPDK_ERRLOG("Unable to register rqpair RDMA responses\n");
-		return -1;
+	/* Responses of qpairs using an SRQ land in the buffers of the SRQ */
+	if (rqpair->shared_rsrc == NULL) {
+		rc = nvme_rdma_register_rsps(rqpair);
+		SPDK_DEBUGLOG(SPDK_LOG_NVME, "rc =%d\n", rc);
+		if (rc < 0) {
+			SPDK_ERRLOG("Unable to register rqpair RDMA responses\n");
+			return -1;
+		}
+		SPDK_DEBUGLOG(SPDK_LOG_NVME, "RDMA responses registered\n");
 	}
-	SPDK_DEBUGLOG(SPDK_LOG_NVME, "RDMA responses registered\n");
 
 	rc = nvme_rdma_register_mem(rqpair);
 	if (rc < 0) {
@@ -1568,7 +1944,8 @@ nvme_rdma_ctrlr_create_qpair(struct spdk_nvme_ctrlr *ctrlr,
 			     uint16_t qid, uint32_t qsize,
 			     enum spdk_nvme_qprio qprio,
 			     uint32_t num_requests,
-			     bool delay_cmd_submit)
+			     bool delay_cmd_submit,
+			     bool share_rsrc)
 {
 	struct nvme_rdma_qpair *rqpair;
 	struct spdk_nvme_qpair *qpair;
@@ -1582,6 +1959,7 @@ nvme_rdma_ctrlr_create_qpair(struct spdk_nvme_ctrlr *ctrlr,
 
 	rqpair->num_entries = qsize;
 	rqpair->delay_cmd_submit = delay_cmd_submit;
+	rqpair->share_rsrc = share_rsrc;
 	qpair = &rqpair->qpair;
 	rc = nvme_qpair_init(qpair, qid, ctrlr, qprio, num_requests);
 	if (rc != 0) {
@@ -1661,6 +2039,9 @@ nvme_rdma_ctrlr_disconnect_qpair(struct spdk_nvme_ctrlr *ctrlr, struct spdk_nvme
 		}
 	}
 
+	/* Completions still arriving on a shared CQ are dropped from now on */
+	rqpair->qp_num = 0;
+
 	if (rqpair->cm_id) {
 		if (rqpair->cm_id->qp) {
 			rdma_destroy_qp(rqpair->cm_id);
@@ -1689,6 +2070,8 @@ nvme_rdma_ctrlr_delete_io_qpair(struct spdk_nvme_ctrlr *ctrlr, struct spdk_nvme_
 
 	rqpair = nvme_rdma_qpair(qpair);
 
+	nvme_rdma_qpair_detach_shared_rsrc(rqpair);
+
 	nvme_rdma_free_reqs(rqpair);
 	nvme_rdma_free_rsps(rqpair);
 	free(rqpair);
@@ -1702,7 +2085,8 @@ nvme_rdma_ctrlr_create_io_qpair(struct spdk_nvme_ctrlr *ctrlr, uint16_t qid,
 {
 	return nvme_rdma_ctrlr_create_qpair(ctrlr, qid, opts->io_queue_size, opts->qprio,
 					    opts->io_queue_requests,
-					    opts->delay_cmd_submit);
+					    opts->delay_cmd_submit,
+					    opts->share_transport_resources);
 }
 
 int
@@ -1797,7 +2181,7 @@ struct spdk_nvme_ctrlr *nvme_rdma_ctrlr_construct(const struct spdk_nvme_transpo
 
 	rctrlr->ctrlr.adminq = nvme_rdma_ctrlr_create_qpair(&rctrlr->ctrlr, 0,
 			       SPDK_NVMF_MIN_ADMIN_QUEUE_ENTRIES, 0, SPDK_NVMF_MIN_ADMIN_QUEUE_ENTRIES,
-			       false);
+			       false, false);
 	if (!rctrlr->ctrlr.adminq) {
 		SPDK_ERRLOG("failed to create admin qpair\n");
 		nvme_rdma_ctrlr_destruct(&rctrlr->ctrlr);
@@ -1957,6 +2341,86 @@ nvme_rdma_qpair_check_timeout(struct spdk_nvme_qpair *qpair)
 
 #define MAX_COMPLETIONS_PER_POLL 128
 
+/*
+ * Reap a batch of completions from a shared CQ and hand each of them over to
+ *  the qpair it belongs to. The completions are then processed by their own
+ *  qpairs, so completion callbacks keep running in their qpair's context.
+ */
+static int
+nvme_rdma_shared_rsrc_poll(struct nvme_rdma_shared_rsrc *rsrc)
+{
+	struct ibv_wc		wc[MAX_COMPLETIONS_PER_POLL];
+	struct nvme_rdma_qpair	*owner;
+	uint32_t		i, j, tail;
+	int			rc;
+
+	rc = ibv_poll_cq(rsrc->cq, MAX_COMPLETIONS_PER_POLL, wc);
+	if (rc <= 0) {
+		return rc;
+	}
+
+	for (i = 0; i < (uint32_t)rc; i++) {
+		owner = NULL;
+		for (j = 0; j < rsrc->num_qpairs; j++) {
+			if (rsrc->qpairs[j]->qp_num == wc[i].qp_num) {
+				owner = rsrc->qpairs[j];
+				break;
+			}
+		}
+
+		/* Buffers of failed receives go straight back to the SRQ */
+		if (wc[i].wr_id < rsrc->srq_depth &&
+		    (owner == NULL || wc[i].status != IBV_WC_SUCCESS)) {
+			nvme_rdma_shared_rsrc_post_recv(rsrc, wc[i].wr_id);
+		}
+
+		if (owner == NULL) {
+			/* Flushed completion of a qpair that was already disconnected */
+			continue;
+		}
+
+		if (spdk_unlikely(owner->pending_wcs_count == owner->pending_wcs_size)) {
+			SPDK_ERRLOG("No room left for completions of qpair %p\n", owner);
+			continue;
+		}
+
+		tail = (owner->pending_wcs_head + owner->pending_wcs_count) % owner->pending_wcs_size;
+		owner->pending_wcs[tail] = wc[i];
+		owner->pending_wcs_count++;
+	}
+
+	return rc;
+}
+
+static int
+nvme_rdma_qpair_poll_cq(struct nvme_rdma_qpair *rqpair, int batch_size, struct ibv_wc *wc)
+{
+	int rc, count;
+
+	if (rqpair->shared_rsrc == NULL) {
+		return ibv_poll_cq(rqpair->cq, batch_size, wc);
+	}
+
+	/* Whichever qpair of the thread polls first reaps the completions of all of them */
+	while (rqpair->pending_wcs_count == 0) {
+		rc = nvme_rdma_shared_rsrc_poll(rqpair->shared_rsrc);
+		if (rc < MAX_COMPLETIONS_PER_POLL) {
+			if (rc < 0) {
+				return rc;
+			}
+			break;
+		}
+	}
+
+	for (count = 0; count < batch_size && rqpair->pending_wcs_count > 0; count++) {
+		wc[count] = rqpair->pending_wcs[rqpair->pending_wcs_head];
+		rqpair->pending_wcs_head = (rqpair->pending_wcs_head + 1) % rqpair->pending_wcs_size;
+		rqpair->pending_wcs_count--;
+	}
+
+	return count;
+}
+
 int
 nvme_rdma_qpair_process_completions(struct spdk_nvme_qpair *qpair,
 				    uint32_t max_completions)
@@ -1965,7 +2429,6 @@ nvme_rdma_qpair_process_completions(struct spdk_nvme_qpair *qpair,
 	struct ibv_wc			wc[MAX_COMPLETIONS_PER_POLL];
 	int				i, rc = 0, batch_size;
 	uint32_t			reaped;
-	struct ibv_cq			*cq;
 	struct spdk_nvme_rdma_req	*rdma_req;
 	struct nvme_rdma_ctrlr		*rctrlr;
 
@@ -1974,6 +2437,11 @@ nvme_rdma_qpair_process_completions(struct spdk_nvme_qpair *qpair,
 		return -1;
 	}
 
+	if (rqpair->shared_rsrc != NULL &&
+	    spdk_unlikely(nvme_rdma_shared_rsrc_submit_recvs(rqpair->shared_rsrc))) {
+		return -1;
+	}
+
 	if (max_completions == 0) {
 		max_completions = rqpair->num_entries;
 	} else {
@@ -1990,13 +2458,11 @@ nvme_rdma_qpair_process_completions(struct spdk_nvme_qpair *qpair,
 		goto fail;
 	}
 
-	cq = rqpair->cq;
-
 	reaped = 0;
 	do {
 		batch_size = spdk_min((max_completions - reaped),
 				      MAX_COMPLETIONS_PER_POLL);
-		rc = ibv_poll_cq(cq, batch_size, wc);
+		rc = nvme_rdma_qpair_poll_cq(rqpair, batch_size, wc);
 		if (rc < 0) {
 			SPDK_ERRLOG("Error polling CQ! (%d): %s\n",
 				    errno, spdk_strerror(errno));
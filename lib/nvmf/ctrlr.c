@@ -251,6 +251,12 @@ _spdk_nvmf_subsystem_add_ctrlr(void *ctx)
 	struct spdk_nvmf_qpair *qpair = req->qpair;
 	struct spdk_nvmf_fabric_connect_rsp *rsp = &req->rsp->connect_rsp;
 	struct spdk_nvmf_ctrlr *ctrlr = qpair->ctrlr;
+	struct spdk_nvme_transport_id listen_trid = {};
+
+	/* The ANA states reported to the controller are the ones of the listener it connected to */
+	if (spdk_nvmf_qpair_get_listen_trid(qpair, &listen_trid) == 0) {
+		ctrlr->listener = spdk_nvmf_subsystem_find_listener(ctrlr->subsys, &listen_trid);
+	}
 
 	if (spdk_nvmf_subsystem_add_ctrlr(ctrlr->subsys, ctrlr)) {
 		SPDK_ERRLOG("Unable to add controller to subsystem\n");
@@ -300,6 +306,7 @@ spdk_nvmf_ctrlr_create(struct spdk_nvmf_subsystem *subsystem,
 			KAS_DEFAULT_VALUE * KAS_TIME_UNIT_IN_MS) *
 			KAS_DEFAULT_VALUE * KAS_TIME_UNIT_IN_MS;
 	ctrlr->feat.async_event_configuration.bits.ns_attr_notice = 1;
+	ctrlr->feat.async_event_configuration.bits.ana_change_notice = subsystem->ana_reporting;
 	ctrlr->feat.volatile_write_cache.bits.wce = 1;
 
 	if (ctrlr->subsys->subtype == SPDK_NVMF_SUBTYPE_DISCOVERY) {
@@ -1305,7 +1312,7 @@ spdk_nvmf_ctrlr_async_event_request(struct spdk_nvmf_request *req)
 
 	/* AER cmd is an exception */
 	sgroup = &req->qpair->group->sgroups[ctrlr->subsys->id];
-	sgroup->io_outstanding--;
+	sgroup->mgmt_io_outstanding--;
 
 	ctrlr->aer_req = req;
 	return SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS;
@@ -1472,6 +1479,116 @@ spdk_nvmf_get_reservation_notification_log_page(struct spdk_nvmf_ctrlr *ctrlr,
 	return;
 }
 
+static inline enum spdk_nvme_ana_state
+nvmf_ctrlr_get_ana_state(struct spdk_nvmf_ctrlr *ctrlr, uint32_t anagrpid)
+{
+	if (!ctrlr->subsys->ana_reporting || ctrlr->listener == NULL) {
+		return SPDK_NVME_ANA_OPTIMIZED_STATE;
+	}
+
+	return ctrlr->listener->ana_state[anagrpid - 1];
+}
+
+static inline enum spdk_nvme_path_status_code
+nvmf_ana_state_to_sc(enum spdk_nvme_ana_state ana_state)
+{
+	switch (ana_state) {
+	case SPDK_NVME_ANA_INACCESSIBLE_STATE:
+		return SPDK_NVME_SC_ASYMMETRIC_ACCESS_INACCESSIBLE;
+	case SPDK_NVME_ANA_PERSISTENT_LOSS_STATE:
+		return SPDK_NVME_SC_ASYMMETRIC_ACCESS_PERSISTENT_LOSS;
+	case SPDK_NVME_ANA_CHANGE_STATE:
+		return SPDK_NVME_SC_ASYMMETRIC_ACCESS_TRANSITION;
+	default:
+		return SPDK_NVME_SC_INTERNAL_PATH_ERROR;
+	}
+}
+
+static void
+spdk_nvmf_get_ana_log_page(struct spdk_nvmf_ctrlr *ctrlr, void *buffer,
+			   uint64_t offset, uint32_t length, bool rgo)
+{
+	struct spdk_nvmf_subsystem *subsystem = ctrlr->subsys;
+	struct spdk_nvme_ana_page *ana_hdr;
+	struct spdk_nvme_ana_group_descriptor *ana_desc;
+	struct spdk_nvmf_ns *ns;
+	uint64_t change_count;
+	uint32_t *num_ns_in_group;
+	uint32_t anagrpid, num_groups = 0, num_ns = 0;
+	size_t page_size, copy_len = 0;
+	char *page, *pos;
+
+	num_ns_in_group = calloc(subsystem->max_nsid, sizeof(*num_ns_in_group));
+	if (num_ns_in_group == NULL) {
+		SPDK_ERRLOG("Unable to allocate ANA group list\n");
+		goto zero_fill;
+	}
+
+	for (ns = spdk_nvmf_subsystem_get_first_ns(subsystem); ns != NULL;
+	     ns = spdk_nvmf_subsystem_get_next_ns(subsystem, ns)) {
+		if (num_ns_in_group[ns->opts.anagrpid - 1]++ == 0) {
+			num_groups++;
+		}
+		num_ns++;
+	}
+
+	page_size = sizeof(*ana_hdr) + num_groups * sizeof(*ana_desc);
+	if (!rgo) {
+		page_size += num_ns * sizeof(uint32_t);
+	}
+
+	page = calloc(1, page_size);
+	if (page == NULL) {
+		SPDK_ERRLOG("Unable to allocate ANA log page\n");
+		free(num_ns_in_group);
+		goto zero_fill;
+	}
+
+	change_count = ctrlr->listener ? ctrlr->listener->ana_state_change_count : 0;
+
+	ana_hdr = (struct spdk_nvme_ana_page *)page;
+	ana_hdr->change_count = change_count;
+	ana_hdr->num_ana_group_desc = num_groups;
+
+	pos = page + sizeof(*ana_hdr);
+	for (anagrpid = 1; anagrpid <= subsystem->max_nsid; anagrpid++) {
+		if (num_ns_in_group[anagrpid - 1] == 0) {
+			continue;
+		}
+
+		ana_desc = (struct spdk_nvme_ana_group_descriptor *)pos;
+		ana_desc->ana_group_id = anagrpid;
+		ana_desc->change_count = change_count;
+		ana_desc->ana_state = nvmf_ctrlr_get_ana_state(ctrlr, anagrpid);
+		pos += sizeof(*ana_desc);
+
+		if (rgo) {
+			continue;
+		}
+
+		for (ns = spdk_nvmf_subsystem_get_first_ns(subsystem); ns != NULL;
+		     ns = spdk_nvmf_subsystem_get_next_ns(subsystem, ns)) {
+			if (ns->opts.anagrpid == anagrpid) {
+				ana_desc->nsid[ana_desc->num_of_nsid++] = ns->nsid;
+				pos += sizeof(uint32_t);
+			}
+		}
+	}
+
+	if (offset < page_size) {
+		copy_len = spdk_min(page_size - offset, length);
+		memcpy(buffer, page + offset, copy_len);
+	}
+
+	free(page);
+	free(num_ns_in_group);
+
+zero_fill:
+	if (copy_len < length) {
+		memset((char *)buffer + copy_len, 0, length - copy_len);
+	}
+}
+
 static int
 spdk_nvmf_ctrlr_get_log_page(struct spdk_nvmf_request *req)
 {
@@ -1537,6 +1654,14 @@ spdk_nvmf_ctrlr_get_log_page(struct spdk_nvmf_request *req)
 		case SPDK_NVME_LOG_CHANGED_NS_LIST:
 			spdk_nvmf_get_changed_ns_list_log_page(ctrlr, req->data, offset, len);
 			return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+		case SPDK_NVME_LOG_ASYMMETRIC_NAMESPACE_ACCESS:
+			if (!subsystem->ana_reporting) {
+				goto invalid_log_page;
+			}
+			/* Bit 0 of the log specific field is Return Groups Only */
+			spdk_nvmf_get_ana_log_page(ctrlr, req->data, offset, len,
+						   cmd->cdw10_bits.get_log_page.lsp & 0x1);
+			return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
 		case SPDK_NVME_LOG_RESERVATION_NOTIFICATION:
 			spdk_nvmf_get_reservation_notification_log_page(ctrlr, req->data, offset, len);
 			return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
@@ -1584,6 +1709,10 @@ spdk_nvmf_ctrlr_identify_ns(struct spdk_nvmf_ctrlr *ctrlr,
 
 	spdk_nvmf_bdev_ctrlr_identify_ns(ns, nsdata, ctrlr->dif_insert_or_strip);
 
+	if (subsystem->ana_reporting) {
+		nsdata->anagrpid = ns->opts.anagrpid;
+	}
+
 	/* Due to bug in the Linux kernel NVMe driver we have to set noiob no larger than mdts */
 	max_num_blocks = ctrlr->admin_qpair->transport->opts.max_io_size /
 			 (1U << nsdata->lbaf[nsdata->flbas.format].lbads);
@@ -1640,7 +1769,9 @@ spdk_nvmf_ctrlr_identify_ctrlr(struct spdk_nvmf_ctrlr *ctrlr, struct spdk_nvme_c
 	cdata->sgls.keyed_sgl = 1;
 	cdata->sgls.sgl_offset = 1;
 	cdata->fuses.compare_and_write = 1;
-	cdata->acwu = 1;
+	/* Each namespace reports its own NAWUN and NACWU, so these are just the minimum */
+	cdata->awun = 0;
+	cdata->acwu = 0;
 	spdk_strcpy_pad(cdata->subnqn, subsystem->subnqn, sizeof(cdata->subnqn), '\0');
 
 	SPDK_DEBUGLOG(SPDK_LOG_NVMF, "ctrlr data: maxcmd 0x%x\n", cdata->maxcmd);
@@ -1659,6 +1790,21 @@ spdk_nvmf_ctrlr_identify_ctrlr(struct spdk_nvmf_ctrlr *ctrlr, struct spdk_nvme_c
 		cdata->cmic.multi_host = 1;
 		cdata->oaes.ns_attribute_notices = 1;
 		cdata->ctratt.host_id_exhid_supported = 1;
+
+		if (subsystem->ana_reporting) {
+			cdata->cmic.ana_reporting = 1;
+			cdata->oaes.ana_change_notices = 1;
+			/* ANA transition time in seconds */
+			cdata->anatt = 10;
+			cdata->anacap.ana_optimized_state = 1;
+			cdata->anacap.ana_non_optimized_state = 1;
+			cdata->anacap.ana_inaccessible_state = 1;
+			cdata->anacap.no_change_anagrpid = 1;
+			cdata->anacap.non_zero_anagrpid = 1;
+			cdata->anagrpmax = subsystem->max_nsid;
+			cdata->nanagrpid = subsystem->max_nsid;
+		}
+
 		cdata->aerl = 0;
 		cdata->frmw.slot1_ro = 1;
 		cdata->frmw.num_slots = 1;
@@ -2192,6 +2338,47 @@ spdk_nvmf_ctrlr_process_fabrics_cmd(struct spdk_nvmf_request *req)
 	}
 }
 
+int
+spdk_nvmf_ctrlr_async_event_ana_change_notice(struct spdk_nvmf_ctrlr *ctrlr)
+{
+	struct spdk_nvmf_request *req;
+	struct spdk_nvme_cpl *rsp;
+	union spdk_nvme_async_event_completion event = {0};
+
+	/* Users may disable the event notification */
+	if (!ctrlr->feat.async_event_configuration.bits.ana_change_notice) {
+		return 0;
+	}
+
+	event.bits.async_event_type = SPDK_NVME_ASYNC_EVENT_TYPE_NOTICE;
+	event.bits.async_event_info = SPDK_NVME_ASYNC_EVENT_ANA_CHANGE;
+	event.bits.log_page_identifier = SPDK_NVME_LOG_ASYMMETRIC_NAMESPACE_ACCESS;
+
+	/* If there is no outstanding AER request, queue the event.  Then
+	 * if an AER is later submitted, this event can be sent as a
+	 * response.
+	 */
+	if (!ctrlr->aer_req) {
+		if (ctrlr->notice_event.bits.async_event_type ==
+		    SPDK_NVME_ASYNC_EVENT_TYPE_NOTICE) {
+			return 0;
+		}
+
+		ctrlr->notice_event.raw = event.raw;
+		return 0;
+	}
+
+	req = ctrlr->aer_req;
+	rsp = &req->rsp->nvme_cpl;
+
+	rsp->cdw0 = event.raw;
+
+	spdk_nvmf_request_complete(req);
+	ctrlr->aer_req = NULL;
+
+	return 0;
+}
+
 int
 spdk_nvmf_ctrlr_async_event_ns_notice(struct spdk_nvmf_ctrlr *ctrlr)
 {
@@ -2553,7 +2740,9 @@ spdk_nvmf_ctrlr_process_io_cmd(struct spdk_nvmf_request *req)
 	struct spdk_nvmf_ctrlr *ctrlr = req->qpair->ctrlr;
 	struct spdk_nvme_cmd *cmd = &req->cmd->nvme_cmd;
 	struct spdk_nvme_cpl *response = &req->rsp->nvme_cpl;
+	struct spdk_nvmf_subsystem_poll_group *sgroup;
 	struct spdk_nvmf_subsystem_pg_ns_info *ns_info;
+	enum spdk_nvme_ana_state ana_state;
 
 	/* pre-set response details for this command */
 	response->status.sc = SPDK_NVME_SC_SUCCESS;
@@ -2581,9 +2770,28 @@ spdk_nvmf_ctrlr_process_io_cmd(struct spdk_nvmf_request *req)
 		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
 	}
 
+	ana_state = nvmf_ctrlr_get_ana_state(ctrlr, ns->opts.anagrpid);
+	if (spdk_unlikely(ana_state != SPDK_NVME_ANA_OPTIMIZED_STATE &&
+			  ana_state != SPDK_NVME_ANA_NON_OPTIMIZED_STATE)) {
+		SPDK_DEBUGLOG(SPDK_LOG_NVMF, "Fail I/O command due to ANA state %d\n", ana_state);
+		response->status.sct = SPDK_NVME_SCT_PATH;
+		response->status.sc = nvmf_ana_state_to_sc(ana_state);
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
 	/* scan-build falsely reporting dereference of null pointer */
 	assert(group != NULL && group->sgroups != NULL);
-	ns_info = &group->sgroups[ctrlr->subsys->id].ns_info[nsid - 1];
+	sgroup = &group->sgroups[ctrlr->subsys->id];
+	ns_info = nsid <= sgroup->num_ns ? &sgroup->ns_info[nsid - 1] : NULL;
+	if (spdk_unlikely(ns_info == NULL || ns_info->channel == NULL)) {
+		/* The namespace is being added and is not attached to this poll group yet */
+		SPDK_DEBUGLOG(SPDK_LOG_NVMF, "nsid %u is not attached to poll group %p\n",
+			      nsid, group);
+		response->status.sc = SPDK_NVME_SC_INVALID_NAMESPACE_OR_FORMAT;
+		response->status.dnr = 1;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
 	if (nvmf_ns_reservation_request_check(ns_info, ctrlr, req)) {
 		SPDK_DEBUGLOG(SPDK_LOG_NVMF, "Reservation Conflict for nsid %u, opcode %u\n",
 			      cmd->nsid, cmd->opc);
@@ -2661,12 +2869,136 @@ spdk_nvmf_request_free(struct spdk_nvmf_request *req)
 	return 0;
 }
 
+/*
+ * Returns the poll group information of the namespace an I/O request is addressed to,
+ * or NULL if the request is accounted and fenced by the subsystem poll group as a whole.
+ * That is the case for admin and fabrics requests and for I/O requests to namespaces
+ * that are not attached to the poll group.
+ */
+static inline struct spdk_nvmf_subsystem_pg_ns_info *
+nvmf_request_get_ns_info(struct spdk_nvmf_request *req,
+			 struct spdk_nvmf_subsystem_poll_group *sgroup)
+{
+	uint32_t nsid;
+
+	if (spdk_unlikely(spdk_nvmf_qpair_is_admin_queue(req->qpair) ||
+			  req->cmd->nvmf_cmd.opcode == SPDK_NVME_OPC_FABRIC)) {
+		return NULL;
+	}
+
+	/* This also catches NSID 0, since 0 - 1 wraps around to UINT32_MAX */
+	nsid = req->cmd->nvme_cmd.nsid;
+	if (spdk_unlikely(nsid - 1 >= sgroup->num_ns ||
+			  sgroup->ns_info[nsid - 1].channel == NULL)) {
+		return NULL;
+	}
+
+	return &sgroup->ns_info[nsid - 1];
+}
+
+void
+spdk_nvmf_subsystem_poll_group_check_paused(struct spdk_nvmf_subsystem_poll_group *sgroup)
+{
+	struct spdk_nvmf_subsystem_pg_ns_info *ns_info;
+	uint32_t i;
+
+	assert(sgroup->state == SPDK_NVMF_SUBSYSTEM_PAUSING);
+
+	if (sgroup->mgmt_io_outstanding > 0) {
+		return;
+	}
+
+	/* Only the namespaces being paused have to drain */
+	for (i = 0; i < sgroup->num_ns; i++) {
+		ns_info = &sgroup->ns_info[i];
+		if (ns_info->state == SPDK_NVMF_SUBSYSTEM_PAUSING && ns_info->io_outstanding > 0) {
+			return;
+		}
+	}
+
+	for (i = 0; i < sgroup->num_ns; i++) {
+		ns_info = &sgroup->ns_info[i];
+		if (ns_info->state == SPDK_NVMF_SUBSYSTEM_PAUSING) {
+			ns_info->state = SPDK_NVMF_SUBSYSTEM_PAUSED;
+		}
+	}
+
+	sgroup->state = SPDK_NVMF_SUBSYSTEM_PAUSED;
+	if (sgroup->cb_fn) {
+		sgroup->cb_fn(sgroup->cb_arg, 0);
+	}
+}
+
+void
+spdk_nvmf_subsystem_poll_group_io_done(struct spdk_nvmf_subsystem_poll_group *sgroup,
+				       struct spdk_nvmf_subsystem_pg_ns_info *ns_info)
+{
+	if (ns_info != NULL) {
+		assert(ns_info->io_outstanding > 0);
+		ns_info->io_outstanding--;
+	} else {
+		assert(sgroup->mgmt_io_outstanding > 0);
+		sgroup->mgmt_io_outstanding--;
+	}
+
+	if (spdk_unlikely(sgroup->state == SPDK_NVMF_SUBSYSTEM_PAUSING)) {
+		spdk_nvmf_subsystem_poll_group_check_paused(sgroup);
+	}
+}
+
+static inline void
+nvmf_io_stat_update(struct spdk_nvmf_io_stat *stat, uint8_t opc, uint64_t bytes, uint64_t ticks)
+{
+	struct spdk_histogram_data histogram = {
+		.bucket_shift = NVMF_IO_STAT_HISTOGRAM_BUCKET_SHIFT,
+		.bucket = stat->latency_buckets,
+	};
+
+	if (opc == SPDK_NVME_OPC_READ) {
+		stat->bytes_read += bytes;
+		stat->num_read_ops++;
+		stat->read_latency_ticks += ticks;
+	} else {
+		stat->bytes_written += bytes;
+		stat->num_write_ops++;
+		stat->write_latency_ticks += ticks;
+	}
+
+	if (spdk_likely(ticks > 0)) {
+		spdk_histogram_data_tally(&histogram, ticks);
+	}
+}
+
+static void
+nvmf_request_update_io_stat(struct spdk_nvmf_request *req,
+			    struct spdk_nvmf_subsystem_pg_ns_info *ns_info)
+{
+	struct spdk_nvme_cpl *rsp = &req->rsp->nvme_cpl;
+	uint8_t opc = req->cmd->nvme_cmd.opc;
+	uint64_t ticks;
+
+	if ((opc != SPDK_NVME_OPC_READ && opc != SPDK_NVME_OPC_WRITE) ||
+	    rsp->status.sct != SPDK_NVME_SCT_GENERIC || rsp->status.sc != SPDK_NVME_SC_SUCCESS) {
+		return;
+	}
+
+	/* A zero copy write is only done once its buffers are committed */
+	if (opc == SPDK_NVME_OPC_WRITE && req->zcopy_bdev_io != NULL) {
+		return;
+	}
+
+	ticks = spdk_get_ticks() - req->exec_tsc;
+	nvmf_io_stat_update(&ns_info->io_stat, opc, req->length, ticks);
+	nvmf_io_stat_update(&req->qpair->io_stat, opc, req->length, ticks);
+}
+
 int
 spdk_nvmf_request_complete(struct spdk_nvmf_request *req)
 {
 	struct spdk_nvme_cpl *rsp = &req->rsp->nvme_cpl;
 	struct spdk_nvmf_qpair *qpair;
 	struct spdk_nvmf_subsystem_poll_group *sgroup = NULL;
+	struct spdk_nvmf_subsystem_pg_ns_info *ns_info = NULL;
 	bool is_connect = req->cmd->nvmf_cmd.opcode == SPDK_NVME_OPC_FABRIC &&
 			  req->cmd->nvmf_cmd.fctype == SPDK_NVMF_FABRIC_COMMAND_CONNECT;
 
@@ -2677,26 +3009,29 @@ spdk_nvmf_request_complete(struct spdk_nvmf_request *req)
 	qpair = req->qpair;
 	if (qpair->ctrlr) {
 		sgroup = &qpair->group->sgroups[qpair->ctrlr->subsys->id];
+		ns_info = nvmf_request_get_ns_info(req, sgroup);
 	}
 
 	SPDK_DEBUGLOG(SPDK_LOG_NVMF,
 		      "cpl: cdw0=0x%08x sct=0x%01x sc=0x%02x cid=0x%04x\n",
 		      rsp->cdw0, rsp->status.sct, rsp->status.sc, rsp->cid);
 
+	if (ns_info != NULL) {
+		nvmf_request_update_io_stat(req, ns_info);
+	}
+
 	TAILQ_REMOVE(&qpair->outstanding, req, link);
 	if (spdk_nvmf_transport_req_complete(req)) {
 		SPDK_ERRLOG("Transport request completion error!\n");
 	}
 
-	/* AER cmd and fabric connect are exceptions */
-	if (sgroup != NULL && qpair->ctrlr->aer_req != req && !is_connect) {
-		assert(sgroup->io_outstanding > 0);
-		sgroup->io_outstanding--;
-		if (sgroup->state == SPDK_NVMF_SUBSYSTEM_PAUSING &&
-		    sgroup->io_outstanding == 0) {
-			sgroup->state = SPDK_NVMF_SUBSYSTEM_PAUSED;
-			sgroup->cb_fn(sgroup->cb_arg, 0);
-		}
+	/*
+	 * AER cmd and fabric connect are exceptions. Zero copy requests stay outstanding
+	 *  until the bdev gets its buffers back in spdk_nvmf_request_zcopy_end().
+	 */
+	if (sgroup != NULL && qpair->ctrlr->aer_req != req && !is_connect &&
+	    req->zcopy_bdev_io == NULL) {
+		spdk_nvmf_subsystem_poll_group_io_done(sgroup, ns_info);
 	}
 
 	spdk_nvmf_qpair_request_cleanup(qpair);
@@ -2750,15 +3085,19 @@ nvmf_trace_command(union nvmf_h2c_msg *h2c_msg, bool is_admin_queue)
 
 static void
 _nvmf_request_exec(struct spdk_nvmf_request *req,
-		   struct spdk_nvmf_subsystem_poll_group *sgroup)
+		   struct spdk_nvmf_subsystem_poll_group *sgroup,
+		   struct spdk_nvmf_subsystem_pg_ns_info *ns_info)
 {
 	struct spdk_nvmf_qpair *qpair = req->qpair;
 	spdk_nvmf_request_exec_status status;
 
 	nvmf_trace_command(req->cmd, spdk_nvmf_qpair_is_admin_queue(qpair));
 
-	if (sgroup) {
-		sgroup->io_outstanding++;
+	if (ns_info) {
+		ns_info->io_outstanding++;
+		req->exec_tsc = spdk_get_ticks();
+	} else if (sgroup) {
+		sgroup->mgmt_io_outstanding++;
 	}
 
 	/* Place the request on the outstanding list so we can keep track of it */
@@ -2789,7 +3128,7 @@ spdk_nvmf_request_exec_fabrics(struct spdk_nvmf_request *req)
 		sgroup = &qpair->group->sgroups[qpair->ctrlr->subsys->id];
 	}
 
-	_nvmf_request_exec(req, sgroup);
+	_nvmf_request_exec(req, sgroup, NULL);
 }
 
 void
@@ -2797,9 +3136,11 @@ spdk_nvmf_request_exec(struct spdk_nvmf_request *req)
 {
 	struct spdk_nvmf_qpair *qpair = req->qpair;
 	struct spdk_nvmf_subsystem_poll_group *sgroup = NULL;
+	struct spdk_nvmf_subsystem_pg_ns_info *ns_info = NULL;
 
 	if (qpair->ctrlr) {
 		sgroup = &qpair->group->sgroups[qpair->ctrlr->subsys->id];
+		ns_info = nvmf_request_get_ns_info(req, sgroup);
 	}
 
 	if (qpair->state != SPDK_NVMF_QPAIR_ACTIVE) {
@@ -2808,15 +3149,26 @@ spdk_nvmf_request_exec(struct spdk_nvmf_request *req)
 		/* Place the request on the outstanding list so we can keep track of it */
 		TAILQ_INSERT_TAIL(&qpair->outstanding, req, link);
 		/* Still increment io_outstanding because request_complete decrements it */
-		if (sgroup != NULL) {
-			sgroup->io_outstanding++;
+		if (ns_info != NULL) {
+			ns_info->io_outstanding++;
+		} else if (sgroup != NULL) {
+			sgroup->mgmt_io_outstanding++;
 		}
 		spdk_nvmf_request_complete(req);
 		return;
 	}
 
-	/* Check if the subsystem is paused (if there is a subsystem) */
-	if (sgroup != NULL) {
+	/*
+	 * Check if the subsystem is paused (if there is a subsystem). I/O to a namespace
+	 * is only held back while that namespace itself is paused.
+	 */
+	if (ns_info != NULL) {
+		if (spdk_unlikely(ns_info->state != SPDK_NVMF_SUBSYSTEM_ACTIVE)) {
+			/* The namespace is not currently active. Queue this request. */
+			TAILQ_INSERT_TAIL(&sgroup->queued, req, link);
+			return;
+		}
+	} else if (sgroup != NULL) {
 		if (sgroup->state != SPDK_NVMF_SUBSYSTEM_ACTIVE) {
 			/* The subsystem is not currently active. Queue this request. */
 			TAILQ_INSERT_TAIL(&sgroup->queued, req, link);
@@ -2824,7 +3176,7 @@ spdk_nvmf_request_exec(struct spdk_nvmf_request *req)
 		}
 	}
 
-	_nvmf_request_exec(req, sgroup);
+	_nvmf_request_exec(req, sgroup, ns_info);
 }
 
 static bool
@@ -2882,6 +3234,64 @@ spdk_nvmf_request_get_dif_ctx(struct spdk_nvmf_request *req, struct spdk_dif_ctx
 	return spdk_nvmf_ctrlr_get_dif_ctx(ctrlr, &req->cmd->nvme_cmd, dif_ctx);
 }
 
+bool
+spdk_nvmf_request_use_zcopy(struct spdk_nvmf_request *req)
+{
+	struct spdk_nvmf_qpair *qpair = req->qpair;
+	struct spdk_nvmf_ctrlr *ctrlr = qpair->ctrlr;
+	struct spdk_nvme_cmd *cmd = &req->cmd->nvme_cmd;
+	struct spdk_nvmf_ns *ns;
+
+	if (spdk_likely(!qpair->transport->opts.zcopy)) {
+		return false;
+	}
+
+	if (ctrlr == NULL || qpair->state != SPDK_NVMF_QPAIR_ACTIVE ||
+	    spdk_nvmf_qpair_is_admin_queue(qpair)) {
+		return false;
+	}
+
+	/* Only plain reads and writes use the buffers of the bdev directly */
+	if ((cmd->opc != SPDK_NVME_OPC_READ && cmd->opc != SPDK_NVME_OPC_WRITE) ||
+	    (cmd->fuse & SPDK_NVME_CMD_FUSE_MASK) || req->dif.dif_insert_or_strip) {
+		return false;
+	}
+
+	ns = _spdk_nvmf_subsystem_get_ns(ctrlr->subsys, cmd->nsid);
+	if (ns == NULL || ns->bdev == NULL) {
+		return false;
+	}
+
+	return spdk_nvmf_bdev_ctrlr_zcopy_supported(ns->bdev, cmd, req->length);
+}
+
+void
+spdk_nvmf_request_zcopy_end(struct spdk_nvmf_request *req)
+{
+	struct spdk_bdev_io *bdev_io = req->zcopy_bdev_io;
+	struct spdk_nvmf_qpair *qpair = req->qpair;
+	struct spdk_nvmf_subsystem_poll_group *sgroup;
+
+	req->zcopy = false;
+	req->zcopy_bdev_io = NULL;
+
+	if (bdev_io != NULL) {
+		sgroup = &qpair->group->sgroups[qpair->ctrlr->subsys->id];
+		spdk_nvmf_bdev_ctrlr_zcopy_end(bdev_io, sgroup, req->cmd->nvme_cmd.nsid);
+	}
+}
+
+void
+spdk_nvmf_request_zcopy_commit(struct spdk_nvmf_request *req)
+{
+	assert(req->zcopy_bdev_io != NULL);
+	assert(req->xfer == SPDK_NVME_DATA_HOST_TO_CONTROLLER);
+
+	/* The request is completed a second time once the bdev has the data */
+	TAILQ_INSERT_TAIL(&req->qpair->outstanding, req, link);
+	spdk_nvmf_bdev_ctrlr_zcopy_commit(req);
+}
+
 void
 spdk_nvmf_set_custom_admin_cmd_hdlr(uint8_t opc, spdk_nvmf_custom_cmd_hdlr hdlr)
 {
@@ -121,6 +121,144 @@ nvmf_bdev_ctrlr_complete_cmd(struct spdk_bdev_io *bdev_io, bool success,
 	spdk_bdev_free_io(bdev_io);
 }
 
+static void
+nvmf_bdev_ctrlr_free_io(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	spdk_bdev_free_io(bdev_io);
+}
+
+struct nvmf_bdev_ctrlr_zcopy_end_ctx {
+	struct spdk_nvmf_subsystem_poll_group	*sgroup;
+	uint32_t				nsid;
+};
+
+static void
+nvmf_bdev_ctrlr_zcopy_end_done(struct spdk_bdev_io *bdev_io,
+			       struct spdk_nvmf_subsystem_poll_group *sgroup, uint32_t nsid)
+{
+	struct spdk_nvmf_subsystem_pg_ns_info *ns_info;
+
+	/* ns_info is reallocated when namespaces change, so only index it right before use */
+	assert(nsid != 0 && nsid <= sgroup->num_ns);
+	ns_info = &sgroup->ns_info[nsid - 1];
+
+	spdk_bdev_free_io(bdev_io);
+	spdk_nvmf_subsystem_poll_group_io_done(sgroup, ns_info);
+}
+
+static void
+nvmf_bdev_ctrlr_zcopy_end_complete(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct nvmf_bdev_ctrlr_zcopy_end_ctx *ctx = cb_arg;
+	struct spdk_nvmf_subsystem_poll_group *sgroup = ctx->sgroup;
+	uint32_t nsid = ctx->nsid;
+
+	free(ctx);
+	nvmf_bdev_ctrlr_zcopy_end_done(bdev_io, sgroup, nsid);
+}
+
+void
+spdk_nvmf_bdev_ctrlr_zcopy_end(struct spdk_bdev_io *bdev_io,
+			       struct spdk_nvmf_subsystem_poll_group *sgroup, uint32_t nsid)
+{
+	struct nvmf_bdev_ctrlr_zcopy_end_ctx *ctx;
+	int rc;
+
+	/*
+	 * The request is recycled by the transport as soon as this returns, so the
+	 *  poll group and namespace are carried to the completion separately.
+	 */
+	ctx = calloc(1, sizeof(*ctx));
+	if (spdk_unlikely(ctx == NULL)) {
+		SPDK_ERRLOG("Unable to allocate zero copy end context\n");
+		rc = -ENOMEM;
+	} else {
+		ctx->sgroup = sgroup;
+		ctx->nsid = nsid;
+
+		/* Reads have nothing to commit and writes that get here were abandoned */
+		rc = spdk_bdev_zcopy_end(bdev_io, false, nvmf_bdev_ctrlr_zcopy_end_complete, ctx);
+		if (spdk_likely(rc == 0)) {
+			return;
+		}
+		free(ctx);
+	}
+
+	SPDK_ERRLOG("Unable to release zero copy buffers: %s\n", spdk_strerror(-rc));
+	nvmf_bdev_ctrlr_zcopy_end_done(bdev_io, sgroup, nsid);
+}
+
+static void
+nvmf_bdev_ctrlr_zcopy_start_complete(struct spdk_bdev_io *bdev_io, bool success,
+				     void *cb_arg)
+{
+	struct spdk_nvmf_request	*req = cb_arg;
+	struct spdk_nvme_cpl		*response = &req->rsp->nvme_cpl;
+	struct iovec			*iovs;
+	int				iovcnt, i;
+
+	if (spdk_unlikely(!success)) {
+		nvmf_bdev_ctrlr_complete_cmd(bdev_io, success, req);
+		return;
+	}
+
+	spdk_bdev_io_get_iovec(bdev_io, &iovs, &iovcnt);
+	if (spdk_unlikely(iovcnt > NVMF_REQ_MAX_BUFFERS)) {
+		SPDK_ERRLOG("Zero copy request returned too many buffers (%d)\n", iovcnt);
+		if (spdk_bdev_zcopy_end(bdev_io, false, nvmf_bdev_ctrlr_free_io, NULL) != 0) {
+			spdk_bdev_free_io(bdev_io);
+		}
+		response->status.sct = SPDK_NVME_SCT_GENERIC;
+		response->status.sc = SPDK_NVME_SC_INTERNAL_DEVICE_ERROR;
+		spdk_nvmf_request_complete(req);
+		return;
+	}
+
+	/* The data is transferred straight to or from the buffers of the bdev, which are
+	 *  held until the transport calls spdk_nvmf_request_zcopy_commit() or
+	 *  spdk_nvmf_request_zcopy_end(). */
+	for (i = 0; i < iovcnt; i++) {
+		req->iov[i] = iovs[i];
+	}
+	req->iovcnt = iovcnt;
+	req->data = req->iov[0].iov_base;
+	req->zcopy_bdev_io = bdev_io;
+
+	response->cdw0 = 0;
+	response->status.sct = SPDK_NVME_SCT_GENERIC;
+	response->status.sc = SPDK_NVME_SC_SUCCESS;
+
+	spdk_nvmf_request_complete(req);
+}
+
+static void
+nvmf_bdev_ctrlr_zcopy_commit_complete(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct spdk_nvmf_request *req = cb_arg;
+
+	req->zcopy = false;
+	req->zcopy_bdev_io = NULL;
+
+	nvmf_bdev_ctrlr_complete_cmd(bdev_io, success, req);
+}
+
+void
+spdk_nvmf_bdev_ctrlr_zcopy_commit(struct spdk_nvmf_request *req)
+{
+	struct spdk_nvme_cpl *rsp = &req->rsp->nvme_cpl;
+	int rc;
+
+	rc = spdk_bdev_zcopy_end(req->zcopy_bdev_io, true, nvmf_bdev_ctrlr_zcopy_commit_complete,
+				 req);
+	if (spdk_unlikely(rc != 0)) {
+		/* The buffers are still held and get released along with the request */
+		SPDK_ERRLOG("Unable to commit zero copy buffers: %s\n", spdk_strerror(-rc));
+		rsp->status.sct = SPDK_NVME_SCT_GENERIC;
+		rsp->status.sc = SPDK_NVME_SC_INTERNAL_DEVICE_ERROR;
+		spdk_nvmf_request_complete(req);
+	}
+}
+
 static void
 nvmf_bdev_ctrlr_complete_admin_cmd(struct spdk_bdev_io *bdev_io, bool success,
 				   void *cb_arg)
@@ -148,7 +286,10 @@ spdk_nvmf_bdev_ctrlr_identify_ns(struct spdk_nvmf_ns *ns, struct spdk_nvme_ns_da
 	nsdata->nuse = num_blocks;
 	nsdata->nlbaf = 0;
 	nsdata->flbas.format = 0;
-	nsdata->nacwu = spdk_bdev_get_acwu(bdev);
+	/* The atomicity parameters are per namespace and 0's based */
+	nsdata->nsfeat.ns_atomic_write_unit = 1;
+	nsdata->nawun = spdk_bdev_get_awun(bdev) - 1;
+	nsdata->nacwu = spdk_bdev_get_acwu(bdev) - 1;
 	if (!dif_insert_or_strip) {
 		nsdata->lbaf[0].ms = spdk_bdev_get_md_size(bdev);
 		nsdata->lbaf[0].lbads = spdk_u32log2(spdk_bdev_get_block_size(bdev));
@@ -212,6 +353,23 @@ nvmf_bdev_ctrlr_get_rw_params(const struct spdk_nvme_cmd *cmd, uint64_t *start_l
 	*num_blocks = (from_le32(&cmd->cdw12) & 0xFFFFu) + 1;
 }
 
+bool
+spdk_nvmf_bdev_ctrlr_zcopy_supported(struct spdk_bdev *bdev, struct spdk_nvme_cmd *cmd,
+				     uint32_t length)
+{
+	uint64_t start_lba;
+	uint64_t num_blocks;
+
+	if (!spdk_bdev_io_type_supported(bdev, SPDK_BDEV_IO_TYPE_ZCOPY)) {
+		return false;
+	}
+
+	/* The buffers of the bdev only cover the blocks being accessed */
+	nvmf_bdev_ctrlr_get_rw_params(cmd, &start_lba, &num_blocks);
+
+	return num_blocks * spdk_bdev_get_block_size(bdev) == length;
+}
+
 static bool
 nvmf_bdev_ctrlr_lba_in_range(uint64_t bdev_num_blocks, uint64_t io_start_lba,
 			     uint64_t io_num_blocks)
@@ -286,8 +444,13 @@ spdk_nvmf_bdev_ctrlr_read_cmd(struct spdk_bdev *bdev, struct spdk_bdev_desc *des
 		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
 	}
 
-	rc = spdk_bdev_readv_blocks(desc, ch, req->iov, req->iovcnt, start_lba, num_blocks,
-				    nvmf_bdev_ctrlr_complete_cmd, req);
+	if (req->zcopy) {
+		rc = spdk_bdev_zcopy_start(desc, ch, start_lba, num_blocks, true,
+					   nvmf_bdev_ctrlr_zcopy_start_complete, req);
+	} else {
+		rc = spdk_bdev_readv_blocks(desc, ch, req->iov, req->iovcnt, start_lba, num_blocks,
+					    nvmf_bdev_ctrlr_complete_cmd, req);
+	}
 	if (spdk_unlikely(rc)) {
 		if (rc == -ENOMEM) {
 			nvmf_bdev_ctrl_queue_io(req, bdev, ch, spdk_nvmf_ctrlr_process_io_cmd_resubmit, req);
@@ -330,8 +493,13 @@ spdk_nvmf_bdev_ctrlr_write_cmd(struct spdk_bdev *bdev, struct spdk_bdev_desc *de
 		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
 	}
 
-	rc = spdk_bdev_writev_blocks(desc, ch, req->iov, req->iovcnt, start_lba, num_blocks,
-				     nvmf_bdev_ctrlr_complete_cmd, req);
+	if (req->zcopy) {
+		rc = spdk_bdev_zcopy_start(desc, ch, start_lba, num_blocks, false,
+					   nvmf_bdev_ctrlr_zcopy_start_complete, req);
+	} else {
+		rc = spdk_bdev_writev_blocks(desc, ch, req->iov, req->iovcnt, start_lba, num_blocks,
+					     nvmf_bdev_ctrlr_complete_cmd, req);
+	}
 	if (spdk_unlikely(rc)) {
 		if (rc == -ENOMEM) {
 			nvmf_bdev_ctrl_queue_io(req, bdev, ch, spdk_nvmf_ctrlr_process_io_cmd_resubmit, req);
@@ -420,6 +588,14 @@ spdk_nvmf_bdev_ctrlr_compare_and_write_cmd(struct spdk_bdev *bdev, struct spdk_b
 		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
 	}
 
+	if (spdk_unlikely(write_num_blocks > spdk_bdev_get_acwu(bdev))) {
+		SPDK_ERRLOG("Fused command NLB %" PRIu64 " > ACWU %" PRIu16 "\n",
+			    write_num_blocks, spdk_bdev_get_acwu(bdev));
+		rsp->status.sct = SPDK_NVME_SCT_GENERIC;
+		rsp->status.sc = SPDK_NVME_SC_INVALID_FIELD;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
 	if (spdk_unlikely(write_num_blocks * block_size > write_req->length)) {
 		SPDK_ERRLOG("Write NLB %" PRIu64 " * block size %" PRIu32 " > SGL length %" PRIu32 "\n",
 			    write_num_blocks, block_size, write_req->length);
@@ -3015,7 +3015,7 @@ nvmf_fc_adm_add_rem_nport_listener(struct spdk_nvmf_fc_nport *nport, bool add)
 				spdk_nvmf_fc_create_trid(&ctx->trid,
 							 nport->fc_nodename.u.wwn,
 							 nport->fc_portname.u.wwn);
-				if (spdk_nvmf_subsystem_pause(subsystem,
+				if (spdk_nvmf_subsystem_pause(subsystem, SPDK_NVME_GLOBAL_NS_TAG,
 							      nvmf_fc_adm_subsystem_paused_cb,
 							      ctx)) {
 					SPDK_ERRLOG("Failed to pause subsystem: %s\n",
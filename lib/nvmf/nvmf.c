@@ -64,6 +64,8 @@ struct nvmf_qpair_disconnect_ctx {
 	struct spdk_thread *thread;
 	void *ctx;
 	uint16_t qid;
+	/* Statistics of the destroyed qpair, to be kept by its controller */
+	struct spdk_nvmf_io_stat io_stat;
 };
 
 /*
@@ -361,6 +363,28 @@ spdk_nvmf_get_next_tgt(struct spdk_nvmf_tgt *prev)
 	return TAILQ_NEXT(prev, link);
 }
 
+static void
+spdk_nvmf_write_listen_address_json(struct spdk_json_write_ctx *w,
+				    const struct spdk_nvme_transport_id *trid)
+{
+	const char *adrfam;
+
+	adrfam = spdk_nvme_transport_id_adrfam_str(trid->adrfam);
+
+	/*     "listen_address" : { */
+	spdk_json_write_named_object_begin(w, "listen_address");
+
+	spdk_json_write_named_string(w, "trtype", trid->trstring);
+	if (adrfam) {
+		spdk_json_write_named_string(w, "adrfam", adrfam);
+	}
+
+	spdk_json_write_named_string(w, "traddr", trid->traddr);
+	spdk_json_write_named_string(w, "trsvcid", trid->trsvcid);
+	/*     } "listen_address" */
+	spdk_json_write_object_end(w);
+}
+
 static void
 spdk_nvmf_write_subsystem_config_json(struct spdk_json_write_ctx *w,
 				      struct spdk_nvmf_subsystem *subsystem)
@@ -370,9 +394,9 @@ spdk_nvmf_write_subsystem_config_json(struct spdk_json_write_ctx *w,
 	const struct spdk_nvme_transport_id *trid;
 	struct spdk_nvmf_ns *ns;
 	struct spdk_nvmf_ns_opts ns_opts;
-	uint32_t max_namespaces;
+	enum spdk_nvme_ana_state ana_state;
+	uint32_t max_namespaces, anagrpid;
 	char uuid_str[SPDK_UUID_STRING_LEN];
-	const char *adrfam;
 
 	if (spdk_nvmf_subsystem_get_type(subsystem) != SPDK_NVMF_SUBTYPE_NVME) {
 		return;
@@ -394,6 +418,10 @@ spdk_nvmf_write_subsystem_config_json(struct spdk_json_write_ctx *w,
 		spdk_json_write_named_uint32(w, "max_namespaces", max_namespaces);
 	}
 
+	if (spdk_nvmf_subsystem_get_ana_reporting(subsystem)) {
+		spdk_json_write_named_bool(w, "ana_reporting", true);
+	}
+
 	/*     } "params" */
 	spdk_json_write_object_end(w);
 
@@ -404,8 +432,6 @@ spdk_nvmf_write_subsystem_config_json(struct spdk_json_write_ctx *w,
 	     listener = spdk_nvmf_subsystem_get_next_listener(subsystem, listener)) {
 		trid = spdk_nvmf_listener_get_trid(listener);
 
-		adrfam = spdk_nvme_transport_id_adrfam_str(trid->adrfam);
-
 		spdk_json_write_object_begin(w);
 		spdk_json_write_named_string(w, "method", "nvmf_subsystem_add_listener");
 
@@ -414,18 +440,7 @@ spdk_nvmf_write_subsystem_config_json(struct spdk_json_write_ctx *w,
 
 		spdk_json_write_named_string(w, "nqn", spdk_nvmf_subsystem_get_nqn(subsystem));
 
-		/*     "listen_address" : { */
-		spdk_json_write_named_object_begin(w, "listen_address");
-
-		spdk_json_write_named_string(w, "trtype", trid->trstring);
-		if (adrfam) {
-			spdk_json_write_named_string(w, "adrfam", adrfam);
-		}
-
-		spdk_json_write_named_string(w, "traddr", trid->traddr);
-		spdk_json_write_named_string(w, "trsvcid", trid->trsvcid);
-		/*     } "listen_address" */
-		spdk_json_write_object_end(w);
+		spdk_nvmf_write_listen_address_json(w, trid);
 
 		/*     } "params" */
 		spdk_json_write_object_end(w);
@@ -487,6 +502,10 @@ spdk_nvmf_write_subsystem_config_json(struct spdk_json_write_ctx *w,
 			spdk_json_write_named_string(w, "uuid",  uuid_str);
 		}
 
+		if (ns_opts.anagrpid != spdk_nvmf_ns_get_id(ns)) {
+			spdk_json_write_named_uint32(w, "anagrpid", ns_opts.anagrpid);
+		}
+
 		/*     "namespace" */
 		spdk_json_write_object_end(w);
 
@@ -496,6 +515,39 @@ spdk_nvmf_write_subsystem_config_json(struct spdk_json_write_ctx *w,
 		/* } */
 		spdk_json_write_object_end(w);
 	}
+
+	if (!spdk_nvmf_subsystem_get_ana_reporting(subsystem)) {
+		return;
+	}
+
+	/* ANA states are restored once all namespaces, and so all ANA groups, exist */
+	for (listener = spdk_nvmf_subsystem_get_first_listener(subsystem); listener != NULL;
+	     listener = spdk_nvmf_subsystem_get_next_listener(subsystem, listener)) {
+		for (anagrpid = 1; anagrpid <= spdk_nvmf_subsystem_get_max_nsid(subsystem); anagrpid++) {
+			ana_state = spdk_nvmf_listener_get_ana_state(listener, anagrpid);
+			if (ana_state == SPDK_NVME_ANA_OPTIMIZED_STATE ||
+			    !spdk_nvmf_subsystem_ana_group_in_use(subsystem, anagrpid)) {
+				continue;
+			}
+
+			spdk_json_write_object_begin(w);
+			spdk_json_write_named_string(w, "method", "nvmf_subsystem_listener_set_ana_state");
+
+			/*     "params" : { */
+			spdk_json_write_named_object_begin(w, "params");
+
+			spdk_json_write_named_string(w, "nqn", spdk_nvmf_subsystem_get_nqn(subsystem));
+			spdk_nvmf_write_listen_address_json(w, spdk_nvmf_listener_get_trid(listener));
+			spdk_json_write_named_string(w, "ana_state", spdk_nvmf_ana_state_str(ana_state));
+			spdk_json_write_named_uint32(w, "anagrpid", anagrpid);
+
+			/*     } "params" */
+			spdk_json_write_object_end(w);
+
+			/* } */
+			spdk_json_write_object_end(w);
+		}
+	}
 }
 
 void
@@ -745,6 +797,7 @@ spdk_nvmf_poll_group_add(struct spdk_nvmf_poll_group *group,
 
 	TAILQ_INIT(&qpair->outstanding);
 	qpair->group = group;
+	memset(&qpair->io_stat, 0, sizeof(qpair->io_stat));
 
 	TAILQ_FOREACH(tgroup, &group->tgroups, link) {
 		if (tgroup->transport == qpair->transport) {
@@ -756,6 +809,7 @@ spdk_nvmf_poll_group_add(struct spdk_nvmf_poll_group *group,
 	/* We add the qpair to the group only it is succesfully added into the tgroup */
 	if (rc == 0) {
 		TAILQ_INSERT_TAIL(&group->qpairs, qpair, link);
+		group->stat.current_qpairs++;
 		spdk_nvmf_qpair_set_state(qpair, SPDK_NVMF_QPAIR_ACTIVE);
 	}
 
@@ -777,6 +831,8 @@ _spdk_nvmf_ctrlr_free_from_qpair(void *ctx)
 	struct spdk_nvmf_ctrlr *ctrlr = qpair_ctx->ctrlr;
 	uint32_t count;
 
+	spdk_nvmf_io_stat_merge(&ctrlr->io_stat, &qpair_ctx->io_stat);
+
 	spdk_bit_array_clear(ctrlr->qpair_mask, qpair_ctx->qid);
 	count = spdk_bit_array_count_set(ctrlr->qpair_mask);
 	if (count == 0) {
@@ -831,7 +887,10 @@ _spdk_nvmf_qpair_destroy(void *ctx, int status)
 	}
 
 	TAILQ_REMOVE(&qpair->group->qpairs, qpair, link);
+	assert(qpair->group->stat.current_qpairs > 0);
+	qpair->group->stat.current_qpairs--;
 
+	qpair_ctx->io_stat = qpair->io_stat;
 	spdk_nvmf_transport_qpair_fini(qpair);
 
 	if (!ctrlr || !ctrlr->thread) {
@@ -1095,6 +1154,8 @@ poll_group_update_subsystem(struct spdk_nvmf_poll_group *group,
 				ns_info->reg_hostid[j++] = reg->hostid;
 			}
 		}
+
+		ns_info->sgroup = sgroup;
 	}
 
 	if (ns_changed) {
@@ -1115,6 +1176,16 @@ spdk_nvmf_poll_group_update_subsystem(struct spdk_nvmf_poll_group *group,
 	return poll_group_update_subsystem(group, subsystem);
 }
 
+static void
+poll_group_activate_ns(struct spdk_nvmf_subsystem_poll_group *sgroup)
+{
+	uint32_t i;
+
+	for (i = 0; i < sgroup->num_ns; i++) {
+		sgroup->ns_info[i].state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
+	}
+}
+
 int
 spdk_nvmf_poll_group_add_subsystem(struct spdk_nvmf_poll_group *group,
 				   struct spdk_nvmf_subsystem *subsystem,
@@ -1131,6 +1202,7 @@ spdk_nvmf_poll_group_add_subsystem(struct spdk_nvmf_poll_group *group,
 		goto fini;
 	}
 
+	poll_group_activate_ns(sgroup);
 	sgroup->state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
 fini:
 	if (cb_fn) {
@@ -1258,10 +1330,11 @@ fini:
 
 void
 spdk_nvmf_poll_group_pause_subsystem(struct spdk_nvmf_poll_group *group,
-				     struct spdk_nvmf_subsystem *subsystem,
+				     struct spdk_nvmf_subsystem *subsystem, uint32_t nsid,
 				     spdk_nvmf_poll_group_mod_done cb_fn, void *cb_arg)
 {
 	struct spdk_nvmf_subsystem_poll_group *sgroup;
+	uint32_t i;
 	int rc = 0;
 
 	if (subsystem->id >= group->num_sgroups) {
@@ -1278,14 +1351,20 @@ spdk_nvmf_poll_group_pause_subsystem(struct spdk_nvmf_poll_group *group,
 	assert(sgroup->state == SPDK_NVMF_SUBSYSTEM_ACTIVE);
 	sgroup->state = SPDK_NVMF_SUBSYSTEM_PAUSING;
 
-	if (sgroup->io_outstanding > 0) {
-		sgroup->cb_fn = cb_fn;
-		sgroup->cb_arg = cb_arg;
-		return;
+	/*
+	 * Admin commands are always held back. I/O is only held back for the namespaces
+	 * being paused, so the other namespaces of the subsystem keep serving I/O.
+	 */
+	for (i = 0; i < sgroup->num_ns; i++) {
+		if (nsid == SPDK_NVME_GLOBAL_NS_TAG || nsid == i + 1) {
+			sgroup->ns_info[i].state = SPDK_NVMF_SUBSYSTEM_PAUSING;
+		}
 	}
 
-	assert(sgroup->io_outstanding == 0);
-	sgroup->state = SPDK_NVMF_SUBSYSTEM_PAUSED;
+	sgroup->cb_fn = cb_fn;
+	sgroup->cb_arg = cb_arg;
+	spdk_nvmf_subsystem_poll_group_check_paused(sgroup);
+	return;
 fini:
 	if (cb_fn) {
 		cb_fn(cb_arg, rc);
@@ -1315,6 +1394,7 @@ spdk_nvmf_poll_group_resume_subsystem(struct spdk_nvmf_poll_group *group,
 		goto fini;
 	}
 
+	poll_group_activate_ns(sgroup);
 	sgroup->state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
 
 	/* Release all queued requests */
@@ -1360,3 +1440,9 @@ spdk_nvmf_poll_group_get_stat(struct spdk_nvmf_tgt *tgt,
 	spdk_put_io_channel(ch);
 	return 0;
 }
+
+uint32_t
+spdk_nvmf_poll_group_get_num_qpairs(struct spdk_nvmf_poll_group *group)
+{
+	return group->stat.current_qpairs;
+}
@@ -41,6 +41,7 @@
 #include "spdk/nvmf_spec.h"
 #include "spdk/assert.h"
 #include "spdk/bdev.h"
+#include "spdk/histogram_data.h"
 #include "spdk/queue.h"
 #include "spdk/util.h"
 #include "spdk/thread.h"
@@ -104,6 +105,10 @@ struct spdk_nvmf_host {
 struct spdk_nvmf_listener {
 	struct spdk_nvme_transport_id	trid;
 	struct spdk_nvmf_transport	*transport;
+	/* ANA state of each ANA group, indexed by ANA group ID - 1 */
+	enum spdk_nvme_ana_state	*ana_state;
+	uint32_t			num_ana_groups;
+	uint64_t			ana_state_change_count;
 	TAILQ_ENTRY(spdk_nvmf_listener)	link;
 };
 
@@ -122,6 +127,28 @@ struct spdk_nvmf_transport_poll_group {
 	TAILQ_ENTRY(spdk_nvmf_transport_poll_group)			link;
 };
 
+/*
+ * The latency histogram of the I/O statistics has a single bucket per power of two
+ * ticks. That is coarse, but small enough to be kept for every namespace and queue pair.
+ */
+#define NVMF_IO_STAT_HISTOGRAM_BUCKET_SHIFT	0
+#define NVMF_IO_STAT_HISTOGRAM_NUM_BUCKETS	((1ULL << NVMF_IO_STAT_HISTOGRAM_BUCKET_SHIFT) * \
+						 (64 - NVMF_IO_STAT_HISTOGRAM_BUCKET_SHIFT + 1))
+
+/*
+ * Read and write statistics. They are only updated by the thread of the poll group
+ * they belong to, so collecting them doesn't need any locking.
+ */
+struct spdk_nvmf_io_stat {
+	uint64_t	bytes_read;
+	uint64_t	num_read_ops;
+	uint64_t	bytes_written;
+	uint64_t	num_write_ops;
+	uint64_t	read_latency_ticks;
+	uint64_t	write_latency_ticks;
+	uint64_t	latency_buckets[NVMF_IO_STAT_HISTOGRAM_NUM_BUCKETS];
+};
+
 /* Maximum number of registrants supported per namespace */
 #define SPDK_NVMF_MAX_NUM_REGISTRANTS		16
 
@@ -152,6 +179,15 @@ struct spdk_nvmf_subsystem_pg_ns_info {
 	/* Host ID for the registrants with the namespace */
 	struct spdk_uuid		reg_hostid[SPDK_NVMF_MAX_NUM_REGISTRANTS];
 	uint64_t			num_blocks;
+
+	/* I/O requests outstanding to this namespace on this poll group */
+	uint64_t			io_outstanding;
+	/* I/O to this namespace is queued unless the state is active */
+	enum spdk_nvmf_subsystem_state	state;
+	struct spdk_nvmf_subsystem_poll_group	*sgroup;
+
+	/* Statistics of the I/O to this namespace on this poll group */
+	struct spdk_nvmf_io_stat	io_stat;
 };
 
 typedef void(*spdk_nvmf_poll_group_mod_done)(void *cb_arg, int status);
@@ -161,7 +197,11 @@ struct spdk_nvmf_subsystem_poll_group {
 	struct spdk_nvmf_subsystem_pg_ns_info	*ns_info;
 	uint32_t				num_ns;
 
-	uint64_t				io_outstanding;
+	/*
+	 * Admin and fabrics requests, and I/O requests to namespaces that are not
+	 * attached to this poll group, outstanding on this poll group.
+	 */
+	uint64_t				mgmt_io_outstanding;
 	spdk_nvmf_poll_group_mod_done		cb_fn;
 	void					*cb_arg;
 
@@ -221,10 +261,15 @@ struct spdk_nvmf_request {
 	struct iovec			iov[NVMF_REQ_MAX_BUFFERS];
 	uint32_t			iovcnt;
 	bool				data_from_pool;
+	/* Data buffers are provided by the bdev through zcopy */
+	bool				zcopy;
+	struct spdk_bdev_io		*zcopy_bdev_io;
 	struct spdk_bdev_io_wait_entry	bdev_io_wait;
 	struct spdk_nvmf_dif_info	dif;
 	spdk_nvmf_nvme_passthru_cmd_cb	cmd_cb_fn;
 	struct spdk_nvmf_request	*first_fused_req;
+	/* Tick count when the request started executing */
+	uint64_t			exec_tsc;
 
 	STAILQ_ENTRY(spdk_nvmf_request)	buf_link;
 	TAILQ_ENTRY(spdk_nvmf_request)	link;
@@ -259,6 +304,8 @@ struct spdk_nvmf_ns {
 	char *ptpl_file;
 	/* Persist Through Power Loss feature is enabled */
 	bool ptpl_activated;
+	/* Append log the persistent reservation is written to, created on first update */
+	struct spdk_nvmf_ns_ptpl_log *ptpl_log;
 };
 
 struct spdk_nvmf_qpair {
@@ -276,6 +323,9 @@ struct spdk_nvmf_qpair {
 
 	struct spdk_nvmf_request		*first_fused_req;
 
+	/* Statistics of the I/O submitted through this qpair */
+	struct spdk_nvmf_io_stat		io_stat;
+
 	TAILQ_HEAD(, spdk_nvmf_request)		outstanding;
 	TAILQ_ENTRY(spdk_nvmf_qpair)		link;
 };
@@ -318,6 +368,9 @@ struct spdk_nvmf_ctrlr {
 
 	struct spdk_nvmf_ctrlr_feat feat;
 
+	/* Listener the admin queue connected through, NULL if not in the subsystem's list */
+	struct spdk_nvmf_listener	*listener;
+
 	struct spdk_nvmf_qpair	*admin_qpair;
 	struct spdk_thread	*thread;
 	struct spdk_bit_array	*qpair_mask;
@@ -339,6 +392,9 @@ struct spdk_nvmf_ctrlr {
 
 	bool				dif_insert_or_strip;
 
+	/* Statistics of the I/O qpairs already destroyed, only accessed on the ctrlr thread */
+	struct spdk_nvmf_io_stat	io_stat;
+
 	TAILQ_ENTRY(spdk_nvmf_ctrlr)	link;
 };
 
@@ -352,6 +408,7 @@ struct spdk_nvmf_subsystem {
 	uint16_t next_cntlid;
 	bool allow_any_host;
 	bool allow_any_listener ;
+	bool ana_reporting;
 
 	struct spdk_nvmf_tgt			*tgt;
 
@@ -383,9 +440,13 @@ int spdk_nvmf_poll_group_add_subsystem(struct spdk_nvmf_poll_group *group,
 void spdk_nvmf_poll_group_remove_subsystem(struct spdk_nvmf_poll_group *group,
 		struct spdk_nvmf_subsystem *subsystem, spdk_nvmf_poll_group_mod_done cb_fn, void *cb_arg);
 void spdk_nvmf_poll_group_pause_subsystem(struct spdk_nvmf_poll_group *group,
-		struct spdk_nvmf_subsystem *subsystem, spdk_nvmf_poll_group_mod_done cb_fn, void *cb_arg);
+		struct spdk_nvmf_subsystem *subsystem, uint32_t nsid,
+		spdk_nvmf_poll_group_mod_done cb_fn, void *cb_arg);
 void spdk_nvmf_poll_group_resume_subsystem(struct spdk_nvmf_poll_group *group,
 		struct spdk_nvmf_subsystem *subsystem, spdk_nvmf_poll_group_mod_done cb_fn, void *cb_arg);
+void spdk_nvmf_subsystem_poll_group_io_done(struct spdk_nvmf_subsystem_poll_group *sgroup,
+		struct spdk_nvmf_subsystem_pg_ns_info *ns_info);
+void spdk_nvmf_subsystem_poll_group_check_paused(struct spdk_nvmf_subsystem_poll_group *sgroup);
 void spdk_nvmf_request_exec(struct spdk_nvmf_request *req);
 void spdk_nvmf_request_exec_fabrics(struct spdk_nvmf_request *req);
 int spdk_nvmf_request_free(struct spdk_nvmf_request *req);
@@ -405,6 +466,10 @@ int spdk_nvmf_request_get_buffers_multi(struct spdk_nvmf_request *req,
 
 bool spdk_nvmf_request_get_dif_ctx(struct spdk_nvmf_request *req, struct spdk_dif_ctx *dif_ctx);
 
+bool spdk_nvmf_request_use_zcopy(struct spdk_nvmf_request *req);
+void spdk_nvmf_request_zcopy_end(struct spdk_nvmf_request *req);
+void spdk_nvmf_request_zcopy_commit(struct spdk_nvmf_request *req);
+
 void spdk_nvmf_get_discovery_log_page(struct spdk_nvmf_tgt *tgt, const char *hostnqn,
 				      struct iovec *iov,
 				      uint32_t iovcnt, uint64_t offset, uint32_t length);
@@ -438,6 +503,11 @@ int spdk_nvmf_bdev_ctrlr_nvme_passthru_io(struct spdk_bdev *bdev, struct spdk_bd
 		struct spdk_io_channel *ch, struct spdk_nvmf_request *req);
 bool spdk_nvmf_bdev_ctrlr_get_dif_ctx(struct spdk_bdev *bdev, struct spdk_nvme_cmd *cmd,
 				      struct spdk_dif_ctx *dif_ctx);
+bool spdk_nvmf_bdev_ctrlr_zcopy_supported(struct spdk_bdev *bdev, struct spdk_nvme_cmd *cmd,
+		uint32_t length);
+void spdk_nvmf_bdev_ctrlr_zcopy_end(struct spdk_bdev_io *bdev_io,
+				    struct spdk_nvmf_subsystem_poll_group *sgroup, uint32_t nsid);
+void spdk_nvmf_bdev_ctrlr_zcopy_commit(struct spdk_nvmf_request *req);
 
 int spdk_nvmf_subsystem_add_ctrlr(struct spdk_nvmf_subsystem *subsystem,
 				  struct spdk_nvmf_ctrlr *ctrlr);
@@ -447,10 +517,14 @@ void spdk_nvmf_subsystem_remove_all_listeners(struct spdk_nvmf_subsystem *subsys
 		bool stop);
 struct spdk_nvmf_ctrlr *spdk_nvmf_subsystem_get_ctrlr(struct spdk_nvmf_subsystem *subsystem,
 		uint16_t cntlid);
+const char *spdk_nvmf_ana_state_str(enum spdk_nvme_ana_state ana_state);
+bool spdk_nvmf_subsystem_ana_group_in_use(struct spdk_nvmf_subsystem *subsystem,
+		uint32_t anagrpid);
 struct spdk_nvmf_listener *spdk_nvmf_subsystem_find_listener(struct spdk_nvmf_subsystem *subsystem,
 		const struct spdk_nvme_transport_id *trid);
 
 int spdk_nvmf_ctrlr_async_event_ns_notice(struct spdk_nvmf_ctrlr *ctrlr);
+int spdk_nvmf_ctrlr_async_event_ana_change_notice(struct spdk_nvmf_ctrlr *ctrlr);
 void spdk_nvmf_ctrlr_async_event_reservation_notification(struct spdk_nvmf_ctrlr *ctrlr);
 void spdk_nvmf_ns_reservation_request(void *ctx);
 void spdk_nvmf_ctrlr_reservation_notice_log(struct spdk_nvmf_ctrlr *ctrlr,
@@ -533,4 +607,21 @@ spdk_nvmf_qpair_is_admin_queue(struct spdk_nvmf_qpair *qpair)
 	return qpair->qid == 0;
 }
 
+static inline void
+spdk_nvmf_io_stat_merge(struct spdk_nvmf_io_stat *dst, const struct spdk_nvmf_io_stat *src)
+{
+	uint64_t i;
+
+	dst->bytes_read += src->bytes_read;
+	dst->num_read_ops += src->num_read_ops;
+	dst->bytes_written += src->bytes_written;
+	dst->num_write_ops += src->num_write_ops;
+	dst->read_latency_ticks += src->read_latency_ticks;
+	dst->write_latency_ticks += src->write_latency_ticks;
+
+	for (i = 0; i < NVMF_IO_STAT_HISTOGRAM_NUM_BUCKETS; i++) {
+		dst->latency_buckets[i] += src->latency_buckets[i];
+	}
+}
+
 #endif /* __NVMF_INTERNAL_H__ */
@@ -228,6 +228,24 @@ dump_nvmf_subsystem(struct spdk_json_write_ctx *w, struct spdk_nvmf_subsystem *s
 		spdk_json_write_named_string(w, "adrfam", adrfam);
 		spdk_json_write_named_string(w, "traddr", trid->traddr);
 		spdk_json_write_named_string(w, "trsvcid", trid->trsvcid);
+
+		if (spdk_nvmf_subsystem_get_ana_reporting(subsystem)) {
+			uint32_t anagrpid;
+
+			spdk_json_write_named_array_begin(w, "ana_states");
+			for (anagrpid = 1; anagrpid <= spdk_nvmf_subsystem_get_max_nsid(subsystem); anagrpid++) {
+				if (!spdk_nvmf_subsystem_ana_group_in_use(subsystem, anagrpid)) {
+					continue;
+				}
+
+				spdk_json_write_object_begin(w);
+				spdk_json_write_named_uint32(w, "anagrpid", anagrpid);
+				spdk_json_write_named_string(w, "ana_state",
+							     spdk_nvmf_ana_state_str(spdk_nvmf_listener_get_ana_state(listener, anagrpid)));
+				spdk_json_write_object_end(w);
+			}
+			spdk_json_write_array_end(w);
+		}
 		spdk_json_write_object_end(w);
 	}
 	spdk_json_write_array_end(w);
@@ -235,6 +253,11 @@ dump_nvmf_subsystem(struct spdk_json_write_ctx *w, struct spdk_nvmf_subsystem *s
 	spdk_json_write_named_bool(w, "allow_any_host",
 				   spdk_nvmf_subsystem_get_allow_any_host(subsystem));
 
+	if (spdk_nvmf_subsystem_get_type(subsystem) == SPDK_NVMF_SUBTYPE_NVME) {
+		spdk_json_write_named_bool(w, "ana_reporting",
+					   spdk_nvmf_subsystem_get_ana_reporting(subsystem));
+	}
+
 	spdk_json_write_named_array_begin(w, "hosts");
 
 	for (host = spdk_nvmf_subsystem_get_first_host(subsystem); host != NULL;
@@ -288,6 +311,10 @@ dump_nvmf_subsystem(struct spdk_json_write_ctx *w, struct spdk_nvmf_subsystem *s
 				spdk_json_write_named_string(w, "uuid", uuid_str);
 			}
 
+			if (spdk_nvmf_subsystem_get_ana_reporting(subsystem)) {
+				spdk_json_write_named_uint32(w, "anagrpid", ns_opts.anagrpid);
+			}
+
 			spdk_json_write_object_end(w);
 		}
 		spdk_json_write_array_end(w);
@@ -343,6 +370,7 @@ struct rpc_subsystem_create {
 	char *tgt_name;
 	uint32_t max_namespaces;
 	bool allow_any_host;
+	bool ana_reporting;
 };
 
 static const struct spdk_json_object_decoder rpc_subsystem_create_decoders[] = {
@@ -352,6 +380,7 @@ static const struct spdk_json_object_decoder rpc_subsystem_create_decoders[] = {
 	{"tgt_name", offsetof(struct rpc_subsystem_create, tgt_name), spdk_json_decode_string, true},
 	{"max_namespaces", offsetof(struct rpc_subsystem_create, max_namespaces), spdk_json_decode_uint32, true},
 	{"allow_any_host", offsetof(struct rpc_subsystem_create, allow_any_host), spdk_json_decode_bool, true},
+	{"ana_reporting", offsetof(struct rpc_subsystem_create, ana_reporting), spdk_json_decode_bool, true},
 };
 
 static void
@@ -415,6 +444,11 @@ spdk_rpc_nvmf_create_subsystem(struct spdk_jsonrpc_request *request,
 
 	spdk_nvmf_subsystem_set_allow_any_host(subsystem, req->allow_any_host);
 
+	if (spdk_nvmf_subsystem_set_ana_reporting(subsystem, req->ana_reporting)) {
+		SPDK_ERRLOG("Subsystem %s: unable to set ANA reporting\n", req->nqn);
+		goto invalid;
+	}
+
 	free(req->nqn);
 	free(req->tgt_name);
 	free(req->serial_number);
@@ -782,7 +816,8 @@ spdk_rpc_nvmf_subsystem_add_listener(struct spdk_jsonrpc_request *request,
 
 	ctx->op = NVMF_RPC_LISTEN_ADD;
 
-	if (spdk_nvmf_subsystem_pause(subsystem, nvmf_rpc_listen_paused, ctx)) {
+	if (spdk_nvmf_subsystem_pause(subsystem, SPDK_NVME_GLOBAL_NS_TAG,
+				      nvmf_rpc_listen_paused, ctx)) {
 		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR, "Internal error");
 		nvmf_rpc_listener_ctx_free(ctx);
 		return;
@@ -845,7 +880,8 @@ spdk_rpc_nvmf_subsystem_remove_listener(struct spdk_jsonrpc_request *request,
 
 	ctx->op = NVMF_RPC_LISTEN_REMOVE;
 
-	if (spdk_nvmf_subsystem_pause(subsystem, nvmf_rpc_listen_paused, ctx)) {
+	if (spdk_nvmf_subsystem_pause(subsystem, SPDK_NVME_GLOBAL_NS_TAG,
+				      nvmf_rpc_listen_paused, ctx)) {
 		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR, "Internal error");
 		nvmf_rpc_listener_ctx_free(ctx);
 		return;
@@ -855,6 +891,128 @@ spdk_rpc_nvmf_subsystem_remove_listener(struct spdk_jsonrpc_request *request,
 SPDK_RPC_REGISTER("nvmf_subsystem_remove_listener", spdk_rpc_nvmf_subsystem_remove_listener,
 		  SPDK_RPC_RUNTIME);
 
+struct nvmf_rpc_ana_state_ctx {
+	char				*nqn;
+	char				*tgt_name;
+	struct rpc_listen_address	address;
+	enum spdk_nvme_ana_state	ana_state;
+	uint32_t			anagrpid;
+
+	struct spdk_jsonrpc_request	*request;
+};
+
+static int
+decode_rpc_ana_state(const struct spdk_json_val *val, void *out)
+{
+	enum spdk_nvme_ana_state *ana_state = out;
+
+	if (spdk_json_strequal(val, "optimized") == true) {
+		*ana_state = SPDK_NVME_ANA_OPTIMIZED_STATE;
+	} else if (spdk_json_strequal(val, "non_optimized") == true) {
+		*ana_state = SPDK_NVME_ANA_NON_OPTIMIZED_STATE;
+	} else if (spdk_json_strequal(val, "inaccessible") == true) {
+		*ana_state = SPDK_NVME_ANA_INACCESSIBLE_STATE;
+	} else {
+		SPDK_ERRLOG("Invalid ANA state\n");
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static const struct spdk_json_object_decoder nvmf_rpc_ana_state_decoder[] = {
+	{"nqn", offsetof(struct nvmf_rpc_ana_state_ctx, nqn), spdk_json_decode_string},
+	{"listen_address", offsetof(struct nvmf_rpc_ana_state_ctx, address), decode_rpc_listen_address},
+	{"ana_state", offsetof(struct nvmf_rpc_ana_state_ctx, ana_state), decode_rpc_ana_state},
+	{"anagrpid", offsetof(struct nvmf_rpc_ana_state_ctx, anagrpid), spdk_json_decode_uint32, true},
+	{"tgt_name", offsetof(struct nvmf_rpc_ana_state_ctx, tgt_name), spdk_json_decode_string, true},
+};
+
+static void
+nvmf_rpc_ana_state_ctx_free(struct nvmf_rpc_ana_state_ctx *ctx)
+{
+	free(ctx->nqn);
+	free(ctx->tgt_name);
+	free_rpc_listen_address(&ctx->address);
+	free(ctx);
+}
+
+static void
+nvmf_rpc_ana_state_done(void *cb_arg, int status)
+{
+	struct nvmf_rpc_ana_state_ctx *ctx = cb_arg;
+	struct spdk_jsonrpc_request *request = ctx->request;
+	struct spdk_json_write_ctx *w;
+
+	nvmf_rpc_ana_state_ctx_free(ctx);
+
+	if (status != 0) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+						 "Invalid parameters");
+		return;
+	}
+
+	w = spdk_jsonrpc_begin_result(request);
+	spdk_json_write_bool(w, true);
+	spdk_jsonrpc_end_result(request, w);
+}
+
+static void
+spdk_rpc_nvmf_subsystem_listener_set_ana_state(struct spdk_jsonrpc_request *request,
+		const struct spdk_json_val *params)
+{
+	struct nvmf_rpc_ana_state_ctx *ctx;
+	struct spdk_nvmf_subsystem *subsystem;
+	struct spdk_nvmf_tgt *tgt;
+	struct spdk_nvme_transport_id trid;
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (!ctx) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR, "Out of memory");
+		return;
+	}
+
+	ctx->request = request;
+
+	if (spdk_json_decode_object(params, nvmf_rpc_ana_state_decoder,
+				    SPDK_COUNTOF(nvmf_rpc_ana_state_decoder),
+				    ctx)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS, "Invalid parameters");
+		nvmf_rpc_ana_state_ctx_free(ctx);
+		return;
+	}
+
+	tgt = spdk_nvmf_get_tgt(ctx->tgt_name);
+	if (!tgt) {
+		SPDK_ERRLOG("Unable to find a target object.\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "Unable to find a target.");
+		nvmf_rpc_ana_state_ctx_free(ctx);
+		return;
+	}
+
+	subsystem = spdk_nvmf_tgt_find_subsystem(tgt, ctx->nqn);
+	if (!subsystem) {
+		SPDK_ERRLOG("Unable to find subsystem with NQN %s\n", ctx->nqn);
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS, "Invalid parameters");
+		nvmf_rpc_ana_state_ctx_free(ctx);
+		return;
+	}
+
+	if (rpc_listen_address_to_trid(&ctx->address, &trid)) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+						 "Invalid parameters");
+		nvmf_rpc_ana_state_ctx_free(ctx);
+		return;
+	}
+
+	spdk_nvmf_subsystem_set_ana_state(subsystem, &trid, ctx->ana_state, ctx->anagrpid,
+					  nvmf_rpc_ana_state_done, ctx);
+}
+SPDK_RPC_REGISTER("nvmf_subsystem_listener_set_ana_state",
+		  spdk_rpc_nvmf_subsystem_listener_set_ana_state, SPDK_RPC_RUNTIME);
+
 struct spdk_nvmf_ns_params {
 	char *bdev_name;
 	char *ptpl_file;
@@ -862,6 +1020,7 @@ struct spdk_nvmf_ns_params {
 	char nguid[16];
 	char eui64[8];
 	struct spdk_uuid uuid;
+	uint32_t anagrpid;
 };
 
 struct rpc_namespaces {
@@ -877,6 +1036,7 @@ static const struct spdk_json_object_decoder rpc_ns_params_decoders[] = {
 	{"nguid", offsetof(struct spdk_nvmf_ns_params, nguid), decode_ns_nguid, true},
 	{"eui64", offsetof(struct spdk_nvmf_ns_params, eui64), decode_ns_eui64, true},
 	{"uuid", offsetof(struct spdk_nvmf_ns_params, uuid), decode_ns_uuid, true},
+	{"anagrpid", offsetof(struct spdk_nvmf_ns_params, anagrpid), spdk_json_decode_uint32, true},
 };
 
 static int
@@ -965,6 +1125,8 @@ nvmf_rpc_ns_paused(struct spdk_nvmf_subsystem *subsystem,
 		ns_opts.uuid = ctx->ns_params.uuid;
 	}
 
+	ns_opts.anagrpid = ctx->ns_params.anagrpid;
+
 	ctx->ns_params.nsid = spdk_nvmf_subsystem_add_ns(subsystem, bdev, &ns_opts, sizeof(ns_opts),
 			      ctx->ns_params.ptpl_file);
 	if (ctx->ns_params.nsid == 0) {
@@ -1026,7 +1188,7 @@ spdk_rpc_nvmf_subsystem_add_ns(struct spdk_jsonrpc_request *request,
 		return;
 	}
 
-	if (spdk_nvmf_subsystem_pause(subsystem, nvmf_rpc_ns_paused, ctx)) {
+	if (spdk_nvmf_subsystem_pause(subsystem, 0, nvmf_rpc_ns_paused, ctx)) {
 		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR, "Internal error");
 		nvmf_rpc_ns_ctx_free(ctx);
 		return;
@@ -1144,7 +1306,7 @@ spdk_rpc_nvmf_subsystem_remove_ns(struct spdk_jsonrpc_request *request,
 		return;
 	}
 
-	if (spdk_nvmf_subsystem_pause(subsystem, nvmf_rpc_remove_ns_paused, ctx)) {
+	if (spdk_nvmf_subsystem_pause(subsystem, ctx->nsid, nvmf_rpc_remove_ns_paused, ctx)) {
 		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR, "Internal error");
 		nvmf_rpc_remove_ns_ctx_free(ctx);
 		return;
@@ -1285,7 +1447,8 @@ spdk_rpc_nvmf_subsystem_add_host(struct spdk_jsonrpc_request *request,
 		return;
 	}
 
-	if (spdk_nvmf_subsystem_pause(subsystem, nvmf_rpc_host_paused, ctx)) {
+	if (spdk_nvmf_subsystem_pause(subsystem, SPDK_NVME_GLOBAL_NS_TAG,
+				      nvmf_rpc_host_paused, ctx)) {
 		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR, "Internal error");
 		nvmf_rpc_host_ctx_free(ctx);
 		return;
@@ -1337,7 +1500,8 @@ spdk_rpc_nvmf_subsystem_remove_host(struct spdk_jsonrpc_request *request,
 		return;
 	}
 
-	if (spdk_nvmf_subsystem_pause(subsystem, nvmf_rpc_host_paused, ctx)) {
+	if (spdk_nvmf_subsystem_pause(subsystem, SPDK_NVME_GLOBAL_NS_TAG,
+				      nvmf_rpc_host_paused, ctx)) {
 		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR, "Internal error");
 		nvmf_rpc_host_ctx_free(ctx);
 		return;
@@ -1397,7 +1561,8 @@ spdk_rpc_nvmf_subsystem_allow_any_host(struct spdk_jsonrpc_request *request,
 		return;
 	}
 
-	if (spdk_nvmf_subsystem_pause(subsystem, nvmf_rpc_host_paused, ctx)) {
+	if (spdk_nvmf_subsystem_pause(subsystem, SPDK_NVME_GLOBAL_NS_TAG,
+				      nvmf_rpc_host_paused, ctx)) {
 		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR, "Internal error");
 		nvmf_rpc_host_ctx_free(ctx);
 		return;
@@ -1606,6 +1771,10 @@ static const struct spdk_json_object_decoder nvmf_rpc_create_transport_decoder[]
 		"wr_batching", offsetof(struct nvmf_rpc_create_transport_ctx, opts.wr_batching),
 		spdk_json_decode_bool, true
 	},
+	{
+		"zcopy", offsetof(struct nvmf_rpc_create_transport_ctx, opts.zcopy),
+		spdk_json_decode_bool, true
+	},
 };
 
 static void
@@ -1746,6 +1915,7 @@ dump_nvmf_transport(struct spdk_json_write_ctx *w, struct spdk_nvmf_transport *t
 	spdk_json_write_named_uint32(w, "num_shared_buffers", opts->num_shared_buffers);
 	spdk_json_write_named_uint32(w, "buf_cache_size", opts->buf_cache_size);
 	spdk_json_write_named_bool(w, "dif_insert_or_strip", opts->dif_insert_or_strip);
+	spdk_json_write_named_bool(w, "zcopy", opts->zcopy);
 	if (type == SPDK_NVME_TRANSPORT_RDMA) {
 		spdk_json_write_named_uint32(w, "max_srq_depth", opts->max_srq_depth);
 		spdk_json_write_named_bool(w, "no_srq", opts->no_srq);
@@ -1888,6 +2058,7 @@ rpc_nvmf_get_stats(struct spdk_io_channel_iter *i)
 		spdk_json_write_named_string(ctx->w, "name", spdk_thread_get_name(spdk_get_thread()));
 		spdk_json_write_named_uint32(ctx->w, "admin_qpairs", stat.admin_qpairs);
 		spdk_json_write_named_uint32(ctx->w, "io_qpairs", stat.io_qpairs);
+		spdk_json_write_named_uint32(ctx->w, "current_qpairs", stat.current_qpairs);
 		spdk_json_write_named_uint64(ctx->w, "pending_bdev_io", stat.pending_bdev_io);
 
 		spdk_json_write_named_array_begin(ctx->w, "transports");
@@ -1962,3 +2133,249 @@ spdk_rpc_nvmf_get_stats(struct spdk_jsonrpc_request *request,
 }
 
 SPDK_RPC_REGISTER("nvmf_get_stats", spdk_rpc_nvmf_get_stats, SPDK_RPC_RUNTIME)
+
+struct rpc_nvmf_ns_io_stat {
+	uint32_t			nsid;
+	struct spdk_nvmf_io_stat	stat;
+};
+
+struct rpc_nvmf_ctrlr_io_stat {
+	uint16_t			cntlid;
+	char				hostnqn[SPDK_NVMF_NQN_MAX_LEN + 1];
+	struct spdk_nvmf_io_stat	stat;
+};
+
+struct rpc_nvmf_get_io_stats_ctx {
+	char *nqn;
+	char *tgt_name;
+	struct spdk_nvmf_subsystem *subsystem;
+	struct spdk_jsonrpc_request *request;
+
+	struct rpc_nvmf_ns_io_stat *ns_stats;
+	uint32_t num_ns;
+	struct rpc_nvmf_ctrlr_io_stat *ctrlr_stats;
+	uint32_t num_ctrlrs;
+};
+
+static const struct spdk_json_object_decoder rpc_get_io_stats_decoders[] = {
+	{"nqn", offsetof(struct rpc_nvmf_get_io_stats_ctx, nqn), spdk_json_decode_string},
+	{
+		"tgt_name", offsetof(struct rpc_nvmf_get_io_stats_ctx, tgt_name),
+		spdk_json_decode_string, true
+	},
+};
+
+static void
+free_get_io_stats_ctx(struct rpc_nvmf_get_io_stats_ctx *ctx)
+{
+	free(ctx->nqn);
+	free(ctx->tgt_name);
+	free(ctx->ns_stats);
+	free(ctx->ctrlr_stats);
+	free(ctx);
+}
+
+static void
+write_nvmf_latency_bucket(void *ctx, uint64_t start, uint64_t end, uint64_t count,
+			  uint64_t total, uint64_t so_far)
+{
+	struct spdk_json_write_ctx *w = ctx;
+
+	if (count == 0) {
+		return;
+	}
+
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_uint64(w, "start", start);
+	spdk_json_write_named_uint64(w, "end", end);
+	spdk_json_write_named_uint64(w, "count", count);
+	spdk_json_write_object_end(w);
+}
+
+static void
+write_nvmf_io_stat(struct spdk_json_write_ctx *w, struct spdk_nvmf_io_stat *stat)
+{
+	struct spdk_histogram_data histogram = {
+		.bucket_shift = NVMF_IO_STAT_HISTOGRAM_BUCKET_SHIFT,
+		.bucket = stat->latency_buckets,
+	};
+
+	spdk_json_write_named_uint64(w, "bytes_read", stat->bytes_read);
+	spdk_json_write_named_uint64(w, "num_read_ops", stat->num_read_ops);
+	spdk_json_write_named_uint64(w, "bytes_written", stat->bytes_written);
+	spdk_json_write_named_uint64(w, "num_write_ops", stat->num_write_ops);
+	spdk_json_write_named_uint64(w, "read_latency_ticks", stat->read_latency_ticks);
+	spdk_json_write_named_uint64(w, "write_latency_ticks", stat->write_latency_ticks);
+
+	spdk_json_write_named_array_begin(w, "latency_histogram");
+	spdk_histogram_data_iterate(&histogram, write_nvmf_latency_bucket, w);
+	spdk_json_write_array_end(w);
+}
+
+static void
+rpc_nvmf_get_io_stats_done(struct spdk_io_channel_iter *i, int status)
+{
+	struct rpc_nvmf_get_io_stats_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
+	struct spdk_json_write_ctx *w;
+	uint32_t j;
+
+	w = spdk_jsonrpc_begin_result(ctx->request);
+	if (w == NULL) {
+		free_get_io_stats_ctx(ctx);
+		return;
+	}
+
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_uint64(w, "tick_rate", spdk_get_ticks_hz());
+
+	spdk_json_write_named_array_begin(w, "namespaces");
+	for (j = 0; j < ctx->num_ns; j++) {
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_uint32(w, "nsid", ctx->ns_stats[j].nsid);
+		write_nvmf_io_stat(w, &ctx->ns_stats[j].stat);
+		spdk_json_write_object_end(w);
+	}
+	spdk_json_write_array_end(w);
+
+	spdk_json_write_named_array_begin(w, "controllers");
+	for (j = 0; j < ctx->num_ctrlrs; j++) {
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_uint32(w, "cntlid", ctx->ctrlr_stats[j].cntlid);
+		spdk_json_write_named_string(w, "hostnqn", ctx->ctrlr_stats[j].hostnqn);
+		write_nvmf_io_stat(w, &ctx->ctrlr_stats[j].stat);
+		spdk_json_write_object_end(w);
+	}
+	spdk_json_write_array_end(w);
+
+	spdk_json_write_object_end(w);
+	spdk_jsonrpc_end_result(ctx->request, w);
+	free_get_io_stats_ctx(ctx);
+}
+
+static void
+rpc_nvmf_get_io_stats(struct spdk_io_channel_iter *i)
+{
+	struct rpc_nvmf_get_io_stats_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
+	struct spdk_io_channel *ch = spdk_io_channel_iter_get_channel(i);
+	struct spdk_nvmf_poll_group *group = spdk_io_channel_get_ctx(ch);
+	struct spdk_nvmf_subsystem_poll_group *sgroup;
+	struct spdk_nvmf_qpair *qpair;
+	uint32_t j, nsid;
+
+	if (ctx->subsystem->id < group->num_sgroups) {
+		sgroup = &group->sgroups[ctx->subsystem->id];
+		for (j = 0; j < ctx->num_ns; j++) {
+			nsid = ctx->ns_stats[j].nsid;
+			if (nsid <= sgroup->num_ns) {
+				spdk_nvmf_io_stat_merge(&ctx->ns_stats[j].stat,
+							&sgroup->ns_info[nsid - 1].io_stat);
+			}
+		}
+	}
+
+	TAILQ_FOREACH(qpair, &group->qpairs, link) {
+		if (qpair->ctrlr == NULL || qpair->ctrlr->subsys != ctx->subsystem) {
+			continue;
+		}
+
+		for (j = 0; j < ctx->num_ctrlrs; j++) {
+			if (ctx->ctrlr_stats[j].cntlid != qpair->ctrlr->cntlid) {
+				continue;
+			}
+
+			spdk_nvmf_io_stat_merge(&ctx->ctrlr_stats[j].stat, &qpair->io_stat);
+			/* Destroyed qpairs are accounted on the thread of the admin qpair */
+			if (spdk_nvmf_qpair_is_admin_queue(qpair)) {
+				spdk_nvmf_io_stat_merge(&ctx->ctrlr_stats[j].stat,
+							&qpair->ctrlr->io_stat);
+			}
+			break;
+		}
+	}
+
+	spdk_for_each_channel_continue(i, 0);
+}
+
+static void
+spdk_rpc_nvmf_subsystem_get_io_stats(struct spdk_jsonrpc_request *request,
+				     const struct spdk_json_val *params)
+{
+	struct rpc_nvmf_get_io_stats_ctx *ctx;
+	struct spdk_nvmf_tgt *tgt;
+	struct spdk_nvmf_ns *ns;
+	struct spdk_nvmf_ctrlr *ctrlr;
+	uint32_t j;
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (!ctx) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "Memory allocation error");
+		return;
+	}
+	ctx->request = request;
+
+	if (spdk_json_decode_object(params, rpc_get_io_stats_decoders,
+				    SPDK_COUNTOF(rpc_get_io_stats_decoders),
+				    ctx)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS, "Invalid parameters");
+		free_get_io_stats_ctx(ctx);
+		return;
+	}
+
+	tgt = spdk_nvmf_get_tgt(ctx->tgt_name);
+	if (!tgt) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "Unable to find a target.");
+		free_get_io_stats_ctx(ctx);
+		return;
+	}
+
+	ctx->subsystem = spdk_nvmf_tgt_find_subsystem(tgt, ctx->nqn);
+	if (!ctx->subsystem) {
+		SPDK_ERRLOG("Unable to find subsystem with NQN %s\n", ctx->nqn);
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS, "Invalid parameters");
+		free_get_io_stats_ctx(ctx);
+		return;
+	}
+
+	/* Take a snapshot of the namespaces and controllers to collect the statistics of */
+	for (ns = spdk_nvmf_subsystem_get_first_ns(ctx->subsystem); ns != NULL;
+	     ns = spdk_nvmf_subsystem_get_next_ns(ctx->subsystem, ns)) {
+		ctx->num_ns++;
+	}
+
+	TAILQ_FOREACH(ctrlr, &ctx->subsystem->ctrlrs, link) {
+		ctx->num_ctrlrs++;
+	}
+
+	ctx->ns_stats = calloc(spdk_max(ctx->num_ns, 1), sizeof(*ctx->ns_stats));
+	ctx->ctrlr_stats = calloc(spdk_max(ctx->num_ctrlrs, 1), sizeof(*ctx->ctrlr_stats));
+	if (!ctx->ns_stats || !ctx->ctrlr_stats) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "Memory allocation error");
+		free_get_io_stats_ctx(ctx);
+		return;
+	}
+
+	j = 0;
+	for (ns = spdk_nvmf_subsystem_get_first_ns(ctx->subsystem); ns != NULL;
+	     ns = spdk_nvmf_subsystem_get_next_ns(ctx->subsystem, ns)) {
+		ctx->ns_stats[j++].nsid = spdk_nvmf_ns_get_id(ns);
+	}
+
+	j = 0;
+	TAILQ_FOREACH(ctrlr, &ctx->subsystem->ctrlrs, link) {
+		ctx->ctrlr_stats[j].cntlid = ctrlr->cntlid;
+		snprintf(ctx->ctrlr_stats[j].hostnqn, sizeof(ctx->ctrlr_stats[j].hostnqn), "%s",
+			 ctrlr->hostnqn);
+		j++;
+	}
+
+	spdk_for_each_channel(tgt,
+			      rpc_nvmf_get_io_stats,
+			      ctx,
+			      rpc_nvmf_get_io_stats_done);
+}
+SPDK_RPC_REGISTER("nvmf_subsystem_get_io_stats", spdk_rpc_nvmf_subsystem_get_io_stats,
+		  SPDK_RPC_RUNTIME)
@@ -1552,12 +1552,18 @@ nvmf_rdma_get_lkey(struct spdk_nvmf_rdma_device *device, struct iovec *iov,
 {
 	uint64_t	translation_len;
 	uint32_t	lkey;
+	struct ibv_mr	*mr;
 
 	translation_len = iov->iov_len;
 
 	if (!g_nvmf_hooks.get_rkey) {
-		lkey = ((struct ibv_mr *)spdk_mem_map_translate(device->map,
-				(uint64_t)iov->iov_base, &translation_len))->lkey;
+		mr = (struct ibv_mr *)spdk_mem_map_translate(device->map, (uint64_t)iov->iov_base,
+				&translation_len);
+		if (spdk_unlikely(mr == NULL)) {
+			/* The memory is not registered with this device */
+			return false;
+		}
+		lkey = mr->lkey;
 	} else {
 		lkey = spdk_mem_map_translate(device->map,
 					      (uint64_t)iov->iov_base, &translation_len);
@@ -1684,6 +1690,58 @@ nvmf_rdma_fill_wr_sgl(struct spdk_nvmf_rdma_poll_group *rgroup,
 	return 0;
 }
 
+/* Point the data WRs at the buffers the bdev provided for a zero copy request. Buffers
+ *  that do not fit in the SGEs of one WR are spread over additional chained WRs. */
+static int
+nvmf_rdma_request_fill_zcopy_sgl(struct spdk_nvmf_rdma_transport *rtransport,
+				 struct spdk_nvmf_rdma_qpair *rqpair,
+				 struct spdk_nvmf_rdma_request *rdma_req)
+{
+	struct spdk_nvmf_request	*req = &rdma_req->req;
+	struct ibv_send_wr		*wr = &rdma_req->data.wr;
+	uint32_t			max_sge, num_wrs, i, lkey;
+	int				rc;
+
+	max_sge = spdk_min(rqpair->max_send_sge, SPDK_NVMF_MAX_SGL_ENTRIES);
+	num_wrs = SPDK_CEIL_DIV(req->iovcnt, max_sge);
+
+	if (num_wrs > 1) {
+		rc = nvmf_request_alloc_wrs(rtransport, rdma_req, num_wrs - 1);
+		if (rc != 0) {
+			SPDK_ERRLOG("Unable to get %u WRs for %u zero copy buffers\n",
+				    num_wrs, req->iovcnt);
+			return rc;
+		}
+	}
+
+	wr->num_sge = 0;
+	for (i = 0; i < req->iovcnt; i++) {
+		if (spdk_unlikely(!nvmf_rdma_get_lkey(rqpair->device, &req->iov[i], &lkey))) {
+			SPDK_ERRLOG("Zero copy buffer %p is not registered with the RDMA device\n",
+				    req->iov[i].iov_base);
+			return -EINVAL;
+		}
+
+		if (wr->num_sge == max_sge) {
+			wr = wr->next;
+			wr->num_sge = 0;
+		}
+
+		wr->sg_list[wr->num_sge].addr = (uintptr_t)req->iov[i].iov_base;
+		wr->sg_list[wr->num_sge].length = req->iov[i].iov_len;
+		wr->sg_list[wr->num_sge].lkey = lkey;
+		wr->num_sge++;
+	}
+
+	if (num_wrs > 1) {
+		nvmf_rdma_update_remote_addr(rdma_req, num_wrs);
+	}
+
+	rdma_req->num_outstanding_data_wr = num_wrs;
+
+	return 0;
+}
+
 static inline uint32_t
 nvmf_rdma_calc_num_wrs(uint32_t length, uint32_t io_unit_size, uint32_t block_size)
 {
@@ -1908,6 +1966,16 @@ spdk_nvmf_rdma_request_parse_sgl(struct spdk_nvmf_rdma_transport *rtransport,
 			req->dif.elba_length = length;
 		}
 
+		if (spdk_nvmf_request_use_zcopy(req)) {
+			/* Only the remote buffer is known yet, the bdev provides the local ones */
+			nvmf_rdma_setup_request(rdma_req);
+			req->zcopy = true;
+			req->iovcnt = 0;
+			rdma_req->num_outstanding_data_wr = 0;
+			SPDK_DEBUGLOG(SPDK_LOG_RDMA, "Request %p will use zero copy\n", rdma_req);
+			return 0;
+		}
+
 		rc = spdk_nvmf_rdma_request_fill_iovs(rtransport, device, rdma_req, length);
 		if (spdk_unlikely(rc < 0)) {
 			if (rc == -EINVAL) {
@@ -2000,6 +2068,8 @@ nvmf_rdma_request_free(struct spdk_nvmf_rdma_request *rdma_req,
 		rgroup = rqpair->poller->group;
 
 		spdk_nvmf_request_free_buffers(&rdma_req->req, &rgroup->group, &rtransport->transport);
+	} else if (rdma_req->req.zcopy) {
+		spdk_nvmf_request_zcopy_end(&rdma_req->req);
 	}
 	nvmf_rdma_request_free_data(rdma_req, rtransport);
 	rdma_req->req.length = 0;
@@ -2113,7 +2183,7 @@ spdk_nvmf_rdma_request_process(struct spdk_nvmf_rdma_transport *rtransport,
 				break;
 			}
 
-			if (!rdma_req->req.data) {
+			if (!rdma_req->req.data && !rdma_req->req.zcopy) {
 				/* No buffers available. */
 				rgroup->stat.pending_data_buffer++;
 				break;
@@ -2169,6 +2239,14 @@ spdk_nvmf_rdma_request_process(struct spdk_nvmf_rdma_transport *rtransport,
 			spdk_trace_record(TRACE_RDMA_REQUEST_STATE_READY_TO_EXECUTE, 0, 0,
 					  (uintptr_t)rdma_req, (uintptr_t)rqpair->cm_id);
 
+			if (rdma_req->req.zcopy_bdev_io != NULL) {
+				/* The data of a zero copy write is in the buffers of the bdev now */
+				assert(rdma_req->req.xfer == SPDK_NVME_DATA_HOST_TO_CONTROLLER);
+				rdma_req->state = RDMA_REQUEST_STATE_EXECUTING;
+				spdk_nvmf_request_zcopy_commit(&rdma_req->req);
+				break;
+			}
+
 			if (spdk_unlikely(rdma_req->req.dif.dif_insert_or_strip)) {
 				if (rdma_req->req.xfer == SPDK_NVME_DATA_HOST_TO_CONTROLLER) {
 					/* generate DIF for write operation */
@@ -2202,9 +2280,19 @@ spdk_nvmf_rdma_request_process(struct spdk_nvmf_rdma_transport *rtransport,
 		case RDMA_REQUEST_STATE_EXECUTED:
 			spdk_trace_record(TRACE_RDMA_REQUEST_STATE_EXECUTED, 0, 0,
 					  (uintptr_t)rdma_req, (uintptr_t)rqpair->cm_id);
+			if (rdma_req->req.zcopy && rsp->status.sc == SPDK_NVME_SC_SUCCESS &&
+			    nvmf_rdma_request_fill_zcopy_sgl(rtransport, rqpair, rdma_req) != 0) {
+				rsp->status.sct = SPDK_NVME_SCT_GENERIC;
+				rsp->status.sc = SPDK_NVME_SC_INTERNAL_DEVICE_ERROR;
+			}
 			if (rdma_req->req.xfer == SPDK_NVME_DATA_CONTROLLER_TO_HOST) {
 				STAILQ_INSERT_TAIL(&rqpair->pending_rdma_write_queue, rdma_req, state_link);
 				rdma_req->state = RDMA_REQUEST_STATE_DATA_TRANSFER_TO_HOST_PENDING;
+			} else if (rdma_req->req.zcopy_bdev_io != NULL &&
+				   rsp->status.sc == SPDK_NVME_SC_SUCCESS) {
+				/* The bdev lent its buffers to a zero copy write, read the data in */
+				STAILQ_INSERT_TAIL(&rqpair->pending_rdma_read_queue, rdma_req, state_link);
+				rdma_req->state = RDMA_REQUEST_STATE_DATA_TRANSFER_TO_CONTROLLER_PENDING;
 			} else {
 				rdma_req->state = RDMA_REQUEST_STATE_READY_TO_COMPLETE;
 			}
@@ -2315,6 +2403,7 @@ spdk_nvmf_rdma_request_process(struct spdk_nvmf_rdma_transport *rtransport,
 #define SPDK_NVMF_RDMA_DEFAULT_NO_SRQ false
 #define SPDK_NVMF_RDMA_DIF_INSERT_OR_STRIP false
 #define SPDK_NVMF_RDMA_WR_BATCHING true
+#define SPDK_NVMF_RDMA_DEFAULT_ZCOPY false
 
 static void
 spdk_nvmf_rdma_opts_init(struct spdk_nvmf_transport_opts *opts)
@@ -2331,6 +2420,7 @@ spdk_nvmf_rdma_opts_init(struct spdk_nvmf_transport_opts *opts)
 	opts->no_srq =			SPDK_NVMF_RDMA_DEFAULT_NO_SRQ;
 	opts->dif_insert_or_strip =	SPDK_NVMF_RDMA_DIF_INSERT_OR_STRIP;
 	opts->wr_batching =             SPDK_NVMF_RDMA_WR_BATCHING;
+	opts->zcopy =			SPDK_NVMF_RDMA_DEFAULT_ZCOPY;
 }
 
 const struct spdk_mem_map_ops g_nvmf_rdma_map_ops = {
@@ -2392,7 +2482,7 @@ spdk_nvmf_rdma_create(struct spdk_nvmf_transport_opts *opts)
 		     "  max_qpairs_per_ctrlr=%d, io_unit_size=%d,\n"
 		     "  in_capsule_data_size=%d, max_aq_depth=%d,\n"
 		     "  num_shared_buffers=%d, max_srq_depth=%d, no_srq=%d,\n"
-		     "  wr_batching=%d\n",
+		     "  wr_batching=%d, zcopy=%d\n",
 		     opts->max_queue_depth,
 		     opts->max_io_size,
 		     opts->max_qpairs_per_ctrlr,
@@ -2402,7 +2492,8 @@ spdk_nvmf_rdma_create(struct spdk_nvmf_transport_opts *opts)
 		     opts->num_shared_buffers,
 		     opts->max_srq_depth,
 		     opts->no_srq,
-		     opts->wr_batching);
+		     opts->wr_batching,
+		     opts->zcopy);
 
 	/* I/O unit size cannot be larger than max I/O size */
 	if (opts->io_unit_size > opts->max_io_size) {
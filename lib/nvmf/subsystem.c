@@ -36,6 +36,7 @@
 #include "nvmf_internal.h"
 #include "transport.h"
 
+#include "spdk/crc32.h"
 #include "spdk/event.h"
 #include "spdk/likely.h"
 #include "spdk/string.h"
@@ -318,6 +319,7 @@ _nvmf_subsystem_remove_listener(struct spdk_nvmf_subsystem *subsystem,
 				bool stop)
 {
 	struct spdk_nvmf_transport *transport;
+	struct spdk_nvmf_ctrlr *ctrlr;
 
 	if (stop) {
 		transport = spdk_nvmf_tgt_get_transport(subsystem->tgt, listener->trid.trstring);
@@ -326,7 +328,15 @@ _nvmf_subsystem_remove_listener(struct spdk_nvmf_subsystem *subsystem,
 		}
 	}
 
+	/* Controllers that are still connected report all ANA groups as optimized from now on */
+	TAILQ_FOREACH(ctrlr, &subsystem->ctrlrs, link) {
+		if (ctrlr->listener == listener) {
+			ctrlr->listener = NULL;
+		}
+	}
+
 	TAILQ_REMOVE(&subsystem->listeners, listener, link);
+	free(listener->ana_state);
 	free(listener);
 }
 
@@ -430,6 +440,7 @@ struct subsystem_state_change_ctx {
 	struct spdk_nvmf_subsystem *subsystem;
 
 	enum spdk_nvmf_subsystem_state requested_state;
+	uint32_t nsid;
 
 	spdk_nvmf_subsystem_state_change_done cb_fn;
 	void *cb_arg;
@@ -483,7 +494,8 @@ subsystem_state_change_on_pg(struct spdk_io_channel_iter *i)
 		}
 		break;
 	case SPDK_NVMF_SUBSYSTEM_PAUSED:
-		spdk_nvmf_poll_group_pause_subsystem(group, ctx->subsystem, subsystem_state_change_continue, i);
+		spdk_nvmf_poll_group_pause_subsystem(group, ctx->subsystem, ctx->nsid,
+						     subsystem_state_change_continue, i);
 		break;
 	default:
 		assert(false);
@@ -493,6 +505,7 @@ subsystem_state_change_on_pg(struct spdk_io_channel_iter *i)
 
 static int
 spdk_nvmf_subsystem_state_change(struct spdk_nvmf_subsystem *subsystem,
+				 uint32_t nsid,
 				 enum spdk_nvmf_subsystem_state requested_state,
 				 spdk_nvmf_subsystem_state_change_done cb_fn,
 				 void *cb_arg)
@@ -532,6 +545,7 @@ spdk_nvmf_subsystem_state_change(struct spdk_nvmf_subsystem *subsystem,
 	}
 
 	ctx->subsystem = subsystem;
+	ctx->nsid = nsid;
 	ctx->requested_state = requested_state;
 	ctx->cb_fn = cb_fn;
 	ctx->cb_arg = cb_arg;
@@ -549,7 +563,8 @@ spdk_nvmf_subsystem_start(struct spdk_nvmf_subsystem *subsystem,
 			  spdk_nvmf_subsystem_state_change_done cb_fn,
 			  void *cb_arg)
 {
-	return spdk_nvmf_subsystem_state_change(subsystem, SPDK_NVMF_SUBSYSTEM_ACTIVE, cb_fn, cb_arg);
+	return spdk_nvmf_subsystem_state_change(subsystem, 0, SPDK_NVMF_SUBSYSTEM_ACTIVE,
+						cb_fn, cb_arg);
 }
 
 int
@@ -557,15 +572,18 @@ spdk_nvmf_subsystem_stop(struct spdk_nvmf_subsystem *subsystem,
 			 spdk_nvmf_subsystem_state_change_done cb_fn,
 			 void *cb_arg)
 {
-	return spdk_nvmf_subsystem_state_change(subsystem, SPDK_NVMF_SUBSYSTEM_INACTIVE, cb_fn, cb_arg);
+	return spdk_nvmf_subsystem_state_change(subsystem, 0, SPDK_NVMF_SUBSYSTEM_INACTIVE,
+						cb_fn, cb_arg);
 }
 
 int
 spdk_nvmf_subsystem_pause(struct spdk_nvmf_subsystem *subsystem,
+			  uint32_t nsid,
 			  spdk_nvmf_subsystem_state_change_done cb_fn,
 			  void *cb_arg)
 {
-	return spdk_nvmf_subsystem_state_change(subsystem, SPDK_NVMF_SUBSYSTEM_PAUSED, cb_fn, cb_arg);
+	return spdk_nvmf_subsystem_state_change(subsystem, nsid, SPDK_NVMF_SUBSYSTEM_PAUSED,
+						cb_fn, cb_arg);
 }
 
 int
@@ -573,7 +591,8 @@ spdk_nvmf_subsystem_resume(struct spdk_nvmf_subsystem *subsystem,
 			   spdk_nvmf_subsystem_state_change_done cb_fn,
 			   void *cb_arg)
 {
-	return spdk_nvmf_subsystem_state_change(subsystem, SPDK_NVMF_SUBSYSTEM_ACTIVE, cb_fn, cb_arg);
+	return spdk_nvmf_subsystem_state_change(subsystem, 0, SPDK_NVMF_SUBSYSTEM_ACTIVE,
+						cb_fn, cb_arg);
 }
 
 struct spdk_nvmf_subsystem *
@@ -747,6 +766,31 @@ spdk_nvmf_subsystem_find_listener(struct spdk_nvmf_subsystem *subsystem,
 	return NULL;
 }
 
+static int
+nvmf_listener_resize_ana_state(struct spdk_nvmf_listener *listener, uint32_t num_ana_groups)
+{
+	enum spdk_nvme_ana_state *ana_state;
+	uint32_t i;
+
+	if (num_ana_groups <= listener->num_ana_groups) {
+		return 0;
+	}
+
+	ana_state = realloc(listener->ana_state, sizeof(*ana_state) * num_ana_groups);
+	if (ana_state == NULL) {
+		return -ENOMEM;
+	}
+
+	for (i = listener->num_ana_groups; i < num_ana_groups; i++) {
+		ana_state[i] = SPDK_NVME_ANA_OPTIMIZED_STATE;
+	}
+
+	listener->ana_state = ana_state;
+	listener->num_ana_groups = num_ana_groups;
+
+	return 0;
+}
+
 int
 spdk_nvmf_subsystem_add_listener(struct spdk_nvmf_subsystem *subsystem,
 				 struct spdk_nvme_transport_id *trid)
@@ -775,6 +819,11 @@ spdk_nvmf_subsystem_add_listener(struct spdk_nvmf_subsystem *subsystem,
 		return -ENOMEM;
 	}
 
+	if (nvmf_listener_resize_ana_state(listener, subsystem->max_nsid)) {
+		free(listener);
+		return -ENOMEM;
+	}
+
 	listener->trid = *trid;
 	listener->transport = transport;
 
@@ -867,6 +916,182 @@ spdk_nvmf_subsytem_any_listener_allowed(struct spdk_nvmf_subsystem *subsystem)
 	return subsystem->allow_any_listener;
 }
 
+int
+spdk_nvmf_subsystem_set_ana_reporting(struct spdk_nvmf_subsystem *subsystem,
+				      bool ana_reporting)
+{
+	if (subsystem->state != SPDK_NVMF_SUBSYSTEM_INACTIVE) {
+		return -EAGAIN;
+	}
+
+	subsystem->ana_reporting = ana_reporting;
+
+	return 0;
+}
+
+bool
+spdk_nvmf_subsystem_get_ana_reporting(const struct spdk_nvmf_subsystem *subsystem)
+{
+	return subsystem->ana_reporting;
+}
+
+struct subsystem_ana_change_ctx {
+	struct spdk_nvmf_subsystem			*subsystem;
+	struct spdk_nvmf_listener			*listener;
+
+	spdk_nvmf_subsystem_set_ana_state_done_fn	cb_fn;
+	void						*cb_arg;
+};
+
+static void
+subsystem_ana_change_done(struct spdk_io_channel_iter *i, int status)
+{
+	struct subsystem_ana_change_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
+
+	if (ctx->cb_fn) {
+		ctx->cb_fn(ctx->cb_arg, status);
+	}
+	free(ctx);
+}
+
+static void
+subsystem_ana_change_on_pg(struct spdk_io_channel_iter *i)
+{
+	struct subsystem_ana_change_ctx *ctx;
+	struct spdk_nvmf_poll_group *group;
+	struct spdk_nvmf_ctrlr *ctrlr;
+
+	ctx = spdk_io_channel_iter_get_ctx(i);
+	group = spdk_io_channel_get_ctx(spdk_io_channel_iter_get_channel(i));
+
+	/* Asynchronous events have to be sent from the thread of the controller */
+	TAILQ_FOREACH(ctrlr, &ctx->subsystem->ctrlrs, link) {
+		if (ctrlr->thread == group->thread && ctrlr->listener == ctx->listener) {
+			spdk_nvmf_ctrlr_async_event_ana_change_notice(ctrlr);
+		}
+	}
+
+	spdk_for_each_channel_continue(i, 0);
+}
+
+void
+spdk_nvmf_subsystem_set_ana_state(struct spdk_nvmf_subsystem *subsystem,
+				  const struct spdk_nvme_transport_id *trid,
+				  enum spdk_nvme_ana_state ana_state, uint32_t anagrpid,
+				  spdk_nvmf_subsystem_set_ana_state_done_fn cb_fn, void *cb_arg)
+{
+	struct spdk_nvmf_listener *listener;
+	struct subsystem_ana_change_ctx *ctx;
+	uint32_t i;
+	int rc;
+
+	if (!subsystem->ana_reporting) {
+		SPDK_ERRLOG("ANA reporting is disabled for subsystem %s\n", subsystem->subnqn);
+		rc = -EINVAL;
+		goto err;
+	}
+
+	switch (ana_state) {
+	case SPDK_NVME_ANA_OPTIMIZED_STATE:
+	case SPDK_NVME_ANA_NON_OPTIMIZED_STATE:
+	case SPDK_NVME_ANA_INACCESSIBLE_STATE:
+		break;
+	default:
+		SPDK_ERRLOG("Unsupported ANA state %d\n", ana_state);
+		rc = -EINVAL;
+		goto err;
+	}
+
+	listener = spdk_nvmf_subsystem_find_listener(subsystem, trid);
+	if (listener == NULL) {
+		SPDK_ERRLOG("Unable to find listener.\n");
+		rc = -EINVAL;
+		goto err;
+	}
+
+	if (anagrpid > listener->num_ana_groups) {
+		SPDK_ERRLOG("ANA group ID %" PRIu32 " is larger than maximum %" PRIu32 "\n",
+			    anagrpid, listener->num_ana_groups);
+		rc = -EINVAL;
+		goto err;
+	}
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		rc = -ENOMEM;
+		goto err;
+	}
+
+	if (anagrpid == 0) {
+		for (i = 0; i < listener->num_ana_groups; i++) {
+			listener->ana_state[i] = ana_state;
+		}
+	} else {
+		listener->ana_state[anagrpid - 1] = ana_state;
+	}
+	listener->ana_state_change_count++;
+
+	ctx->subsystem = subsystem;
+	ctx->listener = listener;
+	ctx->cb_fn = cb_fn;
+	ctx->cb_arg = cb_arg;
+
+	spdk_for_each_channel(subsystem->tgt,
+			      subsystem_ana_change_on_pg,
+			      ctx,
+			      subsystem_ana_change_done);
+	return;
+
+err:
+	if (cb_fn) {
+		cb_fn(cb_arg, rc);
+	}
+}
+
+const char *
+spdk_nvmf_ana_state_str(enum spdk_nvme_ana_state ana_state)
+{
+	switch (ana_state) {
+	case SPDK_NVME_ANA_OPTIMIZED_STATE:
+		return "optimized";
+	case SPDK_NVME_ANA_NON_OPTIMIZED_STATE:
+		return "non_optimized";
+	case SPDK_NVME_ANA_INACCESSIBLE_STATE:
+		return "inaccessible";
+	case SPDK_NVME_ANA_PERSISTENT_LOSS_STATE:
+		return "persistent_loss";
+	case SPDK_NVME_ANA_CHANGE_STATE:
+		return "change";
+	default:
+		return NULL;
+	}
+}
+
+bool
+spdk_nvmf_subsystem_ana_group_in_use(struct spdk_nvmf_subsystem *subsystem, uint32_t anagrpid)
+{
+	struct spdk_nvmf_ns *ns;
+
+	for (ns = spdk_nvmf_subsystem_get_first_ns(subsystem); ns != NULL;
+	     ns = spdk_nvmf_subsystem_get_next_ns(subsystem, ns)) {
+		if (ns->opts.anagrpid == anagrpid) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+enum spdk_nvme_ana_state
+spdk_nvmf_listener_get_ana_state(struct spdk_nvmf_listener *listener, uint32_t anagrpid)
+{
+	if (anagrpid == 0 || anagrpid > listener->num_ana_groups) {
+		return 0;
+	}
+
+	return listener->ana_state[anagrpid - 1];
+}
+
 
 struct subsystem_update_ns_ctx {
 	struct spdk_nvmf_subsystem *subsystem;
@@ -924,6 +1149,8 @@ spdk_nvmf_subsystem_ns_changed(struct spdk_nvmf_subsystem *subsystem, uint32_t n
 	}
 }
 
+static void nvmf_ns_ptpl_log_free(struct spdk_nvmf_ns_ptpl_log *log);
+
 int
 spdk_nvmf_subsystem_remove_ns(struct spdk_nvmf_subsystem *subsystem, uint32_t nsid)
 {
@@ -956,6 +1183,7 @@ spdk_nvmf_subsystem_remove_ns(struct spdk_nvmf_subsystem *subsystem, uint32_t ns
 	if (ns->ptpl_file) {
 		free(ns->ptpl_file);
 	}
+	nvmf_ns_ptpl_log_free(ns->ptpl_log);
 	free(ns);
 
 	spdk_nvmf_subsystem_ns_changed(subsystem, nsid);
@@ -984,7 +1212,7 @@ spdk_nvmf_ns_hot_remove(void *remove_ctx)
 	struct spdk_nvmf_ns *ns = remove_ctx;
 	int rc;
 
-	rc = spdk_nvmf_subsystem_pause(ns->subsystem, _spdk_nvmf_ns_hot_remove, ns);
+	rc = spdk_nvmf_subsystem_pause(ns->subsystem, ns->opts.nsid, _spdk_nvmf_ns_hot_remove, ns);
 	if (rc) {
 		SPDK_ERRLOG("Unable to pause subsystem to process namespace removal!\n");
 	}
@@ -1005,7 +1233,7 @@ spdk_nvmf_ns_resize(void *event_ctx)
 	struct spdk_nvmf_ns *ns = event_ctx;
 	int rc;
 
-	rc = spdk_nvmf_subsystem_pause(ns->subsystem, _spdk_nvmf_ns_resize, ns);
+	rc = spdk_nvmf_subsystem_pause(ns->subsystem, ns->opts.nsid, _spdk_nvmf_ns_resize, ns);
 	if (rc) {
 		SPDK_ERRLOG("Unable to pause subsystem to process namespace resize!\n");
 	}
@@ -1105,8 +1333,20 @@ spdk_nvmf_subsystem_add_ns(struct spdk_nvmf_subsystem *subsystem, struct spdk_bd
 		return 0;
 	}
 
+	/* Each namespace gets its own ANA group unless one was requested */
+	if (opts.anagrpid == 0) {
+		opts.anagrpid = opts.nsid;
+	}
+
+	/* ANA group IDs share the range of NSIDs, so ANAGRPMAX can be reported as NN */
+	if (opts.anagrpid > spdk_max(opts.nsid, subsystem->max_nsid)) {
+		SPDK_ERRLOG("ANA group ID %" PRIu32 " is larger than the maximum NSID\n", opts.anagrpid);
+		return 0;
+	}
+
 	if (opts.nsid > subsystem->max_nsid) {
 		struct spdk_nvmf_ns **new_ns_array;
+		struct spdk_nvmf_listener *listener;
 
 		/* If MaxNamespaces was specified, we can't extend max_nsid beyond it. */
 		if (subsystem->max_allowed_nsid > 0 && opts.nsid > subsystem->max_allowed_nsid) {
@@ -1120,6 +1360,13 @@ spdk_nvmf_subsystem_add_ns(struct spdk_nvmf_subsystem *subsystem, struct spdk_bd
 			return 0;
 		}
 
+		TAILQ_FOREACH(listener, &subsystem->listeners, link) {
+			if (nvmf_listener_resize_ana_state(listener, opts.nsid)) {
+				SPDK_ERRLOG("Memory allocation error while resizing ANA state array.\n");
+				return 0;
+			}
+		}
+
 		new_ns_array = realloc(subsystem->ns, sizeof(struct spdk_nvmf_ns *) * opts.nsid);
 		if (new_ns_array == NULL) {
 			SPDK_ERRLOG("Memory allocation error while resizing namespace array.\n");
@@ -1453,32 +1700,34 @@ static const struct spdk_json_object_decoder nvmf_ns_pr_decoders[] = {
 	{"registrants", offsetof(struct _nvmf_ns_reservation, regs), nvmf_decode_ns_pr_regs},
 };
 
+#define NVMF_PTPL_LOG_MAGIC		0x4c505450	/* "PTPL" */
+/* The log is compacted into a single record once it grows past this size */
+#define NVMF_PTPL_LOG_MAX_SIZE		(1024 * 1024)
+
+/*
+ * The Persist Through Power Loss file is an append log. Every record holds the whole
+ * reservation state of the namespace, so the newest record that passes its CRC check
+ * is the persistent state and a record torn by a crash is ignored. A record without
+ * payload means PTPL was cleared. The JSON payload is padded with whitespace to keep
+ * the record headers aligned.
+ */
+struct nvmf_ptpl_log_rec_hdr {
+	uint32_t	magic;
+	uint32_t	length;
+	uint32_t	crc;
+	uint32_t	reserved;
+};
+
 static int
-spdk_nvmf_ns_load_reservation(const char *file, struct spdk_nvmf_reservation_info *info)
+nvmf_ns_decode_reservation(void *json, size_t json_size, const char *file,
+			   struct spdk_nvmf_reservation_info *info)
 {
-	FILE *fd;
-	size_t json_size;
 	ssize_t values_cnt, rc;
-	void *json = NULL, *end;
+	void *end;
 	struct spdk_json_val *values = NULL;
 	struct _nvmf_ns_reservation res = {};
 	uint32_t i;
 
-	fd = fopen(file, "r");
-	/* It's not an error if the file does not exist */
-	if (!fd) {
-		SPDK_NOTICELOG("File %s does not exist\n", file);
-		return -ENOENT;
-	}
-
-	/* Load all persist file contents into a local buffer */
-	json = spdk_posix_file_load(fd, &json_size);
-	fclose(fd);
-	if (!json) {
-		SPDK_ERRLOG("Load persit file %s failed\n", file);
-		return -ENOMEM;
-	}
-
 	rc = spdk_json_parse(json, json_size, NULL, 0, &end, 0);
 	if (rc < 0) {
 		SPDK_NOTICELOG("Parsing JSON configuration failed (%zd)\n", rc);
@@ -1526,7 +1775,6 @@ spdk_nvmf_ns_load_reservation(const char *file, struct spdk_nvmf_reservation_inf
 	}
 
 exit:
-	free(json);
 	free(values);
 	free(res.bdev_uuid);
 	free(res.holder_uuid);
@@ -1537,6 +1785,72 @@ exit:
 	return rc;
 }
 
+/* Return the newest intact record of the log, or NULL if there is none */
+static struct nvmf_ptpl_log_rec_hdr *
+nvmf_ptpl_log_last_record(void *buf, size_t size)
+{
+	struct nvmf_ptpl_log_rec_hdr *hdr, *last = NULL;
+	size_t offset = 0;
+
+	while (size - offset >= sizeof(*hdr)) {
+		hdr = (struct nvmf_ptpl_log_rec_hdr *)((uint8_t *)buf + offset);
+		if (hdr->magic != NVMF_PTPL_LOG_MAGIC ||
+		    hdr->length > size - offset - sizeof(*hdr) ||
+		    hdr->crc != spdk_crc32c_update(hdr + 1, hdr->length, ~0u)) {
+			break;
+		}
+		last = hdr;
+		offset += sizeof(*hdr) + hdr->length;
+	}
+
+	return last;
+}
+
+static int
+spdk_nvmf_ns_load_reservation(const char *file, struct spdk_nvmf_reservation_info *info)
+{
+	FILE *fd;
+	size_t size, json_size;
+	void *buf, *json;
+	struct nvmf_ptpl_log_rec_hdr *hdr;
+	int rc;
+
+	fd = fopen(file, "r");
+	/* It's not an error if the file does not exist */
+	if (!fd) {
+		SPDK_NOTICELOG("File %s does not exist\n", file);
+		return -ENOENT;
+	}
+
+	/* Load all persist file contents into a local buffer */
+	buf = spdk_posix_file_load(fd, &size);
+	fclose(fd);
+	if (!buf) {
+		SPDK_ERRLOG("Load persit file %s failed\n", file);
+		return -ENOMEM;
+	}
+
+	/* Files written before the append log was introduced hold a single JSON object */
+	json = buf;
+	json_size = size;
+	hdr = buf;
+	if (size >= sizeof(*hdr) && hdr->magic == NVMF_PTPL_LOG_MAGIC) {
+		hdr = nvmf_ptpl_log_last_record(buf, size);
+		if (hdr == NULL || hdr->length == 0) {
+			SPDK_NOTICELOG("No persistent reservation in %s\n", file);
+			free(buf);
+			return -ENOENT;
+		}
+		json = hdr + 1;
+		json_size = hdr->length;
+	}
+
+	rc = nvmf_ns_decode_reservation(json, json_size, file, info);
+	free(buf);
+
+	return rc;
+}
+
 static bool
 nvmf_ns_reservation_all_registrants_type(struct spdk_nvmf_ns *ns);
 
@@ -1596,40 +1910,100 @@ nvmf_ns_reservation_restore(struct spdk_nvmf_ns *ns, struct spdk_nvmf_reservatio
 	return 0;
 }
 
+struct nvmf_ptpl_log_buf {
+	uint8_t		*data;
+	size_t		len;
+	size_t		size;
+};
+
+typedef void (*nvmf_ns_ptpl_persist_cb)(void *cb_arg, int status);
+
+struct nvmf_ns_ptpl_waiter {
+	nvmf_ns_ptpl_persist_cb			cb_fn;
+	void					*cb_arg;
+	TAILQ_ENTRY(nvmf_ns_ptpl_waiter)	link;
+};
+
+/*
+ * Reservation updates are group committed: the state serialized by every update issued
+ * while a write is in progress replaces the pending record, and the next write commits
+ * it for all of them at once. Writes run on a dedicated writer thread so fdatasync()
+ * never blocks the subsystem thread.
+ */
+struct spdk_nvmf_ns_ptpl_log {
+	char					*file;
+	struct spdk_thread			*thread;
+	pthread_t				writer;
+	sem_t					sem;
+	bool					exit;
+
+	/* Owned by the writer thread while a write is in progress */
+	int					fd;
+	uint64_t				size;
+	int					rc;
+
+	/* Newest state, committed by the next write */
+	struct nvmf_ptpl_log_buf		pending;
+	bool					dirty;
+	TAILQ_HEAD(, nvmf_ns_ptpl_waiter)	pending_waiters;
+
+	/* State being committed by the writer thread */
+	struct nvmf_ptpl_log_buf		inflight;
+	bool					writing;
+	TAILQ_HEAD(, nvmf_ns_ptpl_waiter)	inflight_waiters;
+
+	/* The namespace is gone, free the log once the write completes */
+	bool					removed;
+};
+
 static int
-spdk_nvmf_ns_json_write_cb(void *cb_ctx, const void *data, size_t size)
+nvmf_ptpl_log_buf_append(void *cb_ctx, const void *data, size_t size)
 {
-	char *file = cb_ctx;
-	size_t rc;
-	FILE *fd;
+	struct nvmf_ptpl_log_buf *buf = cb_ctx;
+	size_t new_size;
+	uint8_t *tmp;
 
-	fd = fopen(file, "w");
-	if (!fd) {
-		SPDK_ERRLOG("Can't open file %s for write\n", file);
-		return -ENOENT;
+	if (buf->len + size > buf->size) {
+		new_size = spdk_max(buf->size * 2, buf->len + size);
+		tmp = realloc(buf->data, new_size);
+		if (tmp == NULL) {
+			return -ENOMEM;
+		}
+		buf->data = tmp;
+		buf->size = new_size;
 	}
-	rc = fwrite(data, 1, size, fd);
-	fclose(fd);
 
-	return rc == size ? 0 : -1;
+	memcpy(buf->data + buf->len, data, size);
+	buf->len += size;
+
+	return 0;
 }
 
 static int
-spdk_nvmf_ns_reservation_update(const char *file, struct spdk_nvmf_reservation_info *info)
+spdk_nvmf_ns_reservation_encode(struct spdk_nvmf_reservation_info *info,
+				struct nvmf_ptpl_log_buf *buf)
 {
+	struct nvmf_ptpl_log_rec_hdr hdr = {};
 	struct spdk_json_write_ctx *w;
 	uint32_t i;
-	int rc = 0;
+	int rc;
 
-	w = spdk_json_write_begin(spdk_nvmf_ns_json_write_cb, (void *)file, 0);
-	if (w == NULL) {
-		return -ENOMEM;
+	buf->len = 0;
+	rc = nvmf_ptpl_log_buf_append(buf, &hdr, sizeof(hdr));
+	if (rc != 0) {
+		return rc;
 	}
-	/* clear the configuration file */
+
+	/* clear the persistent reservation */
 	if (!info->ptpl_activated) {
 		goto exit;
 	}
 
+	w = spdk_json_write_begin(nvmf_ptpl_log_buf_append, buf, 0);
+	if (w == NULL) {
+		return -ENOMEM;
+	}
+
 	spdk_json_write_object_begin(w);
 	spdk_json_write_named_bool(w, "ptpl", info->ptpl_activated);
 	spdk_json_write_named_uint32(w, "rtype", info->rtype);
@@ -1647,22 +2021,284 @@ spdk_nvmf_ns_reservation_update(const char *file, struct spdk_nvmf_reservation_i
 	spdk_json_write_array_end(w);
 	spdk_json_write_object_end(w);
 
-exit:
 	rc = spdk_json_write_end(w);
-	return rc;
+	while (rc == 0 && buf->len % sizeof(hdr) != 0) {
+		rc = nvmf_ptpl_log_buf_append(buf, " ", 1);
+	}
+	if (rc != 0) {
+		return rc;
+	}
+
+exit:
+	hdr.magic = NVMF_PTPL_LOG_MAGIC;
+	hdr.length = buf->len - sizeof(hdr);
+	hdr.crc = spdk_crc32c_update(buf->data + sizeof(hdr), hdr.length, ~0u);
+	memcpy(buf->data, &hdr, sizeof(hdr));
+
+	return 0;
+}
+
+static int
+nvmf_ptpl_write_all(int fd, const void *data, size_t len, off_t offset)
+{
+	ssize_t rc;
+
+	while (len > 0) {
+		rc = pwrite(fd, data, len, offset);
+		if (rc < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -errno;
+		}
+		data = (const uint8_t *)data + rc;
+		len -= rc;
+		offset += rc;
+	}
+
+	return 0;
+}
+
+/* Replace the log with a single record holding the in-flight state */
+static int
+nvmf_ns_ptpl_log_rewrite(struct spdk_nvmf_ns_ptpl_log *log)
+{
+	char path[PATH_MAX];
+	const char *dir_end;
+	int fd, dir_fd, rc;
+
+	snprintf(path, sizeof(path), "%s.tmp", log->file);
+	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	if (fd < 0) {
+		return -errno;
+	}
+
+	rc = nvmf_ptpl_write_all(fd, log->inflight.data, log->inflight.len, 0);
+	if (rc == 0 && fdatasync(fd) != 0) {
+		rc = -errno;
+	}
+	if (rc == 0 && rename(path, log->file) != 0) {
+		rc = -errno;
+	}
+	if (rc != 0) {
+		close(fd);
+		unlink(path);
+		return rc;
+	}
+
+	/* Make the rename itself durable */
+	dir_end = strrchr(log->file, '/');
+	if (dir_end == NULL) {
+		snprintf(path, sizeof(path), ".");
+	} else {
+		snprintf(path, sizeof(path), "%.*s", (int)spdk_max(dir_end - log->file, 1),
+			 log->file);
+	}
+	dir_fd = open(path, O_RDONLY | O_DIRECTORY);
+	if (dir_fd >= 0) {
+		fsync(dir_fd);
+		close(dir_fd);
+	}
+
+	if (log->fd >= 0) {
+		close(log->fd);
+	}
+	log->fd = fd;
+	log->size = log->inflight.len;
+
+	return 0;
+}
+
+static void nvmf_ns_ptpl_log_kick(struct spdk_nvmf_ns_ptpl_log *log);
+
+static void
+nvmf_ns_ptpl_log_free(struct spdk_nvmf_ns_ptpl_log *log)
+{
+	struct nvmf_ns_ptpl_waiter *waiter, *tmp;
+
+	if (log == NULL) {
+		return;
+	}
+
+	if (log->writing) {
+		log->removed = true;
+		return;
+	}
+
+	TAILQ_FOREACH_SAFE(waiter, &log->pending_waiters, link, tmp) {
+		TAILQ_REMOVE(&log->pending_waiters, waiter, link);
+		waiter->cb_fn(waiter->cb_arg, -ENODEV);
+		free(waiter);
+	}
+
+	log->exit = true;
+	sem_post(&log->sem);
+	pthread_join(log->writer, NULL);
+	sem_destroy(&log->sem);
+
+	if (log->fd >= 0) {
+		close(log->fd);
+	}
+	free(log->pending.data);
+	free(log->inflight.data);
+	free(log->file);
+	free(log);
+}
+
+static void
+nvmf_ns_ptpl_log_write_done(void *ctx)
+{
+	struct spdk_nvmf_ns_ptpl_log *log = ctx;
+	struct nvmf_ns_ptpl_waiter *waiter, *tmp;
+
+	log->writing = false;
+	if (log->rc != 0) {
+		SPDK_ERRLOG("Failed to persist reservation to %s: %s\n", log->file,
+			    spdk_strerror(-log->rc));
+	}
+
+	TAILQ_FOREACH_SAFE(waiter, &log->inflight_waiters, link, tmp) {
+		TAILQ_REMOVE(&log->inflight_waiters, waiter, link);
+		waiter->cb_fn(waiter->cb_arg, log->rc);
+		free(waiter);
+	}
+
+	if (log->removed) {
+		nvmf_ns_ptpl_log_free(log);
+		return;
+	}
+
+	nvmf_ns_ptpl_log_kick(log);
+}
+
+static void
+nvmf_ns_ptpl_log_write(struct spdk_nvmf_ns_ptpl_log *log)
+{
+	if (log->fd < 0 || log->size + log->inflight.len > NVMF_PTPL_LOG_MAX_SIZE) {
+		log->rc = nvmf_ns_ptpl_log_rewrite(log);
+	} else {
+		log->rc = nvmf_ptpl_write_all(log->fd, log->inflight.data, log->inflight.len,
+					      log->size);
+		if (log->rc == 0 && fdatasync(log->fd) != 0) {
+			log->rc = -errno;
+		}
+
+		if (log->rc == 0) {
+			log->size += log->inflight.len;
+		} else {
+			/* A torn record hides everything appended after it, start over */
+			close(log->fd);
+			log->fd = -1;
+		}
+	}
+
+	spdk_thread_send_msg(log->thread, nvmf_ns_ptpl_log_write_done, log);
+}
+
+static void *
+nvmf_ns_ptpl_log_writer(void *ctx)
+{
+	struct spdk_nvmf_ns_ptpl_log *log = ctx;
+
+	while (true) {
+		while (sem_wait(&log->sem) != 0) {
+		}
+		if (log->exit) {
+			break;
+		}
+		nvmf_ns_ptpl_log_write(log);
+	}
+
+	return NULL;
+}
+
+/* Called with the affinity widened so the writer doesn't share the reactor's core */
+static void *
+nvmf_ns_ptpl_log_start_writer(void *ctx)
+{
+	struct spdk_nvmf_ns_ptpl_log *log = ctx;
+	int rc;
+
+	rc = pthread_create(&log->writer, NULL, nvmf_ns_ptpl_log_writer, log);
+	if (rc != 0) {
+		SPDK_ERRLOG("Could not create reservation writer thread: %s\n", spdk_strerror(rc));
+		return NULL;
+	}
+
+	return log;
+}
+
+static void
+nvmf_ns_ptpl_log_kick(struct spdk_nvmf_ns_ptpl_log *log)
+{
+	struct nvmf_ptpl_log_buf tmp;
+
+	if (log->writing || !log->dirty) {
+		return;
+	}
+
+	tmp = log->inflight;
+	log->inflight = log->pending;
+	log->pending = tmp;
+	log->dirty = false;
+	TAILQ_CONCAT(&log->inflight_waiters, &log->pending_waiters, link);
+	log->writing = true;
+	sem_post(&log->sem);
+}
+
+static struct spdk_nvmf_ns_ptpl_log *
+nvmf_ns_ptpl_log_create(const char *file)
+{
+	struct spdk_nvmf_ns_ptpl_log *log;
+
+	log = calloc(1, sizeof(*log));
+	if (log == NULL) {
+		return NULL;
+	}
+
+	log->file = strdup(file);
+	if (log->file == NULL) {
+		free(log);
+		return NULL;
+	}
+
+	/* The first write compacts whatever the file holds, it may predate the log format */
+	log->fd = -1;
+	log->thread = spdk_get_thread();
+	TAILQ_INIT(&log->pending_waiters);
+	TAILQ_INIT(&log->inflight_waiters);
+
+	if (sem_init(&log->sem, 0, 0) != 0) {
+		free(log->file);
+		free(log);
+		return NULL;
+	}
+
+	if (spdk_call_unaffinitized(nvmf_ns_ptpl_log_start_writer, log) == NULL) {
+		sem_destroy(&log->sem);
+		free(log->file);
+		free(log);
+		return NULL;
+	}
+
+	return log;
 }
 
 static int
-nvmf_ns_update_reservation_info(struct spdk_nvmf_ns *ns)
+nvmf_ns_update_reservation_info(struct spdk_nvmf_ns *ns, nvmf_ns_ptpl_persist_cb cb_fn,
+				void *cb_arg)
 {
 	struct spdk_nvmf_reservation_info info;
 	struct spdk_nvmf_registrant *reg, *tmp;
+	struct spdk_nvmf_ns_ptpl_log *log;
+	struct nvmf_ns_ptpl_waiter *waiter;
 	uint32_t i = 0;
+	int rc;
 
 	assert(ns != NULL);
 
 	if (!ns->bdev || !ns->ptpl_file) {
-		return 0;
+		return -EINVAL;
 	}
 
 	memset(&info, 0, sizeof(info));
@@ -1686,7 +2322,32 @@ nvmf_ns_update_reservation_info(struct spdk_nvmf_ns *ns)
 	info.num_regs = i;
 	info.ptpl_activated = ns->ptpl_activated;
 
-	return spdk_nvmf_ns_reservation_update(ns->ptpl_file, &info);
+	if (ns->ptpl_log == NULL) {
+		ns->ptpl_log = nvmf_ns_ptpl_log_create(ns->ptpl_file);
+		if (ns->ptpl_log == NULL) {
+			return -ENOMEM;
+		}
+	}
+	log = ns->ptpl_log;
+
+	waiter = calloc(1, sizeof(*waiter));
+	if (waiter == NULL) {
+		return -ENOMEM;
+	}
+
+	rc = spdk_nvmf_ns_reservation_encode(&info, &log->pending);
+	if (rc != 0) {
+		free(waiter);
+		return rc;
+	}
+
+	log->dirty = true;
+	waiter->cb_fn = cb_fn;
+	waiter->cb_arg = cb_arg;
+	TAILQ_INSERT_TAIL(&log->pending_waiters, waiter, link);
+	nvmf_ns_ptpl_log_kick(log);
+
+	return 0;
 }
 
 static struct spdk_nvmf_registrant *
@@ -2049,12 +2710,6 @@ nvmf_ns_reservation_register(struct spdk_nvmf_ns *ns,
 	}
 
 exit:
-	if (update_sgroup) {
-		rc = nvmf_ns_update_reservation_info(ns);
-		if (rc != 0) {
-			status = SPDK_NVME_SC_INTERNAL_DEVICE_ERROR;
-		}
-	}
 	req->rsp->nvme_cpl.status.sct = SPDK_NVME_SCT_GENERIC;
 	req->rsp->nvme_cpl.status.sc = status;
 	return update_sgroup;
@@ -2217,11 +2872,6 @@ exit:
 
 		}
 	}
-	if (update_sgroup && ns->ptpl_activated) {
-		if (nvmf_ns_update_reservation_info(ns)) {
-			status = SPDK_NVME_SC_INTERNAL_DEVICE_ERROR;
-		}
-	}
 	req->rsp->nvme_cpl.status.sct = SPDK_NVME_SCT_GENERIC;
 	req->rsp->nvme_cpl.status.sc = status;
 	return update_sgroup;
@@ -2322,11 +2972,6 @@ nvmf_ns_reservation_release(struct spdk_nvmf_ns *ns,
 	}
 
 exit:
-	if (update_sgroup && ns->ptpl_activated) {
-		if (nvmf_ns_update_reservation_info(ns)) {
-			status = SPDK_NVME_SC_INTERNAL_DEVICE_ERROR;
-		}
-	}
 	req->rsp->nvme_cpl.status.sct = SPDK_NVME_SCT_GENERIC;
 	req->rsp->nvme_cpl.status.sc = status;
 	return update_sgroup;
@@ -2414,16 +3059,45 @@ spdk_nvmf_ns_reservation_complete(void *ctx)
 	spdk_nvmf_request_complete(req);
 }
 
+struct nvmf_ns_reservation_ctx {
+	struct spdk_nvmf_request	*req;
+	/* The poll group update and the persistent log write run in parallel */
+	int				outstanding;
+};
+
 static void
-_nvmf_ns_reservation_update_done(struct spdk_nvmf_subsystem *subsystem,
-				 void *cb_arg, int status)
+nvmf_ns_reservation_ctx_done(struct nvmf_ns_reservation_ctx *ctx)
 {
-	struct spdk_nvmf_request *req = (struct spdk_nvmf_request *)cb_arg;
+	struct spdk_nvmf_request *req = ctx->req;
 	struct spdk_nvmf_poll_group *group = req->qpair->group;
 
+	if (--ctx->outstanding > 0) {
+		return;
+	}
+
+	free(ctx);
 	spdk_thread_send_msg(group->thread, spdk_nvmf_ns_reservation_complete, req);
 }
 
+static void
+_nvmf_ns_reservation_update_done(struct spdk_nvmf_subsystem *subsystem,
+				 void *cb_arg, int status)
+{
+	nvmf_ns_reservation_ctx_done(cb_arg);
+}
+
+static void
+_nvmf_ns_reservation_persist_done(void *cb_arg, int status)
+{
+	struct nvmf_ns_reservation_ctx *ctx = cb_arg;
+
+	if (status != 0) {
+		ctx->req->rsp->nvme_cpl.status.sct = SPDK_NVME_SCT_GENERIC;
+		ctx->req->rsp->nvme_cpl.status.sc = SPDK_NVME_SC_INTERNAL_DEVICE_ERROR;
+	}
+	nvmf_ns_reservation_ctx_done(ctx);
+}
+
 void
 spdk_nvmf_ns_reservation_request(void *ctx)
 {
@@ -2431,13 +3105,17 @@ spdk_nvmf_ns_reservation_request(void *ctx)
 	struct spdk_nvme_cmd *cmd = &req->cmd->nvme_cmd;
 	struct spdk_nvmf_ctrlr *ctrlr = req->qpair->ctrlr;
 	struct subsystem_update_ns_ctx *update_ctx;
+	struct nvmf_ns_reservation_ctx *res_ctx;
 	uint32_t nsid;
 	struct spdk_nvmf_ns *ns;
 	bool update_sgroup = false;
+	bool ptpl_activated;
+	int rc;
 
 	nsid = cmd->nsid;
 	ns = _spdk_nvmf_subsystem_get_ns(ctrlr->subsys, nsid);
 	assert(ns != NULL);
+	ptpl_activated = ns->ptpl_activated;
 
 	switch (cmd->opc) {
 	case SPDK_NVME_OPC_RESERVATION_REGISTER:
@@ -2456,21 +3134,41 @@ spdk_nvmf_ns_reservation_request(void *ctx)
 		break;
 	}
 
-	/* update reservation information to subsystem's poll group */
-	if (update_sgroup) {
-		update_ctx = calloc(1, sizeof(*update_ctx));
-		if (update_ctx == NULL) {
-			SPDK_ERRLOG("Can't alloc subsystem poll group update context\n");
-			goto update_done;
+	if (!update_sgroup) {
+		goto complete;
+	}
+
+	res_ctx = calloc(1, sizeof(*res_ctx));
+	if (res_ctx == NULL) {
+		SPDK_ERRLOG("Can't alloc reservation context\n");
+		goto complete;
+	}
+	res_ctx->req = req;
+	res_ctx->outstanding = 1;
+
+	/* persist the new state, or clear it if PTPL was just deactivated */
+	if (ns->ptpl_file && (ns->ptpl_activated || ptpl_activated)) {
+		res_ctx->outstanding++;
+		rc = nvmf_ns_update_reservation_info(ns, _nvmf_ns_reservation_persist_done, res_ctx);
+		if (rc != 0) {
+			_nvmf_ns_reservation_persist_done(res_ctx, rc);
 		}
-		update_ctx->subsystem = ctrlr->subsys;
-		update_ctx->cb_fn = _nvmf_ns_reservation_update_done;
-		update_ctx->cb_arg = req;
+	}
 
-		spdk_nvmf_subsystem_update_ns(ctrlr->subsys, subsystem_update_ns_done, update_ctx);
+	/* update reservation information to subsystem's poll group */
+	update_ctx = calloc(1, sizeof(*update_ctx));
+	if (update_ctx == NULL) {
+		SPDK_ERRLOG("Can't alloc subsystem poll group update context\n");
+		nvmf_ns_reservation_ctx_done(res_ctx);
 		return;
 	}
+	update_ctx->subsystem = ctrlr->subsys;
+	update_ctx->cb_fn = _nvmf_ns_reservation_update_done;
+	update_ctx->cb_arg = res_ctx;
+
+	spdk_nvmf_subsystem_update_ns(ctrlr->subsys, subsystem_update_ns_done, update_ctx);
+	return;
 
-update_done:
-	_nvmf_ns_reservation_update_done(ctrlr->subsys, (void *)req, 0);
+complete:
+	spdk_thread_send_msg(req->qpair->group->thread, spdk_nvmf_ns_reservation_complete, req);
 }
@@ -183,6 +183,14 @@ struct spdk_nvmf_tcp_req  {
 	 */
 	bool					pdu_in_use;
 
+	/*
+	 * Capsule response appended to the final C2H data PDU when the
+	 * completion cannot be conveyed by the SUCCESS flag. It goes out in
+	 * the same socket request as the data, so it needs no PDU of its own.
+	 */
+	struct spdk_nvme_tcp_rsp		piggyback_rsp;
+	uint8_t					piggyback_hdgst[SPDK_NVME_TCP_DIGEST_LEN];
+
 	/* In-capsule data buffer */
 	uint8_t					*buf;
 
@@ -486,7 +494,8 @@ spdk_nvmf_tcp_create(struct spdk_nvmf_transport_opts *opts)
 		     "  max_qpairs_per_ctrlr=%d, io_unit_size=%d,\n"
 		     "  in_capsule_data_size=%d, max_aq_depth=%d\n"
 		     "  num_shared_buffers=%d, c2h_success=%d,\n"
-		     "  dif_insert_or_strip=%d, sock_priority=%d\n",
+		     "  dif_insert_or_strip=%d, sock_priority=%d\n"
+		     "  zcopy=%d\n",
 		     opts->max_queue_depth,
 		     opts->max_io_size,
 		     opts->max_qpairs_per_ctrlr,
@@ -496,7 +505,8 @@ spdk_nvmf_tcp_create(struct spdk_nvmf_transport_opts *opts)
 		     opts->num_shared_buffers,
 		     opts->c2h_success,
 		     opts->dif_insert_or_strip,
-		     opts->sock_priority);
+		     opts->sock_priority,
+		     opts->zcopy);
 
 	if (opts->sock_priority > SPDK_NVMF_TCP_DEFAULT_MAX_SOCK_PRIORITY) {
 		SPDK_ERRLOG("Unsupported socket_priority=%d, the current range is: 0 to %d\n"
@@ -747,8 +757,8 @@ _pdu_write_done(void *_pdu, int err)
 	pdu->cb_fn(pdu->cb_arg);
 }
 
-static void
-spdk_nvmf_tcp_qpair_write_pdu(struct spdk_nvmf_tcp_qpair *tqpair,
+static uint32_t
+spdk_nvmf_tcp_qpair_build_pdu(struct spdk_nvmf_tcp_qpair *tqpair,
 			      struct nvme_tcp_pdu *pdu,
 			      nvme_tcp_qpair_xfer_complete_cb cb_fn,
 			      void *cb_arg)
@@ -756,7 +766,6 @@ spdk_nvmf_tcp_qpair_write_pdu(struct spdk_nvmf_tcp_qpair *tqpair,
 	int hlen;
 	uint32_t crc32c;
 	uint32_t mapped_length = 0;
-	ssize_t rc;
 
 	assert(&tqpair->pdu_in_progress != pdu);
 
@@ -782,6 +791,17 @@ spdk_nvmf_tcp_qpair_write_pdu(struct spdk_nvmf_tcp_qpair *tqpair,
 			       &mapped_length);
 	pdu->sock_req.cb_fn = _pdu_write_done;
 	pdu->sock_req.cb_arg = pdu;
+
+	return mapped_length;
+}
+
+static void
+spdk_nvmf_tcp_qpair_send_pdu(struct spdk_nvmf_tcp_qpair *tqpair,
+			     struct nvme_tcp_pdu *pdu,
+			     uint32_t mapped_length)
+{
+	ssize_t rc;
+
 	TAILQ_INSERT_TAIL(&tqpair->send_queue, pdu, tailq);
 	if (pdu->hdr->common.pdu_type == SPDK_NVME_TCP_PDU_TYPE_IC_RESP ||
 	    pdu->hdr->common.pdu_type == SPDK_NVME_TCP_PDU_TYPE_C2H_TERM_REQ) {
@@ -794,9 +814,29 @@ spdk_nvmf_tcp_qpair_write_pdu(struct spdk_nvmf_tcp_qpair *tqpair,
 		}
 	} else {
 		spdk_sock_writev_async(tqpair->sock, &pdu->sock_req);
+
+		/* With other requests still executing on this qpair, leave the PDU
+		 * queued so that the sock layer gathers it with their responses into
+		 * a single writev when the poll group flushes. Otherwise there is
+		 * nothing to coalesce it with, so push it out now. */
+		if (tqpair->state_cntr[TCP_REQUEST_STATE_EXECUTING] == 0) {
+			spdk_sock_flush(tqpair->sock);
+		}
 	}
 }
 
+static void
+spdk_nvmf_tcp_qpair_write_pdu(struct spdk_nvmf_tcp_qpair *tqpair,
+			      struct nvme_tcp_pdu *pdu,
+			      nvme_tcp_qpair_xfer_complete_cb cb_fn,
+			      void *cb_arg)
+{
+	uint32_t mapped_length;
+
+	mapped_length = spdk_nvmf_tcp_qpair_build_pdu(tqpair, pdu, cb_fn, cb_arg);
+	spdk_nvmf_tcp_qpair_send_pdu(tqpair, pdu, mapped_length);
+}
+
 static int
 spdk_nvmf_tcp_qpair_init_mem_resource(struct spdk_nvmf_tcp_qpair *tqpair)
 {
@@ -1361,16 +1401,10 @@ static void
 spdk_nvmf_tcp_pdu_c2h_data_complete(void *cb_arg)
 {
 	struct spdk_nvmf_tcp_req *tcp_req = cb_arg;
-	struct spdk_nvmf_tcp_qpair *tqpair = SPDK_CONTAINEROF(tcp_req->req.qpair,
-					     struct spdk_nvmf_tcp_qpair, qpair);
 
-	assert(tqpair != NULL);
-	if (tqpair->qpair.transport->opts.c2h_success) {
-		nvmf_tcp_request_free(tcp_req);
-	} else {
-		nvmf_tcp_req_pdu_fini(tcp_req);
-		spdk_nvmf_tcp_send_capsule_resp_pdu(tcp_req, tqpair);
-	}
+	/* The completion went out either as the SUCCESS flag or as the capsule
+	 * response piggybacked on the data PDU, so the request is done. */
+	nvmf_tcp_request_free(tcp_req);
 }
 
 static void
@@ -1766,11 +1800,12 @@ nvmf_tcp_pdu_payload_insert_dif(struct nvme_tcp_pdu *pdu, uint32_t read_offset,
 }
 
 static int
-nvme_tcp_recv_buf_read(struct spdk_sock *sock, struct nvme_tcp_pdu_recv_buf *pdu_recv_buf)
+nvme_tcp_recv_buf_read(struct spdk_sock *sock, struct nvme_tcp_pdu_recv_buf *pdu_recv_buf,
+		       uint32_t max_len)
 {
 	int rc;
 
-	rc = nvme_tcp_read_data(sock, pdu_recv_buf->size - pdu_recv_buf->off,
+	rc = nvme_tcp_read_data(sock, spdk_min(max_len, pdu_recv_buf->size - pdu_recv_buf->off),
 				(void *)pdu_recv_buf->buf + pdu_recv_buf->off);
 	if (rc < 0) {
 		SPDK_DEBUGLOG(SPDK_LOG_NVMF_TCP, "will disconnect sock=%p\n", sock);
@@ -1829,13 +1864,31 @@ nvme_tcp_read_payload_data_from_pdu_recv_buf(struct nvme_tcp_pdu_recv_buf *pdu_r
 	return size;
 }
 
+/*
+ * Returns how much to read into the receive buffer for the remaining hdr_len
+ * bytes of a PDU header. Normally the buffer is filled to amortize the reads
+ * over several PDUs, but while H2C data is expected the read stops at the end
+ * of the header, so that the payload behind it is read directly into the
+ * request's data buffers instead of being copied out of the receive buffer.
+ */
+static inline uint32_t
+spdk_nvmf_tcp_recv_buf_read_len(struct spdk_nvmf_tcp_qpair *tqpair, uint32_t hdr_len)
+{
+	if (tqpair->state_cntr[TCP_REQUEST_STATE_TRANSFERRING_HOST_TO_CONTROLLER] == 0 &&
+	    tqpair->state_cntr[TCP_REQUEST_STATE_AWAITING_R2T_ACK] == 0) {
+		return UINT32_MAX;
+	}
+
+	return hdr_len;
+}
+
 static int
 spdk_nvmf_tcp_sock_process(struct spdk_nvmf_tcp_qpair *tqpair)
 {
 	int rc = 0;
 	struct nvme_tcp_pdu *pdu;
 	enum nvme_tcp_pdu_recv_state prev_state;
-	uint32_t data_len;
+	uint32_t data_len, hdr_len;
 	struct spdk_nvmf_tcp_transport *ttransport = SPDK_CONTAINEROF(tqpair->qpair.transport,
 			struct spdk_nvmf_tcp_transport, transport);
 
@@ -1854,7 +1907,16 @@ spdk_nvmf_tcp_sock_process(struct spdk_nvmf_tcp_qpair *tqpair)
 			}
 
 			if (!tqpair->pdu_recv_buf.remain_size) {
-				rc = nvme_tcp_recv_buf_read(tqpair->sock, &tqpair->pdu_recv_buf);
+				/* H2C data has the shortest header of the PDUs carrying data */
+				hdr_len = sizeof(struct spdk_nvme_tcp_h2c_data_hdr) -
+					  pdu->ch_valid_bytes;
+				if (tqpair->host_hdgst_enable) {
+					hdr_len += SPDK_NVME_TCP_DIGEST_LEN;
+				}
+
+				hdr_len = spdk_nvmf_tcp_recv_buf_read_len(tqpair, hdr_len);
+				rc = nvme_tcp_recv_buf_read(tqpair->sock, &tqpair->pdu_recv_buf,
+							    hdr_len);
 				if (rc <= 0) {
 					return rc;
 				}
@@ -1877,7 +1939,10 @@ spdk_nvmf_tcp_sock_process(struct spdk_nvmf_tcp_qpair *tqpair)
 		/* Wait for the pdu specific header  */
 		case NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_PSH:
 			if (!tqpair->pdu_recv_buf.remain_size) {
-				rc = nvme_tcp_recv_buf_read(tqpair->sock, &tqpair->pdu_recv_buf);
+				hdr_len = spdk_nvmf_tcp_recv_buf_read_len(tqpair,
+						pdu->psh_len - pdu->psh_valid_bytes);
+				rc = nvme_tcp_recv_buf_read(tqpair->sock, &tqpair->pdu_recv_buf,
+							    hdr_len);
 				if (rc <= 0) {
 					return rc;
 				}
@@ -1991,6 +2056,14 @@ spdk_nvmf_tcp_req_parse_sgl(struct spdk_nvmf_tcp_req *tcp_req,
 			req->dif.elba_length = length;
 		}
 
+		if (req->xfer == SPDK_NVME_DATA_CONTROLLER_TO_HOST && spdk_nvmf_request_use_zcopy(req)) {
+			/* The data buffers are provided by the bdev once the read executes */
+			req->zcopy = true;
+			req->iovcnt = 0;
+			SPDK_DEBUGLOG(SPDK_LOG_NVMF_TCP, "Request %p will use zero copy\n", tcp_req);
+			return 0;
+		}
+
 		if (spdk_nvmf_request_get_buffers(req, group, transport, length)) {
 			/* No available buffers. Queue this request up. */
 			SPDK_DEBUGLOG(SPDK_LOG_NVMF_TCP, "No available large data buffers. Queueing request %p\n",
@@ -2073,13 +2146,55 @@ nvmf_tcp_dif_error_to_compl_status(uint8_t err_type) {
 	return result;
 }
 
+/*
+ * Append the capsule response for tcp_req to the socket request of its
+ * C2H data PDU, so the host receives data and completion in one write.
+ */
+static uint32_t
+spdk_nvmf_tcp_pdu_append_capsule_resp(struct spdk_nvmf_tcp_qpair *tqpair,
+				      struct nvme_tcp_pdu *pdu,
+				      struct spdk_nvmf_tcp_req *tcp_req)
+{
+	struct spdk_nvme_tcp_rsp *capsule_resp = &tcp_req->piggyback_rsp;
+	struct iovec *iov;
+	uint32_t crc32c;
+
+	assert(pdu->sock_req.iovcnt + 2 <= (int)SPDK_COUNTOF(pdu->iov));
+
+	memset(capsule_resp, 0, sizeof(*capsule_resp));
+	capsule_resp->common.pdu_type = SPDK_NVME_TCP_PDU_TYPE_CAPSULE_RESP;
+	capsule_resp->common.plen = capsule_resp->common.hlen = sizeof(*capsule_resp);
+	capsule_resp->rccqe = tcp_req->req.rsp->nvme_cpl;
+
+	iov = &pdu->iov[pdu->sock_req.iovcnt++];
+	iov->iov_base = capsule_resp;
+	iov->iov_len = sizeof(*capsule_resp);
+
+	if (tqpair->host_hdgst_enable) {
+		capsule_resp->common.flags |= SPDK_NVME_TCP_CH_FLAGS_HDGSTF;
+		capsule_resp->common.plen += SPDK_NVME_TCP_DIGEST_LEN;
+
+		crc32c = spdk_crc32c_update(capsule_resp, sizeof(*capsule_resp), ~0);
+		crc32c = crc32c ^ SPDK_CRC32C_XOR;
+		MAKE_DIGEST_WORD(tcp_req->piggyback_hdgst, crc32c);
+
+		iov = &pdu->iov[pdu->sock_req.iovcnt++];
+		iov->iov_base = tcp_req->piggyback_hdgst;
+		iov->iov_len = SPDK_NVME_TCP_DIGEST_LEN;
+	}
+
+	return capsule_resp->common.plen;
+}
+
 static void
 spdk_nvmf_tcp_send_c2h_data(struct spdk_nvmf_tcp_qpair *tqpair,
 			    struct spdk_nvmf_tcp_req *tcp_req)
 {
 	struct nvme_tcp_pdu *rsp_pdu;
 	struct spdk_nvme_tcp_c2h_data_hdr *c2h_data;
-	uint32_t plen, pdo, alignment;
+	struct spdk_nvme_cpl *rsp = &tcp_req->req.rsp->nvme_cpl;
+	uint32_t plen, pdo, alignment, mapped_length;
+	bool success;
 	int rc;
 
 	SPDK_DEBUGLOG(SPDK_LOG_NVMF_TCP, "enter\n");
@@ -2129,7 +2244,6 @@ spdk_nvmf_tcp_send_c2h_data(struct spdk_nvmf_tcp_qpair *tqpair,
 				  c2h_data->datao, c2h_data->datal);
 
 	if (spdk_unlikely(tcp_req->req.dif.dif_insert_or_strip)) {
-		struct spdk_nvme_cpl *rsp = &tcp_req->req.rsp->nvme_cpl;
 		struct spdk_dif_error err_blk = {};
 
 		rc = spdk_dif_verify_stream(rsp_pdu->data_iov, rsp_pdu->data_iovcnt,
@@ -2145,12 +2259,22 @@ spdk_nvmf_tcp_send_c2h_data(struct spdk_nvmf_tcp_qpair *tqpair,
 		}
 	}
 
+	/* The SUCCESS flag implies a completion with all command specific
+	 * fields zeroed, so it can only stand in for a response that has none. */
+	success = tqpair->qpair.transport->opts.c2h_success && rsp->cdw0 == 0 && rsp->rsvd1 == 0;
+
 	c2h_data->common.flags |= SPDK_NVME_TCP_C2H_DATA_FLAGS_LAST_PDU;
-	if (tqpair->qpair.transport->opts.c2h_success) {
+	if (success) {
 		c2h_data->common.flags |= SPDK_NVME_TCP_C2H_DATA_FLAGS_SUCCESS;
 	}
 
-	spdk_nvmf_tcp_qpair_write_pdu(tqpair, rsp_pdu, spdk_nvmf_tcp_pdu_c2h_data_complete, tcp_req);
+	mapped_length = spdk_nvmf_tcp_qpair_build_pdu(tqpair, rsp_pdu,
+			spdk_nvmf_tcp_pdu_c2h_data_complete, tcp_req);
+	if (!success) {
+		mapped_length += spdk_nvmf_tcp_pdu_append_capsule_resp(tqpair, rsp_pdu, tcp_req);
+	}
+
+	spdk_nvmf_tcp_qpair_send_pdu(tqpair, rsp_pdu, mapped_length);
 }
 
 static int
@@ -2286,7 +2410,7 @@ spdk_nvmf_tcp_req_process(struct spdk_nvmf_tcp_transport *ttransport,
 				break;
 			}
 
-			if (!tcp_req->req.data) {
+			if (!tcp_req->req.data && !tcp_req->req.zcopy) {
 				SPDK_DEBUGLOG(SPDK_LOG_NVMF_TCP, "No buffer allocated for tcp_req(%p) on tqpair(%p\n)",
 					      tcp_req, tqpair);
 				/* No buffers available. */
@@ -2370,6 +2494,8 @@ spdk_nvmf_tcp_req_process(struct spdk_nvmf_tcp_transport *ttransport,
 			spdk_trace_record(TRACE_TCP_REQUEST_STATE_COMPLETED, 0, 0, (uintptr_t)tcp_req, 0);
 			if (tcp_req->req.data_from_pool) {
 				spdk_nvmf_request_free_buffers(&tcp_req->req, group, transport);
+			} else if (tcp_req->req.zcopy) {
+				spdk_nvmf_request_zcopy_end(&tcp_req->req);
 			}
 			tcp_req->req.length = 0;
 			tcp_req->req.iovcnt = 0;
@@ -2606,6 +2732,7 @@ spdk_nvmf_tcp_qpair_get_listen_trid(struct spdk_nvmf_qpair *qpair,
 #define SPDK_NVMF_TCP_DEFAULT_SUCCESS_OPTIMIZATION true
 #define SPDK_NVMF_TCP_DEFAULT_DIF_INSERT_OR_STRIP false
 #define SPDK_NVMF_TCP_DEFAULT_SOCK_PRIORITY 0
+#define SPDK_NVMF_TCP_DEFAULT_ZCOPY false
 
 static void
 spdk_nvmf_tcp_opts_init(struct spdk_nvmf_transport_opts *opts)
@@ -2621,6 +2748,7 @@ spdk_nvmf_tcp_opts_init(struct spdk_nvmf_transport_opts *opts)
 	opts->c2h_success =		SPDK_NVMF_TCP_DEFAULT_SUCCESS_OPTIMIZATION;
 	opts->dif_insert_or_strip =	SPDK_NVMF_TCP_DEFAULT_DIF_INSERT_OR_STRIP;
 	opts->sock_priority =		SPDK_NVMF_TCP_DEFAULT_SOCK_PRIORITY;
+	opts->zcopy =			SPDK_NVMF_TCP_DEFAULT_ZCOPY;
 }
 
 const struct spdk_nvmf_transport_ops spdk_nvmf_transport_tcp = {
@@ -86,9 +86,18 @@ TAILQ_HEAD(zcopy_mbuf_list, zcopy_mbuf);
  * Structure contains variables relevant to RX/TX virtqueues.
  */
 struct vhost_virtqueue {
-	struct vring_desc	*desc;
-	struct vring_avail	*avail;
-	struct vring_used	*used;
+	union {
+		struct vring_desc		*desc;
+		struct vring_packed_desc	*desc_packed;
+	};
+	union {
+		struct vring_avail		*avail;
+		struct vring_packed_desc_event	*driver_event;
+	};
+	union {
+		struct vring_used		*used;
+		struct vring_packed_desc_event	*device_event;
+	};
 	uint32_t		size;
 
 	uint16_t		last_avail_idx;
@@ -140,6 +149,10 @@ struct vhost_virtqueue {
  #define VIRTIO_F_VERSION_1 32
 #endif
 
+#ifndef VIRTIO_F_RING_PACKED
+ #define VIRTIO_F_RING_PACKED 34
+#endif
+
 #define VHOST_USER_F_PROTOCOL_FEATURES	30
 
 /* Features supported by this builtin vhost-user net driver. */
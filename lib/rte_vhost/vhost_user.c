@@ -360,6 +360,66 @@ qva_to_vva(struct virtio_net *dev, uint64_t qva, uint64_t *len)
 
 static int vhost_setup_mem_table(struct virtio_net *dev);
 
+/*
+ * Packed virtqueues consist of a single descriptor ring and two event
+ * suppression structures in place of the avail and used rings.
+ */
+static int
+vhost_user_set_vring_addr_packed(struct virtio_net *dev, VhostUserMsg *msg)
+{
+	struct vhost_virtqueue *vq;
+	uint64_t len;
+
+	vq = dev->virtqueue[msg->payload.addr.index];
+
+	len = sizeof(struct vring_packed_desc) * vq->size;
+	vq->desc_packed = (struct vring_packed_desc *)(uintptr_t)qva_to_vva(dev,
+			msg->payload.addr.desc_user_addr, &len);
+	if (vq->desc_packed == NULL ||
+			len != sizeof(struct vring_packed_desc) * vq->size) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"(%d) failed to map packed desc ring.\n",
+			dev->vid);
+		return -1;
+	}
+
+	dev = numa_realloc(dev, msg->payload.addr.index);
+	vq = dev->virtqueue[msg->payload.addr.index];
+
+	len = sizeof(struct vring_packed_desc_event);
+	vq->driver_event = (struct vring_packed_desc_event *)(uintptr_t)qva_to_vva(dev,
+			msg->payload.addr.avail_user_addr, &len);
+	if (vq->driver_event == NULL ||
+			len != sizeof(struct vring_packed_desc_event)) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"(%d) failed to find driver area address.\n",
+			dev->vid);
+		return -1;
+	}
+
+	len = sizeof(struct vring_packed_desc_event);
+	vq->device_event = (struct vring_packed_desc_event *)(uintptr_t)qva_to_vva(dev,
+			msg->payload.addr.used_user_addr, &len);
+	if (vq->device_event == NULL ||
+			len != sizeof(struct vring_packed_desc_event)) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"(%d) failed to find device area address.\n",
+			dev->vid);
+		return -1;
+	}
+
+	vq->log_guest_addr = msg->payload.addr.log_guest_addr;
+
+	VHOST_LOG_DEBUG(VHOST_CONFIG, "(%d) mapped address desc_packed: %p\n",
+			dev->vid, vq->desc_packed);
+	VHOST_LOG_DEBUG(VHOST_CONFIG, "(%d) mapped address driver_event: %p\n",
+			dev->vid, vq->driver_event);
+	VHOST_LOG_DEBUG(VHOST_CONFIG, "(%d) mapped address device_event: %p\n",
+			dev->vid, vq->device_event);
+
+	return 0;
+}
+
 /*
  * The virtio device sends us the desc, used and avail ring addresses.
  * This function then converts these to our address space.
@@ -387,6 +447,9 @@ vhost_user_set_vring_addr(struct virtio_net *dev, VhostUserMsg *msg)
 	/* addr->index refers to the queue index. The txq 1, rxq is 0. */
 	vq = dev->virtqueue[msg->payload.addr.index];
 
+	if (dev->negotiated_features & (1ULL << VIRTIO_F_RING_PACKED))
+		return vhost_user_set_vring_addr_packed(dev, msg);
+
 	/* The addresses are converted from QEMU virtual to Vhost virtual. */
 	len = sizeof(struct vring_desc) * vq->size;
 	vq->desc = (struct vring_desc *)(uintptr_t)qva_to_vva(dev,
@@ -45,6 +45,10 @@ spdk_scsi_lun_complete_task(struct spdk_scsi_lun *lun, struct spdk_scsi_task *ta
 {
 	if (lun) {
 		TAILQ_REMOVE(&lun->tasks, task, scsi_link);
+		if (task->initiator_port) {
+			assert(task->initiator_port->num_tasks > 0);
+			task->initiator_port->num_tasks--;
+		}
 		spdk_trace_record(TRACE_SCSI_TASK_DONE, lun->dev->id, 0, (uintptr_t)task, 0);
 	}
 	task->cpl_fn(task);
@@ -54,6 +58,10 @@ static void
 scsi_lun_complete_mgmt_task(struct spdk_scsi_lun *lun, struct spdk_scsi_task *task)
 {
 	TAILQ_REMOVE(&lun->mgmt_tasks, task, scsi_link);
+	if (task->initiator_port) {
+		assert(task->initiator_port->num_mgmt_tasks > 0);
+		task->initiator_port->num_mgmt_tasks--;
+	}
 
 	task->cpl_fn(task);
 
@@ -165,6 +173,9 @@ spdk_scsi_lun_append_mgmt_task(struct spdk_scsi_lun *lun,
 			       struct spdk_scsi_task *task)
 {
 	TAILQ_INSERT_TAIL(&lun->pending_mgmt_tasks, task, scsi_link);
+	if (task->initiator_port) {
+		task->initiator_port->num_mgmt_tasks++;
+	}
 }
 
 void
@@ -226,6 +237,9 @@ void
 spdk_scsi_lun_append_task(struct spdk_scsi_lun *lun, struct spdk_scsi_task *task)
 {
 	TAILQ_INSERT_TAIL(&lun->pending_tasks, task, scsi_link);
+	if (task->initiator_port) {
+		task->initiator_port->num_tasks++;
+	}
 }
 
 static void
@@ -554,6 +568,11 @@ spdk_scsi_lun_has_pending_mgmt_tasks(const struct spdk_scsi_lun *lun,
 		return scsi_lun_has_pending_mgmt_tasks(lun);
 	}
 
+	/* Most of the time nothing is pending for the port on any LUN. */
+	if (initiator_port->num_mgmt_tasks == 0) {
+		return false;
+	}
+
 	TAILQ_FOREACH(task, &lun->pending_mgmt_tasks, scsi_link) {
 		if (task->initiator_port == initiator_port) {
 			return true;
@@ -579,6 +598,10 @@ spdk_scsi_lun_has_pending_tasks(const struct spdk_scsi_lun *lun,
 		return scsi_lun_has_pending_tasks(lun);
 	}
 
+	if (initiator_port->num_tasks == 0) {
+		return false;
+	}
+
 	TAILQ_FOREACH(task, &lun->pending_tasks, scsi_link) {
 		if (task->initiator_port == initiator_port) {
 			return true;
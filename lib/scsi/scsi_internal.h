@@ -58,6 +58,13 @@ struct spdk_scsi_port {
 	uint16_t		transport_id_len;
 	char			transport_id[SPDK_SCSI_MAX_TRANSPORT_ID_LENGTH];
 	char			name[SPDK_SCSI_PORT_MAX_NAME_LENGTH];
+
+	/*
+	 * Number of tasks and management tasks which were queued to any LUN through
+	 *  this port as the initiator port and are not completed yet.
+	 */
+	uint32_t		num_tasks;
+	uint32_t		num_mgmt_tasks;
 };
 
 /* Registrant with I_T nextus */
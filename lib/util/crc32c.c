@@ -32,6 +32,7 @@
  */
 
 #include "spdk/crc32.h"
+#include "spdk/util.h"
 
 #ifdef SPDK_CONFIG_ISAL
 #define SPDK_HAVE_ISAL
@@ -88,6 +89,12 @@ spdk_crc32c_update(const void *buf, size_t len, uint32_t crc)
 	return crc;
 }
 
+static inline uint32_t
+crc32c_u64(uint32_t crc, uint64_t block)
+{
+	return (uint32_t)_mm_crc32_u64(crc, block);
+}
+
 #elif defined(SPDK_HAVE_ARM_CRC)
 
 uint32_t
@@ -113,6 +120,12 @@ spdk_crc32c_update(const void *buf, size_t len, uint32_t crc)
 	return crc;
 }
 
+static inline uint32_t
+crc32c_u64(uint32_t crc, uint64_t block)
+{
+	return __crc32cd(crc, block);
+}
+
 #else /* Neither SSE 4.2 nor ARM CRC32 instructions available */
 
 static struct spdk_crc32_table g_crc32c_table;
@@ -130,3 +143,70 @@ spdk_crc32c_update(const void *buf, size_t len, uint32_t crc)
 }
 
 #endif
+
+#if defined(SPDK_HAVE_SSE4_2) || defined(SPDK_HAVE_ARM_CRC)
+
+/*
+ * The CRC32 instruction has a latency of several cycles but can be issued every cycle,
+ *  so a single buffer leaves most of its throughput unused. Interleave three buffers
+ *  over their common length and finish each one separately.
+ */
+static void
+crc32c_update_x3(const void *const *bufs, const size_t *lens, uint32_t *crcs)
+{
+	const uint8_t *buf0 = bufs[0], *buf1 = bufs[1], *buf2 = bufs[2];
+	uint32_t crc0 = crcs[0], crc1 = crcs[1], crc2 = crcs[2];
+	uint64_t block0, block1, block2;
+	size_t count, done;
+
+	count = spdk_min(lens[0], spdk_min(lens[1], lens[2])) / 8;
+	done = count * 8;
+
+	while (count--) {
+		memcpy(&block0, buf0, sizeof(block0));
+		memcpy(&block1, buf1, sizeof(block1));
+		memcpy(&block2, buf2, sizeof(block2));
+		crc0 = crc32c_u64(crc0, block0);
+		crc1 = crc32c_u64(crc1, block1);
+		crc2 = crc32c_u64(crc2, block2);
+		buf0 += sizeof(block0);
+		buf1 += sizeof(block1);
+		buf2 += sizeof(block2);
+	}
+
+	crcs[0] = spdk_crc32c_update(buf0, lens[0] - done, crc0);
+	crcs[1] = spdk_crc32c_update(buf1, lens[1] - done, crc1);
+	crcs[2] = spdk_crc32c_update(buf2, lens[2] - done, crc2);
+}
+
+void
+spdk_crc32c_update_multi(const void *const *bufs, const size_t *lens, uint32_t *crcs, int num)
+{
+	int i;
+
+	for (i = 0; i + 3 <= num; i += 3) {
+		crc32c_update_x3(&bufs[i], &lens[i], &crcs[i]);
+	}
+
+	for (; i < num; i++) {
+		crcs[i] = spdk_crc32c_update(bufs[i], lens[i], crcs[i]);
+	}
+}
+
+#else
+
+/*
+ * ISA-L already splits each buffer into interleaved streams and the table based
+ *  fallback has nothing to gain from it, so just checksum the buffers one by one.
+ */
+void
+spdk_crc32c_update_multi(const void *const *bufs, const size_t *lens, uint32_t *crcs, int num)
+{
+	int i;
+
+	for (i = 0; i < num; i++) {
+		crcs[i] = spdk_crc32c_update(bufs[i], lens[i], crcs[i]);
+	}
+}
+
+#endif
@@ -33,6 +33,8 @@
 
 #include "spdk/stdinc.h"
 
+#include <sys/epoll.h>
+
 #include "spdk/env.h"
 #include "spdk/likely.h"
 #include "spdk/string.h"
@@ -147,8 +149,13 @@ vhost_log_used_vring_elem(struct spdk_vhost_session *vsession,
 		return;
 	}
 
-	offset = offsetof(struct vring_used, ring[idx]);
-	len = sizeof(virtqueue->vring.used->ring[idx]);
+	if (spdk_unlikely(virtqueue->packed.packed_ring)) {
+		offset = idx * sizeof(struct vring_packed_desc);
+		len = sizeof(struct vring_packed_desc);
+	} else {
+		offset = offsetof(struct vring_used, ring[idx]);
+		len = sizeof(virtqueue->vring.used->ring[idx]);
+	}
 	vq_idx = virtqueue - vsession->virtqueue;
 
 	rte_vhost_log_used_vring(vsession->vid, vq_idx, offset, len);
@@ -245,6 +252,113 @@ vhost_vq_get_desc(struct spdk_vhost_session *vsession, struct spdk_vhost_virtque
 	return 0;
 }
 
+bool
+vhost_vq_packed_ring_is_avail(struct spdk_vhost_virtqueue *virtqueue)
+{
+	uint16_t flags = virtqueue->vring.desc_packed[virtqueue->last_avail_idx].flags;
+
+	/* The driver marks a descriptor available by setting its F_AVAIL bit
+	 * to the avail wrap counter (and F_USED to the inverse of it).
+	 */
+	return !!(flags & VRING_DESC_F_AVAIL) == virtqueue->packed.avail_phase &&
+	       !!(flags & VRING_DESC_F_USED) != virtqueue->packed.avail_phase;
+}
+
+static bool
+vhost_vring_packed_desc_is_indirect(struct vring_packed_desc *cur_desc)
+{
+	return !!(cur_desc->flags & VRING_DESC_F_INDIRECT);
+}
+
+uint16_t
+vhost_vq_packed_ring_get_buffer_id(struct spdk_vhost_virtqueue *virtqueue, uint16_t *num_descs)
+{
+	struct vring_packed_desc *desc;
+	uint16_t size = virtqueue->vring.size;
+	uint16_t req_idx = virtqueue->last_avail_idx;
+
+	/* The buffer id is stored in the last descriptor of the chain. Chains
+	 * are written to consecutive ring entries, so this is a sequential walk.
+	 */
+	*num_descs = 1;
+	desc = &virtqueue->vring.desc_packed[req_idx];
+	if (!vhost_vring_packed_desc_is_indirect(desc)) {
+		while ((desc->flags & VRING_DESC_F_NEXT) != 0 && *num_descs < size) {
+			req_idx = req_idx + 1 < size ? req_idx + 1 : 0;
+			desc = &virtqueue->vring.desc_packed[req_idx];
+			(*num_descs)++;
+		}
+	}
+
+	/* Packed ring size doesn't have to be a power of 2. */
+	virtqueue->last_avail_idx += *num_descs;
+	if (virtqueue->last_avail_idx >= size) {
+		virtqueue->last_avail_idx -= size;
+		virtqueue->packed.avail_phase = !virtqueue->packed.avail_phase;
+	}
+
+	SPDK_DEBUGLOG(SPDK_LOG_VHOST_RING,
+		      "AVAIL: buffer_id=%"PRIu16" num_descs=%"PRIu16" last_avail_idx=%"PRIu16"\n",
+		      desc->id, *num_descs, virtqueue->last_avail_idx);
+
+	return desc->id;
+}
+
+void
+vhost_vq_packed_ring_enqueue(struct spdk_vhost_session *vsession,
+			     struct spdk_vhost_virtqueue *virtqueue,
+			     uint16_t num_descs, uint16_t buffer_id, uint32_t len)
+{
+	struct vring_packed_desc *desc = &virtqueue->vring.desc_packed[virtqueue->last_used_idx];
+	uint16_t flags;
+
+	SPDK_DEBUGLOG(SPDK_LOG_VHOST_RING,
+		      "Queue %td - USED RING: last_idx=%"PRIu16" buffer_id=%"PRIu16" len=%"PRIu32"\n",
+		      virtqueue - vsession->virtqueue, virtqueue->last_used_idx, buffer_id, len);
+
+	/* Used descriptors only carry the buffer id and the written length. */
+	desc->id = buffer_id;
+	desc->len = len;
+
+	flags = desc->flags & ~(VRING_DESC_F_AVAIL_USED | VRING_DESC_F_WRITE);
+	if (len != 0) {
+		flags |= VRING_DESC_F_WRITE;
+	}
+
+	/* The driver may consider the descriptor used as soon as it sees the
+	 * flags, so id and len must be visible first. A used descriptor has
+	 * both F_AVAIL and F_USED set to the used wrap counter.
+	 */
+	spdk_smp_wmb();
+	if (virtqueue->packed.used_phase) {
+		flags |= VRING_DESC_F_AVAIL_USED;
+	}
+	*(volatile uint16_t *)&desc->flags = flags;
+
+	vhost_log_used_vring_elem(vsession, virtqueue, virtqueue->last_used_idx);
+
+	virtqueue->last_used_idx += num_descs;
+	if (virtqueue->last_used_idx >= virtqueue->vring.size) {
+		virtqueue->last_used_idx -= virtqueue->vring.size;
+		virtqueue->packed.used_phase = !virtqueue->packed.used_phase;
+	}
+
+	virtqueue->used_req_cnt++;
+}
+
+static bool
+vhost_vq_event_is_suppressed(struct spdk_vhost_virtqueue *virtqueue)
+{
+	if (spdk_unlikely(virtqueue->packed.packed_ring)) {
+		/* Without VIRTIO_RING_F_EVENT_IDX the driver can only turn
+		 * the events on or off entirely.
+		 */
+		return virtqueue->vring.driver_event->flags == VRING_PACKED_EVENT_FLAG_DISABLE;
+	}
+
+	return !!(virtqueue->vring.avail->flags & VRING_AVAIL_F_NO_INTERRUPT);
+}
+
 int
 vhost_vq_used_signal(struct spdk_vhost_session *vsession,
 		     struct spdk_vhost_virtqueue *virtqueue)
@@ -271,75 +385,275 @@ vhost_vq_used_signal(struct spdk_vhost_session *vsession,
 
 
 static void
-check_session_io_stats(struct spdk_vhost_session *vsession, uint64_t now)
+check_vq_io_stats(struct spdk_vhost_session *vsession, struct spdk_vhost_virtqueue *virtqueue,
+		  uint64_t now)
 {
-	struct spdk_vhost_virtqueue *virtqueue;
 	uint32_t irq_delay_base = vsession->coalescing_delay_time_base;
 	uint32_t io_threshold = vsession->coalescing_io_rate_threshold;
 	int32_t irq_delay;
 	uint32_t req_cnt;
-	uint16_t q_idx;
 
-	if (now < vsession->next_stats_check_time) {
+	if (now < virtqueue->next_stats_check_time) {
 		return;
 	}
 
-	vsession->next_stats_check_time = now + vsession->stats_check_interval;
-	for (q_idx = 0; q_idx < vsession->max_queues; q_idx++) {
-		virtqueue = &vsession->virtqueue[q_idx];
+	virtqueue->next_stats_check_time = now + vsession->stats_check_interval;
 
-		req_cnt = virtqueue->req_cnt + virtqueue->used_req_cnt;
-		if (req_cnt <= io_threshold) {
-			continue;
+	req_cnt = virtqueue->req_cnt + virtqueue->used_req_cnt;
+	if (req_cnt <= io_threshold) {
+		return;
+	}
+
+	irq_delay = (irq_delay_base * (req_cnt - io_threshold)) / io_threshold;
+	virtqueue->irq_delay_time = (uint32_t) spdk_max(0, irq_delay);
+
+	virtqueue->req_cnt = 0;
+	virtqueue->next_event_time = now;
+}
+
+void
+vhost_session_vq_used_signal(struct spdk_vhost_session *vsession,
+			     struct spdk_vhost_virtqueue *virtqueue)
+{
+	uint64_t now;
+
+	if (virtqueue->vring.desc == NULL) {
+		return;
+	}
+
+	if (vsession->coalescing_delay_time_base == 0) {
+		if (vhost_vq_event_is_suppressed(virtqueue)) {
+			return;
 		}
 
-		irq_delay = (irq_delay_base * (req_cnt - io_threshold)) / io_threshold;
-		virtqueue->irq_delay_time = (uint32_t) spdk_max(0, irq_delay);
+		vhost_vq_used_signal(vsession, virtqueue);
+		return;
+	}
+
+	now = spdk_get_ticks();
+	check_vq_io_stats(vsession, virtqueue, now);
+
+	/* No need for event right now */
+	if (now < virtqueue->next_event_time ||
+	    vhost_vq_event_is_suppressed(virtqueue)) {
+		return;
+	}
 
-		virtqueue->req_cnt = 0;
-		virtqueue->next_event_time = now;
+	if (!vhost_vq_used_signal(vsession, virtqueue)) {
+		return;
 	}
+
+	/* Syscall is quite long so update time */
+	now = spdk_get_ticks();
+	virtqueue->next_event_time = now + virtqueue->irq_delay_time;
 }
 
 void
 vhost_session_used_signal(struct spdk_vhost_session *vsession)
 {
-	struct spdk_vhost_virtqueue *virtqueue;
-	uint64_t now;
 	uint16_t q_idx;
 
-	if (vsession->coalescing_delay_time_base == 0) {
-		for (q_idx = 0; q_idx < vsession->max_queues; q_idx++) {
-			virtqueue = &vsession->virtqueue[q_idx];
+	for (q_idx = 0; q_idx < vsession->max_queues; q_idx++) {
+		vhost_session_vq_used_signal(vsession, &vsession->virtqueue[q_idx]);
+	}
+}
 
-			if (virtqueue->vring.desc == NULL ||
-			    (virtqueue->vring.avail->flags & VRING_AVAIL_F_NO_INTERRUPT)) {
-				continue;
-			}
+static void
+vhost_vq_set_notification(struct spdk_vhost_virtqueue *virtqueue, bool enable)
+{
+	if (virtqueue->packed.packed_ring) {
+		virtqueue->vring.device_event->flags = enable ? VRING_PACKED_EVENT_FLAG_ENABLE :
+						       VRING_PACKED_EVENT_FLAG_DISABLE;
+	} else {
+		virtqueue->vring.used->flags = enable ? 0 : VRING_USED_F_NO_NOTIFY;
+	}
+}
+
+static bool
+vhost_vq_has_avail(struct spdk_vhost_virtqueue *virtqueue)
+{
+	if (virtqueue->packed.packed_ring) {
+		return vhost_vq_packed_ring_is_avail(virtqueue);
+	}
+
+	return *(volatile uint16_t *)&virtqueue->vring.avail->idx != virtqueue->last_avail_idx;
+}
 
-			vhost_vq_used_signal(vsession, virtqueue);
+static void
+vhost_poller_intr_resume(struct vhost_poller_intr *intr)
+{
+	struct spdk_vhost_session *vsession = intr->vsession;
+	struct vhost_poll_group *pg = intr->pg;
+	struct spdk_vhost_virtqueue *vq;
+	uint32_t q_idx;
+
+	for (q_idx = intr->first_q; q_idx < vsession->max_queues; q_idx += intr->q_step) {
+		vq = &vsession->virtqueue[q_idx];
+		/* The eventfd might have been closed already, so ignore any errors */
+		epoll_ctl(pg->epfd, EPOLL_CTL_DEL, vq->vring.kickfd, NULL);
+		vhost_vq_set_notification(vq, false);
+		vq->intr = NULL;
+	}
+
+	intr->suspended = false;
+	intr->idle_tsc = 0;
+	spdk_poller_resume(intr->poller);
+
+	assert(pg->suspended_cnt > 0);
+	if (--pg->suspended_cnt == 0) {
+		spdk_poller_unregister(&pg->kick_poller);
+	}
+}
+
+static int
+vhost_poll_group_kick_poller(void *arg)
+{
+	struct vhost_poll_group *pg = arg;
+	struct epoll_event events[32];
+	struct spdk_vhost_virtqueue *vq;
+	uint64_t val;
+	int i, rc;
+
+	rc = epoll_wait(pg->epfd, events, SPDK_COUNTOF(events), 0);
+	for (i = 0; i < rc; i++) {
+		vq = events[i].data.ptr;
+
+		/* The eventfd is readable, so this doesn't block */
+		if (read(vq->vring.kickfd, &val, sizeof(val)) < 0) {
+			SPDK_DEBUGLOG(SPDK_LOG_VHOST, "Failed to read kick eventfd %d: %s\n",
+				      vq->vring.kickfd, spdk_strerror(errno));
 		}
-	} else {
-		now = spdk_get_ticks();
-		check_session_io_stats(vsession, now);
 
-		for (q_idx = 0; q_idx < vsession->max_queues; q_idx++) {
-			virtqueue = &vsession->virtqueue[q_idx];
+		if (vq->intr != NULL) {
+			vhost_poller_intr_resume(vq->intr);
+		}
+	}
 
-			/* No need for event right now */
-			if (now < virtqueue->next_event_time ||
-			    (virtqueue->vring.avail->flags & VRING_AVAIL_F_NO_INTERRUPT)) {
-				continue;
-			}
+	return rc > 0 ? rc : 0;
+}
 
-			if (!vhost_vq_used_signal(vsession, virtqueue)) {
-				continue;
-			}
+static bool
+vhost_poller_intr_suspend(struct vhost_poller_intr *intr)
+{
+	struct spdk_vhost_session *vsession = intr->vsession;
+	struct vhost_poll_group *pg = intr->pg;
+	struct spdk_vhost_virtqueue *vq;
+	struct epoll_event event = {};
+	uint32_t q_idx;
+
+	if (pg->epfd < 0 || intr->first_q >= vsession->max_queues) {
+		return false;
+	}
+
+	for (q_idx = intr->first_q; q_idx < vsession->max_queues; q_idx += intr->q_step) {
+		vq = &vsession->virtqueue[q_idx];
+		if (vq->vring.kickfd < 0) {
+			return false;
+		}
+	}
+
+	for (q_idx = intr->first_q; q_idx < vsession->max_queues; q_idx += intr->q_step) {
+		vq = &vsession->virtqueue[q_idx];
+		/* Flush any coalesced interrupts, nobody will send them later */
+		vq->next_event_time = 0;
+		vhost_vq_used_signal(vsession, vq);
+		vhost_vq_set_notification(vq, true);
+	}
+
+	/* The driver either sees the notifications enabled, or we see its new
+	 * requests below.
+	 */
+	spdk_mb();
+
+	for (q_idx = intr->first_q; q_idx < vsession->max_queues; q_idx += intr->q_step) {
+		vq = &vsession->virtqueue[q_idx];
+		if (vhost_vq_has_avail(vq)) {
+			goto err;
+		}
 
-			/* Syscall is quite long so update time */
-			now = spdk_get_ticks();
-			virtqueue->next_event_time = now + virtqueue->irq_delay_time;
+		event.events = EPOLLIN;
+		event.data.ptr = vq;
+		if (epoll_ctl(pg->epfd, EPOLL_CTL_ADD, vq->vring.kickfd, &event) != 0) {
+			SPDK_ERRLOG("%s: failed to watch kick eventfd of queue %"PRIu32": %s\n",
+				    vsession->name, q_idx, spdk_strerror(errno));
+			goto err;
 		}
+
+		vq->intr = intr;
+	}
+
+	spdk_poller_pause(intr->poller);
+	intr->suspended = true;
+	if (pg->suspended_cnt++ == 0) {
+		pg->kick_poller = spdk_poller_register(vhost_poll_group_kick_poller, pg,
+						       SPDK_VHOST_KICK_CHECK_PERIOD_US);
+	}
+
+	SPDK_DEBUGLOG(SPDK_LOG_VHOST, "%s: suspended poller of idle queue %"PRIu16"\n",
+		      vsession->name, intr->first_q);
+	return true;
+
+err:
+	for (q_idx = intr->first_q; q_idx < vsession->max_queues; q_idx += intr->q_step) {
+		vq = &vsession->virtqueue[q_idx];
+		epoll_ctl(pg->epfd, EPOLL_CTL_DEL, vq->vring.kickfd, NULL);
+		vhost_vq_set_notification(vq, false);
+		vq->intr = NULL;
+	}
+
+	return false;
+}
+
+void
+vhost_poller_intr_init(struct vhost_poller_intr *intr, struct spdk_vhost_session *vsession,
+		       struct vhost_poll_group *pg, struct spdk_poller *poller,
+		       uint16_t first_q, uint16_t q_step)
+{
+	assert(pg->thread == spdk_get_thread());
+	assert(q_step > 0);
+
+	intr->vsession = vsession;
+	intr->pg = pg;
+	intr->poller = poller;
+	intr->first_q = first_q;
+	intr->q_step = q_step;
+	intr->suspended = false;
+	intr->idle_tsc = 0;
+	intr->idle_timeout_ticks = SPDK_VHOST_IDLE_TIMEOUT_US * spdk_get_ticks_hz() /
+				   SPDK_SEC_TO_USEC;
+}
+
+void
+vhost_poller_intr_update(struct vhost_poller_intr *intr, bool idle)
+{
+	uint64_t now;
+
+	if (spdk_likely(!idle)) {
+		intr->idle_tsc = 0;
+		return;
+	}
+
+	now = spdk_get_ticks();
+	if (intr->idle_tsc == 0) {
+		intr->idle_tsc = now;
+		return;
+	}
+
+	if (now - intr->idle_tsc < intr->idle_timeout_ticks) {
+		return;
+	}
+
+	if (!vhost_poller_intr_suspend(intr)) {
+		/* Try again after another idle period */
+		intr->idle_tsc = now;
+	}
+}
+
+void
+vhost_poller_intr_fini(struct vhost_poller_intr *intr)
+{
+	if (intr->suspended) {
+		vhost_poller_intr_resume(intr);
 	}
 }
 
@@ -468,13 +782,13 @@ vhost_vring_desc_is_wr(struct vring_desc *cur_desc)
 	return !!(cur_desc->flags & VRING_DESC_F_WRITE);
 }
 
-int
-vhost_vring_desc_to_iov(struct spdk_vhost_session *vsession, struct iovec *iov,
-			uint16_t *iov_index, const struct vring_desc *desc)
+static int
+vhost_gpa_to_iov(struct spdk_vhost_session *vsession, struct iovec *iov,
+		 uint16_t *iov_index, uint64_t addr, uint32_t desc_len)
 {
 	uint64_t len;
-	uint64_t remaining = desc->len;
-	uintptr_t payload = desc->addr;
+	uint64_t remaining = desc_len;
+	uintptr_t payload = addr;
 	uintptr_t vva;
 
 	do {
@@ -498,6 +812,119 @@ vhost_vring_desc_to_iov(struct spdk_vhost_session *vsession, struct iovec *iov,
 	return 0;
 }
 
+int
+vhost_vring_desc_to_iov(struct spdk_vhost_session *vsession, struct iovec *iov,
+			uint16_t *iov_index, const struct vring_desc *desc)
+{
+	return vhost_gpa_to_iov(vsession, iov, iov_index, desc->addr, desc->len);
+}
+
+static void
+vhost_vring_desc_iter_load(struct vhost_vring_desc_iter *iter)
+{
+	if (iter->desc == NULL) {
+		return;
+	}
+
+	if (iter->vq->packed.packed_ring) {
+		iter->addr = iter->desc_packed->addr;
+		iter->len = iter->desc_packed->len;
+		iter->wr = !!(iter->desc_packed->flags & VRING_DESC_F_WRITE);
+	} else {
+		iter->addr = iter->desc->addr;
+		iter->len = iter->desc->len;
+		iter->wr = vhost_vring_desc_is_wr(iter->desc);
+	}
+}
+
+int
+vhost_vring_desc_iter_init(struct spdk_vhost_session *vsession,
+			   struct spdk_vhost_virtqueue *virtqueue, uint16_t req_idx,
+			   struct vhost_vring_desc_iter *iter)
+{
+	struct vring_packed_desc *desc;
+	int rc;
+
+	iter->vq = virtqueue;
+	iter->desc_cnt = 1;
+
+	if (!virtqueue->packed.packed_ring) {
+		rc = vhost_vq_get_desc(vsession, virtqueue, req_idx, &iter->desc, &iter->desc_table,
+				       &iter->desc_table_size);
+		if (rc != 0) {
+			iter->desc = NULL;
+			return rc;
+		}
+
+		vhost_vring_desc_iter_load(iter);
+		return 0;
+	}
+
+	if (spdk_unlikely(req_idx >= virtqueue->vring.size)) {
+		iter->desc = NULL;
+		return -1;
+	}
+
+	desc = &virtqueue->vring.desc_packed[req_idx];
+	if (vhost_vring_packed_desc_is_indirect(desc)) {
+		/* Indirect tables are walked sequentially, F_NEXT is unused there. */
+		iter->indirect = true;
+		iter->desc_idx = 0;
+		iter->desc_table_size = desc->len / sizeof(*desc);
+		iter->desc_table_packed = vhost_gpa_to_vva(vsession, desc->addr,
+					  sizeof(*desc) * iter->desc_table_size);
+		if (iter->desc_table_packed == NULL || iter->desc_table_size == 0) {
+			iter->desc = NULL;
+			return -1;
+		}
+		iter->desc_packed = iter->desc_table_packed;
+	} else {
+		iter->indirect = false;
+		iter->desc_idx = req_idx;
+		iter->desc_table_size = virtqueue->vring.size;
+		iter->desc_table_packed = virtqueue->vring.desc_packed;
+		iter->desc_packed = desc;
+	}
+
+	vhost_vring_desc_iter_load(iter);
+	return 0;
+}
+
+int
+vhost_vring_desc_iter_next(struct vhost_vring_desc_iter *iter)
+{
+	int rc = 0;
+
+	if (!iter->vq->packed.packed_ring) {
+		rc = vhost_vring_desc_get_next(&iter->desc, iter->desc_table, iter->desc_table_size);
+	} else if (iter->indirect) {
+		iter->desc_idx++;
+		iter->desc_packed = iter->desc_idx < iter->desc_table_size ?
+				    &iter->desc_table_packed[iter->desc_idx] : NULL;
+	} else if ((iter->desc_packed->flags & VRING_DESC_F_NEXT) == 0) {
+		iter->desc_packed = NULL;
+	} else {
+		iter->desc_idx = iter->desc_idx + 1 < iter->desc_table_size ? iter->desc_idx + 1 : 0;
+		iter->desc_packed = &iter->desc_table_packed[iter->desc_idx];
+	}
+
+	if (iter->desc != NULL && spdk_unlikely(++iter->desc_cnt > iter->desc_table_size)) {
+		/* Break a cycle */
+		iter->desc = NULL;
+		return -1;
+	}
+
+	vhost_vring_desc_iter_load(iter);
+	return rc;
+}
+
+int
+vhost_vring_desc_iter_to_iov(struct spdk_vhost_session *vsession, struct iovec *iov,
+			     uint16_t *iov_index, const struct vhost_vring_desc_iter *iter)
+{
+	return vhost_gpa_to_iov(vsession, iov, iov_index, iter->addr, iter->len);
+}
+
 static struct spdk_vhost_session *
 vhost_session_find_by_id(struct spdk_vhost_dev *vdev, unsigned id)
 {
@@ -706,32 +1133,59 @@ spdk_vhost_dev_get_cpumask(struct spdk_vhost_dev *vdev)
 	return &vdev->cpumask;
 }
 
-struct vhost_poll_group *
-vhost_get_poll_group(struct spdk_cpuset *cpumask)
+uint32_t
+vhost_get_poll_groups(struct spdk_cpuset *cpumask, struct vhost_poll_group **pgs,
+		      uint32_t max_pgs)
 {
 	struct vhost_poll_group *pg, *selected_pg;
-	uint32_t min_ctrlrs;
+	uint32_t pg_cnt, i;
 
-	min_ctrlrs = INT_MAX;
-	selected_pg = TAILQ_FIRST(&g_poll_groups);
+	for (pg_cnt = 0; pg_cnt < max_pgs; pg_cnt++) {
+		selected_pg = NULL;
 
-	TAILQ_FOREACH(pg, &g_poll_groups, tailq) {
-		spdk_cpuset_copy(&g_tmp_cpuset, cpumask);
-		spdk_cpuset_and(&g_tmp_cpuset, spdk_thread_get_cpumask(pg->thread));
+		TAILQ_FOREACH(pg, &g_poll_groups, tailq) {
+			spdk_cpuset_copy(&g_tmp_cpuset, cpumask);
+			spdk_cpuset_and(&g_tmp_cpuset, spdk_thread_get_cpumask(pg->thread));
 
-		/* ignore threads which could be relocated to a non-masked cpu. */
-		if (!spdk_cpuset_equal(&g_tmp_cpuset, spdk_thread_get_cpumask(pg->thread))) {
-			continue;
+			/* ignore threads which could be relocated to a non-masked cpu. */
+			if (!spdk_cpuset_equal(&g_tmp_cpuset, spdk_thread_get_cpumask(pg->thread))) {
+				continue;
+			}
+
+			for (i = 0; i < pg_cnt; i++) {
+				if (pgs[i] == pg) {
+					break;
+				}
+			}
+
+			if (i == pg_cnt && (selected_pg == NULL || pg->ref < selected_pg->ref)) {
+				selected_pg = pg;
+			}
 		}
 
-		if (pg->ref < min_ctrlrs) {
-			selected_pg = pg;
-			min_ctrlrs = pg->ref;
+		if (selected_pg == NULL) {
+			break;
 		}
+
+		pgs[pg_cnt] = selected_pg;
+	}
+
+	if (pg_cnt == 0 && max_pgs > 0) {
+		pgs[0] = TAILQ_FIRST(&g_poll_groups);
+		assert(pgs[0] != NULL);
+		pg_cnt = 1;
 	}
 
-	assert(selected_pg != NULL);
-	return selected_pg;
+	return pg_cnt;
+}
+
+struct vhost_poll_group *
+vhost_get_poll_group(struct spdk_cpuset *cpumask)
+{
+	struct vhost_poll_group *pg;
+
+	vhost_get_poll_groups(cpumask, &pg, 1);
+	return pg;
 }
 
 static struct vhost_poll_group *
@@ -989,7 +1443,14 @@ _stop_session(struct spdk_vhost_session *vsession)
 		if (q->vring.desc == NULL) {
 			continue;
 		}
-		rte_vhost_set_vring_base(vsession->vid, i, q->last_avail_idx, q->last_used_idx);
+		if (q->packed.packed_ring) {
+			rte_vhost_set_vring_base(vsession->vid, i,
+						 q->last_avail_idx | (q->packed.avail_phase << 15),
+						 q->last_used_idx | (q->packed.used_phase << 15));
+		} else {
+			rte_vhost_set_vring_base(vsession->vid, i, q->last_avail_idx,
+						 q->last_used_idx);
+		}
 	}
 
 	vhost_session_mem_unregister(vsession->mem);
@@ -1047,6 +1508,11 @@ vhost_start_device_cb(int vid)
 		goto out;
 	}
 
+	if (vhost_get_negotiated_features(vid, &vsession->negotiated_features) != 0) {
+		SPDK_ERRLOG("vhost device %d: Failed to get negotiated driver features\n", vid);
+		goto out;
+	}
+
 	vsession->max_queues = 0;
 	memset(vsession->virtqueue, 0, sizeof(vsession->virtqueue));
 	for (i = 0; i < SPDK_VHOST_MAX_VQUEUES; i++) {
@@ -1068,16 +1534,25 @@ vhost_start_device_cb(int vid)
 			continue;
 		}
 
-		/* Disable I/O submission notifications, we'll be polling. */
-		q->vring.used->flags = VRING_USED_F_NO_NOTIFY;
+		if (vhost_dev_has_feature(vsession, VIRTIO_F_RING_PACKED)) {
+			/* Packed virtqueues have at most 2^15 entries, the top bit
+			 * of the vring base carries the wrap counter.
+			 */
+			q->packed.packed_ring = true;
+			q->packed.avail_phase = q->last_avail_idx >> 15;
+			q->last_avail_idx &= 0x7FFF;
+			q->packed.used_phase = q->last_used_idx >> 15;
+			q->last_used_idx &= 0x7FFF;
+
+			/* Disable I/O submission notifications, we'll be polling. */
+			q->vring.device_event->flags = VRING_PACKED_EVENT_FLAG_DISABLE;
+		} else {
+			/* Disable I/O submission notifications, we'll be polling. */
+			q->vring.used->flags = VRING_USED_F_NO_NOTIFY;
+		}
 		vsession->max_queues = i + 1;
 	}
 
-	if (vhost_get_negotiated_features(vid, &vsession->negotiated_features) != 0) {
-		SPDK_ERRLOG("vhost device %d: Failed to get negotiated driver features\n", vid);
-		goto out;
-	}
-
 	if (vhost_get_mem_table(vid, &vsession->mem) != 0) {
 		SPDK_ERRLOG("vhost device %d: Failed to get guest memory table\n", vid);
 		goto out;
@@ -1252,7 +1727,6 @@ vhost_new_connection_cb(int vid, const char *ifname)
 	vsession->poll_group = NULL;
 	vsession->started = false;
 	vsession->initialized = false;
-	vsession->next_stats_check_time = 0;
 	vsession->stats_check_interval = SPDK_VHOST_STATS_CHECK_INTERVAL_MS *
 					 spdk_get_ticks_hz() / 1000UL;
 	TAILQ_INSERT_TAIL(&vdev->vsessions, vsession, tailq);
@@ -1355,6 +1829,12 @@ vhost_create_poll_group(void *ctx)
 	}
 
 	pg->thread = spdk_get_thread();
+	pg->epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (pg->epfd < 0) {
+		/* Not fatal, the virtqueues will be just polled all the time */
+		SPDK_WARNLOG("Failed to create epoll fd: %s\n", spdk_strerror(errno));
+	}
+
 	TAILQ_INSERT_TAIL(&g_poll_groups, pg, tailq);
 }
 
@@ -1417,6 +1897,9 @@ _spdk_vhost_fini(void *arg1)
 	sem_destroy(&g_dpdk_sem);
 	TAILQ_FOREACH_SAFE(pg, &g_poll_groups, tailq, tpg) {
 		TAILQ_REMOVE(&g_poll_groups, pg, tailq);
+		if (pg->epfd >= 0) {
+			close(pg->epfd);
+		}
 		free(pg);
 	}
 	g_fini_cpl_cb();
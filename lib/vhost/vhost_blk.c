@@ -53,27 +53,41 @@
 		(1ULL << VIRTIO_BLK_F_SCSI)     | (1ULL << VIRTIO_BLK_F_CONFIG_WCE) | \
 		(1ULL << VIRTIO_BLK_F_MQ))
 
-/* Not supported features */
-#define SPDK_VHOST_BLK_DISABLED_FEATURES (SPDK_VHOST_DISABLED_FEATURES | \
-		(1ULL << VIRTIO_BLK_F_GEOMETRY) | (1ULL << VIRTIO_BLK_F_CONFIG_WCE) | \
-		(1ULL << VIRTIO_BLK_F_BARRIER)  | (1ULL << VIRTIO_BLK_F_SCSI))
-
 /* Vhost-blk support protocol features */
 #ifndef SPDK_CONFIG_VHOST_INTERNAL_LIB
 #define SPDK_VHOST_BLK_PROTOCOL_FEATURES ((1ULL << VHOST_USER_PROTOCOL_F_CONFIG) | \
 		(1ULL << VHOST_USER_PROTOCOL_F_INFLIGHT_SHMFD))
+/*
+ * In-flight requests are only tracked for split virtqueues, so packed ones would
+ * lose their outstanding requests when the backend reconnects.
+ */
+#define SPDK_VHOST_BLK_INFLIGHT_DISABLED_FEATURES (1ULL << VIRTIO_F_RING_PACKED)
 #else
 #define SPDK_VHOST_BLK_PROTOCOL_FEATURES (1ULL << VHOST_USER_PROTOCOL_F_CONFIG)
+#define SPDK_VHOST_BLK_INFLIGHT_DISABLED_FEATURES 0
 #endif
 
+/* Not supported features */
+#define SPDK_VHOST_BLK_DISABLED_FEATURES (SPDK_VHOST_DISABLED_FEATURES | \
+		(1ULL << VIRTIO_BLK_F_GEOMETRY) | (1ULL << VIRTIO_BLK_F_CONFIG_WCE) | \
+		(1ULL << VIRTIO_BLK_F_BARRIER)  | (1ULL << VIRTIO_BLK_F_SCSI) | \
+		SPDK_VHOST_BLK_INFLIGHT_DISABLED_FEATURES)
+
+/* Maximum size of a bdev I/O built out of merged requests */
+#define SPDK_VHOST_BLK_MAX_MERGE_SIZE (128 * 1024)
+
 struct spdk_vhost_blk_task {
 	struct spdk_bdev_io *bdev_io;
 	struct spdk_vhost_blk_session *bvsession;
+	struct spdk_vhost_blk_queue_group *group;
 	struct spdk_vhost_virtqueue *vq;
 
 	volatile uint8_t *status;
 
 	uint16_t req_idx;
+	/* Buffer id and number of ring entries of a packed virtqueue request */
+	uint16_t buffer_id;
+	uint16_t num_descs;
 
 	/* for io wait */
 	struct spdk_bdev_io_wait_entry bdev_io_wait;
@@ -85,6 +99,33 @@ struct spdk_vhost_blk_task {
 	uint32_t used_len;
 	uint16_t iovcnt;
 	struct iovec iovs[SPDK_VHOST_IOVS_MAX];
+
+	/* VIRTIO_BLK_T_* type of the request, with the barrier flag cleared */
+	uint32_t type;
+
+	/* Read or write request range */
+	bool write;
+	uint64_t offset;
+	uint64_t num_bytes;
+
+	/* Next request merged into this one's bdev I/O. If set on the first
+	 * request, num_bytes and merge_iovs describe the whole bdev I/O.
+	 */
+	struct spdk_vhost_blk_task *merge_next;
+	struct iovec *merge_iovs;
+	uint16_t merge_iovcnt;
+};
+
+/*
+ * Read and write requests taken from a virtqueue within a single poll
+ * that are waiting to be submitted. Requests of the same type that are
+ * adjacent on the bdev are submitted as a single vectored bdev I/O.
+ */
+struct vhost_blk_merge {
+	struct spdk_vhost_blk_task *head;
+	struct spdk_vhost_blk_task *tail;
+	uint64_t num_bytes;
+	uint16_t iovcnt;
 };
 
 struct spdk_vhost_blk_dev {
@@ -92,14 +133,39 @@ struct spdk_vhost_blk_dev {
 	struct spdk_bdev *bdev;
 	struct spdk_bdev_desc *bdev_desc;
 	bool readonly;
+	bool merge_requests;
+	/* Set under the vhost lock once the bdev is hot-removed, no new channels may be taken */
+	bool bdev_removing;
+};
+
+/*
+ * Set of virtqueues of a session polled by a single thread with its own
+ * bdev channel. Group 0 always runs on the session's own thread.
+ */
+struct spdk_vhost_blk_queue_group {
+	struct spdk_vhost_blk_session *bvsession;
+	struct vhost_poll_group *pg;
+	struct spdk_poller *requestq_poller;
+	struct spdk_poller *stop_poller;
+	struct spdk_io_channel *io_channel;
+	struct vhost_poller_intr intr;
+
+	/* Number of tasks of this group currently in flight */
+	int task_cnt;
+
+	/* Index of this group. It polls virtqueues idx, idx + num_groups, ... */
+	uint16_t idx;
 };
 
 struct spdk_vhost_blk_session {
 	/* The parent session must be the very first field in this struct */
 	struct spdk_vhost_session vsession;
 	struct spdk_vhost_blk_dev *bvdev;
-	struct spdk_poller *requestq_poller;
-	struct spdk_io_channel *io_channel;
+	struct spdk_vhost_blk_queue_group *groups;
+	uint16_t num_groups;
+
+	/* Number of groups that haven't finished stopping yet. */
+	uint16_t num_groups_running;
 	struct spdk_poller *stop_poller;
 };
 
@@ -109,13 +175,14 @@ static const struct spdk_vhost_dev_backend vhost_blk_device_backend;
 static int
 process_blk_request(struct spdk_vhost_blk_task *task,
 		    struct spdk_vhost_blk_session *bvsession,
-		    struct spdk_vhost_virtqueue *vq);
+		    struct spdk_vhost_virtqueue *vq,
+		    struct vhost_blk_merge *merge);
 
 static void
 blk_task_finish(struct spdk_vhost_blk_task *task)
 {
-	assert(task->bvsession->vsession.task_cnt > 0);
-	task->bvsession->vsession.task_cnt--;
+	assert(task->group->task_cnt > 0);
+	task->group->task_cnt--;
 	task->used = false;
 }
 
@@ -126,6 +193,19 @@ blk_task_init(struct spdk_vhost_blk_task *task)
 	task->iovcnt = SPDK_COUNTOF(task->iovs);
 	task->status = NULL;
 	task->used_len = 0;
+	task->merge_next = NULL;
+}
+
+static void
+blk_task_enqueue(struct spdk_vhost_blk_task *task)
+{
+	if (task->vq->packed.packed_ring) {
+		vhost_vq_packed_ring_enqueue(&task->bvsession->vsession, task->vq, task->num_descs,
+					     task->buffer_id, task->used_len);
+	} else {
+		vhost_vq_used_ring_enqueue(&task->bvsession->vsession, task->vq, task->req_idx,
+					   task->used_len);
+	}
 }
 
 static void
@@ -135,8 +215,7 @@ invalid_blk_request(struct spdk_vhost_blk_task *task, uint8_t status)
 		*task->status = status;
 	}
 
-	vhost_vq_used_ring_enqueue(&task->bvsession->vsession, task->vq, task->req_idx,
-				   task->used_len);
+	blk_task_enqueue(task);
 	blk_task_finish(task);
 	SPDK_DEBUGLOG(SPDK_LOG_VHOST_BLK_DATA, "Invalid request (status=%" PRIu8")\n", status);
 }
@@ -154,19 +233,17 @@ blk_iovs_setup(struct spdk_vhost_blk_session *bvsession, struct spdk_vhost_virtq
 {
 	struct spdk_vhost_session *vsession = &bvsession->vsession;
 	struct spdk_vhost_dev *vdev = vsession->vdev;
-	struct vring_desc *desc, *desc_table;
+	struct vhost_vring_desc_iter iter;
 	uint16_t out_cnt = 0, cnt = 0;
-	uint32_t desc_table_size, len = 0;
-	uint32_t desc_handled_cnt;
+	uint32_t len = 0;
 	int rc;
 
-	rc = vhost_vq_get_desc(vsession, vq, req_idx, &desc, &desc_table, &desc_table_size);
+	rc = vhost_vring_desc_iter_init(vsession, vq, req_idx, &iter);
 	if (rc != 0) {
 		SPDK_ERRLOG("%s: invalid descriptor at index %"PRIu16".\n", vdev->name, req_idx);
 		return -1;
 	}
 
-	desc_handled_cnt = 0;
 	while (1) {
 		/*
 		 * Maximum cnt reached?
@@ -178,32 +255,25 @@ blk_iovs_setup(struct spdk_vhost_blk_session *bvsession, struct spdk_vhost_virtq
 			return -1;
 		}
 
-		if (spdk_unlikely(vhost_vring_desc_to_iov(vsession, iovs, &cnt, desc))) {
+		if (spdk_unlikely(vhost_vring_desc_iter_to_iov(vsession, iovs, &cnt, &iter))) {
 			SPDK_DEBUGLOG(SPDK_LOG_VHOST_BLK, "%s: invalid descriptor %" PRIu16" (req_idx = %"PRIu16").\n",
 				      vsession->name, req_idx, cnt);
 			return -1;
 		}
 
-		len += desc->len;
+		len += iter.len;
 
-		out_cnt += vhost_vring_desc_is_wr(desc);
+		out_cnt += iter.wr;
 
-		rc = vhost_vring_desc_get_next(&desc, desc_table, desc_table_size);
+		rc = vhost_vring_desc_iter_next(&iter);
 		if (rc != 0) {
+			/* Either an invalid index or a cycle in the chain. */
 			SPDK_ERRLOG("%s: descriptor chain at index %"PRIu16" terminated unexpectedly.\n",
 				    vsession->name, req_idx);
 			return -1;
-		} else if (desc == NULL) {
+		} else if (iter.desc == NULL) {
 			break;
 		}
-
-		desc_handled_cnt++;
-		if (spdk_unlikely(desc_handled_cnt > desc_table_size)) {
-			/* Break a cycle and report an error, if any. */
-			SPDK_ERRLOG("%s: found a cycle in the descriptor chain: desc_table_size = %d, desc_handled_cnt = %d.\n",
-				    vsession->name, desc_table_size, desc_handled_cnt);
-			return -1;
-		}
 	}
 
 	/*
@@ -224,13 +294,26 @@ static void
 blk_request_finish(bool success, struct spdk_vhost_blk_task *task)
 {
 	*task->status = success ? VIRTIO_BLK_S_OK : VIRTIO_BLK_S_IOERR;
-	vhost_vq_used_ring_enqueue(&task->bvsession->vsession, task->vq, task->req_idx,
-				   task->used_len);
+	blk_task_enqueue(task);
 	SPDK_DEBUGLOG(SPDK_LOG_VHOST_BLK, "Finished task (%p) req_idx=%d\n status: %s\n", task,
 		      task->req_idx, success ? "OK" : "FAIL");
 	blk_task_finish(task);
 }
 
+/* Finish a request along with all the requests merged into it */
+static void
+blk_merged_request_finish(bool success, struct spdk_vhost_blk_task *task)
+{
+	struct spdk_vhost_blk_task *next;
+
+	do {
+		next = task->merge_next;
+		task->merge_next = NULL;
+		blk_request_finish(success, task);
+		task = next;
+	} while (task != NULL);
+}
+
 static void
 blk_request_complete_cb(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
 {
@@ -241,18 +324,94 @@ blk_request_complete_cb(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg
 }
 
 static void
-blk_request_resubmit(void *arg)
+blk_merged_request_complete_cb(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
 {
-	struct spdk_vhost_blk_task *task = (struct spdk_vhost_blk_task *)arg;
-	int rc = 0;
+	struct spdk_vhost_blk_task *task = cb_arg;
 
-	blk_task_init(task);
+	spdk_bdev_free_io(bdev_io);
+	blk_merged_request_finish(success, task);
+}
 
-	rc = process_blk_request(task, task->bvsession, task->vq);
-	if (rc == 0) {
-		SPDK_DEBUGLOG(SPDK_LOG_VHOST_BLK, "====== Task %p resubmitted ======\n", task);
+static inline void blk_request_queue_io(struct spdk_vhost_blk_task *task);
+
+static int
+blk_request_submit_rw(struct spdk_vhost_blk_task *task)
+{
+	struct spdk_vhost_blk_dev *bvdev = task->bvsession->bvdev;
+	spdk_bdev_io_completion_cb cb;
+	struct iovec *iovs;
+	int iovcnt;
+
+	if (task->merge_next == NULL) {
+		iovs = &task->iovs[1];
+		iovcnt = task->iovcnt;
+		cb = blk_request_complete_cb;
 	} else {
+		iovs = task->merge_iovs;
+		iovcnt = task->merge_iovcnt;
+		cb = blk_merged_request_complete_cb;
+	}
+
+	if (task->write) {
+		return spdk_bdev_writev(bvdev->bdev_desc, task->group->io_channel, iovs, iovcnt,
+					task->offset, task->num_bytes, cb, task);
+	} else {
+		return spdk_bdev_readv(bvdev->bdev_desc, task->group->io_channel, iovs, iovcnt,
+				       task->offset, task->num_bytes, cb, task);
+	}
+}
+
+/* Submit the bdev I/O of an already parsed request */
+static int
+blk_request_submit(struct spdk_vhost_blk_task *task)
+{
+	struct spdk_vhost_blk_dev *bvdev = task->bvsession->bvdev;
+	struct virtio_blk_discard_write_zeroes *desc;
+	uint64_t flush_bytes;
+
+	switch (task->type) {
+	case VIRTIO_BLK_T_IN:
+	case VIRTIO_BLK_T_OUT:
+		return blk_request_submit_rw(task);
+	case VIRTIO_BLK_T_DISCARD:
+		desc = task->iovs[1].iov_base;
+		return spdk_bdev_unmap(bvdev->bdev_desc, task->group->io_channel,
+				       desc->sector * 512, desc->num_sectors * 512,
+				       blk_request_complete_cb, task);
+	case VIRTIO_BLK_T_WRITE_ZEROES:
+		desc = task->iovs[1].iov_base;
+		return spdk_bdev_write_zeroes(bvdev->bdev_desc, task->group->io_channel,
+					      desc->sector * 512, desc->num_sectors * 512,
+					      blk_request_complete_cb, task);
+	case VIRTIO_BLK_T_FLUSH:
+		flush_bytes = spdk_bdev_get_num_blocks(bvdev->bdev) * spdk_bdev_get_block_size(bvdev->bdev);
+		return spdk_bdev_flush(bvdev->bdev_desc, task->group->io_channel,
+				       0, flush_bytes,
+				       blk_request_complete_cb, task);
+	default:
+		assert(false);
+		return -EINVAL;
+	}
+}
+
+/*
+ * The descriptor chain is not parsed again, since on packed rings its slots
+ * may already have been overwritten by the used descriptors of other requests.
+ */
+static void
+blk_request_resubmit(void *arg)
+{
+	struct spdk_vhost_blk_task *task = arg;
+	int rc;
+
+	rc = blk_request_submit(task);
+	if (rc == -ENOMEM) {
+		blk_request_queue_io(task);
+	} else if (rc != 0) {
 		SPDK_DEBUGLOG(SPDK_LOG_VHOST_BLK, "====== Task %p failed ======\n", task);
+		blk_merged_request_finish(false, task);
+	} else {
+		SPDK_DEBUGLOG(SPDK_LOG_VHOST_BLK, "====== Task %p resubmitted ======\n", task);
 	}
 }
 
@@ -267,17 +426,84 @@ blk_request_queue_io(struct spdk_vhost_blk_task *task)
 	task->bdev_io_wait.cb_fn = blk_request_resubmit;
 	task->bdev_io_wait.cb_arg = task;
 
-	rc = spdk_bdev_queue_io_wait(bdev, bvsession->io_channel, &task->bdev_io_wait);
+	rc = spdk_bdev_queue_io_wait(bdev, task->group->io_channel, &task->bdev_io_wait);
 	if (rc != 0) {
 		SPDK_ERRLOG("%s: failed to queue I/O, rc=%d\n", bvsession->vsession.name, rc);
-		invalid_blk_request(task, VIRTIO_BLK_S_IOERR);
+		blk_merged_request_finish(false, task);
+	}
+}
+
+/* Submit the pending requests of a merge stage as a single bdev I/O */
+static void
+blk_merge_flush(struct vhost_blk_merge *merge)
+{
+	struct spdk_vhost_blk_task *head = merge->head;
+	struct spdk_vhost_blk_task *task;
+	int rc;
+
+	if (head == NULL) {
+		return;
+	}
+
+	merge->head = NULL;
+	merge->tail = NULL;
+
+	if (head->merge_next != NULL) {
+		head->merge_iovcnt = 0;
+		for (task = head; task != NULL; task = task->merge_next) {
+			memcpy(&head->merge_iovs[head->merge_iovcnt], &task->iovs[1],
+			       task->iovcnt * sizeof(struct iovec));
+			head->merge_iovcnt += task->iovcnt;
+		}
+		assert(head->merge_iovcnt == merge->iovcnt);
+		head->num_bytes = merge->num_bytes;
+
+		SPDK_DEBUGLOG(SPDK_LOG_VHOST_BLK, "Merged %s: %"PRIu64" bytes at %"PRIu64"\n",
+			      head->write ? "WRITE" : "READ", head->num_bytes, head->offset);
+	}
+
+	rc = blk_request_submit_rw(head);
+	if (rc == -ENOMEM) {
+		SPDK_DEBUGLOG(SPDK_LOG_VHOST_BLK, "No memory, start to queue io.\n");
+		blk_request_queue_io(head);
+	} else if (rc != 0) {
+		blk_merged_request_finish(false, head);
+	}
+}
+
+/*
+ * Add a read or write request to the merge stage. It's appended to the
+ * pending bdev I/O if it directly follows it, otherwise the pending bdev
+ * I/O is submitted and a new one is started.
+ */
+static void
+blk_merge_add(struct vhost_blk_merge *merge, struct spdk_vhost_blk_task *task)
+{
+	struct spdk_vhost_blk_task *tail = merge->tail;
+
+	if (tail != NULL && tail->write == task->write &&
+	    tail->offset + tail->num_bytes == task->offset &&
+	    merge->num_bytes + task->num_bytes <= SPDK_VHOST_BLK_MAX_MERGE_SIZE &&
+	    merge->iovcnt + task->iovcnt <= SPDK_VHOST_IOVS_MAX) {
+		tail->merge_next = task;
+		merge->tail = task;
+		merge->num_bytes += task->num_bytes;
+		merge->iovcnt += task->iovcnt;
+		return;
 	}
+
+	blk_merge_flush(merge);
+	merge->head = task;
+	merge->tail = task;
+	merge->num_bytes = task->num_bytes;
+	merge->iovcnt = task->iovcnt;
 }
 
 static int
 process_blk_request(struct spdk_vhost_blk_task *task,
 		    struct spdk_vhost_blk_session *bvsession,
-		    struct spdk_vhost_virtqueue *vq)
+		    struct spdk_vhost_virtqueue *vq,
+		    struct vhost_blk_merge *merge)
 {
 	struct spdk_vhost_blk_dev *bvdev = bvsession->bvdev;
 	const struct virtio_blk_outhdr *req;
@@ -285,7 +511,6 @@ process_blk_request(struct spdk_vhost_blk_task *task,
 	struct iovec *iov;
 	uint32_t type;
 	uint32_t payload_len;
-	uint64_t flush_bytes;
 	int rc;
 
 	if (blk_iovs_setup(bvsession, vq, task->req_idx, task->iovs, &task->iovcnt, &payload_len)) {
@@ -324,6 +549,12 @@ process_blk_request(struct spdk_vhost_blk_task *task,
 	/* Don't care about barier for now (as QEMU's virtio-blk do). */
 	type &= ~VIRTIO_BLK_T_BARRIER;
 #endif
+	task->type = type;
+
+	if (merge != NULL && type != VIRTIO_BLK_T_IN && type != VIRTIO_BLK_T_OUT) {
+		/* Don't submit other requests ahead of the reads and writes preceding them */
+		blk_merge_flush(merge);
+	}
 
 	switch (type) {
 	case VIRTIO_BLK_T_IN:
@@ -337,27 +568,22 @@ process_blk_request(struct spdk_vhost_blk_task *task,
 
 		if (type == VIRTIO_BLK_T_IN) {
 			task->used_len = payload_len + sizeof(*task->status);
-			rc = spdk_bdev_readv(bvdev->bdev_desc, bvsession->io_channel,
-					     &task->iovs[1], task->iovcnt, req->sector * 512,
-					     payload_len, blk_request_complete_cb, task);
 		} else if (!bvdev->readonly) {
 			task->used_len = sizeof(*task->status);
-			rc = spdk_bdev_writev(bvdev->bdev_desc, bvsession->io_channel,
-					      &task->iovs[1], task->iovcnt, req->sector * 512,
-					      payload_len, blk_request_complete_cb, task);
 		} else {
 			SPDK_DEBUGLOG(SPDK_LOG_VHOST_BLK, "Device is in read-only mode!\n");
-			rc = -1;
+			invalid_blk_request(task, VIRTIO_BLK_S_IOERR);
+			return -1;
 		}
 
-		if (rc) {
-			if (rc == -ENOMEM) {
-				SPDK_DEBUGLOG(SPDK_LOG_VHOST_BLK, "No memory, start to queue io.\n");
-				blk_request_queue_io(task);
-			} else {
-				invalid_blk_request(task, VIRTIO_BLK_S_IOERR);
-				return -1;
-			}
+		task->write = type == VIRTIO_BLK_T_OUT;
+		task->offset = req->sector * 512;
+		task->num_bytes = payload_len;
+
+		if (merge != NULL) {
+			/* Submitted by blk_merge_flush() */
+			blk_merge_add(merge, task);
+			return 0;
 		}
 		break;
 	case VIRTIO_BLK_T_DISCARD:
@@ -367,19 +593,6 @@ process_blk_request(struct spdk_vhost_blk_task *task,
 			invalid_blk_request(task, VIRTIO_BLK_S_IOERR);
 			return -1;
 		}
-
-		rc = spdk_bdev_unmap(bvdev->bdev_desc, bvsession->io_channel,
-				     desc->sector * 512, desc->num_sectors * 512,
-				     blk_request_complete_cb, task);
-		if (rc) {
-			if (rc == -ENOMEM) {
-				SPDK_DEBUGLOG(SPDK_LOG_VHOST_BLK, "No memory, start to queue io.\n");
-				blk_request_queue_io(task);
-			} else {
-				invalid_blk_request(task, VIRTIO_BLK_S_IOERR);
-				return -1;
-			}
-		}
 		break;
 	case VIRTIO_BLK_T_WRITE_ZEROES:
 		desc = task->iovs[1].iov_base;
@@ -395,39 +608,13 @@ process_blk_request(struct spdk_vhost_blk_task *task,
 			invalid_blk_request(task, VIRTIO_BLK_S_UNSUPP);
 			return -1;
 		}
-
-		rc = spdk_bdev_write_zeroes(bvdev->bdev_desc, bvsession->io_channel,
-					    desc->sector * 512, desc->num_sectors * 512,
-					    blk_request_complete_cb, task);
-		if (rc) {
-			if (rc == -ENOMEM) {
-				SPDK_DEBUGLOG(SPDK_LOG_VHOST_BLK, "No memory, start to queue io.\n");
-				blk_request_queue_io(task);
-			} else {
-				invalid_blk_request(task, VIRTIO_BLK_S_IOERR);
-				return -1;
-			}
-		}
 		break;
 	case VIRTIO_BLK_T_FLUSH:
-		flush_bytes = spdk_bdev_get_num_blocks(bvdev->bdev) * spdk_bdev_get_block_size(bvdev->bdev);
 		if (req->sector != 0) {
 			SPDK_NOTICELOG("sector must be zero for flush command\n");
 			invalid_blk_request(task, VIRTIO_BLK_S_IOERR);
 			return -1;
 		}
-		rc = spdk_bdev_flush(bvdev->bdev_desc, bvsession->io_channel,
-				     0, flush_bytes,
-				     blk_request_complete_cb, task);
-		if (rc) {
-			if (rc == -ENOMEM) {
-				SPDK_DEBUGLOG(SPDK_LOG_VHOST_BLK, "No memory, start to queue io.\n");
-				blk_request_queue_io(task);
-			} else {
-				invalid_blk_request(task, VIRTIO_BLK_S_IOERR);
-				return -1;
-			}
-		}
 		break;
 	case VIRTIO_BLK_T_GET_ID:
 		if (!task->iovcnt || !payload_len) {
@@ -438,13 +625,24 @@ process_blk_request(struct spdk_vhost_blk_task *task,
 		spdk_strcpy_pad(task->iovs[1].iov_base, spdk_bdev_get_product_name(bvdev->bdev),
 				task->used_len, ' ');
 		blk_request_finish(true, task);
-		break;
+		return 0;
 	default:
 		SPDK_DEBUGLOG(SPDK_LOG_VHOST_BLK, "Not supported request type '%"PRIu32"'.\n", type);
 		invalid_blk_request(task, VIRTIO_BLK_S_UNSUPP);
 		return -1;
 	}
 
+	rc = blk_request_submit(task);
+	if (rc) {
+		if (rc == -ENOMEM) {
+			SPDK_DEBUGLOG(SPDK_LOG_VHOST_BLK, "No memory, start to queue io.\n");
+			blk_request_queue_io(task);
+		} else {
+			invalid_blk_request(task, VIRTIO_BLK_S_IOERR);
+			return -1;
+		}
+	}
+
 	return 0;
 }
 
@@ -485,11 +683,11 @@ submit_inflight_desc(struct spdk_vhost_blk_session *bvsession,
 			continue;
 		}
 
-		vsession->task_cnt++;
+		task->group->task_cnt++;
 
 		blk_task_init(task);
 
-		rc = process_blk_request(task, bvsession, vq);
+		rc = process_blk_request(task, bvsession, vq, NULL);
 		if (rc == 0) {
 			SPDK_DEBUGLOG(SPDK_LOG_VHOST_BLK, "====== Task %p req_idx %d submitted ======\n", task,
 				      req_idx);
@@ -503,11 +701,12 @@ submit_inflight_desc(struct spdk_vhost_blk_session *bvsession,
 	resubmit->resubmit_list = NULL;
 }
 
-static void
+static uint16_t
 process_vq(struct spdk_vhost_blk_session *bvsession, struct spdk_vhost_virtqueue *vq)
 {
 	struct spdk_vhost_blk_task *task;
 	struct spdk_vhost_session *vsession = &bvsession->vsession;
+	struct vhost_blk_merge merge = {}, *mergep;
 	int rc;
 	uint16_t reqs[32];
 	uint16_t reqs_cnt, i;
@@ -517,9 +716,11 @@ process_vq(struct spdk_vhost_blk_session *bvsession, struct spdk_vhost_virtqueue
 
 	reqs_cnt = vhost_vq_avail_ring_get(vq, reqs, SPDK_COUNTOF(reqs));
 	if (!reqs_cnt) {
-		return;
+		return 0;
 	}
 
+	mergep = bvsession->bvdev->merge_requests ? &merge : NULL;
+
 	for (i = 0; i < reqs_cnt; i++) {
 		SPDK_DEBUGLOG(SPDK_LOG_VHOST_BLK, "====== Starting processing request idx %"PRIu16"======\n",
 			      reqs[i]);
@@ -540,11 +741,11 @@ process_vq(struct spdk_vhost_blk_session *bvsession, struct spdk_vhost_virtqueue
 			continue;
 		}
 
-		vsession->task_cnt++;
+		task->group->task_cnt++;
 
 		blk_task_init(task);
 
-		rc = process_blk_request(task, bvsession, vq);
+		rc = process_blk_request(task, bvsession, vq, mergep);
 		if (rc == 0) {
 			SPDK_DEBUGLOG(SPDK_LOG_VHOST_BLK, "====== Task %p req_idx %d submitted ======\n", task,
 				      reqs[i]);
@@ -552,21 +753,89 @@ process_vq(struct spdk_vhost_blk_session *bvsession, struct spdk_vhost_virtqueue
 			SPDK_DEBUGLOG(SPDK_LOG_VHOST_BLK, "====== Task %p req_idx %d failed ======\n", task, reqs[i]);
 		}
 	}
+
+	blk_merge_flush(&merge);
+	return reqs_cnt;
+}
+
+static uint16_t
+process_packed_vq(struct spdk_vhost_blk_session *bvsession, struct spdk_vhost_virtqueue *vq)
+{
+	struct spdk_vhost_blk_task *task;
+	struct spdk_vhost_session *vsession = &bvsession->vsession;
+	struct vhost_blk_merge merge = {}, *mergep;
+	uint16_t req_idx, buffer_id, num_descs;
+	uint16_t i;
+	int rc;
+
+	mergep = bvsession->bvdev->merge_requests ? &merge : NULL;
+	for (i = 0; i < 32 && vhost_vq_packed_ring_is_avail(vq); i++) {
+		req_idx = vq->last_avail_idx;
+		buffer_id = vhost_vq_packed_ring_get_buffer_id(vq, &num_descs);
+
+		SPDK_DEBUGLOG(SPDK_LOG_VHOST_BLK, "====== Starting processing request idx %"PRIu16"======\n",
+			      req_idx);
+
+		/* Tasks of packed virtqueues are indexed by the buffer id. */
+		if (spdk_unlikely(buffer_id >= vq->vring.size)) {
+			SPDK_ERRLOG("%s: buffer id '%"PRIu16"' exceeds virtqueue size (%"PRIu16").\n",
+				    vsession->name, buffer_id, vq->vring.size);
+			vhost_vq_packed_ring_enqueue(vsession, vq, num_descs, buffer_id, 0);
+			continue;
+		}
+
+		task = &((struct spdk_vhost_blk_task *)vq->tasks)[buffer_id];
+		if (spdk_unlikely(task->used)) {
+			SPDK_ERRLOG("%s: request with buffer id '%"PRIu16"' is already pending.\n",
+				    vsession->name, buffer_id);
+			vhost_vq_packed_ring_enqueue(vsession, vq, num_descs, buffer_id, 0);
+			continue;
+		}
+
+		task->group->task_cnt++;
+
+		blk_task_init(task);
+		task->req_idx = req_idx;
+		task->buffer_id = buffer_id;
+		task->num_descs = num_descs;
+
+		rc = process_blk_request(task, bvsession, vq, mergep);
+		if (rc == 0) {
+			SPDK_DEBUGLOG(SPDK_LOG_VHOST_BLK, "====== Task %p req_idx %d submitted ======\n", task,
+				      req_idx);
+		} else {
+			SPDK_DEBUGLOG(SPDK_LOG_VHOST_BLK, "====== Task %p req_idx %d failed ======\n", task,
+				      req_idx);
+		}
+	}
+
+	blk_merge_flush(&merge);
+	return i;
 }
 
 static int
 vdev_worker(void *arg)
 {
-	struct spdk_vhost_blk_session *bvsession = arg;
+	struct spdk_vhost_blk_queue_group *group = arg;
+	struct spdk_vhost_blk_session *bvsession = group->bvsession;
 	struct spdk_vhost_session *vsession = &bvsession->vsession;
+	struct spdk_vhost_virtqueue *vq;
+	uint32_t reqs_cnt = 0;
 
 	uint16_t q_idx;
 
-	for (q_idx = 0; q_idx < vsession->max_queues; q_idx++) {
-		process_vq(bvsession, &vsession->virtqueue[q_idx]);
+	for (q_idx = group->idx; q_idx < vsession->max_queues; q_idx += bvsession->num_groups) {
+		vq = &vsession->virtqueue[q_idx];
+		if (vq->packed.packed_ring) {
+			reqs_cnt += process_packed_vq(bvsession, vq);
+		} else {
+			reqs_cnt += process_vq(bvsession, vq);
+		}
+
+		vhost_session_vq_used_signal(vsession, vq);
 	}
 
-	vhost_session_used_signal(vsession);
+	vhost_poller_intr_update(&group->intr, reqs_cnt == 0 && group->task_cnt == 0);
 
 	return -1;
 }
@@ -577,9 +846,15 @@ no_bdev_process_vq(struct spdk_vhost_blk_session *bvsession, struct spdk_vhost_v
 	struct spdk_vhost_session *vsession = &bvsession->vsession;
 	struct iovec iovs[SPDK_VHOST_IOVS_MAX];
 	uint32_t length;
-	uint16_t iovcnt, req_idx;
+	uint16_t iovcnt, req_idx, buffer_id = 0, num_descs = 0;
 
-	if (vhost_vq_avail_ring_get(vq, &req_idx, 1) != 1) {
+	if (vq->packed.packed_ring) {
+		if (!vhost_vq_packed_ring_is_avail(vq)) {
+			return;
+		}
+		req_idx = vq->last_avail_idx;
+		buffer_id = vhost_vq_packed_ring_get_buffer_id(vq, &num_descs);
+	} else if (vhost_vq_avail_ring_get(vq, &req_idx, 1) != 1) {
 		return;
 	}
 
@@ -589,25 +864,31 @@ no_bdev_process_vq(struct spdk_vhost_blk_session *bvsession, struct spdk_vhost_v
 		SPDK_DEBUGLOG(SPDK_LOG_VHOST_BLK_DATA, "Aborting request %" PRIu16"\n", req_idx);
 	}
 
-	vhost_vq_used_ring_enqueue(vsession, vq, req_idx, 0);
+	if (vq->packed.packed_ring) {
+		vhost_vq_packed_ring_enqueue(vsession, vq, num_descs, buffer_id, 0);
+	} else {
+		vhost_vq_used_ring_enqueue(vsession, vq, req_idx, 0);
+	}
 }
 
 static int
 no_bdev_vdev_worker(void *arg)
 {
-	struct spdk_vhost_blk_session *bvsession = arg;
+	struct spdk_vhost_blk_queue_group *group = arg;
+	struct spdk_vhost_blk_session *bvsession = group->bvsession;
 	struct spdk_vhost_session *vsession = &bvsession->vsession;
+	struct spdk_vhost_virtqueue *vq;
 	uint16_t q_idx;
 
-	for (q_idx = 0; q_idx < vsession->max_queues; q_idx++) {
-		no_bdev_process_vq(bvsession, &vsession->virtqueue[q_idx]);
+	for (q_idx = group->idx; q_idx < vsession->max_queues; q_idx += bvsession->num_groups) {
+		vq = &vsession->virtqueue[q_idx];
+		no_bdev_process_vq(bvsession, vq);
+		vhost_session_vq_used_signal(vsession, vq);
 	}
 
-	vhost_session_used_signal(vsession);
-
-	if (vsession->task_cnt == 0 && bvsession->io_channel) {
-		spdk_put_io_channel(bvsession->io_channel);
-		bvsession->io_channel = NULL;
+	if (group->task_cnt == 0 && group->io_channel) {
+		spdk_put_io_channel(group->io_channel);
+		group->io_channel = NULL;
 	}
 
 	return -1;
@@ -645,16 +926,56 @@ spdk_vhost_blk_get_dev(struct spdk_vhost_dev *vdev)
 }
 
 static void
-vhost_dev_bdev_remove_cpl_cb(struct spdk_vhost_dev *vdev, void *ctx)
+vhost_dev_bdev_close_cpl(void *ctx)
 {
+	struct spdk_vhost_blk_dev *bvdev = ctx;
 
-	/* All sessions have been notified, time to close the bdev */
-	struct spdk_vhost_blk_dev *bvdev = to_blk_dev(vdev);
+	if (spdk_vhost_trylock() != 0) {
+		spdk_thread_send_msg(spdk_get_thread(), vhost_dev_bdev_close_cpl, ctx);
+		return;
+	}
 
-	assert(bvdev != NULL);
+	/* All queue groups have stopped submitting I/O, time to close the bdev */
+	assert(bvdev->vdev.pending_async_op_num > 0);
+	bvdev->vdev.pending_async_op_num--;
 	spdk_bdev_close(bvdev->bdev_desc);
 	bvdev->bdev_desc = NULL;
 	bvdev->bdev = NULL;
+
+	spdk_vhost_unlock();
+}
+
+static void
+vhost_dev_bdev_close_msg(void *ctx)
+{
+}
+
+static void
+vhost_dev_bdev_remove_cpl_cb(struct spdk_vhost_dev *vdev, void *ctx)
+{
+
+	/* All sessions have been notified, but their secondary queue groups
+	 * might still be switching to the no-bdev pollers. Go through all
+	 * threads once, so that those messages are processed before the bdev
+	 * is closed.
+	 */
+	struct spdk_vhost_blk_dev *bvdev = to_blk_dev(vdev);
+
+	assert(bvdev != NULL);
+	vdev->pending_async_op_num++;
+	spdk_for_each_thread(vhost_dev_bdev_close_msg, bvdev, vhost_dev_bdev_close_cpl);
+}
+
+static void
+vhost_blk_group_bdev_remove(void *arg)
+{
+	struct spdk_vhost_blk_queue_group *group = arg;
+
+	if (group->requestq_poller) {
+		vhost_poller_intr_fini(&group->intr);
+		spdk_poller_unregister(&group->requestq_poller);
+		group->requestq_poller = spdk_poller_register(no_bdev_vdev_worker, group, 0);
+	}
 }
 
 static int
@@ -663,11 +984,18 @@ vhost_session_bdev_remove_cb(struct spdk_vhost_dev *vdev,
 			     void *ctx)
 {
 	struct spdk_vhost_blk_session *bvsession;
+	uint16_t i;
 
 	bvsession = (struct spdk_vhost_blk_session *)vsession;
-	if (bvsession->requestq_poller) {
-		spdk_poller_unregister(&bvsession->requestq_poller);
-		bvsession->requestq_poller = spdk_poller_register(no_bdev_vdev_worker, bvsession, 0);
+	if (!vsession->started || bvsession->stop_poller != NULL) {
+		/* Stopping queue groups don't submit any new I/O */
+		return 0;
+	}
+
+	vhost_blk_group_bdev_remove(&bvsession->groups[0]);
+	for (i = 1; i < bvsession->num_groups; i++) {
+		spdk_thread_send_msg(bvsession->groups[i].pg->thread, vhost_blk_group_bdev_remove,
+				     &bvsession->groups[i]);
 	}
 
 	return 0;
@@ -682,6 +1010,10 @@ bdev_remove_cb(void *remove_ctx)
 		     bvdev->vdev.name);
 
 	spdk_vhost_lock();
+	/* Sessions started from now on, possibly while the already running ones are
+	 * being switched over, must not get a channel on the descriptor being closed.
+	 */
+	bvdev->bdev_removing = true;
 	vhost_dev_foreach_session(&bvdev->vdev, vhost_session_bdev_remove_cb,
 				  vhost_dev_bdev_remove_cpl_cb, NULL);
 	spdk_vhost_unlock();
@@ -711,10 +1043,20 @@ alloc_task_pool(struct spdk_vhost_blk_session *bvsession)
 	struct spdk_vhost_session *vsession = &bvsession->vsession;
 	struct spdk_vhost_virtqueue *vq;
 	struct spdk_vhost_blk_task *task;
+	struct iovec *merge_iovs;
 	uint32_t task_cnt;
+	size_t task_size;
 	uint16_t i;
 	uint32_t j;
 
+	/* Any task might become the first one of a merged bdev I/O, so each
+	 * gets a separate iovec array for it, placed after all the tasks.
+	 */
+	task_size = sizeof(struct spdk_vhost_blk_task);
+	if (bvsession->bvdev->merge_requests) {
+		task_size += SPDK_VHOST_IOVS_MAX * sizeof(struct iovec);
+	}
+
 	for (i = 0; i < vsession->max_queues; i++) {
 		vq = &vsession->virtqueue[i];
 		if (vq->vring.desc == NULL) {
@@ -729,7 +1071,7 @@ alloc_task_pool(struct spdk_vhost_blk_session *bvsession)
 			free_task_pool(bvsession);
 			return -1;
 		}
-		vq->tasks = spdk_zmalloc(sizeof(struct spdk_vhost_blk_task) * task_cnt,
+		vq->tasks = spdk_zmalloc(task_size * task_cnt,
 					 SPDK_CACHE_LINE_SIZE, NULL,
 					 SPDK_ENV_LCORE_ID_ANY, SPDK_MALLOC_DMA);
 		if (vq->tasks == NULL) {
@@ -739,17 +1081,57 @@ alloc_task_pool(struct spdk_vhost_blk_session *bvsession)
 			return -1;
 		}
 
+		merge_iovs = (struct iovec *)&((struct spdk_vhost_blk_task *)vq->tasks)[task_cnt];
 		for (j = 0; j < task_cnt; j++) {
 			task = &((struct spdk_vhost_blk_task *)vq->tasks)[j];
 			task->bvsession = bvsession;
+			task->group = &bvsession->groups[i % bvsession->num_groups];
 			task->req_idx = j;
 			task->vq = vq;
+			if (bvsession->bvdev->merge_requests) {
+				task->merge_iovs = &merge_iovs[j * SPDK_VHOST_IOVS_MAX];
+			}
+		}
+	}
+
+	return 0;
+}
+
+static int
+vhost_blk_group_start(struct spdk_vhost_blk_queue_group *group)
+{
+	struct spdk_vhost_blk_session *bvsession = group->bvsession;
+	struct spdk_vhost_blk_dev *bvdev = bvsession->bvdev;
+	bool has_bdev = bvdev->bdev != NULL && !bvdev->bdev_removing;
+
+	if (has_bdev) {
+		group->io_channel = spdk_bdev_get_io_channel(bvdev->bdev_desc);
+		if (!group->io_channel) {
+			SPDK_ERRLOG("%s: I/O channel allocation failed\n", bvsession->vsession.name);
+			return -1;
 		}
 	}
 
+	group->requestq_poller = spdk_poller_register(has_bdev ? vdev_worker : no_bdev_vdev_worker,
+				 group, 0);
+	vhost_poller_intr_init(&group->intr, &bvsession->vsession, group->pg, group->requestq_poller,
+			       group->idx, bvsession->num_groups);
+	SPDK_INFOLOG(SPDK_LOG_VHOST, "%s: started poller for queue group %"PRIu16" on lcore %d\n",
+		     bvsession->vsession.name, group->idx, spdk_env_get_current_core());
 	return 0;
 }
 
+static void
+vhost_blk_group_start_msg(void *arg)
+{
+	struct spdk_vhost_blk_queue_group *group = arg;
+
+	if (vhost_blk_group_start(group) != 0) {
+		/* The session is already running, so just fail the I/O of this group */
+		group->requestq_poller = spdk_poller_register(no_bdev_vdev_worker, group, 0);
+	}
+}
+
 static int
 vhost_blk_start_cb(struct spdk_vhost_dev *vdev,
 		   struct spdk_vhost_session *vsession, void *unused)
@@ -777,20 +1159,21 @@ vhost_blk_start_cb(struct spdk_vhost_dev *vdev,
 		goto out;
 	}
 
-	if (bvdev->bdev) {
-		bvsession->io_channel = spdk_bdev_get_io_channel(bvdev->bdev_desc);
-		if (!bvsession->io_channel) {
-			free_task_pool(bvsession);
-			SPDK_ERRLOG("%s: I/O channel allocation failed\n", vsession->name);
-			rc = -1;
-			goto out;
-		}
+	rc = vhost_blk_group_start(&bvsession->groups[0]);
+	if (rc != 0) {
+		free_task_pool(bvsession);
+		goto out;
 	}
 
-	bvsession->requestq_poller = spdk_poller_register(bvdev->bdev ? vdev_worker : no_bdev_vdev_worker,
-				     bvsession, 0);
-	SPDK_INFOLOG(SPDK_LOG_VHOST, "%s: started poller on lcore %d\n",
-		     vsession->name, spdk_env_get_current_core());
+	/* The other groups are started asynchronously. Messages sent to their
+	 * threads later on, e.g. the stop request, will be processed after this one.
+	 */
+	for (i = 1; i < bvsession->num_groups; i++) {
+		spdk_thread_send_msg(bvsession->groups[i].pg->thread, vhost_blk_group_start_msg,
+				     &bvsession->groups[i]);
+	}
+
+	bvsession->num_groups_running = bvsession->num_groups;
 out:
 	vhost_session_start_done(vsession, rc);
 	return rc;
@@ -799,11 +1182,43 @@ out:
 static int
 vhost_blk_start(struct spdk_vhost_session *vsession)
 {
-	struct vhost_poll_group *pg;
+	struct spdk_vhost_blk_session *bvsession = to_blk_session(vsession);
+	struct vhost_poll_group *pgs[SPDK_VHOST_MAX_VQUEUES];
+	uint32_t num_pgs;
+	uint16_t i;
+	int rc;
+
+	/* Spread the virtqueues over as many threads allowed by the cpumask as possible */
+	num_pgs = vhost_get_poll_groups(&vsession->vdev->cpumask, pgs,
+					spdk_max(vsession->max_queues, 1));
+	bvsession->groups = calloc(num_pgs, sizeof(*bvsession->groups));
+	if (bvsession->groups == NULL) {
+		SPDK_ERRLOG("%s: failed to allocate queue groups\n", vsession->name);
+		return -ENOMEM;
+	}
+
+	bvsession->num_groups = num_pgs;
+	for (i = 0; i < num_pgs; i++) {
+		bvsession->groups[i].bvsession = bvsession;
+		bvsession->groups[i].pg = pgs[i];
+		bvsession->groups[i].idx = i;
+	}
 
-	pg = vhost_get_poll_group(&vsession->vdev->cpumask);
-	return vhost_session_send_event(pg, vsession, vhost_blk_start_cb,
-					3, "start session");
+	rc = vhost_session_send_event(pgs[0], vsession, vhost_blk_start_cb,
+				      3, "start session");
+	if (rc != 0) {
+		free(bvsession->groups);
+		bvsession->groups = NULL;
+		bvsession->num_groups = 0;
+		return rc;
+	}
+
+	/* The first poll group is referenced by the session itself */
+	for (i = 1; i < num_pgs; i++) {
+		pgs[i]->ref++;
+	}
+
+	return 0;
 }
 
 static int
@@ -813,7 +1228,7 @@ destroy_session_poller_cb(void *arg)
 	struct spdk_vhost_session *vsession = &bvsession->vsession;
 	int i;
 
-	if (vsession->task_cnt > 0) {
+	if (bvsession->num_groups_running > 0) {
 		return -1;
 	}
 
@@ -829,12 +1244,17 @@ destroy_session_poller_cb(void *arg)
 	SPDK_INFOLOG(SPDK_LOG_VHOST, "%s: stopping poller on lcore %d\n",
 		     vsession->name, spdk_env_get_current_core());
 
-	if (bvsession->io_channel) {
-		spdk_put_io_channel(bvsession->io_channel);
-		bvsession->io_channel = NULL;
+	free_task_pool(bvsession);
+
+	for (i = 1; i < bvsession->num_groups; i++) {
+		assert(bvsession->groups[i].pg->ref > 0);
+		bvsession->groups[i].pg->ref--;
 	}
 
-	free_task_pool(bvsession);
+	free(bvsession->groups);
+	bvsession->groups = NULL;
+	bvsession->num_groups = 0;
+
 	spdk_poller_unregister(&bvsession->stop_poller);
 	vhost_session_stop_done(vsession, 0);
 
@@ -842,13 +1262,59 @@ destroy_session_poller_cb(void *arg)
 	return -1;
 }
 
+static void
+vhost_blk_group_stopped(void *arg)
+{
+	struct spdk_vhost_blk_session *bvsession = arg;
+
+	assert(bvsession->num_groups_running > 0);
+	bvsession->num_groups_running--;
+}
+
+static int
+vhost_blk_group_stop_poller_cb(void *arg)
+{
+	struct spdk_vhost_blk_queue_group *group = arg;
+	struct spdk_vhost_blk_session *bvsession = group->bvsession;
+
+	if (group->task_cnt > 0) {
+		return -1;
+	}
+
+	if (group->io_channel) {
+		spdk_put_io_channel(group->io_channel);
+		group->io_channel = NULL;
+	}
+
+	spdk_poller_unregister(&group->stop_poller);
+	spdk_thread_send_msg(bvsession->vsession.poll_group->thread, vhost_blk_group_stopped,
+			     bvsession);
+	return -1;
+}
+
+static void
+vhost_blk_group_stop(void *arg)
+{
+	struct spdk_vhost_blk_queue_group *group = arg;
+
+	vhost_poller_intr_fini(&group->intr);
+	spdk_poller_unregister(&group->requestq_poller);
+	group->stop_poller = spdk_poller_register(vhost_blk_group_stop_poller_cb, group, 1000);
+}
+
 static int
 vhost_blk_stop_cb(struct spdk_vhost_dev *vdev,
 		  struct spdk_vhost_session *vsession, void *unused)
 {
 	struct spdk_vhost_blk_session *bvsession = to_blk_session(vsession);
+	uint16_t i;
+
+	vhost_blk_group_stop(&bvsession->groups[0]);
+	for (i = 1; i < bvsession->num_groups; i++) {
+		spdk_thread_send_msg(bvsession->groups[i].pg->thread, vhost_blk_group_stop,
+				     &bvsession->groups[i]);
+	}
 
-	spdk_poller_unregister(&bvsession->requestq_poller);
 	bvsession->stop_poller = spdk_poller_register(destroy_session_poller_cb,
 				 bvsession, 1000);
 	return 0;
@@ -872,6 +1338,7 @@ vhost_blk_dump_info_json(struct spdk_vhost_dev *vdev, struct spdk_json_write_ctx
 	spdk_json_write_named_object_begin(w, "block");
 
 	spdk_json_write_named_bool(w, "readonly", bvdev->readonly);
+	spdk_json_write_named_bool(w, "merge_requests", bvdev->merge_requests);
 
 	spdk_json_write_name(w, "bdev");
 	if (bdev) {
@@ -902,6 +1369,7 @@ vhost_blk_write_config_json(struct spdk_vhost_dev *vdev, struct spdk_json_write_
 	spdk_json_write_named_string(w, "dev_name", spdk_bdev_get_name(bvdev->bdev));
 	spdk_json_write_named_string(w, "cpumask", spdk_cpuset_fmt(&vdev->cpumask));
 	spdk_json_write_named_bool(w, "readonly", bvdev->readonly);
+	spdk_json_write_named_bool(w, "merge_requests", bvdev->merge_requests);
 	spdk_json_write_object_end(w);
 
 	spdk_json_write_object_end(w);
@@ -993,6 +1461,7 @@ vhost_blk_controller_construct(void)
 	char *cpumask;
 	char *name;
 	bool readonly;
+	bool merge_requests;
 
 	for (sp = spdk_conf_first_section(NULL); sp != NULL; sp = spdk_conf_next_section(sp)) {
 		if (!spdk_conf_section_match_prefix(sp, "VhostBlk")) {
@@ -1013,13 +1482,15 @@ vhost_blk_controller_construct(void)
 
 		cpumask = spdk_conf_section_get_val(sp, "Cpumask");
 		readonly = spdk_conf_section_get_boolval(sp, "ReadOnly", false);
+		merge_requests = spdk_conf_section_get_boolval(sp, "MergeRequests", false);
 
 		bdev_name = spdk_conf_section_get_val(sp, "Dev");
 		if (bdev_name == NULL) {
 			continue;
 		}
 
-		if (spdk_vhost_blk_construct(name, cpumask, bdev_name, readonly) < 0) {
+		if (spdk_vhost_blk_construct(name, cpumask, bdev_name,
+					     readonly, merge_requests) < 0) {
 			return -1;
 		}
 	}
@@ -1028,7 +1499,8 @@ vhost_blk_controller_construct(void)
 }
 
 int
-spdk_vhost_blk_construct(const char *name, const char *cpumask, const char *dev_name, bool readonly)
+spdk_vhost_blk_construct(const char *name, const char *cpumask, const char *dev_name,
+			 bool readonly, bool merge_requests)
 {
 	struct spdk_vhost_blk_dev *bvdev = NULL;
 	struct spdk_vhost_dev *vdev;
@@ -1077,6 +1549,7 @@ spdk_vhost_blk_construct(const char *name, const char *cpumask, const char *dev_
 
 	bvdev->bdev = bdev;
 	bvdev->readonly = readonly;
+	bvdev->merge_requests = merge_requests;
 	ret = vhost_dev_register(vdev, name, cpumask, &vhost_blk_device_backend);
 	if (ret != 0) {
 		spdk_bdev_close(bvdev->bdev_desc);
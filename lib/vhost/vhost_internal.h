@@ -68,23 +68,67 @@
  */
 #define SPDK_VHOST_COALESCING_DELAY_BASE_US 0
 
+/*
+ * Time after which the poller of idle virtqueues is suspended and the
+ * guest is asked to kick the virtqueues instead.
+ */
+#define SPDK_VHOST_IDLE_TIMEOUT_US 100000
+/*
+ * Rate at which kicks of suspended virtqueues are checked. This bounds the
+ * extra latency of the first request after an idle period.
+ */
+#define SPDK_VHOST_KICK_CHECK_PERIOD_US 50
+
 
 #define SPDK_VHOST_FEATURES ((1ULL << VHOST_F_LOG_ALL) | \
 	(1ULL << VHOST_USER_F_PROTOCOL_FEATURES) | \
 	(1ULL << VIRTIO_F_VERSION_1) | \
 	(1ULL << VIRTIO_F_NOTIFY_ON_EMPTY) | \
 	(1ULL << VIRTIO_RING_F_EVENT_IDX) | \
-	(1ULL << VIRTIO_RING_F_INDIRECT_DESC))
+	(1ULL << VIRTIO_RING_F_INDIRECT_DESC) | \
+	(1ULL << VIRTIO_F_RING_PACKED))
 
 #define SPDK_VHOST_DISABLED_FEATURES ((1ULL << VIRTIO_RING_F_EVENT_IDX) | \
 	(1ULL << VIRTIO_F_NOTIFY_ON_EMPTY))
 
+#define VRING_DESC_F_AVAIL	(1ULL << VRING_PACKED_DESC_F_AVAIL)
+#define VRING_DESC_F_USED	(1ULL << VRING_PACKED_DESC_F_USED)
+#define VRING_DESC_F_AVAIL_USED	(VRING_DESC_F_AVAIL | VRING_DESC_F_USED)
+
 struct vhost_poll_group {
 	struct spdk_thread *thread;
 	unsigned ref;
+
+	/* epoll set of the kick eventfds of suspended virtqueues */
+	int epfd;
+	/* Checks epfd while any poller on this thread is suspended */
+	struct spdk_poller *kick_poller;
+	uint32_t suspended_cnt;
+
 	TAILQ_ENTRY(vhost_poll_group) tailq;
 };
 
+/*
+ * A virtqueue poller that can be suspended while its virtqueues are idle.
+ * The guest is then asked to kick the virtqueues and the poller is resumed
+ * on the first kick.
+ */
+struct vhost_poller_intr {
+	struct spdk_vhost_session *vsession;
+	struct vhost_poll_group *pg;
+	struct spdk_poller *poller;
+
+	/* Virtqueues first_q, first_q + q_step, ... are served by the poller */
+	uint16_t first_q;
+	uint16_t q_step;
+
+	bool suspended;
+
+	/* Tick count at which the virtqueues went idle, 0 if they're busy */
+	uint64_t idle_tsc;
+	uint64_t idle_timeout_ticks;
+};
+
 typedef struct rte_vhost_resubmit_desc spdk_vhost_resubmit_desc;
 typedef struct rte_vhost_resubmit_info spdk_vhost_resubmit_info;
 
@@ -94,6 +138,15 @@ struct spdk_vhost_virtqueue {
 	uint16_t last_avail_idx;
 	uint16_t last_used_idx;
 
+	struct {
+		/* Wrap counter the driver uses to mark descriptors available */
+		uint8_t avail_phase	: 1;
+		/* Wrap counter we use to mark descriptors used */
+		uint8_t used_phase	: 1;
+		uint8_t reserved	: 5;
+		bool packed_ring	: 1;
+	} packed;
+
 	void *tasks;
 
 	/* Request count from last stats check */
@@ -108,6 +161,12 @@ struct spdk_vhost_virtqueue {
 	/* Next time when we need to send event */
 	uint64_t next_event_time;
 
+	/* Next time when stats for event coalescing will be checked */
+	uint64_t next_stats_check_time;
+
+	/* Suspended poller of this virtqueue, if any */
+	struct vhost_poller_intr *intr;
+
 	/* Associated vhost_virtqueue in the virtio device's virtqueue list */
 	uint32_t vring_idx;
 } __attribute((aligned(SPDK_CACHE_LINE_SIZE)));
@@ -142,9 +201,6 @@ struct spdk_vhost_session {
 	uint32_t coalescing_delay_time_base;
 	uint32_t coalescing_io_rate_threshold;
 
-	/* Next time when stats for event coalescing will be checked. */
-	uint64_t next_stats_check_time;
-
 	/* Interval used for event coalescing checking. */
 	uint64_t stats_check_interval;
 
@@ -225,6 +281,37 @@ struct spdk_vhost_dev_backend {
 	int (*remove_device)(struct spdk_vhost_dev *vdev);
 };
 
+/*
+ * Position in the descriptor chain of a single request. Hides the differences
+ * between split and packed virtqueues as well as direct and indirect chains.
+ */
+struct vhost_vring_desc_iter {
+	struct spdk_vhost_virtqueue *vq;
+
+	/* Current descriptor, NULL once the end of the chain is reached. */
+	union {
+		struct vring_desc *desc;
+		struct vring_packed_desc *desc_packed;
+	};
+	union {
+		struct vring_desc *desc_table;
+		struct vring_packed_desc *desc_table_packed;
+	};
+	uint32_t desc_table_size;
+
+	/* Index of the current descriptor in the packed descriptor table */
+	uint16_t desc_idx;
+	bool indirect;
+
+	/* Number of descriptors walked so far, to break cycles */
+	uint32_t desc_cnt;
+
+	/* Buffer of the current descriptor */
+	uint64_t addr;
+	uint32_t len;
+	bool wr;
+};
+
 void *vhost_gpa_to_vva(struct spdk_vhost_session *vsession, uint64_t addr, uint64_t len);
 
 uint16_t vhost_vq_avail_ring_get(struct spdk_vhost_virtqueue *vq, uint16_t *reqs,
@@ -251,6 +338,63 @@ int vhost_vq_get_desc(struct spdk_vhost_session *vsession, struct spdk_vhost_vir
 		      uint16_t req_idx, struct vring_desc **desc, struct vring_desc **desc_table,
 		      uint32_t *desc_table_size);
 
+/**
+ * Check if the driver made the descriptor at \c last_avail_idx of a packed
+ * virtqueue available.
+ * \param vq packed virtqueue
+ * \return true if there's a new request to process.
+ */
+bool vhost_vq_packed_ring_is_avail(struct spdk_vhost_virtqueue *vq);
+
+/**
+ * Consume the descriptor chain starting at \c last_avail_idx of a packed
+ * virtqueue and return its buffer id.
+ * \param vq packed virtqueue
+ * \param num_descs set to the number of ring entries taken by the chain
+ * \return buffer id of the chain
+ */
+uint16_t vhost_vq_packed_ring_get_buffer_id(struct spdk_vhost_virtqueue *vq,
+		uint16_t *num_descs);
+
+/**
+ * Mark a descriptor chain of a packed virtqueue used.
+ * \param vsession vhost session
+ * \param vq packed virtqueue
+ * \param num_descs number of ring entries the chain took
+ * \param buffer_id buffer id of the chain
+ * \param len number of bytes written to the chain
+ */
+void vhost_vq_packed_ring_enqueue(struct spdk_vhost_session *vsession,
+				  struct spdk_vhost_virtqueue *vq,
+				  uint16_t num_descs, uint16_t buffer_id, uint32_t len);
+
+/**
+ * Start walking the descriptor chain at given index of given virtqueue,
+ * either split or packed.
+ * \param vsession vhost session
+ * \param vq virtqueue
+ * \param req_idx index of the head descriptor
+ * \param iter iterator to be set to the first descriptor of the chain
+ * \return 0 on success, -1 if given index or indirect table is invalid.
+ */
+int vhost_vring_desc_iter_init(struct spdk_vhost_session *vsession,
+			       struct spdk_vhost_virtqueue *vq, uint16_t req_idx,
+			       struct vhost_vring_desc_iter *iter);
+
+/**
+ * Move the iterator to the next descriptor of the chain.
+ * \param iter descriptor iterator
+ * \return 0 on success, -1 if the chain is broken. The iterator's
+ * \c desc is set to NULL when the end of the chain is reached.
+ */
+int vhost_vring_desc_iter_next(struct vhost_vring_desc_iter *iter);
+
+/**
+ * Translate the buffer of the iterator's current descriptor into iovecs.
+ */
+int vhost_vring_desc_iter_to_iov(struct spdk_vhost_session *vsession, struct iovec *iov,
+				 uint16_t *iov_index, const struct vhost_vring_desc_iter *iter);
+
 /**
  * Send IRQ/call client (if pending) for \c vq.
  * \param vsession vhost session
@@ -269,6 +413,51 @@ int vhost_vq_used_signal(struct spdk_vhost_session *vsession, struct spdk_vhost_
  */
 void vhost_session_used_signal(struct spdk_vhost_session *vsession);
 
+/**
+ * Send IRQ for \c vq if it needs to be signaled, honoring the session's
+ * interrupt coalescing settings. Different virtqueues of a session may be
+ * signaled from different threads.
+ * \param vsession vhost session
+ * \param vq virtqueue
+ */
+void vhost_session_vq_used_signal(struct spdk_vhost_session *vsession,
+				  struct spdk_vhost_virtqueue *vq);
+
+/**
+ * Prepare \c poller to be suspended while its virtqueues are idle.
+ *
+ * Must be called on the thread of \c pg, which is also the thread of the poller.
+ *
+ * \param intr context to initialize
+ * \param vsession vhost session
+ * \param pg poll group of the current thread
+ * \param poller poller serving the virtqueues
+ * \param first_q index of the first virtqueue served by the poller
+ * \param q_step distance between the virtqueues served by the poller
+ */
+void vhost_poller_intr_init(struct vhost_poller_intr *intr, struct spdk_vhost_session *vsession,
+			    struct vhost_poll_group *pg, struct spdk_poller *poller,
+			    uint16_t first_q, uint16_t q_step);
+
+/**
+ * Report the result of a single run of the poller. Once the poller stays idle
+ * for SPDK_VHOST_IDLE_TIMEOUT_US, guest notifications are enabled and the poller
+ * is paused until any of its virtqueues gets kicked.
+ *
+ * \param intr poller context
+ * \param idle true if the poller found no new requests and has no requests
+ * in flight
+ */
+void vhost_poller_intr_update(struct vhost_poller_intr *intr, bool idle);
+
+/**
+ * Resume the poller if it's suspended. Must be called before the poller is
+ * unregistered.
+ *
+ * \param intr poller context
+ */
+void vhost_poller_intr_fini(struct vhost_poller_intr *intr);
+
 void vhost_vq_used_ring_enqueue(struct spdk_vhost_session *vsession,
 				struct spdk_vhost_virtqueue *vq,
 				uint16_t id, uint32_t len);
@@ -404,6 +593,20 @@ int vhost_get_negotiated_features(int vid, uint64_t *negotiated_features);
 
 struct vhost_poll_group *vhost_get_poll_group(struct spdk_cpuset *cpumask);
 
+/**
+ * Select up to \c max_pgs distinct poll groups allowed by \c cpumask, least
+ * loaded first. At least one poll group is always returned.
+ *
+ * Must be called under the global vhost mutex.
+ *
+ * \param cpumask cpumask the poll group threads must be confined to
+ * \param pgs array to be filled with the selected poll groups
+ * \param max_pgs size of the \c pgs array
+ * \return number of selected poll groups
+ */
+uint32_t vhost_get_poll_groups(struct spdk_cpuset *cpumask, struct vhost_poll_group **pgs,
+			       uint32_t max_pgs);
+
 int remove_vhost_controller(struct spdk_vhost_dev *vdev);
 
 #ifdef SPDK_CONFIG_VHOST_INTERNAL_LIB
@@ -73,9 +73,16 @@ struct spdk_vhost_nvme_cq {
 	uint16_t cq_head;
 	uint16_t guest_signaled_cq_head;
 	uint32_t need_signaled_cnt;
-	STAILQ_HEAD(, spdk_vhost_nvme_task) cq_full_waited_tasks;
+	/* Completed tasks whose CQEs haven't been posted yet */
+	STAILQ_HEAD(, spdk_vhost_nvme_task) pending_tasks;
 	bool irq_enabled;
 	int virq;
+
+	/* Interrupt coalescing, configured with vhost_controller_set_coalescing */
+	uint32_t req_cnt;
+	uint64_t irq_delay_time;
+	uint64_t next_event_time;
+	uint64_t next_stats_check_time;
 };
 
 struct spdk_vhost_nvme_ns {
@@ -85,13 +92,13 @@ struct spdk_vhost_nvme_ns {
 	uint32_t nsid;
 	uint32_t active_ns;
 	struct spdk_bdev_desc *bdev_desc;
-	struct spdk_io_channel *bdev_io_channel;
 	struct spdk_nvme_ns_data nsdata;
 };
 
 struct spdk_vhost_nvme_task {
 	struct spdk_nvme_cmd cmd;
 	struct spdk_vhost_nvme_dev *nvme;
+	struct spdk_vhost_nvme_queue_group *group;
 	uint16_t sqid;
 	uint16_t cqid;
 
@@ -121,6 +128,27 @@ struct spdk_vhost_nvme_task {
 	STAILQ_ENTRY(spdk_vhost_nvme_task) stailq;
 };
 
+/*
+ * I/O queues of a controller polled by a single thread. A CQ and all the SQs
+ * bound to it always belong to the same group. Group 0 runs on the session's
+ * thread.
+ */
+struct spdk_vhost_nvme_queue_group {
+	struct spdk_vhost_nvme_dev *nvme;
+	struct vhost_poll_group *pg;
+	struct spdk_poller *requestq_poller;
+	struct spdk_poller *stop_poller;
+	struct spdk_io_channel *ns_channels[MAX_NAMESPACE];
+
+	struct spdk_vhost_nvme_task *tasks;
+	STAILQ_HEAD(, spdk_vhost_nvme_task) free_tasks;
+
+	/* Number of tasks of this group taken from its pool */
+	int task_cnt;
+
+	uint16_t idx;
+};
+
 struct spdk_vhost_nvme_dev {
 	struct spdk_vhost_dev vdev;
 
@@ -150,8 +178,10 @@ struct spdk_vhost_nvme_dev {
 	struct spdk_vhost_session *vsession;
 
 	TAILQ_ENTRY(spdk_vhost_nvme_dev) tailq;
-	STAILQ_HEAD(, spdk_vhost_nvme_task) free_tasks;
-	struct spdk_poller *requestq_poller;
+	struct spdk_vhost_nvme_queue_group *groups;
+	uint16_t num_groups;
+	/* Number of groups that haven't finished stopping yet */
+	uint16_t num_groups_running;
 	struct spdk_poller *stop_poller;
 };
 
@@ -190,6 +220,12 @@ static inline unsigned int cq_offset(unsigned int qid, uint32_t db_stride)
 	return (qid * 2 + 1) * db_stride;
 }
 
+static inline uint16_t
+nvme_cq_group_idx(struct spdk_vhost_nvme_dev *nvme, uint16_t cqid)
+{
+	return (cqid - 1) % nvme->num_groups;
+}
+
 static void
 nvme_inc_cq_head(struct spdk_vhost_nvme_cq *cq)
 {
@@ -206,6 +242,29 @@ nvme_cq_is_full(struct spdk_vhost_nvme_cq *cq)
 	return ((cq->cq_head + 1) % cq->size == cq->guest_signaled_cq_head);
 }
 
+static struct spdk_vhost_nvme_task *
+vhost_nvme_get_task(struct spdk_vhost_nvme_queue_group *group)
+{
+	struct spdk_vhost_nvme_task *task;
+
+	task = STAILQ_FIRST(&group->free_tasks);
+	if (spdk_unlikely(task == NULL)) {
+		return NULL;
+	}
+
+	STAILQ_REMOVE_HEAD(&group->free_tasks, stailq);
+	group->task_cnt++;
+	return task;
+}
+
+static void
+vhost_nvme_put_task(struct spdk_vhost_nvme_task *task)
+{
+	assert(task->group->task_cnt > 0);
+	task->group->task_cnt--;
+	STAILQ_INSERT_TAIL(&task->group->free_tasks, task, stailq);
+}
+
 static void
 nvme_inc_sq_head(struct spdk_vhost_nvme_sq *sq)
 {
@@ -320,70 +379,149 @@ spdk_nvme_map_prps(struct spdk_vhost_nvme_dev *nvme, struct spdk_nvme_cmd *cmd,
 }
 
 static void
-spdk_nvme_cq_signal_fd(struct spdk_vhost_nvme_dev *nvme)
+vhost_nvme_cq_check_io_stats(struct spdk_vhost_session *vsession, struct spdk_vhost_nvme_cq *cq,
+			     uint64_t now)
 {
-	struct spdk_vhost_nvme_cq *cq;
-	uint32_t qid, cq_head;
+	uint32_t io_threshold = vsession->coalescing_io_rate_threshold;
+	uint32_t req_cnt;
 
-	assert(nvme != NULL);
+	if (now < cq->next_stats_check_time) {
+		return;
+	}
 
-	for (qid = 1; qid <= MAX_IO_QUEUES; qid++) {
-		cq = spdk_vhost_nvme_get_cq_from_qid(nvme, qid);
-		if (!cq || !cq->valid) {
-			continue;
-		}
+	cq->next_stats_check_time = now + vsession->stats_check_interval;
+	req_cnt = cq->req_cnt + cq->need_signaled_cnt;
+	cq->req_cnt = 0;
 
-		cq_head = spdk_vhost_nvme_get_queue_head(nvme, cq_offset(qid, 1));
-		if (cq->irq_enabled && cq->need_signaled_cnt && (cq->cq_head != cq_head)) {
-			eventfd_write(cq->virq, (eventfd_t)1);
-			cq->need_signaled_cnt = 0;
-		}
+	if (io_threshold == 0 || req_cnt <= io_threshold) {
+		cq->irq_delay_time = 0;
+		return;
 	}
+
+	cq->irq_delay_time = (uint64_t)vsession->coalescing_delay_time_base *
+			     (req_cnt - io_threshold) / io_threshold;
+	cq->next_event_time = now;
 }
 
 static void
-spdk_vhost_nvme_task_complete(struct spdk_vhost_nvme_task *task)
+vhost_nvme_cq_signal(struct spdk_vhost_nvme_dev *nvme, struct spdk_vhost_nvme_cq *cq)
 {
-	struct spdk_vhost_nvme_dev *nvme = task->nvme;
-	struct spdk_nvme_cpl cqe = {0};
-	struct spdk_vhost_nvme_cq *cq;
+	struct spdk_vhost_session *vsession = nvme->vsession;
+	uint32_t cq_head;
+	uint64_t now;
+
+	if (!cq->irq_enabled || !cq->need_signaled_cnt) {
+		return;
+	}
+
+	/* The guest has already consumed all CQEs, no need to interrupt it */
+	cq_head = spdk_vhost_nvme_get_queue_head(nvme, cq_offset(cq->cqid, 1));
+	if (cq->cq_head == cq_head) {
+		return;
+	}
+
+	if (vsession->coalescing_delay_time_base == 0) {
+		eventfd_write(cq->virq, (eventfd_t)1);
+		cq->need_signaled_cnt = 0;
+		return;
+	}
+
+	now = spdk_get_ticks();
+	vhost_nvme_cq_check_io_stats(vsession, cq, now);
+	if (now < cq->next_event_time) {
+		return;
+	}
+
+	eventfd_write(cq->virq, (eventfd_t)1);
+	cq->req_cnt += cq->need_signaled_cnt;
+	cq->need_signaled_cnt = 0;
+
+	/* Syscall is quite long so update time */
+	cq->next_event_time = spdk_get_ticks() + cq->irq_delay_time;
+}
+
+/*
+ * Post the CQEs of all completed tasks of a CQ, as long as there's space in
+ * it. The entries are written with the previous phase first and made visible
+ * to the guest at once, after a single write barrier.
+ */
+static void
+vhost_nvme_cq_post_cqes(struct spdk_vhost_nvme_dev *nvme, struct spdk_vhost_nvme_cq *cq)
+{
+	struct spdk_vhost_nvme_task *task;
 	struct spdk_vhost_nvme_sq *sq;
-	struct spdk_nvme_cmd *cmd = &task->cmd;
-	uint16_t cqid = task->cqid;
-	uint16_t sqid = task->sqid;
+	struct spdk_nvme_cpl cqe;
+	uint16_t head, cnt, i;
+	uint8_t phase;
 
-	cq = spdk_vhost_nvme_get_cq_from_qid(nvme, cqid);
-	sq = spdk_vhost_nvme_get_sq_from_qid(nvme, sqid);
-	if (spdk_unlikely(!cq || !sq)) {
+	if (STAILQ_EMPTY(&cq->pending_tasks)) {
 		return;
 	}
 
-	cq->guest_signaled_cq_head = spdk_vhost_nvme_get_queue_head(nvme, cq_offset(cqid, 1));
-	if (spdk_unlikely(nvme_cq_is_full(cq))) {
-		STAILQ_INSERT_TAIL(&cq->cq_full_waited_tasks, task, stailq);
+	cq->guest_signaled_cq_head = spdk_vhost_nvme_get_queue_head(nvme, cq_offset(cq->cqid, 1));
+	head = cq->cq_head;
+	phase = cq->phase;
+	cnt = 0;
+
+	while (!STAILQ_EMPTY(&cq->pending_tasks) && !nvme_cq_is_full(cq)) {
+		task = STAILQ_FIRST(&cq->pending_tasks);
+		STAILQ_REMOVE_HEAD(&cq->pending_tasks, stailq);
+		sq = spdk_vhost_nvme_get_sq_from_qid(nvme, task->sqid);
+
+		memset(&cqe, 0, sizeof(cqe));
+		cqe.sqid = task->sqid;
+		cqe.sqhd = sq->sq_head;
+		cqe.cid = task->cmd.cid;
+		cqe.status.dnr = task->dnr;
+		cqe.status.sct = task->sct;
+		cqe.status.sc = task->sc;
+		cqe.status.p = !cq->phase;
+		cq->cq_cqe[cq->cq_head] = cqe;
+
+		nvme_inc_cq_head(cq);
+		cnt++;
+
+		vhost_nvme_put_task(task);
+	}
+
+	if (cnt == 0) {
 		return;
 	}
 
-	cqe.sqid = sqid;
-	cqe.sqhd = sq->sq_head;
-	cqe.cid = cmd->cid;
-	cqe.status.dnr = task->dnr;
-	cqe.status.sct = task->sct;
-	cqe.status.sc = task->sc;
-	cqe.status.p = !cq->phase;
-	cq->cq_cqe[cq->cq_head] = cqe;
 	spdk_smp_wmb();
-	cq->cq_cqe[cq->cq_head].status.p = cq->phase;
+	for (i = 0; i < cnt; i++) {
+		cq->cq_cqe[head].status.p = phase;
+		if (++head == cq->size) {
+			head = 0;
+			phase = !phase;
+		}
+	}
 
-	nvme_inc_cq_head(cq);
-	cq->need_signaled_cnt++;
+	cq->need_signaled_cnt += cnt;
 
 	/* MMIO Controll */
 	if (nvme->dataplane_started) {
-		nvme->dbbuf_eis[cq_offset(cqid, 1)] = (uint32_t)(cq->guest_signaled_cq_head - 1);
+		nvme->dbbuf_eis[cq_offset(cq->cqid, 1)] = (uint32_t)(cq->guest_signaled_cq_head - 1);
+	}
+}
+
+static void
+spdk_vhost_nvme_task_complete(struct spdk_vhost_nvme_task *task)
+{
+	struct spdk_vhost_nvme_dev *nvme = task->nvme;
+	struct spdk_vhost_nvme_cq *cq;
+	struct spdk_vhost_nvme_sq *sq;
+
+	cq = spdk_vhost_nvme_get_cq_from_qid(nvme, task->cqid);
+	sq = spdk_vhost_nvme_get_sq_from_qid(nvme, task->sqid);
+	if (spdk_unlikely(!cq || !sq || !cq->valid)) {
+		/* The CQ has been deleted, nothing to post the CQE to */
+		vhost_nvme_put_task(task);
+		return;
 	}
 
-	STAILQ_INSERT_TAIL(&nvme->free_tasks, task, stailq);
+	/* The CQE will be posted by the poller, together with any others */
+	STAILQ_INSERT_TAIL(&cq->pending_tasks, task, stailq);
 }
 
 static void
@@ -415,7 +553,6 @@ blk_unmap_complete_cb(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
 {
 	struct spdk_vhost_nvme_task *child = cb_arg;
 	struct spdk_vhost_nvme_task *task = child->parent;
-	struct spdk_vhost_nvme_dev *nvme = task->nvme;
 	int sct, sc;
 	uint32_t cdw0;
 
@@ -435,7 +572,7 @@ blk_unmap_complete_cb(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
 		spdk_vhost_nvme_task_complete(task);
 	}
 
-	STAILQ_INSERT_TAIL(&nvme->free_tasks, child, stailq);
+	vhost_nvme_put_task(child);
 }
 
 static struct spdk_vhost_nvme_ns *
@@ -469,7 +606,8 @@ vhost_nvme_queue_task(struct spdk_vhost_nvme_task *task)
 	task->bdev_io_wait.cb_fn = vhost_nvme_resubmit_task;
 	task->bdev_io_wait.cb_arg = task;
 
-	rc = spdk_bdev_queue_io_wait(task->ns->bdev, task->ns->bdev_io_channel, &task->bdev_io_wait);
+	rc = spdk_bdev_queue_io_wait(task->ns->bdev, task->group->ns_channels[task->ns->nsid - 1],
+				     &task->bdev_io_wait);
 	if (rc != 0) {
 		SPDK_ERRLOG("Queue io failed in vhost_nvme_queue_task, rc=%d.\n", rc);
 		task->dnr = 1;
@@ -488,6 +626,7 @@ spdk_nvme_process_sq(struct spdk_vhost_nvme_dev *nvme, struct spdk_vhost_nvme_sq
 	struct spdk_vhost_nvme_task *child;
 	struct spdk_nvme_cmd *cmd = &task->cmd;
 	struct spdk_vhost_nvme_ns *ns;
+	struct spdk_io_channel *ch;
 	int ret = -1;
 	uint32_t len, nlba, block_size;
 	uint64_t slba;
@@ -514,6 +653,7 @@ spdk_nvme_process_sq(struct spdk_vhost_nvme_dev *nvme, struct spdk_vhost_nvme_sq
 	task->sqid = sq->sqid;
 
 	task->ns = ns;
+	ch = task->group->ns_channels[ns->nsid - 1];
 
 	if (spdk_unlikely(!ns->active_ns)) {
 		task->dnr = 1;
@@ -560,39 +700,37 @@ spdk_nvme_process_sq(struct spdk_vhost_nvme_dev *nvme, struct spdk_vhost_nvme_sq
 
 	switch (cmd->opc) {
 	case SPDK_NVME_OPC_READ:
-		ret = spdk_bdev_readv(ns->bdev_desc, ns->bdev_io_channel,
+		ret = spdk_bdev_readv(ns->bdev_desc, ch,
 				      task->iovs, task->iovcnt, slba * block_size,
 				      nlba * block_size, blk_request_complete_cb, task);
 		break;
 	case SPDK_NVME_OPC_WRITE:
-		ret = spdk_bdev_writev(ns->bdev_desc, ns->bdev_io_channel,
+		ret = spdk_bdev_writev(ns->bdev_desc, ch,
 				       task->iovs, task->iovcnt, slba * block_size,
 				       nlba * block_size, blk_request_complete_cb, task);
 		break;
 	case SPDK_NVME_OPC_FLUSH:
-		ret = spdk_bdev_flush(ns->bdev_desc, ns->bdev_io_channel,
+		ret = spdk_bdev_flush(ns->bdev_desc, ch,
 				      0, ns->capacity,
 				      blk_request_complete_cb, task);
 		break;
 	case SPDK_NVME_OPC_DATASET_MANAGEMENT:
 		range = (struct spdk_nvme_dsm_range *)task->iovs[0].iov_base;
 		for (i = 0; i < num_ranges; i++) {
-			if (!STAILQ_EMPTY(&nvme->free_tasks)) {
-				child = STAILQ_FIRST(&nvme->free_tasks);
-				STAILQ_REMOVE_HEAD(&nvme->free_tasks, stailq);
-			} else {
+			child = vhost_nvme_get_task(task->group);
+			if (child == NULL) {
 				SPDK_ERRLOG("No free task now\n");
 				ret = -1;
 				break;
 			}
 			task->num_children++;
 			child->parent = task;
-			ret = spdk_bdev_unmap(ns->bdev_desc, ns->bdev_io_channel,
+			ret = spdk_bdev_unmap(ns->bdev_desc, ch,
 					      range[i].starting_lba * block_size,
 					      range[i].length * block_size,
 					      blk_unmap_complete_cb, child);
 			if (ret) {
-				STAILQ_INSERT_TAIL(&nvme->free_tasks, child, stailq);
+				vhost_nvme_put_task(child);
 				break;
 			}
 		}
@@ -623,7 +761,8 @@ spdk_nvme_process_sq(struct spdk_vhost_nvme_dev *nvme, struct spdk_vhost_nvme_sq
 static int
 nvme_worker(void *arg)
 {
-	struct spdk_vhost_nvme_dev *nvme = (struct spdk_vhost_nvme_dev *)arg;
+	struct spdk_vhost_nvme_queue_group *group = arg;
+	struct spdk_vhost_nvme_dev *nvme = group->nvme;
 	struct spdk_vhost_nvme_sq *sq;
 	struct spdk_vhost_nvme_cq *cq;
 	struct spdk_vhost_nvme_task *task;
@@ -649,12 +788,8 @@ nvme_worker(void *arg)
 		if (spdk_unlikely(!cq)) {
 			return -1;
 		}
-		cq->guest_signaled_cq_head = spdk_vhost_nvme_get_queue_head(nvme, cq_offset(sq->cqid, 1));
-		if (spdk_unlikely(!STAILQ_EMPTY(&cq->cq_full_waited_tasks) &&
-				  !nvme_cq_is_full(cq))) {
-			task = STAILQ_FIRST(&cq->cq_full_waited_tasks);
-			STAILQ_REMOVE_HEAD(&cq->cq_full_waited_tasks, stailq);
-			spdk_vhost_nvme_task_complete(task);
+		if (nvme_cq_group_idx(nvme, sq->cqid) != group->idx) {
+			continue;
 		}
 
 		dbbuf_sq = spdk_vhost_nvme_get_queue_head(nvme, sq_offset(qid, 1));
@@ -665,11 +800,10 @@ nvme_worker(void *arg)
 			if (spdk_unlikely(!sq->sq_cmd)) {
 				break;
 			}
-			if (spdk_likely(!STAILQ_EMPTY(&nvme->free_tasks))) {
-				task = STAILQ_FIRST(&nvme->free_tasks);
-				STAILQ_REMOVE_HEAD(&nvme->free_tasks, stailq);
-			} else {
-				return -1;
+			task = vhost_nvme_get_task(group);
+			if (spdk_unlikely(task == NULL)) {
+				/* Post the pending CQEs first */
+				break;
 			}
 
 			task->cmd = sq->sq_cmd[sq->sq_head];
@@ -682,24 +816,105 @@ nvme_worker(void *arg)
 					    sq->sq_tail);
 			}
 
-			/* MMIO Control */
-			if (nvme->dataplane_started) {
-				nvme->dbbuf_eis[sq_offset(qid, 1)] = (uint32_t)(sq->sq_head - 1);
-			}
-
 			/* Maximum batch I/Os to pick up at once */
 			if (count++ == MAX_BATCH_IO) {
 				break;
 			}
 		}
+
+		/* MMIO Control. Once per batch is enough, the guest only rings the
+		 * MMIO doorbell if it moves the tail past the event index.
+		 */
+		if (nvme->dataplane_started && count > 0) {
+			nvme->dbbuf_eis[sq_offset(qid, 1)] = (uint32_t)(sq->sq_head - 1);
+		}
 	}
 
-	/* Completion Queue */
-	spdk_nvme_cq_signal_fd(nvme);
+	/* Completion Queues of this group */
+	for (qid = group->idx + 1; qid <= MAX_IO_QUEUES; qid += nvme->num_groups) {
+		cq = spdk_vhost_nvme_get_cq_from_qid(nvme, qid);
+		if (!cq->valid) {
+			continue;
+		}
+
+		vhost_nvme_cq_post_cqes(nvme, cq);
+		vhost_nvme_cq_signal(nvme, cq);
+	}
 
 	return count;
 }
 
+/*
+ * Poller of a queue group that couldn't allocate its tasks or I/O channels.
+ * Commands of its queues are failed right away, so the guest doesn't wait
+ * for them forever.
+ */
+static int
+no_resources_nvme_worker(void *arg)
+{
+	struct spdk_vhost_nvme_queue_group *group = arg;
+	struct spdk_vhost_nvme_dev *nvme = group->nvme;
+	struct spdk_vhost_nvme_sq *sq;
+	struct spdk_vhost_nvme_cq *cq;
+	struct spdk_nvme_cpl cqe;
+	uint32_t qid;
+
+	if (spdk_unlikely(!nvme->num_sqs)) {
+		return -1;
+	}
+
+	if (spdk_unlikely(!nvme->dataplane_started && !nvme->bar)) {
+		return -1;
+	}
+
+	for (qid = 1; qid <= MAX_IO_QUEUES; qid++) {
+		sq = spdk_vhost_nvme_get_sq_from_qid(nvme, qid);
+		if (!sq->valid || !sq->sq_cmd) {
+			continue;
+		}
+		cq = spdk_vhost_nvme_get_cq_from_qid(nvme, sq->cqid);
+		if (!cq || !cq->valid || nvme_cq_group_idx(nvme, sq->cqid) != group->idx) {
+			continue;
+		}
+
+		sq->sq_tail = (uint16_t)spdk_vhost_nvme_get_queue_head(nvme, sq_offset(qid, 1));
+		cq->guest_signaled_cq_head = spdk_vhost_nvme_get_queue_head(nvme,
+					     cq_offset(sq->cqid, 1));
+		while (sq->sq_head != sq->sq_tail && !nvme_cq_is_full(cq)) {
+			memset(&cqe, 0, sizeof(cqe));
+			cqe.sqid = sq->sqid;
+			cqe.cid = sq->sq_cmd[sq->sq_head].cid;
+			nvme_inc_sq_head(sq);
+			cqe.sqhd = sq->sq_head;
+			cqe.status.dnr = 1;
+			cqe.status.sct = SPDK_NVME_SCT_GENERIC;
+			cqe.status.sc = SPDK_NVME_SC_INTERNAL_DEVICE_ERROR;
+			cqe.status.p = !cq->phase;
+			cq->cq_cqe[cq->cq_head] = cqe;
+			spdk_smp_wmb();
+			cq->cq_cqe[cq->cq_head].status.p = cq->phase;
+
+			nvme_inc_cq_head(cq);
+			cq->need_signaled_cnt++;
+		}
+
+		if (nvme->dataplane_started) {
+			nvme->dbbuf_eis[sq_offset(qid, 1)] = (uint32_t)(sq->sq_head - 1);
+			nvme->dbbuf_eis[cq_offset(sq->cqid, 1)] =
+				(uint32_t)(cq->guest_signaled_cq_head - 1);
+		}
+	}
+
+	for (qid = group->idx + 1; qid <= MAX_IO_QUEUES; qid += nvme->num_groups) {
+		cq = spdk_vhost_nvme_get_cq_from_qid(nvme, qid);
+		if (cq->valid) {
+			vhost_nvme_cq_signal(nvme, cq);
+		}
+	}
+
+	return -1;
+}
+
 static int
 vhost_nvme_doorbell_buffer_config(struct spdk_vhost_nvme_dev *nvme,
 				  struct spdk_nvme_cmd *cmd, struct spdk_nvme_cpl *cpl)
@@ -852,6 +1067,11 @@ vhost_nvme_create_io_cq(struct spdk_vhost_nvme_dev *nvme,
 	cq->cq_head = 0;
 	cq->guest_signaled_cq_head = 0;
 	cq->need_signaled_cnt = 0;
+	cq->req_cnt = 0;
+	cq->irq_delay_time = 0;
+	cq->next_event_time = 0;
+	cq->next_stats_check_time = 0;
+	STAILQ_INIT(&cq->pending_tasks);
 	requested_len = sizeof(struct spdk_nvme_cpl) * cq->size;
 	cq->cq_cqe = vhost_gpa_to_vva(nvme->vsession, dma_addr, requested_len);
 	if (!cq->cq_cqe) {
@@ -862,13 +1082,36 @@ vhost_nvme_create_io_cq(struct spdk_vhost_nvme_dev *nvme,
 	if (nvme->bar) {
 		nvme->bar_db[cq_offset(qid, 1)] = 0;
 	}
-	STAILQ_INIT(&cq->cq_full_waited_tasks);
 
 	cpl->status.sc = 0;
 	cpl->status.sct = 0;
 	return 0;
 }
 
+/*
+ * Return the tasks still waiting for their CQEs to be posted to the pool and
+ * clear the CQ. Runs on the thread of the group owning the CQ.
+ */
+static void
+vhost_nvme_cq_release(void *arg)
+{
+	struct spdk_vhost_nvme_cq *cq = arg;
+	struct spdk_vhost_nvme_task *task;
+
+	if (cq->valid) {
+		/* Created again in the meantime */
+		return;
+	}
+
+	while ((task = STAILQ_FIRST(&cq->pending_tasks)) != NULL) {
+		STAILQ_REMOVE_HEAD(&cq->pending_tasks, stailq);
+		vhost_nvme_put_task(task);
+	}
+
+	memset(cq, 0, sizeof(*cq));
+	cq->cq_cqe = NULL;
+}
+
 static int
 vhost_nvme_delete_io_cq(struct spdk_vhost_nvme_dev *nvme,
 			struct spdk_nvme_cmd *cmd, struct spdk_nvme_cpl *cpl)
@@ -884,8 +1127,15 @@ vhost_nvme_delete_io_cq(struct spdk_vhost_nvme_dev *nvme,
 	nvme->num_cqs--;
 	cq->valid = false;
 
-	memset(cq, 0, sizeof(*cq));
-	cq->cq_cqe = NULL;
+	/* Tasks of this CQ are completed by its group's thread. Once the CQ
+	 * is invalid, they're no longer queued on it.
+	 */
+	if (nvme->num_groups > 0) {
+		spdk_thread_send_msg(nvme->groups[nvme_cq_group_idx(nvme, qid)].pg->thread,
+				     vhost_nvme_cq_release, cq);
+	} else {
+		vhost_nvme_cq_release(cq);
+	}
 
 	cpl->status.sc = 0;
 	cpl->status.sct = 0;
@@ -1042,48 +1292,107 @@ vhost_nvme_set_cq_call(int vid, uint16_t qid, int fd)
 }
 
 static void
-free_task_pool(struct spdk_vhost_nvme_dev *nvme)
+free_task_pool(struct spdk_vhost_nvme_queue_group *group)
 {
-	struct spdk_vhost_nvme_task *task;
-
-	while (!STAILQ_EMPTY(&nvme->free_tasks)) {
-		task = STAILQ_FIRST(&nvme->free_tasks);
-		STAILQ_REMOVE_HEAD(&nvme->free_tasks, stailq);
-		spdk_free(task);
-	}
+	STAILQ_INIT(&group->free_tasks);
+	spdk_free(group->tasks);
+	group->tasks = NULL;
 }
 
 static int
-alloc_task_pool(struct spdk_vhost_nvme_dev *nvme)
+alloc_task_pool(struct spdk_vhost_nvme_queue_group *group)
 {
-	uint32_t entries, i;
+	struct spdk_vhost_nvme_dev *nvme = group->nvme;
+	uint32_t entries, num_queues, i;
 	struct spdk_vhost_nvme_task *task;
 
-	entries = nvme->num_io_queues * MAX_QUEUE_ENTRIES_SUPPORTED;
+	/* Only the queues of this group take tasks from its pool */
+	num_queues = spdk_divide_round_up(nvme->num_io_queues, nvme->num_groups);
+	entries = num_queues * MAX_QUEUE_ENTRIES_SUPPORTED;
 
-	for (i = 0; i < entries; i++) {
-		task = spdk_zmalloc(sizeof(struct spdk_vhost_nvme_task),
+	group->tasks = spdk_zmalloc(sizeof(struct spdk_vhost_nvme_task) * entries,
 				    SPDK_CACHE_LINE_SIZE, NULL,
 				    SPDK_ENV_LCORE_ID_ANY, SPDK_MALLOC_DMA);
-		if (task == NULL) {
-			SPDK_ERRLOG("Controller %s alloc task pool failed\n",
-				    nvme->vdev.name);
-			free_task_pool(nvme);
+	if (group->tasks == NULL) {
+		SPDK_ERRLOG("Controller %s alloc task pool failed\n",
+			    nvme->vdev.name);
+		return -1;
+	}
+
+	STAILQ_INIT(&group->free_tasks);
+	for (i = 0; i < entries; i++) {
+		task = &group->tasks[i];
+		task->group = group;
+		STAILQ_INSERT_TAIL(&group->free_tasks, task, stailq);
+	}
+
+	return 0;
+}
+
+static void
+vhost_nvme_group_put_channels(struct spdk_vhost_nvme_queue_group *group)
+{
+	uint32_t i;
+
+	for (i = 0; i < MAX_NAMESPACE; i++) {
+		if (group->ns_channels[i]) {
+			spdk_put_io_channel(group->ns_channels[i]);
+			group->ns_channels[i] = NULL;
+		}
+	}
+}
+
+static int
+vhost_nvme_group_start(struct spdk_vhost_nvme_queue_group *group)
+{
+	struct spdk_vhost_nvme_dev *nvme = group->nvme;
+	struct spdk_vhost_nvme_ns *ns_dev;
+	uint32_t i;
+
+	if (alloc_task_pool(group) != 0) {
+		return -1;
+	}
+
+	for (i = 0; i < nvme->num_ns; i++) {
+		ns_dev = &nvme->ns[i];
+		if (!ns_dev->active_ns) {
+			continue;
+		}
+
+		group->ns_channels[i] = spdk_bdev_get_io_channel(ns_dev->bdev_desc);
+		if (!group->ns_channels[i]) {
+			vhost_nvme_group_put_channels(group);
+			free_task_pool(group);
 			return -1;
 		}
-		STAILQ_INSERT_TAIL(&nvme->free_tasks, task, stailq);
 	}
 
+	/* Start the NVMe Poller */
+	group->requestq_poller = spdk_poller_register(nvme_worker, group, 0);
+	SPDK_INFOLOG(SPDK_LOG_VHOST_NVME, "Controller %s: queue group %"PRIu16" on lcore %d\n",
+		     nvme->vdev.name, group->idx, spdk_env_get_current_core());
 	return 0;
 }
 
+static void
+vhost_nvme_group_start_msg(void *arg)
+{
+	struct spdk_vhost_nvme_queue_group *group = arg;
+
+	if (vhost_nvme_group_start(group) != 0) {
+		/* The session is already running, so just fail the I/O of this group */
+		SPDK_ERRLOG("Controller %s: failed to start queue group %"PRIu16"\n",
+			    group->nvme->vdev.name, group->idx);
+		group->requestq_poller = spdk_poller_register(no_resources_nvme_worker, group, 0);
+	}
+}
+
 static int
 spdk_vhost_nvme_start_cb(struct spdk_vhost_dev *vdev,
 			 struct spdk_vhost_session *vsession, void *unused)
 {
 	struct spdk_vhost_nvme_dev *nvme = to_nvme_dev(vdev);
-	struct spdk_vhost_nvme_ns *ns_dev;
-	uint32_t i;
+	uint16_t i;
 	int rc = 0;
 
 	if (nvme == NULL) {
@@ -1091,27 +1400,24 @@ spdk_vhost_nvme_start_cb(struct spdk_vhost_dev *vdev,
 		goto out;
 	}
 
-	rc = alloc_task_pool(nvme);
-	if (rc) {
-		goto out;
-	}
-
 	SPDK_NOTICELOG("Start Device %u, Path %s, lcore %d\n", vsession->vid,
 		       vdev->path, spdk_env_get_current_core());
 
-	for (i = 0; i < nvme->num_ns; i++) {
-		ns_dev = &nvme->ns[i];
-		ns_dev->bdev_io_channel = spdk_bdev_get_io_channel(ns_dev->bdev_desc);
-		if (!ns_dev->bdev_io_channel) {
-			rc = -1;
-			goto out;
-		}
+	nvme->vsession = vsession;
+	rc = vhost_nvme_group_start(&nvme->groups[0]);
+	if (rc) {
+		goto out;
 	}
 
-	nvme->vsession = vsession;
-	/* Start the NVMe Poller */
-	nvme->requestq_poller = spdk_poller_register(nvme_worker, nvme, 0);
+	/* The other groups are started asynchronously. Messages sent to their
+	 * threads later on, e.g. the stop request, will be processed after this one.
+	 */
+	for (i = 1; i < nvme->num_groups; i++) {
+		spdk_thread_send_msg(nvme->groups[i].pg->thread, vhost_nvme_group_start_msg,
+				     &nvme->groups[i]);
+	}
 
+	nvme->num_groups_running = nvme->num_groups;
 out:
 	vhost_session_start_done(vsession, rc);
 	return rc;
@@ -1120,7 +1426,10 @@ out:
 static int
 spdk_vhost_nvme_start(struct spdk_vhost_session *vsession)
 {
-	struct vhost_poll_group *pg;
+	struct spdk_vhost_nvme_dev *nvme = to_nvme_dev(vsession->vdev);
+	struct vhost_poll_group *pgs[MAX_IO_QUEUES];
+	uint32_t num_pgs, i;
+	int rc;
 
 	if (vsession->vdev->active_session_num > 0) {
 		/* We're trying to start a second session */
@@ -1128,9 +1437,41 @@ spdk_vhost_nvme_start(struct spdk_vhost_session *vsession)
 		return -1;
 	}
 
-	pg = vhost_get_poll_group(&vsession->vdev->cpumask);
-	return vhost_session_send_event(pg, vsession, spdk_vhost_nvme_start_cb,
-					3, "start session");
+	if (nvme == NULL) {
+		return -1;
+	}
+
+	/* Spread the I/O queues over as many threads allowed by the cpumask as possible */
+	num_pgs = vhost_get_poll_groups(&vsession->vdev->cpumask, pgs, nvme->num_io_queues);
+	nvme->groups = calloc(num_pgs, sizeof(*nvme->groups));
+	if (nvme->groups == NULL) {
+		SPDK_ERRLOG("Controller %s: failed to allocate queue groups\n", nvme->vdev.name);
+		return -ENOMEM;
+	}
+
+	nvme->num_groups = num_pgs;
+	for (i = 0; i < num_pgs; i++) {
+		nvme->groups[i].nvme = nvme;
+		nvme->groups[i].pg = pgs[i];
+		nvme->groups[i].idx = i;
+		STAILQ_INIT(&nvme->groups[i].free_tasks);
+	}
+
+	rc = vhost_session_send_event(pgs[0], vsession, spdk_vhost_nvme_start_cb,
+				      3, "start session");
+	if (rc != 0) {
+		free(nvme->groups);
+		nvme->groups = NULL;
+		nvme->num_groups = 0;
+		return rc;
+	}
+
+	/* The first poll group is referenced by the session itself */
+	for (i = 1; i < num_pgs; i++) {
+		pgs[i]->ref++;
+	}
+
+	return 0;
 }
 
 static void
@@ -1157,24 +1498,27 @@ static int
 destroy_device_poller_cb(void *arg)
 {
 	struct spdk_vhost_nvme_dev *nvme = arg;
-	struct spdk_vhost_nvme_ns *ns_dev;
 	uint32_t i;
 
 	SPDK_DEBUGLOG(SPDK_LOG_VHOST_NVME, "Destroy device poller callback\n");
 
-	/* FIXME wait for pending I/Os to complete */
+	if (nvme->num_groups_running > 0) {
+		return -1;
+	}
 
 	if (spdk_vhost_trylock() != 0) {
 		return -1;
 	}
 
-	for (i = 0; i < nvme->num_ns; i++) {
-		ns_dev = &nvme->ns[i];
-		if (ns_dev->bdev_io_channel) {
-			spdk_put_io_channel(ns_dev->bdev_io_channel);
-			ns_dev->bdev_io_channel = NULL;
-		}
+	for (i = 1; i < nvme->num_groups; i++) {
+		assert(nvme->groups[i].pg->ref > 0);
+		nvme->groups[i].pg->ref--;
 	}
+
+	free(nvme->groups);
+	nvme->groups = NULL;
+	nvme->num_groups = 0;
+
 	/* Clear BAR space */
 	if (nvme->bar) {
 		memset((void *)nvme->bar, 0, nvme->bar_size);
@@ -1192,21 +1536,76 @@ destroy_device_poller_cb(void *arg)
 	return -1;
 }
 
+static void
+vhost_nvme_group_stopped(void *arg)
+{
+	struct spdk_vhost_nvme_dev *nvme = arg;
+
+	assert(nvme->num_groups_running > 0);
+	nvme->num_groups_running--;
+}
+
+static int
+vhost_nvme_group_stop_poller_cb(void *arg)
+{
+	struct spdk_vhost_nvme_queue_group *group = arg;
+	struct spdk_vhost_nvme_dev *nvme = group->nvme;
+	struct spdk_vhost_nvme_task *task;
+	struct spdk_vhost_nvme_cq *cq;
+	uint32_t qid;
+
+	/* CQEs are no longer posted, so tasks completed in the meantime
+	 * are simply returned to the pool.
+	 */
+	for (qid = group->idx + 1; qid <= MAX_IO_QUEUES; qid += nvme->num_groups) {
+		cq = spdk_vhost_nvme_get_cq_from_qid(nvme, qid);
+		while ((task = STAILQ_FIRST(&cq->pending_tasks)) != NULL) {
+			STAILQ_REMOVE_HEAD(&cq->pending_tasks, stailq);
+			vhost_nvme_put_task(task);
+		}
+	}
+
+	if (group->task_cnt > 0) {
+		return -1;
+	}
+
+	vhost_nvme_group_put_channels(group);
+	free_task_pool(group);
+
+	spdk_poller_unregister(&group->stop_poller);
+	spdk_thread_send_msg(nvme->vsession->poll_group->thread, vhost_nvme_group_stopped, nvme);
+	return -1;
+}
+
+static void
+vhost_nvme_group_stop(void *arg)
+{
+	struct spdk_vhost_nvme_queue_group *group = arg;
+
+	spdk_poller_unregister(&group->requestq_poller);
+	group->stop_poller = spdk_poller_register(vhost_nvme_group_stop_poller_cb, group, 1000);
+}
+
 static int
 spdk_vhost_nvme_stop_cb(struct spdk_vhost_dev *vdev,
 			struct spdk_vhost_session *vsession, void *unused)
 {
 	struct spdk_vhost_nvme_dev *nvme = to_nvme_dev(vdev);
+	uint16_t i;
 
 	if (nvme == NULL) {
 		vhost_session_stop_done(vsession, -1);
 		return -1;
 	}
 
-	free_task_pool(nvme);
 	SPDK_NOTICELOG("Stopping Device %u, Path %s\n", vsession->vid, vdev->path);
 
-	spdk_poller_unregister(&nvme->requestq_poller);
+	vhost_nvme_group_stop(&nvme->groups[0]);
+	for (i = 1; i < nvme->num_groups; i++) {
+		spdk_thread_send_msg(nvme->groups[i].pg->thread, vhost_nvme_group_stop,
+				     &nvme->groups[i]);
+	}
+
 	nvme->stop_poller = spdk_poller_register(destroy_device_poller_cb, nvme, 1000);
 
 	return 0;
@@ -1403,7 +1802,6 @@ vhost_nvme_dev_construct(const char *name, const char *cpumask, uint32_t num_io_
 	}
 
 	dev->num_io_queues = num_io_queues;
-	STAILQ_INIT(&dev->free_tasks);
 	TAILQ_INSERT_TAIL(&g_nvme_ctrlrs, dev, tailq);
 
 	spdk_vhost_nvme_ctrlr_identify_update(dev);
@@ -117,6 +117,7 @@ struct spdk_vhost_scsi_session {
 	struct spdk_poller *requestq_poller;
 	struct spdk_poller *mgmt_poller;
 	struct spdk_poller *stop_poller;
+	struct vhost_poller_intr requestq_intr;
 };
 
 struct spdk_vhost_scsi_task {
@@ -135,6 +136,9 @@ struct spdk_vhost_scsi_task {
 	uint32_t used_len;
 
 	int req_idx;
+	/* Buffer id and number of ring entries of a packed virtqueue request */
+	uint16_t buffer_id;
+	uint16_t num_descs;
 
 	/* If set, the task is currently used for I/O processing. */
 	bool used;
@@ -271,33 +275,40 @@ eventq_enqueue(struct spdk_vhost_scsi_session *svsession, unsigned scsi_dev_num,
 {
 	struct spdk_vhost_session *vsession = &svsession->vsession;
 	struct spdk_vhost_virtqueue *vq;
-	struct vring_desc *desc, *desc_table;
+	struct vhost_vring_desc_iter iter;
 	struct virtio_scsi_event *desc_ev;
-	uint32_t desc_table_size, req_size = 0;
-	uint16_t req;
+	uint32_t req_size = 0;
+	uint16_t req, buffer_id = 0, num_descs = 0;
 	int rc;
 
 	assert(scsi_dev_num < SPDK_VHOST_SCSI_CTRLR_MAX_DEVS);
 	vq = &vsession->virtqueue[VIRTIO_SCSI_EVENTQ];
 
-	if (vq->vring.desc == NULL || vhost_vq_avail_ring_get(vq, &req, 1) != 1) {
+	if (vq->vring.desc == NULL ||
+	    (vq->packed.packed_ring ? !vhost_vq_packed_ring_is_avail(vq) :
+	     vhost_vq_avail_ring_get(vq, &req, 1) != 1)) {
 		SPDK_ERRLOG("%s: failed to send virtio event (no avail ring entries?).\n",
 			    vsession->name);
 		return;
 	}
 
-	rc = vhost_vq_get_desc(vsession, vq, req, &desc, &desc_table, &desc_table_size);
-	if (rc != 0 || desc->len < sizeof(*desc_ev)) {
+	if (vq->packed.packed_ring) {
+		req = vq->last_avail_idx;
+		buffer_id = vhost_vq_packed_ring_get_buffer_id(vq, &num_descs);
+	}
+
+	rc = vhost_vring_desc_iter_init(vsession, vq, req, &iter);
+	if (rc != 0 || iter.len < sizeof(*desc_ev)) {
 		SPDK_ERRLOG("%s: invalid eventq descriptor at index %"PRIu16".\n",
 			    vsession->name, req);
 		goto out;
 	}
 
-	desc_ev = vhost_gpa_to_vva(vsession, desc->addr, sizeof(*desc_ev));
+	desc_ev = vhost_gpa_to_vva(vsession, iter.addr, sizeof(*desc_ev));
 	if (desc_ev == NULL) {
 		SPDK_ERRLOG("%s: eventq descriptor at index %"PRIu16" points "
 			    "to unmapped guest memory address %p.\n",
-			    vsession->name, req, (void *)(uintptr_t)desc->addr);
+			    vsession->name, req, (void *)(uintptr_t)iter.addr);
 		goto out;
 	}
 
@@ -317,16 +328,30 @@ eventq_enqueue(struct spdk_vhost_scsi_session *svsession, unsigned scsi_dev_num,
 	req_size = sizeof(*desc_ev);
 
 out:
-	vhost_vq_used_ring_enqueue(vsession, vq, req, req_size);
+	if (vq->packed.packed_ring) {
+		vhost_vq_packed_ring_enqueue(vsession, vq, num_descs, buffer_id, req_size);
+	} else {
+		vhost_vq_used_ring_enqueue(vsession, vq, req, req_size);
+	}
 }
 
 static void
-submit_completion(struct spdk_vhost_scsi_task *task)
+vhost_scsi_task_enqueue(struct spdk_vhost_scsi_task *task, uint32_t used_len)
 {
 	struct spdk_vhost_session *vsession = &task->svsession->vsession;
 
-	vhost_vq_used_ring_enqueue(vsession, task->vq, task->req_idx,
-				   task->used_len);
+	if (task->vq->packed.packed_ring) {
+		vhost_vq_packed_ring_enqueue(vsession, task->vq, task->num_descs, task->buffer_id,
+					     used_len);
+	} else {
+		vhost_vq_used_ring_enqueue(vsession, task->vq, task->req_idx, used_len);
+	}
+}
+
+static void
+submit_completion(struct spdk_vhost_scsi_task *task)
+{
+	vhost_scsi_task_enqueue(task, task->used_len);
 	SPDK_DEBUGLOG(SPDK_LOG_VHOST_SCSI, "Finished task (%p) req_idx=%d\n", task, task->req_idx);
 
 	vhost_scsi_task_put(task);
@@ -380,10 +405,7 @@ mgmt_task_submit(struct spdk_vhost_scsi_task *task, enum spdk_scsi_task_func fun
 static void
 invalid_request(struct spdk_vhost_scsi_task *task)
 {
-	struct spdk_vhost_session *vsession = &task->svsession->vsession;
-
-	vhost_vq_used_ring_enqueue(vsession, task->vq, task->req_idx,
-				   task->used_len);
+	vhost_scsi_task_enqueue(task, task->used_len);
 	vhost_scsi_task_put(task);
 
 	SPDK_DEBUGLOG(SPDK_LOG_VHOST_SCSI, "Invalid request (status=%" PRIu8")\n",
@@ -422,22 +444,21 @@ static void
 process_ctrl_request(struct spdk_vhost_scsi_task *task)
 {
 	struct spdk_vhost_session *vsession = &task->svsession->vsession;
-	struct vring_desc *desc, *desc_table;
+	struct vhost_vring_desc_iter iter;
 	struct virtio_scsi_ctrl_tmf_req *ctrl_req;
 	struct virtio_scsi_ctrl_an_resp *an_resp;
-	uint32_t desc_table_size, used_len = 0;
+	uint32_t used_len = 0;
 	int rc;
 
 	spdk_scsi_task_construct(&task->scsi, vhost_scsi_task_mgmt_cpl, vhost_scsi_task_free_cb);
-	rc = vhost_vq_get_desc(vsession, task->vq, task->req_idx, &desc, &desc_table,
-			       &desc_table_size);
+	rc = vhost_vring_desc_iter_init(vsession, task->vq, task->req_idx, &iter);
 	if (spdk_unlikely(rc != 0)) {
 		SPDK_ERRLOG("%s: invalid controlq descriptor at index %d.\n",
 			    vsession->name, task->req_idx);
 		goto out;
 	}
 
-	ctrl_req = vhost_gpa_to_vva(vsession, desc->addr, sizeof(*ctrl_req));
+	ctrl_req = vhost_gpa_to_vva(vsession, iter.addr, sizeof(*ctrl_req));
 	if (ctrl_req == NULL) {
 		SPDK_ERRLOG("%s: invalid task management request at index %d.\n",
 			    vsession->name, task->req_idx);
@@ -445,15 +466,15 @@ process_ctrl_request(struct spdk_vhost_scsi_task *task)
 	}
 
 	SPDK_DEBUGLOG(SPDK_LOG_VHOST_SCSI_QUEUE,
-		      "Processing controlq descriptor: desc %d/%p, desc_addr %p, len %d, flags %d, last_used_idx %d; kickfd %d; size %d\n",
-		      task->req_idx, desc, (void *)desc->addr, desc->len, desc->flags, task->vq->last_used_idx,
+		      "Processing controlq descriptor: desc %d/%p, desc_addr %p, len %d, wr %d, last_used_idx %d; kickfd %d; size %d\n",
+		      task->req_idx, iter.desc, (void *)iter.addr, iter.len, iter.wr, task->vq->last_used_idx,
 		      task->vq->vring.kickfd, task->vq->vring.size);
-	SPDK_LOGDUMP(SPDK_LOG_VHOST_SCSI_QUEUE, "Request descriptor", (uint8_t *)ctrl_req, desc->len);
+	SPDK_LOGDUMP(SPDK_LOG_VHOST_SCSI_QUEUE, "Request descriptor", (uint8_t *)ctrl_req, iter.len);
 
 	vhost_scsi_task_init_target(task, ctrl_req->lun);
 
-	vhost_vring_desc_get_next(&desc, desc_table, desc_table_size);
-	if (spdk_unlikely(desc == NULL)) {
+	vhost_vring_desc_iter_next(&iter);
+	if (spdk_unlikely(iter.desc == NULL)) {
 		SPDK_ERRLOG("%s: no response descriptor for controlq request %d.\n",
 			    vsession->name, task->req_idx);
 		goto out;
@@ -462,8 +483,8 @@ process_ctrl_request(struct spdk_vhost_scsi_task *task)
 	/* Process the TMF request */
 	switch (ctrl_req->type) {
 	case VIRTIO_SCSI_T_TMF:
-		task->tmf_resp = vhost_gpa_to_vva(vsession, desc->addr, sizeof(*task->tmf_resp));
-		if (spdk_unlikely(desc->len < sizeof(struct virtio_scsi_ctrl_tmf_resp) || task->tmf_resp == NULL)) {
+		task->tmf_resp = vhost_gpa_to_vva(vsession, iter.addr, sizeof(*task->tmf_resp));
+		if (spdk_unlikely(iter.len < sizeof(struct virtio_scsi_ctrl_tmf_resp) || task->tmf_resp == NULL)) {
 			SPDK_ERRLOG("%s: TMF response descriptor at index %d points to invalid guest memory region\n",
 				    vsession->name, task->req_idx);
 			goto out;
@@ -492,8 +513,8 @@ process_ctrl_request(struct spdk_vhost_scsi_task *task)
 		break;
 	case VIRTIO_SCSI_T_AN_QUERY:
 	case VIRTIO_SCSI_T_AN_SUBSCRIBE: {
-		an_resp = vhost_gpa_to_vva(vsession, desc->addr, sizeof(*an_resp));
-		if (spdk_unlikely(desc->len < sizeof(struct virtio_scsi_ctrl_an_resp) || an_resp == NULL)) {
+		an_resp = vhost_gpa_to_vva(vsession, iter.addr, sizeof(*an_resp));
+		if (spdk_unlikely(iter.len < sizeof(struct virtio_scsi_ctrl_an_resp) || an_resp == NULL)) {
 			SPDK_WARNLOG("%s: asynchronous response descriptor points to invalid guest memory region\n",
 				     vsession->name);
 			goto out;
@@ -510,7 +531,7 @@ process_ctrl_request(struct spdk_vhost_scsi_task *task)
 
 	used_len = sizeof(struct virtio_scsi_ctrl_tmf_resp);
 out:
-	vhost_vq_used_ring_enqueue(vsession, task->vq, task->req_idx, used_len);
+	vhost_scsi_task_enqueue(task, used_len);
 	vhost_scsi_task_put(task);
 }
 
@@ -525,24 +546,24 @@ task_data_setup(struct spdk_vhost_scsi_task *task,
 		struct virtio_scsi_cmd_req **req)
 {
 	struct spdk_vhost_session *vsession = &task->svsession->vsession;
-	struct vring_desc *desc, *desc_table;
+	struct vhost_vring_desc_iter iter;
 	struct iovec *iovs = task->iovs;
 	uint16_t iovcnt = 0;
-	uint32_t desc_table_len, len = 0;
+	uint32_t len = 0;
 	int rc;
 
 	spdk_scsi_task_construct(&task->scsi, vhost_scsi_task_cpl, vhost_scsi_task_free_cb);
 
-	rc = vhost_vq_get_desc(vsession, task->vq, task->req_idx, &desc, &desc_table, &desc_table_len);
+	rc = vhost_vring_desc_iter_init(vsession, task->vq, task->req_idx, &iter);
 	/* First descriptor must be readable */
-	if (spdk_unlikely(rc != 0  || vhost_vring_desc_is_wr(desc) ||
-			  desc->len < sizeof(struct virtio_scsi_cmd_req))) {
+	if (spdk_unlikely(rc != 0  || iter.wr ||
+			  iter.len < sizeof(struct virtio_scsi_cmd_req))) {
 		SPDK_WARNLOG("%s: invalid first request descriptor at index %"PRIu16".\n",
 			     vsession->name, task->req_idx);
 		goto invalid_task;
 	}
 
-	*req = vhost_gpa_to_vva(vsession, desc->addr, sizeof(**req));
+	*req = vhost_gpa_to_vva(vsession, iter.addr, sizeof(**req));
 	if (spdk_unlikely(*req == NULL)) {
 		SPDK_WARNLOG("%s: request descriptor at index %d points to invalid guest memory region\n",
 			     vsession->name, task->req_idx);
@@ -550,13 +571,13 @@ task_data_setup(struct spdk_vhost_scsi_task *task,
 	}
 
 	/* Each request must have at least 2 descriptors (e.g. request and response) */
-	vhost_vring_desc_get_next(&desc, desc_table, desc_table_len);
-	if (desc == NULL) {
+	vhost_vring_desc_iter_next(&iter);
+	if (iter.desc == NULL) {
 		SPDK_WARNLOG("%s: descriptor chain at index %d contains neither payload nor response buffer.\n",
 			     vsession->name, task->req_idx);
 		goto invalid_task;
 	}
-	task->scsi.dxfer_dir = vhost_vring_desc_is_wr(desc) ? SPDK_SCSI_DIR_FROM_DEV :
+	task->scsi.dxfer_dir = iter.wr ? SPDK_SCSI_DIR_FROM_DEV :
 			       SPDK_SCSI_DIR_TO_DEV;
 	task->scsi.iovs = iovs;
 
@@ -564,20 +585,20 @@ task_data_setup(struct spdk_vhost_scsi_task *task,
 		/*
 		 * FROM_DEV (READ): [RD_req][WR_resp][WR_buf0]...[WR_bufN]
 		 */
-		task->resp = vhost_gpa_to_vva(vsession, desc->addr, sizeof(*task->resp));
-		if (spdk_unlikely(desc->len < sizeof(struct virtio_scsi_cmd_resp) || task->resp == NULL)) {
+		task->resp = vhost_gpa_to_vva(vsession, iter.addr, sizeof(*task->resp));
+		if (spdk_unlikely(iter.len < sizeof(struct virtio_scsi_cmd_resp) || task->resp == NULL)) {
 			SPDK_WARNLOG("%s: response descriptor at index %d points to invalid guest memory region\n",
 				     vsession->name, task->req_idx);
 			goto invalid_task;
 		}
-		rc = vhost_vring_desc_get_next(&desc, desc_table, desc_table_len);
+		rc = vhost_vring_desc_iter_next(&iter);
 		if (spdk_unlikely(rc != 0)) {
 			SPDK_WARNLOG("%s: invalid descriptor chain at request index %d (descriptor id overflow?).\n",
 				     vsession->name, task->req_idx);
 			goto invalid_task;
 		}
 
-		if (desc == NULL) {
+		if (iter.desc == NULL) {
 			/*
 			 * TEST UNIT READY command and some others might not contain any payload and this is not an error.
 			 */
@@ -593,19 +614,20 @@ task_data_setup(struct spdk_vhost_scsi_task *task,
 		}
 
 		/* All remaining descriptors are data. */
-		while (desc) {
-			if (spdk_unlikely(!vhost_vring_desc_is_wr(desc))) {
+		while (iter.desc) {
+			if (spdk_unlikely(!iter.wr)) {
 				SPDK_WARNLOG("%s: FROM DEV cmd: descriptor nr %" PRIu16" in payload chain is read only.\n",
 					     vsession->name, iovcnt);
 				goto invalid_task;
 			}
 
-			if (spdk_unlikely(vhost_vring_desc_to_iov(vsession, iovs, &iovcnt, desc))) {
+			rc = vhost_vring_desc_iter_to_iov(vsession, iovs, &iovcnt, &iter);
+			if (spdk_unlikely(rc != 0)) {
 				goto invalid_task;
 			}
-			len += desc->len;
+			len += iter.len;
 
-			rc = vhost_vring_desc_get_next(&desc, desc_table, desc_table_len);
+			rc = vhost_vring_desc_iter_next(&iter);
 			if (spdk_unlikely(rc != 0)) {
 				SPDK_WARNLOG("%s: invalid payload in descriptor chain starting at index %d.\n",
 					     vsession->name, task->req_idx);
@@ -622,21 +644,22 @@ task_data_setup(struct spdk_vhost_scsi_task *task,
 		 */
 
 		/* Process descriptors up to response. */
-		while (!vhost_vring_desc_is_wr(desc)) {
-			if (spdk_unlikely(vhost_vring_desc_to_iov(vsession, iovs, &iovcnt, desc))) {
+		while (!iter.wr) {
+			rc = vhost_vring_desc_iter_to_iov(vsession, iovs, &iovcnt, &iter);
+			if (spdk_unlikely(rc != 0)) {
 				goto invalid_task;
 			}
-			len += desc->len;
+			len += iter.len;
 
-			vhost_vring_desc_get_next(&desc, desc_table, desc_table_len);
-			if (spdk_unlikely(desc == NULL)) {
+			vhost_vring_desc_iter_next(&iter);
+			if (spdk_unlikely(iter.desc == NULL)) {
 				SPDK_WARNLOG("%s: TO_DEV cmd: no response descriptor.\n", vsession->name);
 				goto invalid_task;
 			}
 		}
 
-		task->resp = vhost_gpa_to_vva(vsession, desc->addr, sizeof(*task->resp));
-		if (spdk_unlikely(desc->len < sizeof(struct virtio_scsi_cmd_resp) || task->resp == NULL)) {
+		task->resp = vhost_gpa_to_vva(vsession, iter.addr, sizeof(*task->resp));
+		if (spdk_unlikely(iter.len < sizeof(struct virtio_scsi_cmd_resp) || task->resp == NULL)) {
 			SPDK_WARNLOG("%s: response descriptor at index %d points to invalid guest memory region\n",
 				     vsession->name, task->req_idx);
 			goto invalid_task;
@@ -686,54 +709,93 @@ process_request(struct spdk_vhost_scsi_task *task)
 }
 
 static void
-process_controlq(struct spdk_vhost_scsi_session *svsession, struct spdk_vhost_virtqueue *vq)
+process_ctrl_task(struct spdk_vhost_scsi_task *task)
 {
-	struct spdk_vhost_session *vsession = &svsession->vsession;
-	struct spdk_vhost_scsi_task *task;
-	uint16_t reqs[32];
-	uint16_t reqs_cnt, i;
-
-	reqs_cnt = vhost_vq_avail_ring_get(vq, reqs, SPDK_COUNTOF(reqs));
-	for (i = 0; i < reqs_cnt; i++) {
-		if (spdk_unlikely(reqs[i] >= vq->vring.size)) {
-			SPDK_ERRLOG("%s: invalid entry in avail ring. Buffer '%"PRIu16"' exceeds virtqueue size (%"PRIu16")\n",
-				    vsession->name, reqs[i], vq->vring.size);
-			vhost_vq_used_ring_enqueue(vsession, vq, reqs[i], 0);
-			continue;
-		}
+	task->svsession->vsession.task_cnt++;
+	memset(&task->scsi, 0, sizeof(task->scsi));
+	task->tmf_resp = NULL;
+	process_ctrl_request(task);
+}
 
-		task = &((struct spdk_vhost_scsi_task *)vq->tasks)[reqs[i]];
-		if (spdk_unlikely(task->used)) {
-			SPDK_ERRLOG("%s: invalid entry in avail ring. Buffer '%"PRIu16"' is still in use!\n",
-				    vsession->name, reqs[i]);
-			vhost_vq_used_ring_enqueue(vsession, vq, reqs[i], 0);
-			continue;
-		}
+static void
+process_request_task(struct spdk_vhost_scsi_task *task)
+{
+	int result;
 
-		vsession->task_cnt++;
-		memset(&task->scsi, 0, sizeof(task->scsi));
-		task->tmf_resp = NULL;
-		task->used = true;
-		process_ctrl_request(task);
+	SPDK_DEBUGLOG(SPDK_LOG_VHOST_SCSI, "====== Starting processing request idx %d======\n",
+		      task->req_idx);
+
+	task->svsession->vsession.task_cnt++;
+	memset(&task->scsi, 0, sizeof(task->scsi));
+	task->resp = NULL;
+	task->used_len = 0;
+	result = process_request(task);
+	if (likely(result == 0)) {
+		task_submit(task);
+		SPDK_DEBUGLOG(SPDK_LOG_VHOST_SCSI, "====== Task %p req_idx %d submitted ======\n", task,
+			      task->req_idx);
+	} else if (result > 0) {
+		vhost_scsi_task_cpl(&task->scsi);
+		SPDK_DEBUGLOG(SPDK_LOG_VHOST_SCSI, "====== Task %p req_idx %d finished early ======\n", task,
+			      task->req_idx);
+	} else {
+		invalid_request(task);
+		SPDK_DEBUGLOG(SPDK_LOG_VHOST_SCSI, "====== Task %p req_idx %d failed ======\n", task,
+			      task->req_idx);
 	}
 }
 
-static void
-process_requestq(struct spdk_vhost_scsi_session *svsession, struct spdk_vhost_virtqueue *vq)
+/*
+ * Fetch up to reqs_len new requests from either a split or a packed virtqueue
+ * and pass each of them to process_fn. Split virtqueue tasks are indexed by the
+ * head descriptor index, packed virtqueue ones by the buffer id of the chain.
+ * Requests with an invalid or busy task index are completed right away.
+ *
+ * A packed request is processed before the next one is fetched, since completing
+ * a request writes a used descriptor into the ring, possibly over the chains of
+ * requests that haven't been parsed yet.
+ */
+static uint16_t
+vhost_scsi_vq_process_tasks(struct spdk_vhost_session *vsession, struct spdk_vhost_virtqueue *vq,
+			    uint16_t reqs_len, void (*process_fn)(struct spdk_vhost_scsi_task *task))
 {
-	struct spdk_vhost_session *vsession = &svsession->vsession;
 	struct spdk_vhost_scsi_task *task;
 	uint16_t reqs[32];
-	uint16_t reqs_cnt, i;
-	int result;
+	uint16_t reqs_cnt, i, req_idx, task_idx, num_descs;
+	uint16_t tasks_cnt = 0;
+
+	assert(reqs_len <= SPDK_COUNTOF(reqs));
+	if (vq->packed.packed_ring) {
+		for (i = 0; i < reqs_len && vhost_vq_packed_ring_is_avail(vq); i++) {
+			req_idx = vq->last_avail_idx;
+			task_idx = vhost_vq_packed_ring_get_buffer_id(vq, &num_descs);
+			if (spdk_unlikely(task_idx >= vq->vring.size)) {
+				SPDK_ERRLOG("%s: buffer id '%"PRIu16"' exceeds virtqueue size (%"PRIu16").\n",
+					    vsession->name, task_idx, vq->vring.size);
+				vhost_vq_packed_ring_enqueue(vsession, vq, num_descs, task_idx, 0);
+				continue;
+			}
 
-	reqs_cnt = vhost_vq_avail_ring_get(vq, reqs, SPDK_COUNTOF(reqs));
-	assert(reqs_cnt <= 32);
+			task = &((struct spdk_vhost_scsi_task *)vq->tasks)[task_idx];
+			if (spdk_unlikely(task->used)) {
+				SPDK_ERRLOG("%s: request with buffer id '%"PRIu16"' is already pending.\n",
+					    vsession->name, task_idx);
+				vhost_vq_packed_ring_enqueue(vsession, vq, num_descs, task_idx, 0);
+				continue;
+			}
 
-	for (i = 0; i < reqs_cnt; i++) {
-		SPDK_DEBUGLOG(SPDK_LOG_VHOST_SCSI, "====== Starting processing request idx %"PRIu16"======\n",
-			      reqs[i]);
+			task->used = true;
+			task->req_idx = req_idx;
+			task->buffer_id = task_idx;
+			task->num_descs = num_descs;
+			process_fn(task);
+			tasks_cnt++;
+		}
+		return tasks_cnt;
+	}
 
+	reqs_cnt = vhost_vq_avail_ring_get(vq, reqs, reqs_len);
+	for (i = 0; i < reqs_cnt; i++) {
 		if (spdk_unlikely(reqs[i] >= vq->vring.size)) {
 			SPDK_ERRLOG("%s: request idx '%"PRIu16"' exceeds virtqueue size (%"PRIu16").\n",
 				    vsession->name, reqs[i], vq->vring.size);
@@ -749,26 +811,24 @@ process_requestq(struct spdk_vhost_scsi_session *svsession, struct spdk_vhost_vi
 			continue;
 		}
 
-		vsession->task_cnt++;
-		memset(&task->scsi, 0, sizeof(task->scsi));
-		task->resp = NULL;
 		task->used = true;
-		task->used_len = 0;
-		result = process_request(task);
-		if (likely(result == 0)) {
-			task_submit(task);
-			SPDK_DEBUGLOG(SPDK_LOG_VHOST_SCSI, "====== Task %p req_idx %d submitted ======\n", task,
-				      task->req_idx);
-		} else if (result > 0) {
-			vhost_scsi_task_cpl(&task->scsi);
-			SPDK_DEBUGLOG(SPDK_LOG_VHOST_SCSI, "====== Task %p req_idx %d finished early ======\n", task,
-				      task->req_idx);
-		} else {
-			invalid_request(task);
-			SPDK_DEBUGLOG(SPDK_LOG_VHOST_SCSI, "====== Task %p req_idx %d failed ======\n", task,
-				      task->req_idx);
-		}
+		process_fn(task);
+		tasks_cnt++;
 	}
+
+	return tasks_cnt;
+}
+
+static void
+process_controlq(struct spdk_vhost_scsi_session *svsession, struct spdk_vhost_virtqueue *vq)
+{
+	vhost_scsi_vq_process_tasks(&svsession->vsession, vq, 32, process_ctrl_task);
+}
+
+static uint16_t
+process_requestq(struct spdk_vhost_scsi_session *svsession, struct spdk_vhost_virtqueue *vq)
+{
+	return vhost_scsi_vq_process_tasks(&svsession->vsession, vq, 32, process_request_task);
 }
 
 static int
@@ -791,14 +851,18 @@ vdev_worker(void *arg)
 {
 	struct spdk_vhost_scsi_session *svsession = arg;
 	struct spdk_vhost_session *vsession = &svsession->vsession;
+	uint32_t tasks_cnt = 0;
 	uint32_t q_idx;
 
 	for (q_idx = VIRTIO_SCSI_REQUESTQ; q_idx < vsession->max_queues; q_idx++) {
-		process_requestq(svsession, &vsession->virtqueue[q_idx]);
+		tasks_cnt += process_requestq(svsession, &vsession->virtqueue[q_idx]);
 	}
 
 	vhost_session_used_signal(vsession);
 
+	vhost_poller_intr_update(&svsession->requestq_intr,
+				 tasks_cnt == 0 && vsession->task_cnt == 0);
+
 	return -1;
 }
 
@@ -1346,6 +1410,8 @@ vhost_scsi_start_cb(struct spdk_vhost_dev *vdev,
 		     vsession->name, spdk_env_get_current_core());
 
 	svsession->requestq_poller = spdk_poller_register(vdev_worker, svsession, 0);
+	vhost_poller_intr_init(&svsession->requestq_intr, vsession, svdev->poll_group,
+			       svsession->requestq_poller, VIRTIO_SCSI_REQUESTQ, 1);
 	if (vsession->virtqueue[VIRTIO_SCSI_CONTROLQ].vring.desc &&
 	    vsession->virtqueue[VIRTIO_SCSI_EVENTQ].vring.desc) {
 		svsession->mgmt_poller = spdk_poller_register(vdev_mgmt_worker, svsession,
@@ -1437,6 +1503,7 @@ vhost_scsi_stop_cb(struct spdk_vhost_dev *vdev,
 	struct spdk_vhost_scsi_session *svsession = to_scsi_session(vsession);
 
 	/* Stop receiving new I/O requests */
+	vhost_poller_intr_fini(&svsession->requestq_intr);
 	spdk_poller_unregister(&svsession->requestq_poller);
 
 	/* Stop receiving controlq requests, also stop processing the
@@ -43,12 +43,14 @@
 #include "spdk/json.h"
 #include "spdk/nvme.h"
 #include "spdk/nvme_ocssd.h"
+#include "spdk/nvme_zns.h"
 #include "spdk/thread.h"
 #include "spdk/string.h"
 #include "spdk/likely.h"
 #include "spdk/util.h"
 
 #include "spdk/bdev_module.h"
+#include "spdk/bdev_zone.h"
 #include "spdk_internal/log.h"
 
 #define SPDK_BDEV_NVME_DEFAULT_DELAY_CMD_SUBMIT true
@@ -89,6 +91,12 @@ struct nvme_bdev_io {
 
 	/** Keeps track if first of fused commands was submitted */
 	bool first_fused_submitted;
+
+	/** Buffer used to retrieve zone reports from a Zoned Namespace */
+	struct spdk_nvme_zns_zone_report *zone_report_buf;
+
+	/** Number of zones already filled in for a get zone info request */
+	uint64_t handled_zones;
 };
 
 struct nvme_probe_ctx {
@@ -120,6 +128,7 @@ static struct spdk_bdev_nvme_opts g_opts = {
 	.nvme_ioq_poll_period_us = 0,
 	.io_queue_requests = 0,
 	.delay_cmd_submit = SPDK_BDEV_NVME_DEFAULT_DELAY_CMD_SUBMIT,
+	.weighted_round_robin = false,
 };
 
 #define NVME_HOTPLUG_POLL_PERIOD_MAX			10000000ULL
@@ -133,6 +142,17 @@ static struct spdk_poller *g_hotplug_poller;
 static struct spdk_nvme_probe_ctx *g_hotplug_probe_ctx;
 static char *g_nvme_hostnqn = NULL;
 
+/*
+ * State of the controllers from the configuration file that are attached
+ *  asynchronously during module initialization.
+ */
+static struct nvme_probe_ctx *g_init_probe_ctx;
+static struct spdk_nvme_probe_ctx *g_init_pcie_probe_ctx;
+static struct spdk_poller *g_init_pcie_poller;
+static uint32_t g_init_ctrlrs_outstanding;
+static bool g_init_hotplug_enabled;
+static int64_t g_init_hotplug_period;
+
 static void nvme_ctrlr_populate_namespaces(struct nvme_bdev_ctrlr *nvme_bdev_ctrlr,
 		struct nvme_async_probe_ctx *ctx);
 static void nvme_ctrlr_populate_namespaces_done(struct nvme_async_probe_ctx *ctx);
@@ -163,6 +183,18 @@ static int bdev_nvme_io_passthru_md(struct nvme_bdev *nbdev, struct spdk_io_chan
 				    struct nvme_bdev_io *bio,
 				    struct spdk_nvme_cmd *cmd, void *buf, size_t nbytes, void *md_buf, size_t md_len);
 static int bdev_nvme_reset(struct nvme_bdev_ctrlr *nvme_bdev_ctrlr, struct nvme_bdev_io *bio);
+static int bdev_nvme_alloc_io_qpairs(struct nvme_bdev_ctrlr *nvme_bdev_ctrlr,
+				     struct nvme_io_channel *ch);
+static void bdev_nvme_free_prio_qpairs(struct nvme_io_channel *ch);
+static int bdev_nvme_zone_appendv(struct nvme_bdev *nbdev, struct spdk_io_channel *ch,
+				  struct nvme_bdev_io *bio, struct iovec *iov, int iovcnt, void *md,
+				  uint64_t lba_count, uint64_t zslba);
+static int bdev_nvme_get_zone_info(struct nvme_bdev *nbdev, struct spdk_io_channel *ch,
+				   struct nvme_bdev_io *bio, uint64_t zone_id, uint32_t num_zones,
+				   struct spdk_bdev_zone_info *info);
+static int bdev_nvme_zone_management(struct nvme_bdev *nbdev, struct spdk_io_channel *ch,
+				     struct nvme_bdev_io *bio, uint64_t zone_id,
+				     enum spdk_bdev_zone_action action);
 
 typedef void (*populate_namespace_fn)(struct nvme_bdev_ctrlr *nvme_bdev_ctrlr,
 				      struct nvme_bdev_ns *nvme_ns, struct nvme_async_probe_ctx *ctx);
@@ -204,6 +236,16 @@ spdk_bdev_nvme_get_io_qpair(struct spdk_io_channel *ctrlr_io_ch)
 	return nvme_ch->qpair;
 }
 
+static inline struct spdk_nvme_qpair *
+bdev_nvme_io_qpair(struct nvme_io_channel *nvme_ch, struct nvme_bdev_io *bio)
+{
+	struct spdk_nvme_qpair *qpair;
+
+	qpair = nvme_ch->prio_qpairs[spdk_bdev_io_from_ctx(bio)->priority];
+
+	return qpair != NULL ? qpair : nvme_ch->qpair;
+}
+
 static int
 bdev_nvme_get_ctx_size(void)
 {
@@ -212,6 +254,7 @@ bdev_nvme_get_ctx_size(void)
 
 static struct spdk_bdev_module nvme_if = {
 	.name = "nvme",
+	.async_init = true,
 	.module_init = bdev_nvme_library_init,
 	.module_fini = bdev_nvme_library_fini,
 	.config_text = bdev_nvme_get_spdk_running_config,
@@ -225,7 +268,8 @@ static int
 bdev_nvme_poll(void *arg)
 {
 	struct nvme_io_channel *ch = arg;
-	int32_t num_completions;
+	int32_t num_completions, rc;
+	int i;
 
 	if (ch->qpair == NULL) {
 		return -1;
@@ -236,6 +280,14 @@ bdev_nvme_poll(void *arg)
 	}
 
 	num_completions = spdk_nvme_qpair_process_completions(ch->qpair, 0);
+	for (i = 0; i < SPDK_BDEV_NUM_IO_PRIORITIES; i++) {
+		if (ch->prio_qpairs[i] != NULL) {
+			rc = spdk_nvme_qpair_process_completions(ch->prio_qpairs[i], 0);
+			if (rc > 0) {
+				num_completions += rc;
+			}
+		}
+	}
 
 	if (ch->collect_spin_stat) {
 		if (num_completions > 0) {
@@ -357,18 +409,11 @@ _bdev_nvme_reset_create_qpair(struct spdk_io_channel_iter *i)
 	struct nvme_bdev_ctrlr *nvme_bdev_ctrlr = spdk_io_channel_iter_get_io_device(i);
 	struct spdk_io_channel *_ch = spdk_io_channel_iter_get_channel(i);
 	struct nvme_io_channel *nvme_ch = spdk_io_channel_get_ctx(_ch);
-	struct spdk_nvme_io_qpair_opts opts;
+	int rc;
 
-	spdk_nvme_ctrlr_get_default_io_qpair_opts(nvme_bdev_ctrlr->ctrlr, &opts, sizeof(opts));
-	opts.delay_cmd_submit = g_opts.delay_cmd_submit;
+	rc = bdev_nvme_alloc_io_qpairs(nvme_bdev_ctrlr, nvme_ch);
 
-	nvme_ch->qpair = spdk_nvme_ctrlr_alloc_io_qpair(nvme_bdev_ctrlr->ctrlr, &opts, sizeof(opts));
-	if (!nvme_ch->qpair) {
-		spdk_for_each_channel_continue(i, -1);
-		return;
-	}
-
-	spdk_for_each_channel_continue(i, 0);
+	spdk_for_each_channel_continue(i, rc);
 }
 
 static void
@@ -400,8 +445,6 @@ _bdev_nvme_reset(struct spdk_io_channel_iter *i, int status)
 			      _bdev_nvme_reset_create_qpair,
 			      bio,
 			      _bdev_nvme_reset_create_qpairs_done);
-
-
 }
 
 static void
@@ -411,6 +454,8 @@ _bdev_nvme_reset_destroy_qpair(struct spdk_io_channel_iter *i)
 	struct nvme_io_channel *nvme_ch = spdk_io_channel_get_ctx(ch);
 	int rc;
 
+	/* The qpairs are only ever touched by the thread of their channel */
+	bdev_nvme_free_prio_qpairs(nvme_ch);
 	rc = spdk_nvme_ctrlr_free_io_qpair(nvme_ch->qpair);
 	if (!rc) {
 		nvme_ch->qpair = NULL;
@@ -585,6 +630,31 @@ _bdev_nvme_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_
 						bdev_io->u.nvme_passthru.md_buf,
 						bdev_io->u.nvme_passthru.md_len);
 
+	case SPDK_BDEV_IO_TYPE_ZONE_APPEND:
+		return bdev_nvme_zone_appendv(nbdev,
+					      ch,
+					      nbdev_io,
+					      bdev_io->u.bdev.iovs,
+					      bdev_io->u.bdev.iovcnt,
+					      bdev_io->u.bdev.md_buf,
+					      bdev_io->u.bdev.num_blocks,
+					      bdev_io->u.bdev.offset_blocks);
+
+	case SPDK_BDEV_IO_TYPE_GET_ZONE_INFO:
+		return bdev_nvme_get_zone_info(nbdev,
+					       ch,
+					       nbdev_io,
+					       bdev_io->u.zone_mgmt.zone_id,
+					       bdev_io->u.zone_mgmt.num_zones,
+					       bdev_io->u.zone_mgmt.buf);
+
+	case SPDK_BDEV_IO_TYPE_ZONE_MANAGEMENT:
+		return bdev_nvme_zone_management(nbdev,
+						 ch,
+						 nbdev_io,
+						 bdev_io->u.zone_mgmt.zone_id,
+						 bdev_io->u.zone_mgmt.zone_action);
+
 	default:
 		return -EINVAL;
 	}
@@ -655,37 +725,115 @@ bdev_nvme_io_type_supported(void *ctx, enum spdk_bdev_io_type io_type)
 		}
 		return false;
 
+	case SPDK_BDEV_IO_TYPE_GET_ZONE_INFO:
+	case SPDK_BDEV_IO_TYPE_ZONE_MANAGEMENT:
+		return spdk_nvme_ns_get_csi(nbdev->nvme_ns->ns) == SPDK_NVME_CSI_ZNS;
+
+	case SPDK_BDEV_IO_TYPE_ZONE_APPEND:
+		return spdk_nvme_ns_get_csi(nbdev->nvme_ns->ns) == SPDK_NVME_CSI_ZNS &&
+		       spdk_nvme_zns_ctrlr_get_max_zone_append_size(nbdev->nvme_bdev_ctrlr->ctrlr) != 0;
+
 	default:
 		return false;
 	}
 }
 
-static int
-bdev_nvme_create_cb(void *io_device, void *ctx_buf)
+static const enum spdk_nvme_qprio g_bdev_nvme_qprio[SPDK_BDEV_NUM_IO_PRIORITIES] = {
+	[SPDK_BDEV_IO_PRIORITY_DEFAULT]	= SPDK_NVME_QPRIO_MEDIUM,
+	[SPDK_BDEV_IO_PRIORITY_LOW]	= SPDK_NVME_QPRIO_LOW,
+	[SPDK_BDEV_IO_PRIORITY_HIGH]	= SPDK_NVME_QPRIO_HIGH,
+	[SPDK_BDEV_IO_PRIORITY_URGENT]	= SPDK_NVME_QPRIO_URGENT,
+};
+
+static void
+bdev_nvme_free_prio_qpairs(struct nvme_io_channel *ch)
+{
+	int i;
+
+	for (i = 0; i < SPDK_BDEV_NUM_IO_PRIORITIES; i++) {
+		if (ch->prio_qpairs[i] != NULL) {
+			spdk_nvme_ctrlr_free_io_qpair(ch->prio_qpairs[i]);
+			ch->prio_qpairs[i] = NULL;
+		}
+	}
+}
+
+static void
+bdev_nvme_alloc_prio_qpairs(struct nvme_bdev_ctrlr *nvme_bdev_ctrlr, struct nvme_io_channel *ch,
+			    const struct spdk_nvme_io_qpair_opts *default_opts)
 {
-	struct nvme_bdev_ctrlr *nvme_bdev_ctrlr = io_device;
-	struct nvme_io_channel *ch = ctx_buf;
 	struct spdk_nvme_io_qpair_opts opts;
+	int i;
 
-#ifdef SPDK_CONFIG_VTUNE
-	ch->collect_spin_stat = true;
-#else
-	ch->collect_spin_stat = false;
-#endif
+	for (i = 0; i < SPDK_BDEV_NUM_IO_PRIORITIES; i++) {
+		if (i == SPDK_BDEV_IO_PRIORITY_DEFAULT) {
+			continue;
+		}
+
+		opts = *default_opts;
+		opts.qprio = g_bdev_nvme_qprio[i];
+
+		/*
+		 * Running out of I/O queues is not fatal, the I/O of this class is
+		 *  then simply submitted to the default qpair.
+		 */
+		ch->prio_qpairs[i] = spdk_nvme_ctrlr_alloc_io_qpair(nvme_bdev_ctrlr->ctrlr, &opts,
+				     sizeof(opts));
+		if (ch->prio_qpairs[i] == NULL) {
+			SPDK_WARNLOG("Unable to allocate qpair with priority %d on %s\n",
+				     opts.qprio, nvme_bdev_ctrlr->name);
+		}
+	}
+}
+
+static int
+bdev_nvme_alloc_io_qpairs(struct nvme_bdev_ctrlr *nvme_bdev_ctrlr, struct nvme_io_channel *ch)
+{
+	struct spdk_nvme_io_qpair_opts opts;
 
 	spdk_nvme_ctrlr_get_default_io_qpair_opts(nvme_bdev_ctrlr->ctrlr, &opts, sizeof(opts));
 	opts.delay_cmd_submit = g_opts.delay_cmd_submit;
+	opts.share_transport_resources = true;
 	opts.io_queue_requests = spdk_max(g_opts.io_queue_requests, opts.io_queue_requests);
 	g_opts.io_queue_requests = opts.io_queue_requests;
 
+	if (nvme_bdev_ctrlr->wrr_enabled) {
+		/* Leave the urgent and high priority queues to I/O that asked for them */
+		opts.qprio = SPDK_NVME_QPRIO_MEDIUM;
+	}
+
 	ch->qpair = spdk_nvme_ctrlr_alloc_io_qpair(nvme_bdev_ctrlr->ctrlr, &opts, sizeof(opts));
 
 	if (ch->qpair == NULL) {
 		return -1;
 	}
 
+	if (nvme_bdev_ctrlr->wrr_enabled) {
+		bdev_nvme_alloc_prio_qpairs(nvme_bdev_ctrlr, ch, &opts);
+	}
+
+	return 0;
+}
+
+static int
+bdev_nvme_create_cb(void *io_device, void *ctx_buf)
+{
+	struct nvme_bdev_ctrlr *nvme_bdev_ctrlr = io_device;
+	struct nvme_io_channel *ch = ctx_buf;
+
+#ifdef SPDK_CONFIG_VTUNE
+	ch->collect_spin_stat = true;
+#else
+	ch->collect_spin_stat = false;
+#endif
+
+	if (bdev_nvme_alloc_io_qpairs(nvme_bdev_ctrlr, ch) != 0) {
+		return -1;
+	}
+
 	if (spdk_nvme_ctrlr_is_ocssd_supported(nvme_bdev_ctrlr->ctrlr)) {
 		if (bdev_ocssd_create_io_channel(ch)) {
+			bdev_nvme_free_prio_qpairs(ch);
 			spdk_nvme_ctrlr_free_io_qpair(ch->qpair);
 			return -1;
 		}
@@ -707,6 +855,7 @@ bdev_nvme_destroy_cb(void *io_device, void *ctx_buf)
 		bdev_ocssd_destroy_io_channel(ch);
 	}
 
+	bdev_nvme_free_prio_qpairs(ch);
 	spdk_nvme_ctrlr_free_io_qpair(ch->qpair);
 	spdk_poller_unregister(&ch->poller);
 }
@@ -925,12 +1074,26 @@ nvme_ctrlr_populate_standard_namespace(struct nvme_bdev_ctrlr *nvme_bdev_ctrlr,
 		}
 	}
 
+	if (spdk_nvme_ns_get_csi(ns) == SPDK_NVME_CSI_ZNS) {
+		bdev->disk.zoned = true;
+		bdev->disk.zone_size = spdk_nvme_zns_ns_get_zone_size_sectors(ns);
+		bdev->disk.max_open_zones = spdk_nvme_zns_ns_get_max_open_zones(ns);
+		bdev->disk.optimal_open_zones = bdev->disk.max_open_zones;
+	}
+
+	/* NACWU/ACWU and NAWUN/AWUN are 0's based */
 	if (!bdev_nvme_io_type_supported(bdev, SPDK_BDEV_IO_TYPE_COMPARE_AND_WRITE)) {
 		bdev->disk.acwu = 0;
 	} else if (nsdata->nsfeat.ns_atomic_write_unit) {
-		bdev->disk.acwu = nsdata->nacwu;
+		bdev->disk.acwu = nsdata->nacwu + 1;
 	} else {
-		bdev->disk.acwu = cdata->acwu;
+		bdev->disk.acwu = cdata->acwu + 1;
+	}
+
+	if (nsdata->nsfeat.ns_atomic_write_unit) {
+		bdev->disk.awun = nsdata->nawun + 1;
+	} else {
+		bdev->disk.awun = cdata->awun + 1;
 	}
 
 	bdev->disk.ctxt = bdev;
@@ -960,6 +1123,9 @@ hotplug_probe_cb(void *cb_ctx, const struct spdk_nvme_transport_id *trid,
 		}
 	}
 
+	opts->arb_mechanism = g_opts.weighted_round_robin ? SPDK_NVME_CC_AMS_WRR : SPDK_NVME_CC_AMS_RR;
+	/* Controllers without WRR support are attached with round robin arbitration */
+	opts->arb_mechanism_fallback = true;
 	opts->arbitration_burst = (uint8_t)g_opts.arbitration_burst;
 	opts->low_priority_weight = (uint8_t)g_opts.low_priority_weight;
 	opts->medium_priority_weight = (uint8_t)g_opts.medium_priority_weight;
@@ -1005,6 +1171,9 @@ probe_cb(void *cb_ctx, const struct spdk_nvme_transport_id *trid,
 		snprintf(opts->hostnqn, sizeof(opts->hostnqn), "%s", ctx->hostnqn);
 	}
 
+	opts->arb_mechanism = g_opts.weighted_round_robin ? SPDK_NVME_CC_AMS_WRR : SPDK_NVME_CC_AMS_RR;
+	/* Controllers without WRR support are attached with round robin arbitration */
+	opts->arb_mechanism_fallback = true;
 	opts->arbitration_burst = (uint8_t)g_opts.arbitration_burst;
 	opts->low_priority_weight = (uint8_t)g_opts.low_priority_weight;
 	opts->medium_priority_weight = (uint8_t)g_opts.medium_priority_weight;
@@ -1195,6 +1364,7 @@ static int
 create_ctrlr(struct spdk_nvme_ctrlr *ctrlr,
 	     const char *name,
 	     const struct spdk_nvme_transport_id *trid,
+	     const struct spdk_nvme_ctrlr_opts *opts,
 	     uint32_t prchk_flags)
 {
 	struct nvme_bdev_ctrlr *nvme_bdev_ctrlr;
@@ -1250,6 +1420,8 @@ create_ctrlr(struct spdk_nvme_ctrlr *ctrlr,
 	}
 
 	nvme_bdev_ctrlr->prchk_flags = prchk_flags;
+	/* The options hold the arbitration mechanism that was actually enabled */
+	nvme_bdev_ctrlr->wrr_enabled = opts->arb_mechanism == SPDK_NVME_CC_AMS_WRR;
 
 	spdk_io_device_register(nvme_bdev_ctrlr, bdev_nvme_create_cb, bdev_nvme_destroy_cb,
 				sizeof(struct nvme_io_channel),
@@ -1306,7 +1478,7 @@ attach_cb(void *cb_ctx, const struct spdk_nvme_transport_id *trid,
 
 	SPDK_DEBUGLOG(SPDK_LOG_BDEV_NVME, "Attached to %s (%s)\n", trid->traddr, name);
 
-	create_ctrlr(ctrlr, name, trid, prchk_flags);
+	create_ctrlr(ctrlr, name, trid, opts, prchk_flags);
 
 	nvme_bdev_ctrlr = nvme_bdev_ctrlr_get(trid);
 	if (!nvme_bdev_ctrlr) {
@@ -1491,7 +1663,10 @@ nvme_ctrlr_populate_namespaces_done(struct nvme_async_probe_ctx *ctx)
 		}
 		assert(ns->id == nsid);
 		TAILQ_FOREACH_SAFE(nvme_bdev, &ns->bdevs, tailq, tmp) {
-			if (j < ctx->count) {
+			if (ctx->names == NULL) {
+				/* The caller is only interested in the number of bdevs */
+				j++;
+			} else if (j < ctx->count) {
 				ctx->names[j] = nvme_bdev->disk.name;
 				j++;
 			} else {
@@ -1519,7 +1694,7 @@ connect_attach_cb(void *cb_ctx, const struct spdk_nvme_transport_id *trid,
 
 	spdk_poller_unregister(&ctx->poller);
 
-	rc = create_ctrlr(ctrlr, ctx->base_name, &ctx->trid, ctx->prchk_flags);
+	rc = create_ctrlr(ctrlr, ctx->base_name, &ctx->trid, opts, ctx->prchk_flags);
 	if (rc) {
 		SPDK_ERRLOG("Failed to create new device\n");
 		populate_namespaces_cb(ctx, 0, rc);
@@ -1540,8 +1715,9 @@ bdev_nvme_async_poll(void *arg)
 
 	rc = spdk_nvme_probe_poll_async(ctx->probe_ctx);
 	if (spdk_unlikely(rc != -EAGAIN && rc != 0)) {
+		SPDK_ERRLOG("Failed to attach to NVMe controller (traddr: %s)\n", ctx->trid.traddr);
 		spdk_poller_unregister(&ctx->poller);
-		free(ctx);
+		populate_namespaces_cb(ctx, 0, rc);
 	}
 
 	return 1;
@@ -1595,6 +1771,12 @@ spdk_bdev_nvme_create(struct spdk_nvme_transport_id *trid,
 
 	spdk_nvme_ctrlr_get_default_ctrlr_opts(&ctx->opts, sizeof(ctx->opts));
 	ctx->opts.transport_retry_count = g_opts.retry_count;
+	ctx->opts.arb_mechanism = g_opts.weighted_round_robin ? SPDK_NVME_CC_AMS_WRR : SPDK_NVME_CC_AMS_RR;
+	ctx->opts.arb_mechanism_fallback = true;
+	ctx->opts.arbitration_burst = (uint8_t)g_opts.arbitration_burst;
+	ctx->opts.low_priority_weight = (uint8_t)g_opts.low_priority_weight;
+	ctx->opts.medium_priority_weight = (uint8_t)g_opts.medium_priority_weight;
+	ctx->opts.high_priority_weight = (uint8_t)g_opts.high_priority_weight;
 
 	if (hostnqn) {
 		snprintf(ctx->opts.hostnqn, sizeof(ctx->opts.hostnqn), "%s", hostnqn);
@@ -1648,10 +1830,80 @@ spdk_bdev_nvme_delete(const char *name)
 	return 0;
 }
 
+static void
+bdev_nvme_init_done(void)
+{
+	struct nvme_probe_ctx *probe_ctx = g_init_probe_ctx;
+	size_t i;
+	int rc;
+
+	for (i = 0; i < probe_ctx->count; i++) {
+		if (probe_ctx->trids[i].trtype != SPDK_NVME_TRANSPORT_PCIE) {
+			continue;
+		}
+
+		if (!nvme_bdev_ctrlr_get(&probe_ctx->trids[i])) {
+			SPDK_ERRLOG("NVMe SSD \"%s\" could not be found.\n", probe_ctx->trids[i].traddr);
+			SPDK_ERRLOG("Check PCIe BDF and that it is attached to UIO/VFIO driver.\n");
+		}
+	}
+
+	rc = spdk_bdev_nvme_set_hotplug(g_init_hotplug_enabled, g_init_hotplug_period, NULL, NULL);
+	if (rc) {
+		SPDK_ERRLOG("Failed to setup hotplug (%d): %s", rc, spdk_strerror(-rc));
+	}
+
+	free(probe_ctx);
+	g_init_probe_ctx = NULL;
+
+	spdk_bdev_module_init_done(&nvme_if);
+}
+
+static void
+bdev_nvme_init_ctrlr_done(void *ctx, size_t bdev_count, int rc)
+{
+	struct spdk_nvme_transport_id *trid = ctx;
+
+	if (trid != NULL) {
+		if (rc) {
+			SPDK_ERRLOG("Failed to attach NVMe controller (traddr: %s): %s\n",
+				    trid->traddr, spdk_strerror(-rc));
+		} else {
+			SPDK_DEBUGLOG(SPDK_LOG_BDEV_NVME, "Attached NVMe controller (traddr: %s) with %zu bdevs\n",
+				      trid->traddr, bdev_count);
+		}
+	}
+
+	assert(g_init_ctrlrs_outstanding > 0);
+	if (--g_init_ctrlrs_outstanding == 0) {
+		bdev_nvme_init_done();
+	}
+}
+
+static int
+bdev_nvme_init_pcie_poll(void *arg)
+{
+	int rc;
+
+	rc = spdk_nvme_probe_poll_async(g_init_pcie_probe_ctx);
+	if (rc == -EAGAIN) {
+		return 1;
+	}
+
+	if (rc != 0) {
+		SPDK_ERRLOG("Failed to initialize some of the local NVMe devices\n");
+	}
+
+	g_init_pcie_probe_ctx = NULL;
+	spdk_poller_unregister(&g_init_pcie_poller);
+	bdev_nvme_init_ctrlr_done(NULL, 0, rc);
+
+	return 1;
+}
+
 static int
 bdev_nvme_library_init(void)
 {
-	struct nvme_bdev_ctrlr *nvme_bdev_ctrlr;
 	struct spdk_conf_section *sp;
 	const char *val;
 	int rc = 0;
@@ -1772,9 +2024,6 @@ bdev_nvme_library_init(void)
 		probe_ctx->count++;
 
 		if (probe_ctx->trids[i].trtype != SPDK_NVME_TRANSPORT_PCIE) {
-			struct spdk_nvme_ctrlr *ctrlr;
-			struct spdk_nvme_ctrlr_opts opts;
-
 			if (nvme_bdev_ctrlr_get(&probe_ctx->trids[i])) {
 				SPDK_ERRLOG("A controller with the provided trid (traddr: %s) already exists.\n",
 					    probe_ctx->trids[i].traddr);
@@ -1787,74 +2036,57 @@ bdev_nvme_library_init(void)
 				rc = -1;
 				goto end;
 			}
+		} else {
+			local_nvme_num++;
+		}
+	}
 
-			spdk_nvme_ctrlr_get_default_ctrlr_opts(&opts, sizeof(opts));
-			opts.transport_retry_count = g_opts.retry_count;
-
-			if (probe_ctx->hostnqn != NULL) {
-				snprintf(opts.hostnqn, sizeof(opts.hostnqn), "%s", probe_ctx->hostnqn);
-			}
-
-			if (probe_ctx->hostids[i].hostaddr[0] != '\0') {
-				snprintf(opts.src_addr, sizeof(opts.src_addr), "%s", probe_ctx->hostids[i].hostaddr);
-			}
-
-			if (probe_ctx->hostids[i].hostsvcid[0] != '\0') {
-				snprintf(opts.src_svcid, sizeof(opts.src_svcid), "%s", probe_ctx->hostids[i].hostsvcid);
-			}
-
-			ctrlr = spdk_nvme_connect(&probe_ctx->trids[i], &opts, sizeof(opts));
-			if (ctrlr == NULL) {
-				SPDK_ERRLOG("Unable to connect to provided trid (traddr: %s)\n",
-					    probe_ctx->trids[i].traddr);
-				rc = -1;
-				goto end;
-			}
+	g_init_probe_ctx = probe_ctx;
+	g_init_hotplug_enabled = hotplug_enabled;
+	g_init_hotplug_period = hotplug_period;
 
-			rc = create_ctrlr(ctrlr, probe_ctx->names[i], &probe_ctx->trids[i], 0);
-			if (rc) {
-				goto end;
-			}
+	/*
+	 * Attach all controllers at once. Each fabrics controller is connected from
+	 *  its own poller and all local controllers are initialized by a single probe,
+	 *  so the module is ready as soon as the slowest controller is.
+	 */
+	g_init_ctrlrs_outstanding = 1;
 
-			nvme_bdev_ctrlr = nvme_bdev_ctrlr_get(&probe_ctx->trids[i]);
-			if (!nvme_bdev_ctrlr) {
-				SPDK_ERRLOG("Failed to find new NVMe controller\n");
-				rc = -ENODEV;
-				goto end;
-			}
+	for (i = 0; i < probe_ctx->count; i++) {
+		if (probe_ctx->trids[i].trtype == SPDK_NVME_TRANSPORT_PCIE) {
+			continue;
+		}
 
-			nvme_ctrlr_populate_namespaces(nvme_bdev_ctrlr, NULL);
-		} else {
-			local_nvme_num++;
+		g_init_ctrlrs_outstanding++;
+		rc = spdk_bdev_nvme_create(&probe_ctx->trids[i], &probe_ctx->hostids[i],
+					   probe_ctx->names[i], NULL, 0, probe_ctx->hostnqn,
+					   probe_ctx->prchk_flags[i], bdev_nvme_init_ctrlr_done, &probe_ctx->trids[i]);
+		if (rc) {
+			SPDK_ERRLOG("Unable to connect to provided trid (traddr: %s)\n",
+				    probe_ctx->trids[i].traddr);
+			g_init_ctrlrs_outstanding--;
 		}
 	}
 
 	if (local_nvme_num > 0) {
 		/* used to probe local NVMe device */
-		if (spdk_nvme_probe(NULL, probe_ctx, probe_cb, attach_cb, remove_cb)) {
-			rc = -1;
-			goto end;
-		}
-
-		for (i = 0; i < probe_ctx->count; i++) {
-			if (probe_ctx->trids[i].trtype != SPDK_NVME_TRANSPORT_PCIE) {
-				continue;
-			}
-
-			if (!nvme_bdev_ctrlr_get(&probe_ctx->trids[i])) {
-				SPDK_ERRLOG("NVMe SSD \"%s\" could not be found.\n", probe_ctx->trids[i].traddr);
-				SPDK_ERRLOG("Check PCIe BDF and that it is attached to UIO/VFIO driver.\n");
-			}
+		g_init_pcie_probe_ctx = spdk_nvme_probe_async(NULL, probe_ctx, probe_cb, attach_cb, remove_cb);
+		if (g_init_pcie_probe_ctx == NULL) {
+			SPDK_ERRLOG("Failed to probe local NVMe devices\n");
+		} else {
+			g_init_ctrlrs_outstanding++;
+			g_init_pcie_poller = spdk_poller_register(bdev_nvme_init_pcie_poll, NULL, 0);
 		}
 	}
 
-	rc = spdk_bdev_nvme_set_hotplug(hotplug_enabled, hotplug_period, NULL, NULL);
-	if (rc) {
-		SPDK_ERRLOG("Failed to setup hotplug (%d): %s", rc, spdk_strerror(rc));
-		rc = -1;
-	}
+	bdev_nvme_init_ctrlr_done(NULL, 0, 0);
+	return 0;
+
 end:
 	free(probe_ctx);
+	if (rc == 0) {
+		spdk_bdev_module_init_done(&nvme_if);
+	}
 	return rc;
 }
 
@@ -2051,6 +2283,127 @@ bdev_nvme_comparev_and_writev_done(void *ref, const struct spdk_nvme_cpl *cpl)
 	}
 }
 
+static void
+bdev_nvme_zone_appendv_done(void *ref, const struct spdk_nvme_cpl *cpl)
+{
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx((struct nvme_bdev_io *)ref);
+
+	if (spdk_nvme_cpl_is_pi_error(cpl)) {
+		SPDK_ERRLOG("zone append completed with PI error (sct=%d, sc=%d)\n",
+			    cpl->status.sct, cpl->status.sc);
+		/* Run PI verification for zone append data buffer if PI error is detected. */
+		bdev_nvme_verify_pi_error(bdev_io);
+	}
+
+	/* The controller reports the LBA the data was written at in dwords 0 and 1 */
+	if (spdk_nvme_cpl_is_success(cpl)) {
+		bdev_io->u.bdev.offset_blocks = ((uint64_t)cpl->rsvd1 << 32) | cpl->cdw0;
+	}
+
+	spdk_bdev_io_complete_nvme_status(bdev_io, cpl->cdw0, cpl->status.sct, cpl->status.sc);
+}
+
+static int
+bdev_nvme_fill_zone_info(struct spdk_bdev_zone_info *info, const struct spdk_nvme_zns_zone_desc *desc)
+{
+	switch (desc->zs) {
+	case SPDK_NVME_ZONE_STATE_EMPTY:
+		info->state = SPDK_BDEV_ZONE_STATE_EMPTY;
+		break;
+	case SPDK_NVME_ZONE_STATE_IOPEN:
+	case SPDK_NVME_ZONE_STATE_EOPEN:
+		info->state = SPDK_BDEV_ZONE_STATE_OPEN;
+		break;
+	case SPDK_NVME_ZONE_STATE_CLOSED:
+		info->state = SPDK_BDEV_ZONE_STATE_CLOSED;
+		break;
+	case SPDK_NVME_ZONE_STATE_FULL:
+		info->state = SPDK_BDEV_ZONE_STATE_FULL;
+		break;
+	case SPDK_NVME_ZONE_STATE_RONLY:
+		info->state = SPDK_BDEV_ZONE_STATE_READ_ONLY;
+		break;
+	case SPDK_NVME_ZONE_STATE_OFFLINE:
+		info->state = SPDK_BDEV_ZONE_STATE_OFFLINE;
+		break;
+	default:
+		SPDK_ERRLOG("Invalid zone state: %#x in zone report\n", desc->zs);
+		return -EIO;
+	}
+
+	info->zone_id = desc->zslba;
+	info->write_pointer = desc->wp;
+	info->capacity = desc->zcap;
+
+	return 0;
+}
+
+static void
+bdev_nvme_get_zone_info_done(void *ref, const struct spdk_nvme_cpl *cpl)
+{
+	struct nvme_bdev_io *bio = ref;
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(bio);
+	struct nvme_bdev *nbdev = (struct nvme_bdev *)bdev_io->bdev->ctxt;
+	struct spdk_io_channel *ch = spdk_bdev_io_get_io_channel(bdev_io);
+	struct nvme_io_channel *nvme_ch = spdk_io_channel_get_ctx(ch);
+	uint32_t zones_to_copy = bdev_io->u.zone_mgmt.num_zones;
+	struct spdk_bdev_zone_info *info = bdev_io->u.zone_mgmt.buf;
+	uint64_t max_zones_per_buf, i;
+	uint32_t zone_report_bufsize;
+	int rc;
+
+	if (spdk_nvme_cpl_is_error(cpl)) {
+		goto out_complete_io_nvme_cpl;
+	}
+
+	zone_report_bufsize = spdk_nvme_ns_get_max_io_xfer_size(nbdev->nvme_ns->ns);
+	max_zones_per_buf = (zone_report_bufsize - sizeof(*bio->zone_report_buf)) /
+			    sizeof(bio->zone_report_buf->descs[0]);
+
+	if (bio->zone_report_buf->nr_zones > max_zones_per_buf ||
+	    bio->zone_report_buf->nr_zones == 0) {
+		rc = -EIO;
+		goto out_complete_io_with_error;
+	}
+
+	for (i = 0; i < bio->zone_report_buf->nr_zones && bio->handled_zones < zones_to_copy; i++) {
+		rc = bdev_nvme_fill_zone_info(&info[bio->handled_zones],
+					      &bio->zone_report_buf->descs[i]);
+		if (rc) {
+			goto out_complete_io_with_error;
+		}
+		bio->handled_zones++;
+	}
+
+	if (bio->handled_zones < zones_to_copy) {
+		uint64_t zone_size_lba = spdk_nvme_zns_ns_get_zone_size_sectors(nbdev->nvme_ns->ns);
+		uint64_t slba = bdev_io->u.zone_mgmt.zone_id + (zone_size_lba * bio->handled_zones);
+
+		memset(bio->zone_report_buf, 0, zone_report_bufsize);
+		rc = spdk_nvme_zns_report_zones(nbdev->nvme_ns->ns,
+						bdev_nvme_io_qpair(nvme_ch, bio),
+						bio->zone_report_buf, zone_report_bufsize,
+						slba, SPDK_NVME_ZRA_LIST_ALL, true,
+						bdev_nvme_get_zone_info_done, bio);
+		if (!rc) {
+			return;
+		} else {
+			goto out_complete_io_with_error;
+		}
+	}
+
+out_complete_io_nvme_cpl:
+	spdk_free(bio->zone_report_buf);
+	bio->zone_report_buf = NULL;
+	spdk_bdev_io_complete_nvme_status(bdev_io, 0, cpl->status.sct, cpl->status.sc);
+	return;
+
+out_complete_io_with_error:
+	spdk_free(bio->zone_report_buf);
+	bio->zone_report_buf = NULL;
+	spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+}
+
 static void
 bdev_nvme_queued_done(void *ref, const struct spdk_nvme_cpl *cpl)
 {
@@ -2201,6 +2554,7 @@ bdev_nvme_readv(struct nvme_bdev *nbdev, struct spdk_io_channel *ch,
 		void *md, uint64_t lba_count, uint64_t lba)
 {
 	struct nvme_io_channel *nvme_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_nvme_qpair *qpair = bdev_nvme_io_qpair(nvme_ch, bio);
 	int rc;
 
 	SPDK_DEBUGLOG(SPDK_LOG_BDEV_NVME, "read %lu blocks with offset %#lx\n",
@@ -2211,7 +2565,7 @@ bdev_nvme_readv(struct nvme_bdev *nbdev, struct spdk_io_channel *ch,
 	bio->iovpos = 0;
 	bio->iov_offset = 0;
 
-	rc = spdk_nvme_ns_cmd_readv_with_md(nbdev->nvme_ns->ns, nvme_ch->qpair, lba, lba_count,
+	rc = spdk_nvme_ns_cmd_readv_with_md(nbdev->nvme_ns->ns, qpair, lba, lba_count,
 					    bdev_nvme_readv_done, bio, nbdev->disk.dif_check_flags,
 					    bdev_nvme_queued_reset_sgl, bdev_nvme_queued_next_sge,
 					    md, 0, 0);
@@ -2228,6 +2582,7 @@ bdev_nvme_writev(struct nvme_bdev *nbdev, struct spdk_io_channel *ch,
 		 struct iovec *iov, int iovcnt, void *md, uint64_t lba_count, uint64_t lba)
 {
 	struct nvme_io_channel *nvme_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_nvme_qpair *qpair = bdev_nvme_io_qpair(nvme_ch, bio);
 	int rc;
 
 	SPDK_DEBUGLOG(SPDK_LOG_BDEV_NVME, "write %lu blocks with offset %#lx\n",
@@ -2238,7 +2593,7 @@ bdev_nvme_writev(struct nvme_bdev *nbdev, struct spdk_io_channel *ch,
 	bio->iovpos = 0;
 	bio->iov_offset = 0;
 
-	rc = spdk_nvme_ns_cmd_writev_with_md(nbdev->nvme_ns->ns, nvme_ch->qpair, lba, lba_count,
+	rc = spdk_nvme_ns_cmd_writev_with_md(nbdev->nvme_ns->ns, qpair, lba, lba_count,
 					     bdev_nvme_writev_done, bio, nbdev->disk.dif_check_flags,
 					     bdev_nvme_queued_reset_sgl, bdev_nvme_queued_next_sge,
 					     md, 0, 0);
@@ -2249,12 +2604,109 @@ bdev_nvme_writev(struct nvme_bdev *nbdev, struct spdk_io_channel *ch,
 	return rc;
 }
 
+static int
+bdev_nvme_zone_appendv(struct nvme_bdev *nbdev, struct spdk_io_channel *ch,
+		       struct nvme_bdev_io *bio, struct iovec *iov, int iovcnt, void *md,
+		       uint64_t lba_count, uint64_t zslba)
+{
+	struct nvme_io_channel *nvme_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_nvme_qpair *qpair = bdev_nvme_io_qpair(nvme_ch, bio);
+	int rc;
+
+	SPDK_DEBUGLOG(SPDK_LOG_BDEV_NVME, "zone append %lu blocks to zone start lba %#lx\n",
+		      lba_count, zslba);
+
+	bio->iovs = iov;
+	bio->iovcnt = iovcnt;
+	bio->iovpos = 0;
+	bio->iov_offset = 0;
+
+	rc = spdk_nvme_zns_zone_appendv_with_md(nbdev->nvme_ns->ns, qpair, zslba, lba_count,
+						bdev_nvme_zone_appendv_done, bio,
+						nbdev->disk.dif_check_flags,
+						bdev_nvme_queued_reset_sgl, bdev_nvme_queued_next_sge,
+						md, 0, 0);
+
+	if (rc != 0 && rc != -ENOMEM) {
+		SPDK_ERRLOG("zone append failed: rc = %d\n", rc);
+	}
+	return rc;
+}
+
+static int
+bdev_nvme_get_zone_info(struct nvme_bdev *nbdev, struct spdk_io_channel *ch,
+			struct nvme_bdev_io *bio, uint64_t zone_id, uint32_t num_zones,
+			struct spdk_bdev_zone_info *info)
+{
+	struct nvme_io_channel *nvme_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_nvme_qpair *qpair = bdev_nvme_io_qpair(nvme_ch, bio);
+	struct spdk_nvme_ns *ns = nbdev->nvme_ns->ns;
+	uint32_t zone_report_bufsize = spdk_nvme_ns_get_max_io_xfer_size(ns);
+	uint64_t zone_size = spdk_nvme_zns_ns_get_zone_size_sectors(ns);
+	uint64_t total_zones = spdk_nvme_zns_ns_get_num_zones(ns);
+	int rc;
+
+	if (zone_id % zone_size != 0) {
+		return -EINVAL;
+	}
+
+	if (num_zones == 0 || zone_id / zone_size + num_zones > total_zones) {
+		return -EINVAL;
+	}
+
+	bio->zone_report_buf = spdk_zmalloc(zone_report_bufsize, 0x1000, NULL,
+					    SPDK_ENV_LCORE_ID_ANY, SPDK_MALLOC_DMA);
+	if (bio->zone_report_buf == NULL) {
+		return -ENOMEM;
+	}
+
+	bio->handled_zones = 0;
+
+	rc = spdk_nvme_zns_report_zones(ns, qpair, bio->zone_report_buf, zone_report_bufsize,
+					zone_id, SPDK_NVME_ZRA_LIST_ALL, true,
+					bdev_nvme_get_zone_info_done, bio);
+	if (rc != 0) {
+		spdk_free(bio->zone_report_buf);
+		bio->zone_report_buf = NULL;
+	}
+
+	return rc;
+}
+
+static int
+bdev_nvme_zone_management(struct nvme_bdev *nbdev, struct spdk_io_channel *ch,
+			  struct nvme_bdev_io *bio, uint64_t zone_id,
+			  enum spdk_bdev_zone_action action)
+{
+	struct nvme_io_channel *nvme_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_nvme_qpair *qpair = bdev_nvme_io_qpair(nvme_ch, bio);
+	struct spdk_nvme_ns *ns = nbdev->nvme_ns->ns;
+
+	switch (action) {
+	case SPDK_BDEV_ZONE_CLOSE:
+		return spdk_nvme_zns_close_zone(ns, qpair, zone_id, false,
+						bdev_nvme_queued_done, bio);
+	case SPDK_BDEV_ZONE_FINISH:
+		return spdk_nvme_zns_finish_zone(ns, qpair, zone_id, false,
+						 bdev_nvme_queued_done, bio);
+	case SPDK_BDEV_ZONE_OPEN:
+		return spdk_nvme_zns_open_zone(ns, qpair, zone_id, false,
+					       bdev_nvme_queued_done, bio);
+	case SPDK_BDEV_ZONE_RESET:
+		return spdk_nvme_zns_reset_zone(ns, qpair, zone_id, false,
+						bdev_nvme_queued_done, bio);
+	default:
+		return -EINVAL;
+	}
+}
+
 static int
 bdev_nvme_comparev(struct nvme_bdev *nbdev, struct spdk_io_channel *ch,
 		   struct nvme_bdev_io *bio,
 		   struct iovec *iov, int iovcnt, void *md, uint64_t lba_count, uint64_t lba)
 {
 	struct nvme_io_channel *nvme_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_nvme_qpair *qpair = bdev_nvme_io_qpair(nvme_ch, bio);
 	int rc;
 
 	SPDK_DEBUGLOG(SPDK_LOG_BDEV_NVME, "compare %lu blocks with offset %#lx\n",
@@ -2265,7 +2717,7 @@ bdev_nvme_comparev(struct nvme_bdev *nbdev, struct spdk_io_channel *ch,
 	bio->iovpos = 0;
 	bio->iov_offset = 0;
 
-	rc = spdk_nvme_ns_cmd_comparev_with_md(nbdev->nvme_ns->ns, nvme_ch->qpair, lba, lba_count,
+	rc = spdk_nvme_ns_cmd_comparev_with_md(nbdev->nvme_ns->ns, qpair, lba, lba_count,
 					       bdev_nvme_comparev_done, bio, nbdev->disk.dif_check_flags,
 					       bdev_nvme_queued_reset_sgl, bdev_nvme_queued_next_sge,
 					       md, 0, 0);
@@ -2282,6 +2734,7 @@ bdev_nvme_comparev_and_writev(struct nvme_bdev *nbdev, struct spdk_io_channel *c
 			      int write_iovcnt, void *md, uint64_t lba_count, uint64_t lba)
 {
 	struct nvme_io_channel *nvme_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_nvme_qpair *qpair = bdev_nvme_io_qpair(nvme_ch, bio);
 	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(bio);
 	uint32_t flags = nbdev->disk.dif_check_flags;
 	int rc;
@@ -2306,7 +2759,7 @@ bdev_nvme_comparev_and_writev(struct nvme_bdev *nbdev, struct spdk_io_channel *c
 		flags |= SPDK_NVME_IO_FLAGS_FUSE_FIRST;
 		memset(&bio->cpl, 0, sizeof(bio->cpl));
 
-		rc = spdk_nvme_ns_cmd_comparev_with_md(nbdev->nvme_ns->ns, nvme_ch->qpair, lba, lba_count,
+		rc = spdk_nvme_ns_cmd_comparev_with_md(nbdev->nvme_ns->ns, qpair, lba, lba_count,
 						       bdev_nvme_comparev_and_writev_done, bio, flags,
 						       bdev_nvme_queued_reset_sgl, bdev_nvme_queued_next_sge, md, 0, 0);
 		if (rc == 0) {
@@ -2322,7 +2775,7 @@ bdev_nvme_comparev_and_writev(struct nvme_bdev *nbdev, struct spdk_io_channel *c
 
 	flags |= SPDK_NVME_IO_FLAGS_FUSE_SECOND;
 
-	rc = spdk_nvme_ns_cmd_writev_with_md(nbdev->nvme_ns->ns, nvme_ch->qpair, lba, lba_count,
+	rc = spdk_nvme_ns_cmd_writev_with_md(nbdev->nvme_ns->ns, qpair, lba, lba_count,
 					     bdev_nvme_comparev_and_writev_done, bio, flags,
 					     bdev_nvme_queued_reset_fused_sgl, bdev_nvme_queued_next_fused_sge, md, 0, 0);
 	if (rc != 0 && rc != -ENOMEM) {
@@ -2340,6 +2793,7 @@ bdev_nvme_unmap(struct nvme_bdev *nbdev, struct spdk_io_channel *ch,
 		uint64_t num_blocks)
 {
 	struct nvme_io_channel *nvme_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_nvme_qpair *qpair = bdev_nvme_io_qpair(nvme_ch, bio);
 	struct spdk_nvme_dsm_range dsm_ranges[SPDK_NVME_DATASET_MANAGEMENT_MAX_RANGES];
 	struct spdk_nvme_dsm_range *range;
 	uint64_t offset, remaining;
@@ -2375,7 +2829,7 @@ bdev_nvme_unmap(struct nvme_bdev *nbdev, struct spdk_io_channel *ch,
 	range->length = remaining;
 	range->starting_lba = offset;
 
-	rc = spdk_nvme_ns_cmd_dataset_management(nbdev->nvme_ns->ns, nvme_ch->qpair,
+	rc = spdk_nvme_ns_cmd_dataset_management(nbdev->nvme_ns->ns, qpair,
 			SPDK_NVME_DSM_ATTR_DEALLOCATE,
 			dsm_ranges, num_ranges,
 			bdev_nvme_queued_done, bio);
@@ -2407,6 +2861,7 @@ bdev_nvme_io_passthru(struct nvme_bdev *nbdev, struct spdk_io_channel *ch,
 		      struct spdk_nvme_cmd *cmd, void *buf, size_t nbytes)
 {
 	struct nvme_io_channel *nvme_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_nvme_qpair *qpair = bdev_nvme_io_qpair(nvme_ch, bio);
 	uint32_t max_xfer_size = spdk_nvme_ctrlr_get_max_xfer_size(nbdev->nvme_bdev_ctrlr->ctrlr);
 
 	if (nbytes > max_xfer_size) {
@@ -2420,7 +2875,7 @@ bdev_nvme_io_passthru(struct nvme_bdev *nbdev, struct spdk_io_channel *ch,
 	 */
 	cmd->nsid = spdk_nvme_ns_get_id(nbdev->nvme_ns->ns);
 
-	return spdk_nvme_ctrlr_cmd_io_raw(nbdev->nvme_bdev_ctrlr->ctrlr, nvme_ch->qpair, cmd, buf,
+	return spdk_nvme_ctrlr_cmd_io_raw(nbdev->nvme_bdev_ctrlr->ctrlr, qpair, cmd, buf,
 					  (uint32_t)nbytes, bdev_nvme_queued_done, bio);
 }
 
@@ -2430,6 +2885,7 @@ bdev_nvme_io_passthru_md(struct nvme_bdev *nbdev, struct spdk_io_channel *ch,
 			 struct spdk_nvme_cmd *cmd, void *buf, size_t nbytes, void *md_buf, size_t md_len)
 {
 	struct nvme_io_channel *nvme_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_nvme_qpair *qpair = bdev_nvme_io_qpair(nvme_ch, bio);
 	size_t nr_sectors = nbytes / spdk_nvme_ns_get_extended_sector_size(nbdev->nvme_ns->ns);
 	uint32_t max_xfer_size = spdk_nvme_ctrlr_get_max_xfer_size(nbdev->nvme_bdev_ctrlr->ctrlr);
 
@@ -2449,7 +2905,7 @@ bdev_nvme_io_passthru_md(struct nvme_bdev *nbdev, struct spdk_io_channel *ch,
 	 */
 	cmd->nsid = spdk_nvme_ns_get_id(nbdev->nvme_ns->ns);
 
-	return spdk_nvme_ctrlr_cmd_io_raw_with_md(nbdev->nvme_bdev_ctrlr->ctrlr, nvme_ch->qpair, cmd, buf,
+	return spdk_nvme_ctrlr_cmd_io_raw_with_md(nbdev->nvme_bdev_ctrlr->ctrlr, qpair, cmd, buf,
 			(uint32_t)nbytes, md_buf, bdev_nvme_queued_done, bio);
 }
 
@@ -2598,6 +3054,7 @@ bdev_nvme_config_json(struct spdk_json_write_ctx *w)
 	spdk_json_write_named_uint64(w, "nvme_ioq_poll_period_us", g_opts.nvme_ioq_poll_period_us);
 	spdk_json_write_named_uint32(w, "io_queue_requests", g_opts.io_queue_requests);
 	spdk_json_write_named_bool(w, "delay_cmd_submit", g_opts.delay_cmd_submit);
+	spdk_json_write_named_bool(w, "weighted_round_robin", g_opts.weighted_round_robin);
 	spdk_json_write_object_end(w);
 
 	spdk_json_write_object_end(w);
@@ -80,6 +80,8 @@ struct nvme_bdev_ctrlr {
 	int				ref;
 	bool				resetting;
 	bool				destruct;
+	/** The controller was enabled with weighted round robin arbitration */
+	bool				wrr_enabled;
 	/**
 	 * PI check flags. This flags is set to NVMe controllers created only
 	 * through bdev_nvme_attach_controller RPC or .INI config file. Hot added
@@ -128,6 +130,12 @@ struct ocssd_io_channel;
 
 struct nvme_io_channel {
 	struct spdk_nvme_qpair		*qpair;
+	/**
+	 * Separate qpairs for the non-default bdev I/O priority classes. Only
+	 *  allocated on controllers using weighted round robin arbitration, so
+	 *  a NULL entry means that the default qpair is used for that class.
+	 */
+	struct spdk_nvme_qpair		*prio_qpairs[SPDK_BDEV_NUM_IO_PRIORITIES];
 	struct spdk_poller		*poller;
 	TAILQ_HEAD(, spdk_bdev_io)	pending_resets;
 
@@ -123,11 +123,14 @@ spdk_nvmf_read_config_file_tgt_conf(struct spdk_conf_section *sp,
 			conf->conn_sched = CONNECT_SCHED_HOST_IP;
 		} else if (strcasecmp(conn_scheduler, "Transport") == 0) {
 			conf->conn_sched = CONNECT_SCHED_TRANSPORT_OPTIMAL_GROUP;
+		} else if (strcasecmp(conn_scheduler, "Numa") == 0) {
+			conf->conn_sched = CONNECT_SCHED_NUMA;
 		} else {
 			SPDK_ERRLOG("The valid value of ConnectionScheduler should be:\n"
 				    "\t RoundRobin\n"
 				    "\t Host\n"
-				    "\t Transport\n");
+				    "\t Transport\n"
+				    "\t Numa\n");
 			rc = -1;
 		}
 
@@ -659,6 +662,9 @@ spdk_nvmf_parse_transport(struct spdk_nvmf_parse_transport_ctx *ctx)
 	bval = spdk_conf_section_get_boolval(ctx->sp, "DifInsertOrStrip", false);
 	opts.dif_insert_or_strip = bval;
 
+	bval = spdk_conf_section_get_boolval(ctx->sp, "ZeroCopy", false);
+	opts.zcopy = bval;
+
 	transport = spdk_nvmf_transport_create(type, &opts);
 	if (transport) {
 		spdk_nvmf_tgt_add_transport(g_spdk_nvmf_tgt, transport, spdk_nvmf_tgt_add_transport_done, ctx);
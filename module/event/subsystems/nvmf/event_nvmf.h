@@ -49,6 +49,7 @@ enum spdk_nvmf_connect_sched {
 	CONNECT_SCHED_ROUND_ROBIN = 0,
 	CONNECT_SCHED_HOST_IP,
 	CONNECT_SCHED_TRANSPORT_OPTIMAL_GROUP,
+	CONNECT_SCHED_NUMA,
 };
 
 struct spdk_nvmf_admin_passthru_conf {
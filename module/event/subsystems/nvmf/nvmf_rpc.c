@@ -84,6 +84,8 @@ static int decode_conn_sched(const struct spdk_json_val *val, void *out)
 		*sched = CONNECT_SCHED_HOST_IP;
 	} else if (spdk_json_strequal(val, "transport") == true) {
 		*sched = CONNECT_SCHED_TRANSPORT_OPTIMAL_GROUP;
+	} else if (spdk_json_strequal(val, "numa") == true) {
+		*sched = CONNECT_SCHED_NUMA;
 	} else {
 		SPDK_ERRLOG("Invalid connection scheduling parameter\n");
 		return -EINVAL;
@@ -34,6 +34,7 @@
 #include "event_nvmf.h"
 
 #include "spdk/bdev.h"
+#include "spdk/env.h"
 #include "spdk/event.h"
 #include "spdk/thread.h"
 #include "spdk/log.h"
@@ -60,9 +61,24 @@ enum nvmf_tgt_state {
 struct nvmf_tgt_poll_group {
 	struct spdk_nvmf_poll_group		*group;
 	struct spdk_thread			*thread;
+	int32_t					numa_id;
+	/* Qpairs handed to this poll group by the acceptor. Only modified on the acceptor thread. */
+	uint64_t				num_assigned;
+	/* Qpairs the poll group has processed. Only modified on the poll group thread. */
+	uint64_t				num_added;
 	TAILQ_ENTRY(nvmf_tgt_poll_group)	link;
 };
 
+/* NUMA node of the network device that owns a local transport address */
+struct nvmf_tgt_local_numa {
+	char					traddr[SPDK_NVMF_TRADDR_MAX_LEN + 1];
+	int32_t					numa_id;
+	TAILQ_ENTRY(nvmf_tgt_local_numa)	link;
+};
+
+static TAILQ_HEAD(, nvmf_tgt_local_numa) g_nvmf_tgt_local_numa =
+	TAILQ_HEAD_INITIALIZER(g_nvmf_tgt_local_numa);
+
 struct nvmf_tgt_host_trid {
 	struct spdk_nvme_transport_id       host_trid;
 	struct nvmf_tgt_poll_group          *pg;
@@ -154,6 +170,146 @@ end:
 	return _pg;
 }
 
+static int32_t
+nvmf_tgt_get_traddr_numa_id(const char *traddr)
+{
+	struct ifaddrs *ifaddrs, *ifa;
+	char addr[INET6_ADDRSTRLEN];
+	char path[PATH_MAX];
+	void *sin_addr;
+	FILE *f;
+	int numa_id = SPDK_ENV_SOCKET_ID_ANY;
+
+	if (getifaddrs(&ifaddrs) != 0) {
+		return SPDK_ENV_SOCKET_ID_ANY;
+	}
+
+	for (ifa = ifaddrs; ifa != NULL; ifa = ifa->ifa_next) {
+		if (ifa->ifa_addr == NULL) {
+			continue;
+		}
+
+		if (ifa->ifa_addr->sa_family == AF_INET) {
+			sin_addr = &((struct sockaddr_in *)ifa->ifa_addr)->sin_addr;
+		} else if (ifa->ifa_addr->sa_family == AF_INET6) {
+			sin_addr = &((struct sockaddr_in6 *)ifa->ifa_addr)->sin6_addr;
+		} else {
+			continue;
+		}
+
+		if (inet_ntop(ifa->ifa_addr->sa_family, sin_addr, addr, sizeof(addr)) == NULL ||
+		    strcmp(addr, traddr) != 0) {
+			continue;
+		}
+
+		snprintf(path, sizeof(path), "/sys/class/net/%s/device/numa_node", ifa->ifa_name);
+		f = fopen(path, "r");
+		if (f != NULL) {
+			if (fscanf(f, "%d", &numa_id) != 1) {
+				numa_id = SPDK_ENV_SOCKET_ID_ANY;
+			}
+			fclose(f);
+		}
+		break;
+	}
+
+	freeifaddrs(ifaddrs);
+
+	/* The kernel reports -1 for devices without NUMA affinity */
+	if (numa_id < 0) {
+		numa_id = SPDK_ENV_SOCKET_ID_ANY;
+	}
+
+	return numa_id;
+}
+
+/* Look up the NUMA node of the NIC a qpair was accepted on. Results are cached
+ * per local address, since there are only as many of those as listeners. */
+static int32_t
+nvmf_tgt_get_qpair_numa_id(struct spdk_nvmf_qpair *qpair)
+{
+	struct spdk_nvme_transport_id trid;
+	struct nvmf_tgt_local_numa *entry;
+
+	if (spdk_nvmf_qpair_get_local_trid(qpair, &trid) != 0) {
+		return SPDK_ENV_SOCKET_ID_ANY;
+	}
+
+	if (trid.adrfam != SPDK_NVMF_ADRFAM_IPV4 && trid.adrfam != SPDK_NVMF_ADRFAM_IPV6) {
+		return SPDK_ENV_SOCKET_ID_ANY;
+	}
+
+	TAILQ_FOREACH(entry, &g_nvmf_tgt_local_numa, link) {
+		if (!strncmp(entry->traddr, trid.traddr, SPDK_NVMF_TRADDR_MAX_LEN + 1)) {
+			return entry->numa_id;
+		}
+	}
+
+	entry = calloc(1, sizeof(*entry));
+	if (!entry) {
+		return nvmf_tgt_get_traddr_numa_id(trid.traddr);
+	}
+
+	memcpy(entry->traddr, trid.traddr, SPDK_NVMF_TRADDR_MAX_LEN + 1);
+	entry->numa_id = nvmf_tgt_get_traddr_numa_id(trid.traddr);
+	TAILQ_INSERT_TAIL(&g_nvmf_tgt_local_numa, entry, link);
+
+	SPDK_NOTICELOG("Local address %s is on NUMA node %d\n", entry->traddr, entry->numa_id);
+
+	return entry->numa_id;
+}
+
+/* Qpairs owned by the poll group plus those still in flight to it */
+static uint64_t
+nvmf_tgt_pg_get_load(struct nvmf_tgt_poll_group *pg)
+{
+	return spdk_nvmf_poll_group_get_num_qpairs(pg->group) + (pg->num_assigned - pg->num_added);
+}
+
+/* Select the least loaded poll group, preferring those running on the same NUMA
+ * node as the NIC the qpair arrived on. Ties are broken in round robin order. */
+static struct nvmf_tgt_poll_group *
+spdk_nvmf_get_numa_pg(struct spdk_nvmf_qpair *qpair)
+{
+	struct nvmf_tgt_poll_group *pg, *best = NULL;
+	uint64_t load, best_load = 0;
+	bool local, best_local = false;
+	int32_t numa_id;
+	size_t i;
+
+	numa_id = nvmf_tgt_get_qpair_numa_id(qpair);
+
+	pg = g_next_poll_group;
+	for (i = 0; i < g_num_poll_groups; i++) {
+		if (pg->group != NULL) {
+			local = numa_id != SPDK_ENV_SOCKET_ID_ANY && pg->numa_id == numa_id;
+			load = nvmf_tgt_pg_get_load(pg);
+			if (best == NULL || (local && !best_local) ||
+			    (local == best_local && load < best_load)) {
+				best = pg;
+				best_load = load;
+				best_local = local;
+			}
+		}
+
+		pg = TAILQ_NEXT(pg, link);
+		if (pg == NULL) {
+			pg = TAILQ_FIRST(&g_poll_groups);
+		}
+	}
+
+	if (best == NULL) {
+		return spdk_nvmf_get_next_pg();
+	}
+
+	g_next_poll_group = TAILQ_NEXT(best, link);
+	if (g_next_poll_group == NULL) {
+		g_next_poll_group = TAILQ_FIRST(&g_poll_groups);
+	}
+
+	return best;
+}
+
 static void
 nvmf_tgt_remove_host_trid(struct spdk_nvmf_qpair *qpair)
 {
@@ -227,6 +383,9 @@ nvmf_tgt_get_pg(struct spdk_nvmf_qpair *qpair)
 	case CONNECT_SCHED_TRANSPORT_OPTIMAL_GROUP:
 		pg = spdk_nvmf_get_optimal_pg(qpair);
 		break;
+	case CONNECT_SCHED_NUMA:
+		pg = spdk_nvmf_get_numa_pg(qpair);
+		break;
 	case CONNECT_SCHED_ROUND_ROBIN:
 	default:
 		pg = spdk_nvmf_get_next_pg();
@@ -247,10 +406,14 @@ nvmf_tgt_poll_group_add(void *_ctx)
 	struct nvmf_tgt_pg_ctx *ctx = _ctx;
 	struct spdk_nvmf_qpair *qpair = ctx->qpair;
 	struct nvmf_tgt_poll_group *pg = ctx->pg;
+	int rc;
 
 	free(_ctx);
 
-	if (spdk_nvmf_poll_group_add(pg->group, qpair) != 0) {
+	rc = spdk_nvmf_poll_group_add(pg->group, qpair);
+	pg->num_added++;
+
+	if (rc != 0) {
 		SPDK_ERRLOG("Unable to add the qpair to a poll group.\n");
 		spdk_nvmf_qpair_disconnect(qpair, NULL, NULL);
 	}
@@ -292,6 +455,7 @@ new_qpair(struct spdk_nvmf_qpair *qpair, void *cb_arg)
 
 	ctx->qpair = qpair;
 	ctx->pg = pg;
+	pg->num_assigned++;
 
 	spdk_thread_send_msg(pg->thread, nvmf_tgt_poll_group_add, ctx);
 }
@@ -354,6 +518,7 @@ nvmf_tgt_create_poll_group(void *ctx)
 	}
 
 	pg->thread = spdk_get_thread();
+	pg->numa_id = (int32_t)spdk_env_get_socket_id(spdk_env_get_current_core());
 	pg->group = spdk_nvmf_poll_group_create(g_spdk_nvmf_tgt);
 	TAILQ_INSERT_TAIL(&g_poll_groups, pg, link);
 	g_num_poll_groups++;
@@ -397,6 +562,7 @@ static void
 nvmf_tgt_destroy_done(void *ctx, int status)
 {
 	struct nvmf_tgt_host_trid *trid, *tmp_trid;
+	struct nvmf_tgt_local_numa *entry, *tmp_entry;
 
 	g_tgt_state = NVMF_TGT_STOPPED;
 
@@ -405,6 +571,11 @@ nvmf_tgt_destroy_done(void *ctx, int status)
 		free(trid);
 	}
 
+	TAILQ_FOREACH_SAFE(entry, &g_nvmf_tgt_local_numa, link, tmp_entry) {
+		TAILQ_REMOVE(&g_nvmf_tgt_local_numa, entry, link);
+		free(entry);
+	}
+
 	free(g_spdk_nvmf_tgt_conf);
 	g_spdk_nvmf_tgt_conf = NULL;
 	nvmf_tgt_advance_state();
@@ -529,6 +700,8 @@ get_conn_sched_string(enum spdk_nvmf_connect_sched sched)
 		return "hostip";
 	} else if (sched == CONNECT_SCHED_TRANSPORT_OPTIMAL_GROUP) {
 		return "transport";
+	} else if (sched == CONNECT_SCHED_NUMA) {
+		return "numa";
 	} else {
 		return "roundrobin";
 	}
@@ -428,6 +428,7 @@ def get_vhost_scsi_json(config, section):
 def get_vhost_blk_json(config, section):
     params = [
         ["ReadOnly", "readonly", bool, False],
+        ["MergeRequests", "merge_requests", bool, False],
         ["Dev", "dev_name", str, ""],
         ["Name", "ctrlr", str, ""],
         ["Cpumask", "cpumask", "hex", ""]
@@ -509,6 +510,7 @@ def get_iscsi_options_json(config, section):
         ['ImmediateData', 'immediate_data', bool, True],
         ['ErrorRecoveryLevel', 'error_recovery_level', int, 0],
         ['NopInInterval', 'nop_in_interval', int, 30],
+        ['ConnRebalancePeriod', 'conn_rebalance_period', int, 0],
         ['DefaultTime2Wait', 'default_time2wait', int, 2],
         ['QueueDepth', 'max_queue_depth', int, 64],
         ['', 'first_burst_length', int, 8192]
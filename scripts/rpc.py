@@ -366,7 +366,8 @@ if __name__ == "__main__":
                                        nvme_adminq_poll_period_us=args.nvme_adminq_poll_period_us,
                                        nvme_ioq_poll_period_us=args.nvme_ioq_poll_period_us,
                                        io_queue_requests=args.io_queue_requests,
-                                       delay_cmd_submit=args.delay_cmd_submit)
+                                       delay_cmd_submit=args.delay_cmd_submit,
+                                       weighted_round_robin=args.weighted_round_robin)
 
     p = subparsers.add_parser('bdev_nvme_set_options', aliases=['set_bdev_nvme_options'],
                               help='Set options for the bdev nvme type. This is startup command.')
@@ -393,6 +394,9 @@ if __name__ == "__main__":
     p.add_argument('-d', '--disable-delay-cmd-submit',
                    help='Disable delaying NVMe command submission, i.e. no batching of multiple commands',
                    action='store_false', dest='delay_cmd_submit', default=True)
+    p.add_argument('-w', '--weighted-round-robin',
+                   help='Enable weighted round robin arbitration and per priority class I/O queues',
+                   action='store_true')
     p.set_defaults(func=bdev_nvme_set_options)
 
     def bdev_nvme_set_hotplug(args):
@@ -774,6 +778,7 @@ if __name__ == "__main__":
             node_base=args.node_base,
             nop_timeout=args.nop_timeout,
             nop_in_interval=args.nop_in_interval,
+            conn_rebalance_period=args.conn_rebalance_period,
             disable_chap=args.disable_chap,
             require_chap=args.require_chap,
             mutual_chap=args.mutual_chap,
@@ -794,6 +799,8 @@ if __name__ == "__main__":
     p.add_argument('-b', '--node-base', help='Prefix of the name of iSCSI target node')
     p.add_argument('-o', '--nop-timeout', help='Timeout in seconds to nop-in request to the initiator', type=int)
     p.add_argument('-n', '--nop-in-interval', help='Time interval in secs between nop-in requests by the target', type=int)
+    p.add_argument('-e', '--conn-rebalance-period', help="""Time interval in secs between moving target nodes
+    away from busy poll groups. 0 disables rebalancing.""", type=int)
     p.add_argument('-d', '--disable-chap', help="""CHAP for discovery session should be disabled.
     *** Mutually exclusive with --require-chap""", action='store_true')
     p.add_argument('-r', '--require-chap', help="""CHAP for discovery session should be required.
@@ -1663,7 +1670,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('-s', '--conn-sched', help="""'roundrobin' - Schedule the incoming connections from any host
     on the cores in a round robin manner (Default). 'hostip' - Schedule all the incoming connections from a
     specific host IP on to the same core. Connections from different IP will be assigned to cores in a round
-    robin manner. 'transport' - Schedule the connection according to the transport characteristics.""")
+    robin manner. 'transport' - Schedule the connection according to the transport characteristics. 'numa' - Schedule
+    the connection on the least loaded core on the same NUMA node as the network device it arrived on.""")
     p.add_argument('-i', '--passthru-identify-ctrlr', help="""Passthrough fields like serial number and model number
     when the controller has a single namespace that is an NVMe bdev""", action='store_true')
     p.set_defaults(func=nvmf_set_config)
@@ -1685,7 +1693,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                                        c2h_success=args.c2h_success,
                                        dif_insert_or_strip=args.dif_insert_or_strip,
 				       sock_priority=args.sock_priority,
-				       wr_batching=args.wr_batching)
+				       wr_batching=args.wr_batching,
+                                       zcopy=args.zcopy)
 
     p = subparsers.add_parser('nvmf_create_transport', help='Create NVMf transport')
     p.add_argument('-t', '--trtype', help='Transport type (ex. RDMA)', type=str, required=True)
@@ -1704,6 +1713,9 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('-f', '--dif-insert-or-strip', action='store_true', help='Enable DIF insert/strip. Relevant only for TCP transport')
     p.add_argument('-y', '--sock-priority', help='The sock priority of the tcp connection. Relevant only for TCP transport', type=int)
     p.add_argument('-b', '--wr-batching', action='store_true', help='Disable work requests batching. Relevant only for RDMA transport')
+    p.add_argument('-z', '--zcopy', action='store_true',
+                   help="""Serve reads from the buffers of bdevs that support zero copy. Relevant only for RDMA and TCP
+                   transports. RDMA also transfers writes into these buffers""")
     p.set_defaults(func=nvmf_create_transport)
 
     def nvmf_get_transports(args):
@@ -1729,7 +1741,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                                        serial_number=args.serial_number,
                                        model_number=args.model_number,
                                        allow_any_host=args.allow_any_host,
-                                       max_namespaces=args.max_namespaces)
+                                       max_namespaces=args.max_namespaces,
+                                       ana_reporting=args.ana_reporting)
 
     p = subparsers.add_parser('nvmf_create_subsystem', aliases=['nvmf_subsystem_create'],
                               help='Create an NVMe-oF subsystem')
@@ -1744,6 +1757,7 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument("-a", "--allow-any-host", action='store_true', help="Allow any host to connect (don't enforce host NQN whitelist)")
     p.add_argument("-m", "--max-namespaces", help="Maximum number of namespaces allowed",
                    type=int, default=0)
+    p.add_argument("-r", "--ana-reporting", action='store_true', help="Enable ANA reporting feature")
     p.set_defaults(func=nvmf_create_subsystem)
 
     def nvmf_delete_subsystem(args):
@@ -1794,6 +1808,30 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('-s', '--trsvcid', help='NVMe-oF transport service id: e.g., a port number')
     p.set_defaults(func=nvmf_subsystem_remove_listener)
 
+    def nvmf_subsystem_listener_set_ana_state(args):
+        rpc.nvmf.nvmf_subsystem_listener_set_ana_state(args.client,
+                                                       nqn=args.nqn,
+                                                       ana_state=args.ana_state,
+                                                       trtype=args.trtype,
+                                                       traddr=args.traddr,
+                                                       trsvcid=args.trsvcid,
+                                                       adrfam=args.adrfam,
+                                                       anagrpid=args.anagrpid,
+                                                       tgt_name=args.tgt_name)
+
+    p = subparsers.add_parser('nvmf_subsystem_listener_set_ana_state',
+                              help='Set ANA state of a listener for an NVMe-oF subsystem')
+    p.add_argument('nqn', help='NVMe-oF subsystem NQN')
+    p.add_argument('-n', '--ana-state', help='ANA state to set: optimized, non_optimized, or inaccessible',
+                   required=True)
+    p.add_argument('-t', '--trtype', help='NVMe-oF transport type: e.g., rdma', required=True)
+    p.add_argument('-a', '--traddr', help='NVMe-oF transport address: e.g., an ip address', required=True)
+    p.add_argument('-p', '--tgt_name', help='The name of the parent NVMe-oF target (optional)', type=str)
+    p.add_argument('-f', '--adrfam', help='NVMe-oF transport adrfam: e.g., ipv4, ipv6, ib, fc, intra_host')
+    p.add_argument('-s', '--trsvcid', help='NVMe-oF transport service id: e.g., a port number')
+    p.add_argument('-g', '--anagrpid', help='ANA group ID (optional, all ANA groups by default)', type=int)
+    p.set_defaults(func=nvmf_subsystem_listener_set_ana_state)
+
     def nvmf_subsystem_add_ns(args):
         rpc.nvmf.nvmf_subsystem_add_ns(args.client,
                                        nqn=args.nqn,
@@ -1803,7 +1841,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                                        nsid=args.nsid,
                                        nguid=args.nguid,
                                        eui64=args.eui64,
-                                       uuid=args.uuid)
+                                       uuid=args.uuid,
+                                       anagrpid=args.anagrpid)
 
     p = subparsers.add_parser('nvmf_subsystem_add_ns', help='Add a namespace to an NVMe-oF subsystem')
     p.add_argument('nqn', help='NVMe-oF subsystem NQN')
@@ -1814,6 +1853,7 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('-g', '--nguid', help='Namespace globally unique identifier (optional)')
     p.add_argument('-e', '--eui64', help='Namespace EUI-64 identifier (optional)')
     p.add_argument('-u', '--uuid', help='Namespace UUID (optional)')
+    p.add_argument('-a', '--anagrpid', help='ANA group ID (optional)', type=int)
     p.set_defaults(func=nvmf_subsystem_add_ns)
 
     def nvmf_subsystem_remove_ns(args):
@@ -1873,6 +1913,17 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('-t', '--tgt_name', help='The name of the parent NVMe-oF target (optional)', type=str)
     p.set_defaults(func=nvmf_get_stats)
 
+    def nvmf_subsystem_get_io_stats(args):
+        print_dict(rpc.nvmf.nvmf_subsystem_get_io_stats(args.client,
+                                                        nqn=args.nqn,
+                                                        tgt_name=args.tgt_name))
+
+    p = subparsers.add_parser('nvmf_subsystem_get_io_stats',
+                              help='Display I/O statistics of the namespaces and controllers of a subsystem')
+    p.add_argument('nqn', help='Subsystem NQN')
+    p.add_argument('-t', '--tgt_name', help='The name of the parent NVMe-oF target (optional)', type=str)
+    p.set_defaults(func=nvmf_subsystem_get_io_stats)
+
     # pmem
     def bdev_pmem_create_pool(args):
         num_blocks = int((args.total_size * 1024 * 1024) / args.block_size)
@@ -1980,7 +2031,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                                               ctrlr=args.ctrlr,
                                               dev_name=args.dev_name,
                                               cpumask=args.cpumask,
-                                              readonly=args.readonly)
+                                              readonly=args.readonly,
+                                              merge_requests=args.merge_requests)
 
     p = subparsers.add_parser('vhost_create_blk_controller',
                               aliases=['construct_vhost_blk_controller'],
@@ -1989,6 +2041,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('dev_name', help='device name')
     p.add_argument('--cpumask', help='cpu mask for this controller')
     p.add_argument("-r", "--readonly", action='store_true', help='Set controller as read-only')
+    p.add_argument("-m", "--merge-requests", action='store_true',
+                   help='Submit adjacent read or write requests as a single bdev I/O')
     p.set_defaults(func=vhost_create_blk_controller)
 
     def vhost_create_nvme_controller(args):
@@ -357,7 +357,7 @@ def bdev_nvme_set_options(client, action_on_timeout=None, timeout_us=None, retry
                           arbitration_burst=None, low_priority_weight=None,
                           medium_priority_weight=None, high_priority_weight=None,
                           nvme_adminq_poll_period_us=None, nvme_ioq_poll_period_us=None, io_queue_requests=None,
-                          delay_cmd_submit=None):
+                          delay_cmd_submit=None, weighted_round_robin=None):
     """Set options for the bdev nvme. This is startup command.
 
     Args:
@@ -372,6 +372,7 @@ def bdev_nvme_set_options(client, action_on_timeout=None, timeout_us=None, retry
         nvme_ioq_poll_period_us: How often to poll I/O queues for completions in microseconds (optional)
         io_queue_requests: The number of requests allocated for each NVMe I/O queue. Default: 512 (optional)
         delay_cmd_submit: Enable delayed NVMe command submission to allow batching of multiple commands (optional)
+        weighted_round_robin: Enable weighted round robin arbitration and per priority class I/O queues (optional)
     """
     params = {}
 
@@ -408,6 +409,9 @@ def bdev_nvme_set_options(client, action_on_timeout=None, timeout_us=None, retry
     if delay_cmd_submit is not None:
         params['delay_cmd_submit'] = delay_cmd_submit
 
+    if weighted_round_robin is not None:
+        params['weighted_round_robin'] = weighted_round_robin
+
     return client.call('bdev_nvme_set_options', params)
 
 
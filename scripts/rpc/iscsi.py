@@ -8,6 +8,7 @@ def iscsi_set_options(
         node_base=None,
         nop_timeout=None,
         nop_in_interval=None,
+        conn_rebalance_period=None,
         disable_chap=None,
         require_chap=None,
         mutual_chap=None,
@@ -28,6 +29,7 @@ def iscsi_set_options(
         node_base: Prefix of the name of iSCSI target node (optional)
         nop_timeout: Timeout in seconds to nop-in request to the initiator (optional)
         nop_in_interval: Time interval in secs between nop-in requests by the target (optional)
+        conn_rebalance_period: Interval in secs between moving target nodes away from busy poll groups (optional)
         disable_chap: CHAP for discovery session should be disabled (optional)
         require_chap: CHAP for discovery session should be required
         mutual_chap: CHAP for discovery session should be mutual
@@ -55,6 +57,8 @@ def iscsi_set_options(
         params['nop_timeout'] = nop_timeout
     if nop_in_interval:
         params['nop_in_interval'] = nop_in_interval
+    if conn_rebalance_period:
+        params['conn_rebalance_period'] = conn_rebalance_period
     if disable_chap:
         params['disable_chap'] = disable_chap
     if require_chap:
@@ -107,7 +107,8 @@ def nvmf_create_transport(client,
                           c2h_success=True,
                           dif_insert_or_strip=None,
 			  sock_priority=None,
-			  wr_batching=True):
+			  wr_batching=True,
+                          zcopy=False):
     """NVMf Transport Create options.
 
     Args:
@@ -125,6 +126,7 @@ def nvmf_create_transport(client,
         c2h_success: Boolean flag to disable the C2H success optimization - TCP specific (optional)
         dif_insert_or_strip: Boolean flag to enable DIF insert/strip for I/O - TCP specific (optional)
 	wq_batching: Boolean flag to disable work requests batching - RDMA specific (optional)
+        zcopy: Boolean flag to serve reads from the bdev buffers with zero copy - RDMA and TCP specific (optional)
     Returns:
         True or False
     """
@@ -161,6 +163,8 @@ def nvmf_create_transport(client,
         params['sock_priority'] = sock_priority
     if wr_batching:
 	params['wr_batching'] = wr_batching
+    if zcopy:
+        params['zcopy'] = zcopy
     return client.call('nvmf_create_transport', params)
 
 
@@ -211,7 +215,8 @@ def nvmf_create_subsystem(client,
                           tgt_name=None,
                           model_number='SPDK bdev Controller',
                           allow_any_host=False,
-                          max_namespaces=0):
+                          max_namespaces=0,
+                          ana_reporting=False):
     """Construct an NVMe over Fabrics target subsystem.
 
     Args:
@@ -221,6 +226,7 @@ def nvmf_create_subsystem(client,
         model_number: Model number of virtual controller.
         allow_any_host: Allow any host (True) or enforce allowed host whitelist (False). Default: False.
         max_namespaces: Maximum number of namespaces that can be attached to the subsystem (optional). Default: 0 (Unlimited).
+        ana_reporting: Enable Asymmetric Namespace Access reporting (optional). Default: False.
 
     Returns:
         True or False
@@ -241,6 +247,9 @@ def nvmf_create_subsystem(client,
     if max_namespaces:
         params['max_namespaces'] = max_namespaces
 
+    if ana_reporting:
+        params['ana_reporting'] = True
+
     if tgt_name:
         params['tgt_name'] = tgt_name
 
@@ -314,7 +323,53 @@ def nvmf_subsystem_remove_listener(
     return client.call('nvmf_subsystem_remove_listener', params)
 
 
-def nvmf_subsystem_add_ns(client, nqn, bdev_name, tgt_name=None, ptpl_file=None, nsid=None, nguid=None, eui64=None, uuid=None):
+def nvmf_subsystem_listener_set_ana_state(
+        client,
+        nqn,
+        ana_state,
+        trtype,
+        traddr,
+        trsvcid,
+        adrfam,
+        anagrpid=None,
+        tgt_name=None):
+    """Set ANA state of a listener for an NVMe-oF subsystem.
+
+    Args:
+        nqn: Subsystem NQN.
+        ana_state: ANA state to set ("optimized", "non_optimized", or "inaccessible").
+        trtype: Transport type ("RDMA").
+        traddr: Transport address.
+        trsvcid: Transport service ID.
+        adrfam: Address family ("IPv4", "IPv6", "IB", or "FC").
+        anagrpid: ANA group ID (optional). Default: all ANA groups.
+        tgt_name: name of the parent NVMe-oF target (optional).
+
+    Returns:
+            True or False
+    """
+    listen_address = {'trtype': trtype,
+                      'traddr': traddr,
+                      'trsvcid': trsvcid}
+
+    if adrfam:
+        listen_address['adrfam'] = adrfam
+
+    params = {'nqn': nqn,
+              'listen_address': listen_address,
+              'ana_state': ana_state}
+
+    if anagrpid:
+        params['anagrpid'] = anagrpid
+
+    if tgt_name:
+        params['tgt_name'] = tgt_name
+
+    return client.call('nvmf_subsystem_listener_set_ana_state', params)
+
+
+def nvmf_subsystem_add_ns(client, nqn, bdev_name, tgt_name=None, ptpl_file=None, nsid=None, nguid=None, eui64=None, uuid=None,
+                          anagrpid=None):
     """Add a namespace to a subsystem.
 
     Args:
@@ -325,6 +380,7 @@ def nvmf_subsystem_add_ns(client, nqn, bdev_name, tgt_name=None, ptpl_file=None,
         nguid: 16-byte namespace globally unique identifier in hexadecimal (optional).
         eui64: 8-byte namespace EUI-64 in hexadecimal (e.g. "ABCDEF0123456789") (optional).
         uuid: Namespace UUID (optional).
+        anagrpid: ANA group ID (optional). Default: the namespace ID.
 
     Returns:
         The namespace ID
@@ -346,6 +402,9 @@ def nvmf_subsystem_add_ns(client, nqn, bdev_name, tgt_name=None, ptpl_file=None,
     if uuid:
         ns['uuid'] = uuid
 
+    if anagrpid:
+        ns['anagrpid'] = anagrpid
+
     params = {'nqn': nqn,
               'namespace': ns}
 
@@ -471,3 +530,21 @@ def nvmf_get_stats(client, tgt_name=None):
         }
 
     return client.call('nvmf_get_stats', params)
+
+
+def nvmf_subsystem_get_io_stats(client, nqn, tgt_name=None):
+    """Query I/O statistics of the namespaces and controllers of a subsystem.
+
+    Args:
+        nqn: Subsystem NQN.
+        tgt_name: name of the parent NVMe-oF target (optional).
+
+    Returns:
+        Read and write statistics per namespace and per controller.
+    """
+    params = {'nqn': nqn}
+
+    if tgt_name:
+        params['tgt_name'] = tgt_name
+
+    return client.call('nvmf_subsystem_get_io_stats', params)
@@ -2558,6 +2558,59 @@ bdev_close_while_hotremove(void)
 	free_bdev(bdev);
 }
 
+static void
+bdev_io_priority(void)
+{
+	struct spdk_bdev *bdev;
+	struct spdk_bdev_desc *desc = NULL, *desc_urgent = NULL;
+	struct spdk_io_channel *io_ch;
+	char buf[512];
+	int rc;
+
+	spdk_bdev_initialize(bdev_init_cb, NULL);
+	poll_threads();
+
+	bdev = allocate_bdev("bdev0");
+
+	rc = spdk_bdev_open(bdev, true, NULL, NULL, &desc);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(desc != NULL);
+	rc = spdk_bdev_open(bdev, true, NULL, NULL, &desc_urgent);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(desc_urgent != NULL);
+	io_ch = spdk_bdev_get_io_channel(desc);
+	SPDK_CU_ASSERT_FATAL(io_ch != NULL);
+
+	CU_ASSERT(spdk_bdev_desc_get_io_priority(desc) == SPDK_BDEV_IO_PRIORITY_DEFAULT);
+	rc = spdk_bdev_desc_set_io_priority(desc_urgent, SPDK_BDEV_NUM_IO_PRIORITIES);
+	CU_ASSERT(rc == -EINVAL);
+	rc = spdk_bdev_desc_set_io_priority(desc_urgent, SPDK_BDEV_IO_PRIORITY_URGENT);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(spdk_bdev_desc_get_io_priority(desc_urgent) == SPDK_BDEV_IO_PRIORITY_URGENT);
+
+	/* The I/O inherits the priority of the descriptor it was submitted through */
+	g_bdev_io = NULL;
+	rc = spdk_bdev_read_blocks(desc_urgent, io_ch, buf, 0, 1, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(g_bdev_io != NULL);
+	CU_ASSERT(g_bdev_io->priority == SPDK_BDEV_IO_PRIORITY_URGENT);
+	CU_ASSERT(stub_complete_io(1) == 1);
+
+	g_bdev_io = NULL;
+	rc = spdk_bdev_read_blocks(desc, io_ch, buf, 0, 1, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(g_bdev_io != NULL);
+	CU_ASSERT(g_bdev_io->priority == SPDK_BDEV_IO_PRIORITY_DEFAULT);
+	CU_ASSERT(stub_complete_io(1) == 1);
+
+	spdk_put_io_channel(io_ch);
+	spdk_bdev_close(desc_urgent);
+	spdk_bdev_close(desc);
+	free_bdev(bdev);
+	spdk_bdev_finish(bdev_fini_cb, NULL);
+	poll_threads();
+}
+
 static void
 bdev_open_ext(void)
 {
@@ -3154,6 +3207,7 @@ main(int argc, char **argv)
 		CU_add_test(suite, "bdev_open_while_hotremove", bdev_open_while_hotremove) == NULL ||
 		CU_add_test(suite, "bdev_close_while_hotremove", bdev_close_while_hotremove) == NULL ||
 		CU_add_test(suite, "bdev_open_ext", bdev_open_ext) == NULL ||
+		CU_add_test(suite, "bdev_io_priority", bdev_io_priority) == NULL ||
 		CU_add_test(suite, "bdev_set_io_timeout", bdev_set_io_timeout) == NULL ||
 		CU_add_test(suite, "lba_range_overlap", lba_range_overlap) == NULL ||
 		CU_add_test(suite, "lock_lba_range_check_ranges", lock_lba_range_check_ranges) == NULL ||
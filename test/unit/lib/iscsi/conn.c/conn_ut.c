@@ -226,6 +226,8 @@ DEFINE_STUB(spdk_iscsi_pdu_calc_header_digest, uint32_t,
 DEFINE_STUB(spdk_iscsi_pdu_calc_data_digest, uint32_t,
 	    (struct spdk_iscsi_pdu *pdu), 0);
 
+DEFINE_STUB_V(spdk_iscsi_pdus_calc_digests, (struct spdk_iscsi_pdu **pdus, int num_pdus));
+
 DEFINE_STUB_V(spdk_shutdown_iscsi_conns_done, (void));
 
 static struct spdk_iscsi_task *
@@ -884,6 +886,39 @@ abort_queued_datain_tasks_test(void)
 	g_new_task = NULL;
 }
 
+static void
+get_idlest_pg_test(void)
+{
+	struct spdk_iscsi_poll_group pg1 = {}, pg2 = {}, pg3 = {};
+
+	TAILQ_INIT(&g_spdk_iscsi.poll_group_head);
+	TAILQ_INSERT_TAIL(&g_spdk_iscsi.poll_group_head, &pg1, link);
+	TAILQ_INSERT_TAIL(&g_spdk_iscsi.poll_group_head, &pg2, link);
+	TAILQ_INSERT_TAIL(&g_spdk_iscsi.poll_group_head, &pg3, link);
+	g_next_pg = NULL;
+
+	/* Equally busy and empty poll groups are picked round-robin. */
+	CU_ASSERT(iscsi_conn_get_idlest_pg() == &pg1);
+	CU_ASSERT(iscsi_conn_get_idlest_pg() == &pg2);
+	CU_ASSERT(iscsi_conn_get_idlest_pg() == &pg3);
+	CU_ASSERT(iscsi_conn_get_idlest_pg() == &pg1);
+
+	/* The least busy poll group wins regardless of the number of target nodes. */
+	pg1.load = 600;
+	pg2.load = 300;
+	pg2.num_targets = 4;
+	pg3.load = 500;
+	CU_ASSERT(iscsi_conn_get_idlest_pg() == &pg2);
+
+	/* Within the tolerance, the poll group hosting fewer target nodes wins. */
+	pg3.load = 320;
+	pg3.num_targets = 1;
+	CU_ASSERT(iscsi_conn_get_idlest_pg() == &pg3);
+
+	g_next_pg = NULL;
+	TAILQ_INIT(&g_spdk_iscsi.poll_group_head);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -911,7 +946,8 @@ main(int argc, char **argv)
 		CU_add_test(suite, "free_tasks_on_connection", free_tasks_on_connection) == NULL ||
 		CU_add_test(suite, "free_tasks_with_queued_datain", free_tasks_with_queued_datain) == NULL ||
 		CU_add_test(suite, "abort_queued_datain_task_test", abort_queued_datain_task_test) == NULL ||
-		CU_add_test(suite, "abort_queued_datain_tasks_test", abort_queued_datain_tasks_test) == NULL
+		CU_add_test(suite, "abort_queued_datain_tasks_test", abort_queued_datain_tasks_test) == NULL ||
+		CU_add_test(suite, "get_idlest_pg_test", get_idlest_pg_test) == NULL
 	) {
 		CU_cleanup_registry();
 		return CU_get_error();
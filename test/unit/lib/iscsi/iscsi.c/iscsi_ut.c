@@ -1196,6 +1196,145 @@ build_iovs_test(void)
 	free(data);
 }
 
+static void
+build_iovs_with_data_iovs_test(void)
+{
+	struct spdk_iscsi_conn conn = {};
+	struct spdk_iscsi_pdu pdu = {}, flat_pdu = {};
+	struct iovec iovs[SPDK_ISCSI_MAX_SGL_DESCRIPTORS] = {}, task_iovs[3];
+	uint8_t *data, flat[1024];
+	uint32_t mapped_length = 0;
+	int rc, i;
+
+	conn.header_digest = true;
+	conn.data_digest = true;
+
+	data = calloc(1, 1536);
+	SPDK_CU_ASSERT_FATAL(data != NULL);
+	for (i = 0; i < 1536; i++) {
+		data[i] = rand();
+	}
+	task_iovs[0].iov_base = data;
+	task_iovs[0].iov_len = 512;
+	task_iovs[1].iov_base = data + 512;
+	task_iovs[1].iov_len = 512;
+	task_iovs[2].iov_base = data + 1024;
+	task_iovs[2].iov_len = 512;
+
+	/* The data segment starts in the middle of the first iovec, spans the second one,
+	 *  ends in the third one and is not a multiple of 4 bytes.
+	 */
+	pdu.conn = &conn;
+	pdu.bhs.opcode = ISCSI_OP_SCSI_DATAIN;
+	DSET24(&pdu.bhs.data_segment_len, 1001);
+	pdu.data_iovs = task_iovs;
+	pdu.data_iovcnt = 3;
+	pdu.data_iov_offset = 300;
+
+	rc = spdk_iscsi_build_iovs(&conn, iovs, SPDK_COUNTOF(iovs), &pdu, &mapped_length);
+	CU_ASSERT(rc == 7);
+	CU_ASSERT(iovs[0].iov_base == (void *)&pdu.bhs);
+	CU_ASSERT(iovs[0].iov_len == ISCSI_BHS_LEN);
+	CU_ASSERT(iovs[1].iov_base == (void *)pdu.header_digest);
+	CU_ASSERT(iovs[1].iov_len == ISCSI_DIGEST_LEN);
+	CU_ASSERT(iovs[2].iov_base == (void *)(data + 300));
+	CU_ASSERT(iovs[2].iov_len == 212);
+	CU_ASSERT(iovs[3].iov_base == (void *)(data + 512));
+	CU_ASSERT(iovs[3].iov_len == 512);
+	CU_ASSERT(iovs[4].iov_base == (void *)(data + 1024));
+	CU_ASSERT(iovs[4].iov_len == 277);
+	CU_ASSERT(iovs[5].iov_len == 3);
+	CU_ASSERT(iovs[6].iov_base == (void *)pdu.data_digest);
+	CU_ASSERT(iovs[6].iov_len == ISCSI_DIGEST_LEN);
+	CU_ASSERT(mapped_length == ISCSI_BHS_LEN + ISCSI_DIGEST_LEN + 1004 + ISCSI_DIGEST_LEN);
+
+	/* Resume after the first piece of the data segment. */
+	pdu.writev_offset = ISCSI_BHS_LEN + ISCSI_DIGEST_LEN + 212;
+	rc = spdk_iscsi_build_iovs(&conn, iovs, SPDK_COUNTOF(iovs), &pdu, &mapped_length);
+	CU_ASSERT(rc == 4);
+	CU_ASSERT(iovs[0].iov_base == (void *)(data + 512));
+	CU_ASSERT(iovs[0].iov_len == 512);
+	CU_ASSERT(mapped_length == 512 + 277 + 3 + ISCSI_DIGEST_LEN);
+
+	/* The data digest is the same as for the data segment in a single buffer. */
+	memset(flat, 0, sizeof(flat));
+	memcpy(flat, data + 300, 1001);
+	flat_pdu.conn = &conn;
+	flat_pdu.bhs.opcode = ISCSI_OP_SCSI_DATAIN;
+	DSET24(&flat_pdu.bhs.data_segment_len, 1001);
+	flat_pdu.data = flat;
+	CU_ASSERT(spdk_iscsi_pdu_calc_data_digest(&pdu) ==
+		  spdk_iscsi_pdu_calc_data_digest(&flat_pdu));
+
+	free(data);
+}
+
+static void
+datain_max_data_iovs_test(void)
+{
+	struct spdk_iscsi_sess sess = {};
+	struct spdk_iscsi_conn conn = {};
+	struct spdk_iscsi_task task = {};
+	struct spdk_scsi_dev dev = {};
+	struct spdk_iscsi_pdu *pdu;
+	struct iscsi_bhs_data_in *datah;
+	struct iovec task_iovs[SPDK_ISCSI_MAX_DATA_IOVS + 2];
+	uint8_t data[(SPDK_ISCSI_MAX_DATA_IOVS + 2) * 512];
+	int i;
+
+	sess.MaxBurstLength = SPDK_ISCSI_MAX_BURST_LENGTH;
+
+	conn.sess = &sess;
+	conn.MaxRecvDataSegmentLength = 8192;
+	conn.dev = &dev;
+
+	pdu = spdk_get_pdu(&conn);
+	SPDK_CU_ASSERT_FATAL(pdu != NULL);
+	((struct iscsi_bhs_scsi_req *)&pdu->bhs)->read_bit = 1;
+
+	spdk_iscsi_task_set_pdu(&task, pdu);
+	task.parent = NULL;
+
+	for (i = 0; i < (int)SPDK_COUNTOF(task_iovs); i++) {
+		task_iovs[i].iov_base = data + i * 512;
+		task_iovs[i].iov_len = 512;
+	}
+	task.scsi.iovs = task_iovs;
+	task.scsi.iovcnt = SPDK_COUNTOF(task_iovs);
+	task.scsi.length = sizeof(data);
+	task.scsi.transfer_len = sizeof(data);
+	task.bytes_completed = sizeof(data);
+	task.scsi.data_transferred = sizeof(data);
+	task.scsi.status = SPDK_SCSI_STATUS_GOOD;
+
+	spdk_iscsi_task_response(&conn, &task);
+	spdk_put_pdu(pdu);
+
+	/* The data doesn't fit into a single Data-In PDU's iovecs, so it's split. */
+	pdu = TAILQ_FIRST(&g_write_pdu_list);
+	SPDK_CU_ASSERT_FATAL(pdu != NULL);
+	datah = (struct iscsi_bhs_data_in *)&pdu->bhs;
+	CU_ASSERT(pdu->bhs.opcode == ISCSI_OP_SCSI_DATAIN);
+	CU_ASSERT(DGET24(datah->data_segment_len) == SPDK_ISCSI_MAX_DATA_IOVS * 512);
+	CU_ASSERT(from_be32(&datah->buffer_offset) == 0);
+	CU_ASSERT(pdu->data_iov_offset == 0);
+	CU_ASSERT(datah->flags == 0);
+	TAILQ_REMOVE(&g_write_pdu_list, pdu, tailq);
+	spdk_put_pdu(pdu);
+
+	pdu = TAILQ_FIRST(&g_write_pdu_list);
+	SPDK_CU_ASSERT_FATAL(pdu != NULL);
+	datah = (struct iscsi_bhs_data_in *)&pdu->bhs;
+	CU_ASSERT(DGET24(datah->data_segment_len) == 2 * 512);
+	CU_ASSERT(from_be32(&datah->buffer_offset) == SPDK_ISCSI_MAX_DATA_IOVS * 512);
+	CU_ASSERT(pdu->data_iov_offset == SPDK_ISCSI_MAX_DATA_IOVS * 512);
+	CU_ASSERT(datah->flags == (ISCSI_FLAG_FINAL | ISCSI_DATAIN_STATUS));
+	TAILQ_REMOVE(&g_write_pdu_list, pdu, tailq);
+	spdk_put_pdu(pdu);
+
+	CU_ASSERT(TAILQ_EMPTY(&g_write_pdu_list));
+}
+
 static void
 build_iovs_with_md_test(void)
 {
@@ -1927,7 +2066,11 @@ pdu_hdr_op_data_test(void)
 
 	/* Case 10 - SCSI Data-Out PDU is correct and processed. Created task is held
 	 * to the PDU, but its F bit is 0 and hence R2T is not sent.
+	 *
+	 * No buffer is available to read the data segment into the primary task, so
+	 * a subtask is created for the PDU. See data_out_into_task_buf_test.
 	 */
+	MOCK_SET(spdk_mempool_get, NULL);
 	dev.lun[0] = &lun;
 	to_be32(&data_reqh->data_sn, primary.r2t_datasn);
 	to_be32(&data_reqh->buffer_offset, primary.next_expected_r2t_offset);
@@ -1961,6 +2104,212 @@ pdu_hdr_op_data_test(void)
 	CU_ASSERT(rc == SPDK_ISCSI_CONNECTION_FATAL);
 
 	g_task_pool_is_empty = false;
+	MOCK_CLEAR(spdk_mempool_get);
+}
+
+static void
+data_out_into_task_buf_test(void)
+{
+	struct spdk_iscsi_sess sess = {};
+	struct spdk_iscsi_conn conn = {};
+	struct spdk_iscsi_pdu *pdu;
+	struct spdk_iscsi_task primary = {};
+	struct spdk_scsi_dev dev = {};
+	struct spdk_scsi_lun lun = {};
+	struct spdk_mobj mobj = {};
+	struct iscsi_bhs_data_out *data_reqh;
+	uint32_t offset, ref;
+	int rc, i;
+
+	sess.session_type = SESSION_TYPE_NORMAL;
+	sess.MaxBurstLength = SPDK_ISCSI_MAX_RECV_DATA_SEGMENT_LENGTH * 2;
+	conn.sess = &sess;
+	conn.dev = &dev;
+	dev.lun[0] = &lun;
+	TAILQ_INIT(&g_write_pdu_list);
+
+	primary.scsi.ref = 1;
+	primary.scsi.transfer_len = 8192 * 10;
+	primary.desired_data_transfer_length = SPDK_ISCSI_MAX_RECV_DATA_SEGMENT_LENGTH * 2;
+	conn.pending_r2t = 1;
+	conn.outstanding_r2t_tasks[0] = &primary;
+
+	mobj.buf = calloc(1, SPDK_ISCSI_MAX_RECV_DATA_SEGMENT_LENGTH);
+	SPDK_CU_ASSERT_FATAL(mobj.buf != NULL);
+	MOCK_SET(spdk_mempool_get, &mobj);
+
+	/* Ten 8KB Data-Out PDUs. The first eight fill the buffer of the primary task and
+	 *  are submitted as a single subtask. The last two end the transfer. Each
+	 *  subtask holds a reference to the primary task.
+	 */
+	ref = 1;
+	for (i = 0; i < 10; i++) {
+		offset = 8192 * i;
+		pdu = spdk_get_pdu(&conn);
+		SPDK_CU_ASSERT_FATAL(pdu != NULL);
+		data_reqh = (struct iscsi_bhs_data_out *)&pdu->bhs;
+		data_reqh->opcode = ISCSI_OP_SCSI_DATAOUT;
+		if (i == 9) {
+			data_reqh->flags |= ISCSI_FLAG_FINAL;
+		}
+		DSET24(data_reqh->data_segment_len, 8192);
+		pdu->data_segment_len = 8192;
+		to_be32(&data_reqh->data_sn, i);
+		to_be32(&data_reqh->buffer_offset, offset);
+
+		rc = iscsi_pdu_hdr_op_data(&conn, pdu);
+		CU_ASSERT(rc == 0);
+		CU_ASSERT(pdu->task == &primary);
+		CU_ASSERT(pdu->data_in_task_buf == true);
+		CU_ASSERT(pdu->data_buf == (uint8_t *)mobj.buf + offset % 65536);
+		CU_ASSERT(primary.scsi.ref == ref + 1);
+		CU_ASSERT(primary.mobj == &mobj);
+		CU_ASSERT(primary.mobj_offset == offset / 65536 * 65536);
+
+		rc = iscsi_pdu_payload_op_data(&conn, pdu);
+		CU_ASSERT(rc == 0);
+		if (i == 7 || i == 9) {
+			/* Submitted. The subtask owns the buffer now. */
+			ref++;
+			CU_ASSERT(primary.mobj == NULL);
+			CU_ASSERT(primary.mobj_len == 0);
+		} else {
+			CU_ASSERT(primary.mobj_len == offset % 65536 + 8192);
+		}
+		CU_ASSERT(primary.scsi.ref == ref);
+		spdk_put_pdu(pdu);
+	}
+
+	/* A Data-Out PDU which doesn't follow the collected data submits it first. */
+	primary.mobj = &mobj;
+	primary.mobj_offset = 0;
+	primary.mobj_len = 4096;
+	primary.next_expected_r2t_offset = 8192;
+	primary.r2t_datasn = 0;
+	primary.scsi.transfer_len = 8192 * 20;
+	pdu = spdk_get_pdu(&conn);
+	SPDK_CU_ASSERT_FATAL(pdu != NULL);
+	data_reqh = (struct iscsi_bhs_data_out *)&pdu->bhs;
+	DSET24(data_reqh->data_segment_len, 8192);
+	pdu->data_segment_len = 8192;
+	to_be32(&data_reqh->buffer_offset, 8192);
+
+	rc = iscsi_pdu_hdr_op_data(&conn, pdu);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(pdu->data_buf == mobj.buf);
+	CU_ASSERT(primary.mobj_offset == 8192);
+	CU_ASSERT(primary.mobj_len == 0);
+	spdk_iscsi_task_put(pdu->task);
+	spdk_put_pdu(pdu);
+
+	/* No buffer is available. The collected data is submitted and the PDU gets
+	 *  a subtask of its own.
+	 */
+	primary.mobj_len = 4096;
+	MOCK_SET(spdk_mempool_get, NULL);
+	pdu = spdk_get_pdu(&conn);
+	SPDK_CU_ASSERT_FATAL(pdu != NULL);
+	data_reqh = (struct iscsi_bhs_data_out *)&pdu->bhs;
+	DSET24(data_reqh->data_segment_len, 8192);
+	pdu->data_segment_len = 8192;
+	to_be32(&data_reqh->data_sn, 1);
+	to_be32(&data_reqh->buffer_offset, 16384);
+
+	rc = iscsi_pdu_hdr_op_data(&conn, pdu);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(primary.mobj == NULL);
+	CU_ASSERT(pdu->data_in_task_buf == false);
+	CU_ASSERT(pdu->task != NULL && pdu->task != &primary);
+	spdk_iscsi_task_put(pdu->task);
+	spdk_put_pdu(pdu);
+
+	MOCK_CLEAR(spdk_mempool_get);
+	free(mobj.buf);
+}
+
+#define UT_DIGEST_DATA_LEN	8192
+static void
+pdus_calc_digests_test(void)
+{
+	struct spdk_iscsi_conn conn = {};
+	struct spdk_iscsi_pdu *pdus[ISCSI_DIGEST_BATCH_SIZE];
+	uint32_t header_crcs[ISCSI_DIGEST_BATCH_SIZE], data_crcs[ISCSI_DIGEST_BATCH_SIZE];
+	struct iovec data_iovs[ISCSI_DIGEST_BATCH_SIZE][2];
+	struct spdk_iscsi_pdu *pdu;
+	uint32_t data_len;
+	int i, j;
+
+	conn.header_digest = 1;
+	conn.data_digest = 1;
+
+	for (i = 0; i < ISCSI_DIGEST_BATCH_SIZE; i++) {
+		pdu = calloc(1, sizeof(*pdu));
+		SPDK_CU_ASSERT_FATAL(pdu != NULL);
+		pdu->conn = &conn;
+		for (j = 0; j < ISCSI_BHS_LEN; j++) {
+			((uint8_t *)&pdu->bhs)[j] = rand();
+		}
+		pdu->bhs.opcode = ISCSI_OP_SCSI_DATAIN;
+
+		/* Cover data segments needing padding, AHS and PDUs without data. */
+		data_len = (i % 8 == 7) ? 0 : UT_DIGEST_DATA_LEN - i;
+		DSET24(pdu->bhs.data_segment_len, data_len);
+		pdu->bhs.total_ahs_len = 0;
+		if (i % 5 == 0) {
+			pdu->bhs.total_ahs_len = 2;
+			memset(pdu->ahs, i, 8);
+		}
+
+		pdu->data = calloc(1, UT_DIGEST_DATA_LEN);
+		SPDK_CU_ASSERT_FATAL(pdu->data != NULL);
+		for (j = 0; j < UT_DIGEST_DATA_LEN; j++) {
+			pdu->data[j] = rand();
+		}
+
+		/* Some PDUs refer to their data segment by split iovecs, as Data-In does. */
+		if (i % 3 == 1) {
+			data_iovs[i][0].iov_base = pdu->data;
+			data_iovs[i][0].iov_len = 1000 + i;
+			data_iovs[i][1].iov_base = pdu->data + 1000 + i;
+			data_iovs[i][1].iov_len = UT_DIGEST_DATA_LEN - 1000 - i;
+			pdu->data_iovs = data_iovs[i];
+			pdu->data_iovcnt = 2;
+			pdu->data_iov_offset = i;
+		}
+		pdus[i] = pdu;
+	}
+
+	for (i = 0; i < ISCSI_DIGEST_BATCH_SIZE; i++) {
+		header_crcs[i] = spdk_iscsi_pdu_calc_header_digest(pdus[i]);
+		if (DGET24(pdus[i]->bhs.data_segment_len) != 0) {
+			data_crcs[i] = spdk_iscsi_pdu_calc_data_digest(pdus[i]);
+		}
+	}
+
+	/* The batched digests must match the per-PDU ones. */
+	spdk_iscsi_pdus_calc_digests(pdus, ISCSI_DIGEST_BATCH_SIZE);
+
+	for (i = 0; i < ISCSI_DIGEST_BATCH_SIZE; i++) {
+		pdu = pdus[i];
+		CU_ASSERT(MATCH_DIGEST_WORD(pdu->header_digest, header_crcs[i]));
+		if (DGET24(pdu->bhs.data_segment_len) != 0) {
+			CU_ASSERT(MATCH_DIGEST_WORD(pdu->data_digest, data_crcs[i]));
+		}
+	}
+
+	/* Login responses never carry digests. */
+	pdu = pdus[0];
+	pdu->bhs.opcode = ISCSI_OP_LOGIN_RSP;
+	memset(pdu->header_digest, 0, ISCSI_DIGEST_LEN);
+	memset(pdu->data_digest, 0, ISCSI_DIGEST_LEN);
+	spdk_iscsi_pdus_calc_digests(pdus, 1);
+	CU_ASSERT(MATCH_DIGEST_WORD(pdu->header_digest, 0));
+	CU_ASSERT(MATCH_DIGEST_WORD(pdu->data_digest, 0));
+
+	for (i = 0; i < ISCSI_DIGEST_BATCH_SIZE; i++) {
+		free(pdus[i]->data);
+		free(pdus[i]);
+	}
 }
 
 int
@@ -1997,6 +2346,9 @@ main(int argc, char **argv)
 		|| CU_add_test(suite, "clear all transfer tasks test",
 			       clear_all_transfer_tasks_test) == NULL
 		|| CU_add_test(suite, "build_iovs_test", build_iovs_test) == NULL
+		|| CU_add_test(suite, "build_iovs_with_data_iovs_test",
+			       build_iovs_with_data_iovs_test) == NULL
+		|| CU_add_test(suite, "datain_max_data_iovs_test", datain_max_data_iovs_test) == NULL
 		|| CU_add_test(suite, "build_iovs_with_md_test", build_iovs_with_md_test) == NULL
 		|| CU_add_test(suite, "pdu_hdr_op_login_test", pdu_hdr_op_login_test) == NULL
 		|| CU_add_test(suite, "pdu_hdr_op_text_test", pdu_hdr_op_text_test) == NULL
@@ -2005,6 +2357,9 @@ main(int argc, char **argv)
 		|| CU_add_test(suite, "pdu_hdr_op_task_mgmt_test", pdu_hdr_op_task_mgmt_test) == NULL
 		|| CU_add_test(suite, "pdu_hdr_op_nopout_test", pdu_hdr_op_nopout_test) == NULL
 		|| CU_add_test(suite, "pdu_hdr_op_data_test", pdu_hdr_op_data_test) == NULL
+		|| CU_add_test(suite, "data_out_into_task_buf_test",
+			       data_out_into_task_buf_test) == NULL
+		|| CU_add_test(suite, "pdus_calc_digests_test", pdus_calc_digests_test) == NULL
 	) {
 		CU_cleanup_registry();
 		return CU_get_error();
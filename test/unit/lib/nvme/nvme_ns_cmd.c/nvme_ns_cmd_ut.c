@@ -1474,6 +1474,79 @@ test_nvme_ns_cmd_read_with_md(void)
 	free(metadata);
 }
 
+static void
+test_nvme_ns_cmd_zone_append_with_md(void)
+{
+	struct spdk_nvme_ns             ns;
+	struct spdk_nvme_ctrlr          ctrlr;
+	struct spdk_nvme_qpair          qpair;
+	int                             rc = 0;
+	char				*buffer = NULL;
+	char				*metadata = NULL;
+	uint64_t			lba;
+	uint32_t			lba_count;
+
+	buffer = malloc(512 * 512);
+	SPDK_CU_ASSERT_FATAL(buffer != NULL);
+	metadata = malloc(128 * 512);
+	SPDK_CU_ASSERT_FATAL(metadata != NULL);
+
+	/*
+	 * 512 byte data + 128 byte metadata
+	 * Separate metadata buffer
+	 * Max data transfer size 128 KB
+	 * Max zone append size 128 KB
+	 *
+	 * 256 blocks * 512 bytes per block = single 128 KB zone append
+	 */
+	prepare_for_test(&ns, &ctrlr, &qpair, 512, 128, 128 * 1024, 0, false);
+	ctrlr.max_zone_append_size = 128 * 1024;
+
+	rc = nvme_ns_cmd_zone_append_with_md(&ns, &qpair, buffer, metadata, 0x10000, 256,
+					     NULL, NULL, 0, 0, 0);
+
+	SPDK_CU_ASSERT_FATAL(rc == 0);
+	SPDK_CU_ASSERT_FATAL(g_request != NULL);
+	SPDK_CU_ASSERT_FATAL(g_request->num_children == 0);
+
+	CU_ASSERT(g_request->cmd.opc == SPDK_NVME_OPC_ZONE_APPEND);
+	nvme_cmd_interpret_rw(&g_request->cmd, &lba, &lba_count);
+	CU_ASSERT(lba == 0x10000);
+	CU_ASSERT(lba_count == 256);
+	CU_ASSERT(g_request->payload.md == metadata);
+	CU_ASSERT(g_request->payload_size == 256 * 512);
+
+	nvme_free_request(g_request);
+	cleanup_after_test(&qpair);
+
+	/* A zone append larger than the max zone append size is rejected */
+	prepare_for_test(&ns, &ctrlr, &qpair, 512, 128, 128 * 1024, 0, false);
+	ctrlr.max_zone_append_size = 64 * 1024;
+
+	rc = nvme_ns_cmd_zone_append_with_md(&ns, &qpair, buffer, metadata, 0x10000, 256,
+					     NULL, NULL, 0, 0, 0);
+	CU_ASSERT(rc == -EINVAL);
+	CU_ASSERT(g_request == NULL);
+
+	cleanup_after_test(&qpair);
+
+	/*
+	 * A zone append that would need to be split across a stripe boundary
+	 *  is rejected, since the controller picks the LBA it is written at.
+	 */
+	prepare_for_test(&ns, &ctrlr, &qpair, 512, 128, 128 * 1024, 64 * 1024, false);
+	ctrlr.max_zone_append_size = 128 * 1024;
+
+	rc = nvme_ns_cmd_zone_append_with_md(&ns, &qpair, buffer, metadata, 0x10000, 256,
+					     NULL, NULL, 0, 0, 0);
+	CU_ASSERT(rc == -EINVAL);
+	CU_ASSERT(g_request == NULL);
+
+	cleanup_after_test(&qpair);
+	free(buffer);
+	free(metadata);
+}
+
 static void
 test_nvme_ns_cmd_compare_with_md(void)
 {
@@ -1732,6 +1805,8 @@ int main(int argc, char **argv)
 		|| CU_add_test(suite, "nvme_ns_cmd_write_with_md", test_nvme_ns_cmd_write_with_md) == NULL
 		|| CU_add_test(suite, "nvme_ns_cmd_comparev", test_nvme_ns_cmd_comparev) == NULL
 		|| CU_add_test(suite, "nvme_ns_cmd_compare_and_write", test_nvme_ns_cmd_compare_and_write) == NULL
+		|| CU_add_test(suite, "nvme_ns_cmd_zone_append_with_md",
+			       test_nvme_ns_cmd_zone_append_with_md) == NULL
 		|| CU_add_test(suite, "nvme_ns_cmd_compare_with_md", test_nvme_ns_cmd_compare_with_md) == NULL
 		|| CU_add_test(suite, "nvme_ns_cmd_comparev_with_md", test_nvme_ns_cmd_comparev_with_md) == NULL
 	) {
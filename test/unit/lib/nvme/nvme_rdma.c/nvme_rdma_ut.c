@@ -199,6 +199,82 @@ test_nvme_rdma_build_sgl_request(void)
 	CU_ASSERT(bio.iovpos == NVME_RDMA_MAX_SGL_DESCRIPTORS);
 }
 
+static struct ibv_wc g_ut_wc[8];
+static int g_ut_wc_count;
+
+static int
+ut_poll_cq(struct ibv_cq *cq, int num_entries, struct ibv_wc *wc)
+{
+	int count = spdk_min(num_entries, g_ut_wc_count);
+
+	memcpy(wc, g_ut_wc, count * sizeof(*wc));
+	g_ut_wc_count -= count;
+	memmove(g_ut_wc, &g_ut_wc[count], g_ut_wc_count * sizeof(*wc));
+
+	return count;
+}
+
+static void
+test_nvme_rdma_shared_cq_poll(void)
+{
+	struct ibv_context context = {};
+	struct ibv_cq cq = {};
+	struct ibv_recv_wr recv_wrs[4] = {};
+	struct nvme_rdma_shared_rsrc rsrc = {};
+	struct nvme_rdma_qpair rqpair1 = {}, rqpair2 = {};
+	struct nvme_rdma_qpair *qpairs[2] = { &rqpair1, &rqpair2 };
+	struct ibv_wc pending1[4], pending2[4];
+	struct ibv_wc wc[4];
+	int rc;
+
+	context.ops.poll_cq = ut_poll_cq;
+	cq.context = &context;
+	rsrc.cq = &cq;
+	rsrc.srq_depth = 4;
+	rsrc.rsp_recv_wrs = recv_wrs;
+	rsrc.qpairs = qpairs;
+	rsrc.num_qpairs = 2;
+
+	rqpair1.qp_num = 1;
+	rqpair1.shared_rsrc = &rsrc;
+	rqpair1.pending_wcs = pending1;
+	rqpair1.pending_wcs_size = 4;
+	rqpair2.qp_num = 2;
+	rqpair2.shared_rsrc = &rsrc;
+	rqpair2.pending_wcs = pending2;
+	rqpair2.pending_wcs_size = 4;
+
+	/* Completions of both qpairs, one of an unknown qpair and a failed recv */
+	g_ut_wc[0] = (struct ibv_wc) { .wr_id = 0, .qp_num = 2, .status = IBV_WC_SUCCESS };
+	g_ut_wc[1] = (struct ibv_wc) { .wr_id = 1, .qp_num = 1, .status = IBV_WC_SUCCESS };
+	g_ut_wc[2] = (struct ibv_wc) { .wr_id = 2, .qp_num = 3, .status = IBV_WC_SUCCESS };
+	g_ut_wc[3] = (struct ibv_wc) { .wr_id = 3, .qp_num = 2, .status = IBV_WC_WR_FLUSH_ERR };
+	g_ut_wc_count = 4;
+
+	rc = nvme_rdma_qpair_poll_cq(&rqpair1, 4, wc);
+	CU_ASSERT(rc == 1);
+	CU_ASSERT(wc[0].wr_id == 1);
+	CU_ASSERT(rqpair1.pending_wcs_count == 0);
+	CU_ASSERT(rqpair2.pending_wcs_count == 2);
+
+	/* Receive buffers that won't be processed go back to the SRQ */
+	CU_ASSERT(rsrc.recvs_to_post.first == &recv_wrs[2]);
+	CU_ASSERT(recv_wrs[2].next == &recv_wrs[3]);
+	CU_ASSERT(rsrc.recvs_to_post.last == &recv_wrs[3]);
+
+	/* The second qpair finds its completions without polling the CQ */
+	rc = nvme_rdma_qpair_poll_cq(&rqpair2, 1, wc);
+	CU_ASSERT(rc == 1);
+	CU_ASSERT(wc[0].wr_id == 0);
+	rc = nvme_rdma_qpair_poll_cq(&rqpair2, 4, wc);
+	CU_ASSERT(rc == 1);
+	CU_ASSERT(wc[0].wr_id == 3);
+	CU_ASSERT(wc[0].status == IBV_WC_WR_FLUSH_ERR);
+
+	rc = nvme_rdma_qpair_poll_cq(&rqpair2, 4, wc);
+	CU_ASSERT(rc == 0);
+}
+
 int main(int argc, char **argv)
 {
 	CU_pSuite	suite = NULL;
@@ -214,7 +290,8 @@ int main(int argc, char **argv)
 		return CU_get_error();
 	}
 
-	if (CU_add_test(suite, "build_sgl_request", test_nvme_rdma_build_sgl_request) == NULL) {
+	if (CU_add_test(suite, "build_sgl_request", test_nvme_rdma_build_sgl_request) == NULL ||
+	    CU_add_test(suite, "shared_cq_poll", test_nvme_rdma_shared_cq_poll) == NULL) {
 		CU_cleanup_registry();
 		return CU_get_error();
 	}
@@ -114,6 +114,11 @@ DEFINE_STUB(spdk_nvmf_qpair_get_listen_trid,
 	    (struct spdk_nvmf_qpair *qpair, struct spdk_nvme_transport_id *trid),
 	    0);
 
+DEFINE_STUB(spdk_nvmf_subsystem_find_listener,
+	    struct spdk_nvmf_listener *,
+	    (struct spdk_nvmf_subsystem *subsystem, const struct spdk_nvme_transport_id *trid),
+	    NULL);
+
 DEFINE_STUB(spdk_nvmf_subsystem_listener_allowed,
 	    bool,
 	    (struct spdk_nvmf_subsystem *subsystem, struct spdk_nvme_transport_id *trid),
@@ -137,6 +142,17 @@ DEFINE_STUB(spdk_nvmf_bdev_ctrlr_compare_cmd,
 	     struct spdk_nvmf_request *req),
 	    0);
 
+DEFINE_STUB(spdk_nvmf_bdev_ctrlr_zcopy_supported,
+	    bool,
+	    (struct spdk_bdev *bdev, struct spdk_nvme_cmd *cmd, uint32_t length),
+	    false);
+
+DEFINE_STUB_V(spdk_nvmf_bdev_ctrlr_zcopy_commit, (struct spdk_nvmf_request *req));
+
+DEFINE_STUB_V(spdk_nvmf_bdev_ctrlr_zcopy_end,
+	      (struct spdk_bdev_io *bdev_io, struct spdk_nvmf_subsystem_poll_group *sgroup,
+	       uint32_t nsid));
+
 DEFINE_STUB(spdk_nvmf_bdev_ctrlr_compare_and_write_cmd,
 	    int,
 	    (struct spdk_bdev *bdev, struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
@@ -361,7 +377,7 @@ test_connect(void)
 	snprintf(subsystem.subnqn, sizeof(subsystem.subnqn), "%s", subnqn);
 
 	sgroups = calloc(subsystem.id + 1, sizeof(struct spdk_nvmf_subsystem_poll_group));
-	sgroups[subsystem.id].io_outstanding = 5;
+	sgroups[subsystem.id].mgmt_io_outstanding = 5;
 	group.sgroups = sgroups;
 
 	memset(&cmd, 0, sizeof(cmd));
@@ -830,6 +846,79 @@ test_get_ns_id_desc_list(void)
 	CU_ASSERT(buf[53] == 0);
 }
 
+static void
+test_get_ana_log_page(void)
+{
+	struct spdk_nvmf_subsystem subsystem = { .subtype = SPDK_NVMF_SUBTYPE_NVME };
+	enum spdk_nvme_ana_state ana_state[2] = {
+		SPDK_NVME_ANA_OPTIMIZED_STATE, SPDK_NVME_ANA_INACCESSIBLE_STATE
+	};
+	struct spdk_nvmf_listener listener = {
+		.ana_state = ana_state, .num_ana_groups = 2, .ana_state_change_count = 3
+	};
+	struct spdk_nvmf_ctrlr ctrlr = { .subsys = &subsystem, .listener = &listener };
+	struct spdk_nvmf_qpair qpair = { .ctrlr = &ctrlr };
+	struct spdk_nvmf_ns ns = { .nsid = 1, .opts.anagrpid = 2 };
+	struct spdk_nvmf_request req = {};
+	union nvmf_h2c_msg cmd = {};
+	union nvmf_c2h_msg rsp = {};
+	struct spdk_nvme_ana_page *ana_hdr;
+	struct spdk_nvme_ana_group_descriptor *ana_desc;
+	char data[4096];
+
+	subsystem.max_nsid = 2;
+
+	req.qpair = &qpair;
+	req.cmd = &cmd;
+	req.rsp = &rsp;
+	req.data = &data;
+	req.length = sizeof(data);
+
+	cmd.nvme_cmd.opc = SPDK_NVME_OPC_GET_LOG_PAGE;
+	cmd.nvme_cmd.cdw10_bits.get_log_page.lid = SPDK_NVME_LOG_ASYMMETRIC_NAMESPACE_ACCESS;
+	cmd.nvme_cmd.cdw10_bits.get_log_page.numdl = (req.length / 4 - 1);
+
+	/* ANA reporting disabled - the log page is not supported */
+	CU_ASSERT(spdk_nvmf_ctrlr_get_log_page(&req) == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	CU_ASSERT(rsp.nvme_cpl.status.sct == SPDK_NVME_SCT_GENERIC);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_INVALID_FIELD);
+
+	subsystem.ana_reporting = true;
+	MOCK_SET(spdk_nvmf_subsystem_get_first_ns, &ns);
+
+	/* One namespace in ANA group 2, which is inaccessible through the listener */
+	memset(&rsp, 0, sizeof(rsp));
+	memset(data, 0xFF, sizeof(data));
+	CU_ASSERT(spdk_nvmf_ctrlr_get_log_page(&req) == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	CU_ASSERT(rsp.nvme_cpl.status.sct == SPDK_NVME_SCT_GENERIC);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_SUCCESS);
+	ana_hdr = (struct spdk_nvme_ana_page *)data;
+	CU_ASSERT(ana_hdr->change_count == 3);
+	CU_ASSERT(ana_hdr->num_ana_group_desc == 1);
+	ana_desc = (struct spdk_nvme_ana_group_descriptor *)(data + sizeof(*ana_hdr));
+	CU_ASSERT(ana_desc->ana_group_id == 2);
+	CU_ASSERT(ana_desc->num_of_nsid == 1);
+	CU_ASSERT(ana_desc->change_count == 3);
+	CU_ASSERT(ana_desc->ana_state == SPDK_NVME_ANA_INACCESSIBLE_STATE);
+	CU_ASSERT(ana_desc->nsid[0] == 1);
+	CU_ASSERT(spdk_mem_all_zero(&ana_desc->nsid[1],
+				    sizeof(data) - sizeof(*ana_hdr) - sizeof(*ana_desc) - sizeof(uint32_t)));
+
+	/* Return Groups Only - no NSID list */
+	cmd.nvme_cmd.cdw10_bits.get_log_page.lsp = 0x1;
+	memset(&rsp, 0, sizeof(rsp));
+	memset(data, 0xFF, sizeof(data));
+	CU_ASSERT(spdk_nvmf_ctrlr_get_log_page(&req) == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_SUCCESS);
+	CU_ASSERT(ana_hdr->num_ana_group_desc == 1);
+	CU_ASSERT(ana_desc->ana_group_id == 2);
+	CU_ASSERT(ana_desc->num_of_nsid == 0);
+	CU_ASSERT(spdk_mem_all_zero(&ana_desc->nsid[0],
+				    sizeof(data) - sizeof(*ana_hdr) - sizeof(*ana_desc)));
+
+	MOCK_CLEAR(spdk_nvmf_subsystem_get_first_ns);
+}
+
 static void
 test_identify_ns(void)
 {
@@ -1404,21 +1493,24 @@ test_custom_admin_cmd(void)
 static void
 test_fused_compare_and_write(void)
 {
-	struct spdk_nvmf_request req;
-	struct spdk_nvmf_qpair qpair;
-	struct spdk_nvme_cmd cmd;
-	union nvmf_c2h_msg rsp;
-	struct spdk_nvmf_ctrlr ctrlr;
-	struct spdk_nvmf_subsystem subsystem;
-	struct spdk_nvmf_ns ns;
+	struct spdk_nvmf_request req = {};
+	struct spdk_nvmf_qpair qpair = {};
+	struct spdk_nvme_cmd cmd = {};
+	union nvmf_c2h_msg rsp = {};
+	struct spdk_nvmf_ctrlr ctrlr = {};
+	struct spdk_nvmf_subsystem subsystem = {};
+	struct spdk_nvmf_ns ns = {};
 	struct spdk_nvmf_ns *subsys_ns[1];
-	struct spdk_bdev bdev;
+	struct spdk_bdev bdev = {};
 
-	struct spdk_nvmf_poll_group group;
-	struct spdk_nvmf_subsystem_poll_group sgroups;
-	struct spdk_nvmf_subsystem_pg_ns_info ns_info;
+	struct spdk_nvmf_poll_group group = {};
+	struct spdk_nvmf_subsystem_poll_group sgroups = {};
+	struct spdk_nvmf_subsystem_pg_ns_info ns_info = {};
 
 	ns.bdev = &bdev;
+	ns_info.channel = (struct spdk_io_channel *)0xDEADBEEF;
+	ns_info.state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
+	ns_info.sgroup = &sgroups;
 
 	subsystem.id = 0;
 	subsystem.max_nsid = 1;
@@ -1495,6 +1587,181 @@ test_fused_compare_and_write(void)
 	CU_ASSERT(qpair.first_fused_req == NULL);
 }
 
+static void
+pause_done(void *cb_arg, int status)
+{
+	bool *done = cb_arg;
+
+	CU_ASSERT(status == 0);
+	*done = true;
+}
+
+static void
+test_ns_pause(void)
+{
+	struct spdk_nvmf_subsystem subsystem = {};
+	struct spdk_bdev bdev[2] = {};
+	struct spdk_nvmf_ns ns[2] = {{.nsid = 1, .bdev = &bdev[0]}, {.nsid = 2, .bdev = &bdev[1]}};
+	struct spdk_nvmf_ns *ns_arr[2] = {&ns[0], &ns[1]};
+	struct spdk_nvmf_ctrlr ctrlr = { .subsys = &subsystem };
+	struct spdk_nvmf_poll_group group = {};
+	struct spdk_nvmf_subsystem_poll_group sgroup = {};
+	struct spdk_nvmf_subsystem_pg_ns_info ns_info[2] = {};
+	struct spdk_nvmf_qpair qpair = {};
+	struct spdk_nvmf_request req[2] = {};
+	union nvmf_h2c_msg cmd[2] = {};
+	union nvmf_c2h_msg rsp[2] = {};
+	bool done = false;
+	int i;
+
+	subsystem.ns = ns_arr;
+	subsystem.max_nsid = 2;
+	ctrlr.vcprop.cc.bits.en = 1;
+
+	sgroup.state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
+	sgroup.num_ns = 2;
+	sgroup.ns_info = ns_info;
+	TAILQ_INIT(&sgroup.queued);
+	for (i = 0; i < 2; i++) {
+		ns_info[i].channel = (struct spdk_io_channel *)0xDEADBEEF;
+		ns_info[i].state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
+		ns_info[i].sgroup = &sgroup;
+	}
+	group.sgroups = &sgroup;
+	group.num_sgroups = 1;
+
+	qpair.ctrlr = &ctrlr;
+	qpair.group = &group;
+	qpair.qid = 1;
+	qpair.state = SPDK_NVMF_QPAIR_ACTIVE;
+	TAILQ_INIT(&qpair.outstanding);
+
+	for (i = 0; i < 2; i++) {
+		cmd[i].nvme_cmd.opc = SPDK_NVME_OPC_READ;
+		cmd[i].nvme_cmd.nsid = i + 1;
+		req[i].qpair = &qpair;
+		req[i].cmd = &cmd[i];
+		req[i].rsp = &rsp[i];
+	}
+
+	/* Pausing namespace 1 completes right away with nothing outstanding */
+	sgroup.state = SPDK_NVMF_SUBSYSTEM_PAUSING;
+	ns_info[0].state = SPDK_NVMF_SUBSYSTEM_PAUSING;
+	sgroup.cb_fn = pause_done;
+	sgroup.cb_arg = &done;
+	spdk_nvmf_subsystem_poll_group_check_paused(&sgroup);
+	CU_ASSERT(done == true);
+	CU_ASSERT(sgroup.state == SPDK_NVMF_SUBSYSTEM_PAUSED);
+	CU_ASSERT(ns_info[0].state == SPDK_NVMF_SUBSYSTEM_PAUSED);
+	CU_ASSERT(ns_info[1].state == SPDK_NVMF_SUBSYSTEM_ACTIVE);
+
+	/* I/O to the paused namespace is queued */
+	spdk_nvmf_request_exec(&req[0]);
+	CU_ASSERT(TAILQ_FIRST(&sgroup.queued) == &req[0]);
+	CU_ASSERT(ns_info[0].io_outstanding == 0);
+
+	/* I/O to the other namespace is executed */
+	spdk_nvmf_request_exec(&req[1]);
+	CU_ASSERT(TAILQ_NEXT(&req[0], link) == NULL);
+	CU_ASSERT(nvme_status_success(&rsp[1].nvme_cpl.status));
+	CU_ASSERT(ns_info[1].io_outstanding == 0);
+	CU_ASSERT(TAILQ_EMPTY(&qpair.outstanding));
+	TAILQ_REMOVE(&sgroup.queued, &req[0], link);
+
+	/* Pausing namespace 2 waits for its outstanding I/O */
+	done = false;
+	sgroup.state = SPDK_NVMF_SUBSYSTEM_PAUSING;
+	ns_info[0].state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
+	ns_info[1].state = SPDK_NVMF_SUBSYSTEM_PAUSING;
+	ns_info[0].io_outstanding = 1;
+	ns_info[1].io_outstanding = 1;
+	spdk_nvmf_subsystem_poll_group_check_paused(&sgroup);
+	CU_ASSERT(done == false);
+
+	/* I/O outstanding to namespace 1 does not hold the pause back */
+	spdk_nvmf_subsystem_poll_group_io_done(&sgroup, &ns_info[1]);
+	CU_ASSERT(done == true);
+	CU_ASSERT(sgroup.state == SPDK_NVMF_SUBSYSTEM_PAUSED);
+	CU_ASSERT(ns_info[1].state == SPDK_NVMF_SUBSYSTEM_PAUSED);
+	CU_ASSERT(ns_info[0].io_outstanding == 1);
+}
+
+static void
+test_io_stat(void)
+{
+	struct spdk_nvmf_subsystem subsystem = {};
+	struct spdk_bdev bdev = {};
+	struct spdk_nvmf_ns ns = {.nsid = 1, .bdev = &bdev};
+	struct spdk_nvmf_ns *ns_arr[1] = {&ns};
+	struct spdk_nvmf_ctrlr ctrlr = { .subsys = &subsystem };
+	struct spdk_nvmf_poll_group group = {};
+	struct spdk_nvmf_subsystem_poll_group sgroup = {};
+	struct spdk_nvmf_subsystem_pg_ns_info ns_info = {};
+	struct spdk_nvmf_qpair qpair = {};
+	struct spdk_nvmf_request req = {};
+	union nvmf_h2c_msg cmd = {};
+	union nvmf_c2h_msg rsp = {};
+	uint64_t i, count = 0;
+
+	subsystem.ns = ns_arr;
+	subsystem.max_nsid = 1;
+	ctrlr.vcprop.cc.bits.en = 1;
+
+	sgroup.state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
+	sgroup.num_ns = 1;
+	sgroup.ns_info = &ns_info;
+	TAILQ_INIT(&sgroup.queued);
+	ns_info.channel = (struct spdk_io_channel *)0xDEADBEEF;
+	ns_info.state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
+	ns_info.sgroup = &sgroup;
+	group.sgroups = &sgroup;
+	group.num_sgroups = 1;
+
+	qpair.ctrlr = &ctrlr;
+	qpair.group = &group;
+	qpair.qid = 1;
+	qpair.state = SPDK_NVMF_QPAIR_ACTIVE;
+	TAILQ_INIT(&qpair.outstanding);
+
+	cmd.nvme_cmd.opc = SPDK_NVME_OPC_WRITE;
+	cmd.nvme_cmd.nsid = 1;
+	req.qpair = &qpair;
+	req.cmd = &cmd;
+	req.rsp = &rsp;
+	req.length = 4096;
+
+	/* A successful write is accounted to the namespace and the qpair */
+	MOCK_SET(spdk_nvmf_bdev_ctrlr_write_cmd, SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
+	spdk_nvmf_request_exec(&req);
+	spdk_delay_us(100);
+	spdk_nvmf_request_complete(&req);
+	MOCK_CLEAR(spdk_nvmf_bdev_ctrlr_write_cmd);
+
+	CU_ASSERT(ns_info.io_stat.num_write_ops == 1);
+	CU_ASSERT(ns_info.io_stat.bytes_written == 4096);
+	CU_ASSERT(ns_info.io_stat.write_latency_ticks == 100 * spdk_get_ticks_hz() / 1000000);
+	CU_ASSERT(ns_info.io_stat.num_read_ops == 0);
+	CU_ASSERT(qpair.io_stat.num_write_ops == 1);
+	CU_ASSERT(qpair.io_stat.bytes_written == 4096);
+
+	for (i = 0; i < NVMF_IO_STAT_HISTOGRAM_NUM_BUCKETS; i++) {
+		count += ns_info.io_stat.latency_buckets[i];
+	}
+	CU_ASSERT(count == 1);
+
+	/* A failed read is not */
+	cmd.nvme_cmd.opc = SPDK_NVME_OPC_READ;
+	MOCK_SET(spdk_nvmf_bdev_ctrlr_read_cmd, SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
+	spdk_nvmf_request_exec(&req);
+	rsp.nvme_cpl.status.sc = SPDK_NVME_SC_DATA_TRANSFER_ERROR;
+	spdk_nvmf_request_complete(&req);
+	MOCK_CLEAR(spdk_nvmf_bdev_ctrlr_read_cmd);
+
+	CU_ASSERT(ns_info.io_stat.num_read_ops == 0);
+	CU_ASSERT(qpair.io_stat.num_read_ops == 0);
+	CU_ASSERT(ns_info.io_outstanding == 0);
+}
+
 int main(int argc, char **argv)
 {
 	CU_pSuite	suite = NULL;
@@ -1514,6 +1781,7 @@ int main(int argc, char **argv)
 	    CU_add_test(suite, "process_fabrics_cmd", test_process_fabrics_cmd) == NULL ||
 	    CU_add_test(suite, "connect", test_connect) == NULL ||
 	    CU_add_test(suite, "get_ns_id_desc_list", test_get_ns_id_desc_list) == NULL ||
+	    CU_add_test(suite, "get_ana_log_page", test_get_ana_log_page) == NULL ||
 	    CU_add_test(suite, "identify_ns", test_identify_ns) == NULL ||
 	    CU_add_test(suite, "reservation_write_exclusive", test_reservation_write_exclusive) == NULL ||
 	    CU_add_test(suite, "reservation_exclusive_access", test_reservation_exclusive_access) == NULL ||
@@ -1527,7 +1795,9 @@ int main(int argc, char **argv)
 	    CU_add_test(suite, "set_get_features", test_set_get_features) == NULL ||
 	    CU_add_test(suite, "identify_ctrlr", test_identify_ctrlr) == NULL ||
 	    CU_add_test(suite, "custom_admin_cmd", test_custom_admin_cmd) == NULL ||
-	    CU_add_test(suite, "fused_compare_and_write", test_fused_compare_and_write) == NULL) {
+	    CU_add_test(suite, "fused_compare_and_write", test_fused_compare_and_write) == NULL ||
+	    CU_add_test(suite, "ns_pause", test_ns_pause) == NULL ||
+	    CU_add_test(suite, "io_stat", test_io_stat) == NULL) {
 		CU_cleanup_registry();
 		return CU_get_error();
 	}
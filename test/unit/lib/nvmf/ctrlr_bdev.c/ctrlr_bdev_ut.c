@@ -50,6 +50,8 @@ struct spdk_bdev {
 	uint32_t blocklen;
 	uint64_t num_blocks;
 	uint32_t md_len;
+	uint16_t acwu;
+	uint16_t awun;
 };
 
 uint32_t
@@ -77,6 +79,18 @@ spdk_bdev_get_md_size(const struct spdk_bdev *bdev)
 	return bdev->md_len;
 }
 
+uint16_t
+spdk_bdev_get_acwu(const struct spdk_bdev *bdev)
+{
+	return bdev->acwu;
+}
+
+uint16_t
+spdk_bdev_get_awun(const struct spdk_bdev *bdev)
+{
+	return bdev->awun;
+}
+
 DEFINE_STUB(spdk_bdev_comparev_and_writev_blocks, int,
 	    (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
 	     struct iovec *compare_iov, int compare_iovcnt,
@@ -161,6 +175,23 @@ DEFINE_STUB(spdk_bdev_nvme_io_passthru, int,
 
 DEFINE_STUB_V(spdk_bdev_free_io, (struct spdk_bdev_io *bdev_io));
 
+DEFINE_STUB(spdk_bdev_zcopy_start, int,
+	    (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+	     uint64_t offset_blocks, uint64_t num_blocks, bool populate,
+	     spdk_bdev_io_completion_cb cb, void *cb_arg),
+	    0);
+
+DEFINE_STUB(spdk_bdev_zcopy_end, int,
+	    (struct spdk_bdev_io *bdev_io, bool commit, spdk_bdev_io_completion_cb cb, void *cb_arg),
+	    0);
+
+DEFINE_STUB_V(spdk_bdev_io_get_iovec,
+	      (struct spdk_bdev_io *bdev_io, struct iovec **iovp, int *iovcntp));
+
+DEFINE_STUB_V(spdk_nvmf_subsystem_poll_group_io_done,
+	      (struct spdk_nvmf_subsystem_poll_group *sgroup,
+	       struct spdk_nvmf_subsystem_pg_ns_info *ns_info));
+
 DEFINE_STUB(spdk_nvmf_subsystem_get_nqn, const char *,
 	    (struct spdk_nvmf_subsystem *subsystem), NULL);
 
@@ -237,6 +268,29 @@ test_lba_in_range(void)
 	CU_ASSERT(nvmf_bdev_ctrlr_lba_in_range(UINT64_MAX, UINT64_MAX, 1) == false);
 }
 
+static void
+test_zcopy_supported(void)
+{
+	struct spdk_bdev bdev = { .blocklen = 512 };
+	struct spdk_nvme_cmd cmd = {};
+
+	/* 8 blocks, 0's based */
+	to_le32(&cmd.cdw12, 7);
+
+	/* bdev has no native zero copy support */
+	MOCK_SET(spdk_bdev_io_type_supported, false);
+	CU_ASSERT(spdk_nvmf_bdev_ctrlr_zcopy_supported(&bdev, &cmd, 4096) == false);
+
+	MOCK_SET(spdk_bdev_io_type_supported, true);
+	CU_ASSERT(spdk_nvmf_bdev_ctrlr_zcopy_supported(&bdev, &cmd, 4096) == true);
+
+	/* Transfer length does not match the number of blocks */
+	CU_ASSERT(spdk_nvmf_bdev_ctrlr_zcopy_supported(&bdev, &cmd, 2048) == false);
+	CU_ASSERT(spdk_nvmf_bdev_ctrlr_zcopy_supported(&bdev, &cmd, 8192) == false);
+
+	MOCK_CLEAR(spdk_bdev_io_type_supported);
+}
+
 static void
 test_get_dif_ctx(void)
 {
@@ -269,16 +323,16 @@ test_spdk_nvmf_bdev_ctrlr_compare_and_write_cmd(void)
 	struct spdk_bdev_desc *desc = NULL;
 	struct spdk_io_channel ch = {};
 
-	struct spdk_nvmf_request cmp_req;
-	union nvmf_c2h_msg cmp_rsp;
+	struct spdk_nvmf_request cmp_req = {};
+	union nvmf_c2h_msg cmp_rsp = {};
 
-	struct spdk_nvmf_request write_req;
-	union nvmf_c2h_msg write_rsp;
+	struct spdk_nvmf_request write_req = {};
+	union nvmf_c2h_msg write_rsp = {};
 
 	struct spdk_nvmf_qpair qpair;
 
-	struct spdk_nvme_cmd cmp_cmd;
-	struct spdk_nvme_cmd write_cmd;
+	struct spdk_nvme_cmd cmp_cmd = {};
+	struct spdk_nvme_cmd write_cmd = {};
 
 	struct spdk_nvmf_ctrlr ctrlr;
 	struct spdk_nvmf_subsystem subsystem;
@@ -291,6 +345,7 @@ test_spdk_nvmf_bdev_ctrlr_compare_and_write_cmd(void)
 
 	bdev.blocklen = 512;
 	bdev.num_blocks = 10;
+	bdev.acwu = 2;
 	ns.bdev = &bdev;
 
 	subsystem.id = 0;
@@ -389,6 +444,22 @@ test_spdk_nvmf_bdev_ctrlr_compare_and_write_cmd(void)
 	CU_ASSERT(cmp_rsp.nvme_cpl.status.sc == 0);
 	CU_ASSERT(write_rsp.nvme_cpl.status.sct == SPDK_NVME_SCT_GENERIC);
 	CU_ASSERT(write_rsp.nvme_cpl.status.sc == SPDK_NVME_SC_DATA_SGL_LENGTH_INVALID);
+
+	/* 5. NLB exceeds the atomic compare & write unit */
+	cmp_cmd.cdw10 = 1;	/* SLBA: CDW10 and CDW11 */
+	cmp_cmd.cdw12 = 2;	/* NLB: CDW12 bits 15:00, 0's based */
+
+	write_cmd.cdw10 = 1;	/* SLBA: CDW10 and CDW11 */
+	write_cmd.cdw12 = 2;	/* NLB: CDW12 bits 15:00, 0's based */
+	write_req.length = (write_cmd.cdw12 + 1) * bdev.blocklen;
+
+	rc = spdk_nvmf_bdev_ctrlr_compare_and_write_cmd(&bdev, desc, &ch, &cmp_req, &write_req);
+
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	CU_ASSERT(cmp_rsp.nvme_cpl.status.sct == 0);
+	CU_ASSERT(cmp_rsp.nvme_cpl.status.sc == 0);
+	CU_ASSERT(write_rsp.nvme_cpl.status.sct == SPDK_NVME_SCT_GENERIC);
+	CU_ASSERT(write_rsp.nvme_cpl.status.sc == SPDK_NVME_SC_INVALID_FIELD);
 }
 
 int main(int argc, char **argv)
@@ -410,6 +481,7 @@ int main(int argc, char **argv)
 		CU_add_test(suite, "get_rw_params", test_get_rw_params) == NULL ||
 		CU_add_test(suite, "lba_in_range", test_lba_in_range) == NULL ||
 		CU_add_test(suite, "get_dif_ctx", test_get_dif_ctx) == NULL ||
+		CU_add_test(suite, "zcopy_supported", test_zcopy_supported) == NULL ||
 
 		CU_add_test(suite, "spdk_nvmf_bdev_ctrlr_compare_and_write_cmd",
 			    test_spdk_nvmf_bdev_ctrlr_compare_and_write_cmd) == NULL
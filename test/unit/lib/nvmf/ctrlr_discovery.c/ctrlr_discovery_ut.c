@@ -48,6 +48,9 @@ DEFINE_STUB_V(spdk_bdev_module_release_bdev,
 DEFINE_STUB(spdk_bdev_get_block_size, uint32_t,
 	    (const struct spdk_bdev *bdev), 512);
 
+DEFINE_STUB(spdk_nvmf_ctrlr_async_event_ana_change_notice, int,
+	    (struct spdk_nvmf_ctrlr *ctrlr), 0);
+
 DEFINE_STUB(spdk_nvmf_transport_stop_listen,
 	    int,
 	    (struct spdk_nvmf_transport *transport,
@@ -177,7 +180,7 @@ spdk_nvmf_poll_group_remove_subsystem(struct spdk_nvmf_poll_group *group,
 
 void
 spdk_nvmf_poll_group_pause_subsystem(struct spdk_nvmf_poll_group *group,
-				     struct spdk_nvmf_subsystem *subsystem,
+				     struct spdk_nvmf_subsystem *subsystem, uint32_t nsid,
 				     spdk_nvmf_poll_group_mod_done cb_fn, void *cb_arg)
 {
 }
@@ -81,6 +81,9 @@ DEFINE_STUB(spdk_nvmf_request_get_dif_ctx, bool, (struct spdk_nvmf_request *req,
 		struct spdk_dif_ctx *dif_ctx), false);
 DEFINE_STUB_V(spdk_nvme_trid_populate_transport, (struct spdk_nvme_transport_id *trid,
 		enum spdk_nvme_transport_type trtype));
+DEFINE_STUB(spdk_nvmf_request_use_zcopy, bool, (struct spdk_nvmf_request *req), false);
+DEFINE_STUB_V(spdk_nvmf_request_zcopy_end, (struct spdk_nvmf_request *req));
+DEFINE_STUB_V(spdk_nvmf_request_zcopy_commit, (struct spdk_nvmf_request *req));
 
 const char *
 spdk_nvme_transport_id_trtype_str(enum spdk_nvme_transport_type trtype)
@@ -776,6 +779,91 @@ test_spdk_nvmf_rdma_request_process(void)
 	spdk_mempool_free(rtransport.data_wr_pool);
 }
 
+static void
+test_nvmf_rdma_request_fill_zcopy_sgl(void)
+{
+	struct spdk_nvmf_rdma_transport rtransport = {};
+	struct spdk_nvmf_rdma_poll_group group = {};
+	struct spdk_nvmf_rdma_poller poller = {};
+	struct spdk_nvmf_rdma_device device = {};
+	struct spdk_nvmf_rdma_resources resources = {};
+	struct spdk_nvmf_rdma_qpair rqpair = {};
+	struct spdk_nvmf_rdma_recv *rdma_recv;
+	struct spdk_nvmf_rdma_request *rdma_req;
+	struct ibv_send_wr *wr;
+	uint32_t i;
+	int rc;
+
+	poller_reset(&poller, &group);
+	qpair_reset(&rqpair, &poller, &device, &resources);
+	rqpair.max_send_sge = 4;
+
+	rtransport.data_wr_pool = spdk_mempool_create("test_wr_pool", 128,
+				  sizeof(struct spdk_nvmf_rdma_request_data),
+				  0, 0);
+	MOCK_CLEAR(spdk_mempool_get);
+	device.map = (void *)0x0;
+	g_rdma_mr.lkey = 0xABCD;
+
+	rdma_recv = create_recv(&rqpair, SPDK_NVME_OPC_WRITE);
+	rdma_req = create_req(&rqpair, rdma_recv);
+	rdma_req->req.cmd = (union nvmf_h2c_msg *)rdma_recv->sgl[0].addr;
+	rdma_req->req.xfer = SPDK_NVME_DATA_HOST_TO_CONTROLLER;
+	nvmf_rdma_setup_request(rdma_req);
+
+	/* Test 1: all the buffers of the bdev fit in one WR */
+	rdma_req->req.iovcnt = 4;
+	for (i = 0; i < rdma_req->req.iovcnt; i++) {
+		rdma_req->req.iov[i].iov_base = (void *)(uintptr_t)(0x10000 * (i + 1));
+		rdma_req->req.iov[i].iov_len = 0x1000;
+	}
+
+	rc = nvmf_rdma_request_fill_zcopy_sgl(&rtransport, &rqpair, rdma_req);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(rdma_req->num_outstanding_data_wr == 1);
+	CU_ASSERT(rdma_req->data.wr.num_sge == 4);
+	CU_ASSERT(rdma_req->data.wr.next == NULL);
+	CU_ASSERT(rdma_req->data.wr.wr.rdma.remote_addr == 0xFFFF);
+	for (i = 0; i < 4; i++) {
+		CU_ASSERT(rdma_req->data.wr.sg_list[i].addr == 0x10000 * (i + 1));
+		CU_ASSERT(rdma_req->data.wr.sg_list[i].length == 0x1000);
+		CU_ASSERT(rdma_req->data.wr.sg_list[i].lkey == 0xABCD);
+	}
+	nvmf_rdma_request_free_data(rdma_req, &rtransport);
+
+	/* Test 2: the buffers are spread over chained WRs with consecutive remote addresses */
+	rdma_req->req.iovcnt = 6;
+	for (i = 0; i < rdma_req->req.iovcnt; i++) {
+		rdma_req->req.iov[i].iov_base = (void *)(uintptr_t)(0x10000 * (i + 1));
+		rdma_req->req.iov[i].iov_len = 0x1000;
+	}
+
+	rc = nvmf_rdma_request_fill_zcopy_sgl(&rtransport, &rqpair, rdma_req);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(rdma_req->num_outstanding_data_wr == 2);
+	wr = &rdma_req->data.wr;
+	CU_ASSERT(wr->num_sge == 4);
+	CU_ASSERT(wr->opcode == IBV_WR_RDMA_READ);
+	CU_ASSERT(wr->wr.rdma.remote_addr == 0xFFFF);
+	CU_ASSERT(wr->wr.rdma.rkey == 0xEEEE);
+	wr = wr->next;
+	SPDK_CU_ASSERT_FATAL(wr != NULL);
+	CU_ASSERT(wr->num_sge == 2);
+	CU_ASSERT(wr->opcode == IBV_WR_RDMA_READ);
+	CU_ASSERT(wr->next == NULL);
+	CU_ASSERT(wr->wr.rdma.remote_addr == 0xFFFF + 4 * 0x1000);
+	CU_ASSERT(wr->wr.rdma.rkey == 0xEEEE);
+	CU_ASSERT(wr->sg_list[0].addr == 0x50000);
+	CU_ASSERT(wr->sg_list[1].addr == 0x60000);
+	nvmf_rdma_request_free_data(rdma_req, &rtransport);
+
+	CU_ASSERT(spdk_mempool_count(rtransport.data_wr_pool) == 128);
+
+	free_recv(rdma_recv);
+	free_req(rdma_req);
+	spdk_mempool_free(rtransport.data_wr_pool);
+}
+
 #define TEST_GROUPS_COUNT 5
 static void
 test_spdk_nvmf_rdma_get_optimal_poll_group(void)
@@ -1293,7 +1381,8 @@ int main(int argc, char **argv)
 	if (!CU_add_test(suite, "test_parse_sgl", test_spdk_nvmf_rdma_request_parse_sgl) ||
 	    !CU_add_test(suite, "test_request_process", test_spdk_nvmf_rdma_request_process) ||
 	    !CU_add_test(suite, "test_optimal_pg", test_spdk_nvmf_rdma_get_optimal_poll_group) ||
-	    !CU_add_test(suite, "test_parse_sgl_with_md", test_spdk_nvmf_rdma_request_parse_sgl_with_md)) {
+	    !CU_add_test(suite, "test_parse_sgl_with_md", test_spdk_nvmf_rdma_request_parse_sgl_with_md) ||
+	    !CU_add_test(suite, "test_fill_zcopy_sgl", test_nvmf_rdma_request_fill_zcopy_sgl)) {
 		CU_cleanup_registry();
 		return CU_get_error();
 	}
@@ -59,11 +59,20 @@ DEFINE_STUB(spdk_bdev_get_md_size, uint32_t,
 DEFINE_STUB(spdk_bdev_is_md_interleaved, bool,
 	    (const struct spdk_bdev *bdev), false);
 
+DEFINE_STUB(spdk_nvmf_ctrlr_async_event_ana_change_notice, int,
+	    (struct spdk_nvmf_ctrlr *ctrlr), 0);
+
 DEFINE_STUB(spdk_nvmf_transport_stop_listen,
 	    int,
 	    (struct spdk_nvmf_transport *transport,
 	     const struct spdk_nvme_transport_id *trid), 0);
 
+void *
+spdk_call_unaffinitized(void *cb(void *arg), void *arg)
+{
+	return cb(arg);
+}
+
 int
 spdk_nvmf_transport_listen(struct spdk_nvmf_transport *transport,
 			   const struct spdk_nvme_transport_id *trid,
@@ -134,7 +143,7 @@ spdk_nvmf_poll_group_remove_subsystem(struct spdk_nvmf_poll_group *group,
 
 void
 spdk_nvmf_poll_group_pause_subsystem(struct spdk_nvmf_poll_group *group,
-				     struct spdk_nvmf_subsystem *subsystem,
+				     struct spdk_nvmf_subsystem *subsystem, uint32_t nsid,
 				     spdk_nvmf_poll_group_mod_done cb_fn, void *cb_arg)
 {
 }
@@ -535,6 +544,32 @@ ut_reservation_deinit(void)
 	TAILQ_FOREACH_SAFE(ctrlr, &g_subsystem.ctrlrs, link, ctrlr_tmp) {
 		TAILQ_REMOVE(&g_subsystem.ctrlrs, ctrlr, link);
 	}
+
+	nvmf_ns_ptpl_log_free(g_ns.ptpl_log);
+	g_ns.ptpl_log = NULL;
+}
+
+static void
+ut_reservation_persist_done(void *cb_arg, int status)
+{
+	int *rc = cb_arg;
+
+	*rc = status;
+}
+
+/* Write the reservation state of g_ns to its PTPL file and wait for the write */
+static int
+ut_reservation_persist(void)
+{
+	int rc = -EINPROGRESS;
+
+	SPDK_CU_ASSERT_FATAL(nvmf_ns_update_reservation_info(&g_ns, ut_reservation_persist_done,
+			     &rc) == 0);
+	while (rc == -EINPROGRESS) {
+		poll_threads();
+	}
+
+	return rc;
 }
 
 static struct spdk_nvmf_request *
@@ -787,6 +822,7 @@ test_reservation_register_with_ptpl(void)
 	SPDK_CU_ASSERT_FATAL(!spdk_uuid_compare(&g_ctrlr1_A.hostid, &reg->hostid));
 	/* Load reservation information from configuration file */
 	memset(&info, 0, sizeof(info));
+	SPDK_CU_ASSERT_FATAL(ut_reservation_persist() == 0);
 	rc = spdk_nvmf_ns_load_reservation(g_ns.ptpl_file, &info);
 	SPDK_CU_ASSERT_FATAL(rc == 0);
 	SPDK_CU_ASSERT_FATAL(info.ptpl_activated == true);
@@ -799,6 +835,7 @@ test_reservation_register_with_ptpl(void)
 	SPDK_CU_ASSERT_FATAL(update_sgroup == true);
 	SPDK_CU_ASSERT_FATAL(rsp->status.sc == SPDK_NVME_SC_SUCCESS);
 	SPDK_CU_ASSERT_FATAL(g_ns.ptpl_activated == false);
+	SPDK_CU_ASSERT_FATAL(ut_reservation_persist() == 0);
 	rc = spdk_nvmf_ns_load_reservation(g_ns.ptpl_file, &info);
 	SPDK_CU_ASSERT_FATAL(rc < 0);
 	unlink(g_ns.ptpl_file);
@@ -908,6 +945,7 @@ test_reservation_acquire_release_with_ptpl(void)
 	SPDK_CU_ASSERT_FATAL(!spdk_uuid_compare(&g_ctrlr1_A.hostid, &reg->hostid));
 	/* Load reservation information from configuration file */
 	memset(&info, 0, sizeof(info));
+	SPDK_CU_ASSERT_FATAL(ut_reservation_persist() == 0);
 	rc = spdk_nvmf_ns_load_reservation(g_ns.ptpl_file, &info);
 	SPDK_CU_ASSERT_FATAL(rc == 0);
 	SPDK_CU_ASSERT_FATAL(info.ptpl_activated == true);
@@ -920,6 +958,7 @@ test_reservation_acquire_release_with_ptpl(void)
 	SPDK_CU_ASSERT_FATAL(update_sgroup == true);
 	SPDK_CU_ASSERT_FATAL(rsp->status.sc == SPDK_NVME_SC_SUCCESS);
 	memset(&info, 0, sizeof(info));
+	SPDK_CU_ASSERT_FATAL(ut_reservation_persist() == 0);
 	rc = spdk_nvmf_ns_load_reservation(g_ns.ptpl_file, &info);
 	SPDK_CU_ASSERT_FATAL(rc == 0);
 	SPDK_CU_ASSERT_FATAL(info.ptpl_activated == true);
@@ -936,6 +975,7 @@ test_reservation_acquire_release_with_ptpl(void)
 	SPDK_CU_ASSERT_FATAL(update_sgroup == true);
 	SPDK_CU_ASSERT_FATAL(rsp->status.sc == SPDK_NVME_SC_SUCCESS);
 	memset(&info, 0, sizeof(info));
+	SPDK_CU_ASSERT_FATAL(ut_reservation_persist() == 0);
 	rc = spdk_nvmf_ns_load_reservation(g_ns.ptpl_file, &info);
 	SPDK_CU_ASSERT_FATAL(rc == 0);
 	SPDK_CU_ASSERT_FATAL(info.rtype == 0);
@@ -947,6 +987,76 @@ test_reservation_acquire_release_with_ptpl(void)
 	ut_reservation_deinit();
 }
 
+static void
+test_reservation_ptpl_log(void)
+{
+	struct spdk_nvmf_reservation_info info;
+	struct spdk_nvmf_registrant *reg;
+	int rc1 = -EINPROGRESS, rc2 = -EINPROGRESS, rc3 = -EINPROGRESS;
+	struct stat st;
+	off_t size;
+	FILE *fd;
+	int rc;
+
+	ut_reservation_init();
+
+	g_ns.ptpl_file = "/tmp/Ns1PR.log";
+	g_ns.ptpl_activated = true;
+	unlink(g_ns.ptpl_file);
+
+	reg = calloc(1, sizeof(*reg));
+	SPDK_CU_ASSERT_FATAL(reg != NULL);
+	spdk_uuid_copy(&reg->hostid, &g_ctrlr1_A.hostid);
+	reg->rkey = 0xa1;
+	TAILQ_INSERT_TAIL(&g_ns.registrants, reg, link);
+
+	/* TEST CASE: The first update writes a log with a single record */
+	SPDK_CU_ASSERT_FATAL(ut_reservation_persist() == 0);
+	SPDK_CU_ASSERT_FATAL(stat(g_ns.ptpl_file, &st) == 0);
+	size = st.st_size;
+	CU_ASSERT(size > 0);
+
+	/* TEST CASE: Updates issued during a write are committed together */
+	reg->rkey = 0xb1;
+	CU_ASSERT(nvmf_ns_update_reservation_info(&g_ns, ut_reservation_persist_done, &rc1) == 0);
+	reg->rkey = 0xc1;
+	CU_ASSERT(nvmf_ns_update_reservation_info(&g_ns, ut_reservation_persist_done, &rc2) == 0);
+	reg->rkey = 0xd1;
+	CU_ASSERT(nvmf_ns_update_reservation_info(&g_ns, ut_reservation_persist_done, &rc3) == 0);
+	while (rc1 == -EINPROGRESS || rc2 == -EINPROGRESS || rc3 == -EINPROGRESS) {
+		poll_threads();
+	}
+	CU_ASSERT(rc1 == 0);
+	CU_ASSERT(rc2 == 0);
+	CU_ASSERT(rc3 == 0);
+	SPDK_CU_ASSERT_FATAL(stat(g_ns.ptpl_file, &st) == 0);
+	CU_ASSERT(st.st_size == 3 * size);
+	memset(&info, 0, sizeof(info));
+	rc = spdk_nvmf_ns_load_reservation(g_ns.ptpl_file, &info);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(info.num_regs == 1);
+	CU_ASSERT(info.registrants[0].rkey == 0xd1);
+
+	/* TEST CASE: A record torn by a crash is ignored */
+	fd = fopen(g_ns.ptpl_file, "a");
+	SPDK_CU_ASSERT_FATAL(fd != NULL);
+	fwrite("PTPL\xff\xff\xff\xff", 1, 8, fd);
+	fclose(fd);
+	memset(&info, 0, sizeof(info));
+	rc = spdk_nvmf_ns_load_reservation(g_ns.ptpl_file, &info);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(info.registrants[0].rkey == 0xd1);
+
+	/* TEST CASE: Clearing PTPL appends an empty record */
+	g_ns.ptpl_activated = false;
+	SPDK_CU_ASSERT_FATAL(ut_reservation_persist() == 0);
+	rc = spdk_nvmf_ns_load_reservation(g_ns.ptpl_file, &info);
+	CU_ASSERT(rc == -ENOENT);
+	unlink(g_ns.ptpl_file);
+
+	ut_reservation_deinit();
+}
+
 static void
 test_reservation_release(void)
 {
@@ -1329,6 +1439,7 @@ int main(int argc, char **argv)
 		CU_add_test(suite, "reservation_acquire_preempt_1", test_reservation_acquire_preempt_1) == NULL ||
 		CU_add_test(suite, "reservation_acquire_release_with_ptpl",
 			    test_reservation_acquire_release_with_ptpl) == NULL ||
+		CU_add_test(suite, "reservation_ptpl_log", test_reservation_ptpl_log) == NULL ||
 		CU_add_test(suite, "reservation_release", test_reservation_release) == NULL ||
 		CU_add_test(suite, "reservation_unregister_notification",
 			    test_reservation_unregister_notification) == NULL ||
@@ -64,6 +64,11 @@ DEFINE_STUB(spdk_nvmf_qpair_get_listen_trid,
 	    (struct spdk_nvmf_qpair *qpair, struct spdk_nvme_transport_id *trid),
 	    0);
 
+DEFINE_STUB(spdk_nvmf_subsystem_find_listener,
+	    struct spdk_nvmf_listener *,
+	    (struct spdk_nvmf_subsystem *subsystem, const struct spdk_nvme_transport_id *trid),
+	    NULL);
+
 DEFINE_STUB(spdk_nvmf_subsystem_add_ctrlr,
 	    int,
 	    (struct spdk_nvmf_subsystem *subsystem, struct spdk_nvmf_ctrlr *ctrlr),
@@ -134,6 +139,17 @@ DEFINE_STUB(spdk_nvmf_bdev_ctrlr_compare_cmd,
 	     struct spdk_nvmf_request *req),
 	    0);
 
+DEFINE_STUB(spdk_nvmf_bdev_ctrlr_zcopy_supported,
+	    bool,
+	    (struct spdk_bdev *bdev, struct spdk_nvme_cmd *cmd, uint32_t length),
+	    false);
+
+DEFINE_STUB_V(spdk_nvmf_bdev_ctrlr_zcopy_end,
+	      (struct spdk_bdev_io *bdev_io, struct spdk_nvmf_subsystem_poll_group *sgroup,
+	       uint32_t nsid));
+
+DEFINE_STUB_V(spdk_nvmf_bdev_ctrlr_zcopy_commit, (struct spdk_nvmf_request *req));
+
 DEFINE_STUB(spdk_nvmf_bdev_ctrlr_compare_and_write_cmd,
 	    int,
 	    (struct spdk_bdev *bdev, struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
@@ -491,6 +507,7 @@ test_nvmf_tcp_send_c2h_data(void)
 	tqpair.recv_state = NVME_TCP_PDU_RECV_STATE_ERROR;
 
 	tcp_req.req.cmd = (union nvmf_h2c_msg *)&tcp_req.cmd;
+	tcp_req.req.rsp = (union nvmf_c2h_msg *)&tcp_req.rsp;
 
 	tcp_req.req.iov[0].iov_base = (void *)0xDEADBEEF;
 	tcp_req.req.iov[0].iov_len = 101;
@@ -520,6 +537,34 @@ test_nvmf_tcp_send_c2h_data(void)
 	CU_ASSERT((uint64_t)pdu.data_iov[2].iov_base == 0xC0FFEE);
 	CU_ASSERT(pdu.data_iov[2].iov_len == 99);
 
+	/* Without the SUCCESS flag, the capsule response follows the data in the same request */
+	CU_ASSERT(!(c2h_data->common.flags & SPDK_NVME_TCP_C2H_DATA_FLAGS_SUCCESS));
+	CU_ASSERT(pdu.sock_req.iovcnt == 5);
+	CU_ASSERT(pdu.iov[4].iov_base == &tcp_req.piggyback_rsp);
+	CU_ASSERT(pdu.iov[4].iov_len == sizeof(struct spdk_nvme_tcp_rsp));
+	CU_ASSERT(tcp_req.piggyback_rsp.common.pdu_type == SPDK_NVME_TCP_PDU_TYPE_CAPSULE_RESP);
+	nvmf_tcp_req_pdu_fini(&tcp_req);
+
+	/* The SUCCESS flag replaces the capsule response when it carries no result */
+	ttransport.transport.opts.c2h_success = true;
+	spdk_nvmf_tcp_send_c2h_data(&tqpair, &tcp_req);
+
+	CU_ASSERT(TAILQ_FIRST(&tqpair.send_queue) == &pdu);
+	TAILQ_REMOVE(&tqpair.send_queue, &pdu, tailq);
+	CU_ASSERT(c2h_data->common.flags & SPDK_NVME_TCP_C2H_DATA_FLAGS_SUCCESS);
+	CU_ASSERT(pdu.sock_req.iovcnt == 4);
+	nvmf_tcp_req_pdu_fini(&tcp_req);
+
+	/* But not when it has to return command specific data */
+	tcp_req.rsp.cdw0 = 1;
+	spdk_nvmf_tcp_send_c2h_data(&tqpair, &tcp_req);
+
+	CU_ASSERT(TAILQ_FIRST(&tqpair.send_queue) == &pdu);
+	TAILQ_REMOVE(&tqpair.send_queue, &pdu, tailq);
+	CU_ASSERT(!(c2h_data->common.flags & SPDK_NVME_TCP_C2H_DATA_FLAGS_SUCCESS));
+	CU_ASSERT(pdu.sock_req.iovcnt == 5);
+	CU_ASSERT(tcp_req.piggyback_rsp.rccqe.cdw0 == 1);
+
 	spdk_thread_exit(thread);
 	spdk_thread_destroy(thread);
 }
@@ -676,6 +721,45 @@ test_nvmf_tcp_incapsule_data_handle(void)
 	CU_ASSERT(tqpair.pdu_in_progress.req == (void *)&tcp_req2);
 }
 
+static void
+test_nvmf_tcp_recv_buf_read_len(void)
+{
+	struct spdk_nvmf_tcp_qpair tqpair = {};
+	uint32_t ch_len, psh_len;
+
+	/* Header lengths left to read in the AWAIT_PDU_CH and AWAIT_PDU_PSH states */
+	ch_len = sizeof(struct spdk_nvme_tcp_h2c_data_hdr) + SPDK_NVME_TCP_DIGEST_LEN;
+	psh_len = sizeof(struct spdk_nvme_tcp_h2c_data_hdr) -
+		  sizeof(struct spdk_nvme_tcp_common_pdu_hdr);
+
+	/* No H2C data expected, fill the receive buffer */
+	CU_ASSERT(spdk_nvmf_tcp_recv_buf_read_len(&tqpair, ch_len) == UINT32_MAX);
+	CU_ASSERT(spdk_nvmf_tcp_recv_buf_read_len(&tqpair, psh_len) == UINT32_MAX);
+
+	tqpair.state_cntr[TCP_REQUEST_STATE_FREE] = UT_MAX_QUEUE_DEPTH - 3;
+	tqpair.state_cntr[TCP_REQUEST_STATE_EXECUTING] = 1;
+	tqpair.state_cntr[TCP_REQUEST_STATE_READY_TO_EXECUTE] = 1;
+	tqpair.state_cntr[TCP_REQUEST_STATE_TRANSFERRING_CONTROLLER_TO_HOST] = 1;
+	CU_ASSERT(spdk_nvmf_tcp_recv_buf_read_len(&tqpair, ch_len) == UINT32_MAX);
+	CU_ASSERT(spdk_nvmf_tcp_recv_buf_read_len(&tqpair, psh_len) == UINT32_MAX);
+
+	/* An R2T has been sent, stop at the end of the header */
+	tqpair.state_cntr[TCP_REQUEST_STATE_AWAITING_R2T_ACK] = 1;
+	CU_ASSERT(spdk_nvmf_tcp_recv_buf_read_len(&tqpair, ch_len) == ch_len);
+	CU_ASSERT(spdk_nvmf_tcp_recv_buf_read_len(&tqpair, psh_len) == psh_len);
+
+	/* H2C data is being received */
+	tqpair.state_cntr[TCP_REQUEST_STATE_AWAITING_R2T_ACK] = 0;
+	tqpair.state_cntr[TCP_REQUEST_STATE_TRANSFERRING_HOST_TO_CONTROLLER] = 1;
+	CU_ASSERT(spdk_nvmf_tcp_recv_buf_read_len(&tqpair, ch_len) == ch_len);
+	CU_ASSERT(spdk_nvmf_tcp_recv_buf_read_len(&tqpair, psh_len) == psh_len);
+
+	/* All H2C data has arrived, go back to filling the receive buffer */
+	tqpair.state_cntr[TCP_REQUEST_STATE_TRANSFERRING_HOST_TO_CONTROLLER] = 0;
+	CU_ASSERT(spdk_nvmf_tcp_recv_buf_read_len(&tqpair, ch_len) == UINT32_MAX);
+	CU_ASSERT(spdk_nvmf_tcp_recv_buf_read_len(&tqpair, psh_len) == UINT32_MAX);
+}
+
 
 int main(int argc, char **argv)
 {
@@ -698,7 +782,8 @@ int main(int argc, char **argv)
 		CU_add_test(suite, "nvmf_tcp_poll_group_create", test_nvmf_tcp_poll_group_create) == NULL ||
 		CU_add_test(suite, "nvmf_tcp_send_c2h_data", test_nvmf_tcp_send_c2h_data) == NULL ||
 		CU_add_test(suite, "nvmf_tcp_h2c_data_hdr_handle", test_nvmf_tcp_h2c_data_hdr_handle) == NULL	||
-		CU_add_test(suite, "nvmf_tcp_incapsule_test", test_nvmf_tcp_incapsule_data_handle) == NULL
+		CU_add_test(suite, "nvmf_tcp_incapsule_test", test_nvmf_tcp_incapsule_data_handle) == NULL ||
+		CU_add_test(suite, "nvmf_tcp_recv_buf_read_len", test_nvmf_tcp_recv_buf_read_len) == NULL
 	) {
 		CU_cleanup_registry();
 		return CU_get_error();
@@ -613,6 +613,12 @@ lun_check_pending_tasks_only_for_specific_initiator(void)
 	task1.initiator_port = &initiator_port1;
 	task2.initiator_port = &initiator_port2;
 
+	/* Tasks are inserted directly, so count them for the ports here. */
+	initiator_port1.num_tasks = 1;
+	initiator_port2.num_tasks = 1;
+	initiator_port1.num_mgmt_tasks = 1;
+	initiator_port2.num_mgmt_tasks = 1;
+
 	TAILQ_INSERT_TAIL(&lun->tasks, &task1, scsi_link);
 	TAILQ_INSERT_TAIL(&lun->tasks, &task2, scsi_link);
 	CU_ASSERT(scsi_lun_has_outstanding_tasks(lun) == true);
@@ -666,6 +672,66 @@ lun_check_pending_tasks_only_for_specific_initiator(void)
 	scsi_lun_remove(lun);
 }
 
+static void
+lun_count_tasks_per_initiator(void)
+{
+	struct spdk_scsi_lun *lun;
+	struct spdk_scsi_task task1, task2, mgmt_task;
+	struct spdk_scsi_port initiator_port1 = {};
+	struct spdk_scsi_port initiator_port2 = {};
+	struct spdk_scsi_dev dev = {};
+
+	lun = lun_construct();
+	lun->dev = &dev;
+
+	g_lun_execute_fail = false;
+	g_lun_execute_status = SPDK_SCSI_TASK_PENDING;
+
+	ut_init_task(&task1);
+	task1.lun = lun;
+	task1.initiator_port = &initiator_port1;
+	ut_init_task(&task2);
+	task2.lun = lun;
+	task2.initiator_port = &initiator_port1;
+
+	/* Tasks are counted from being queued until they complete. */
+	spdk_scsi_lun_append_task(lun, &task1);
+	CU_ASSERT(initiator_port1.num_tasks == 1);
+	spdk_scsi_lun_execute_tasks(lun);
+	spdk_scsi_lun_append_task(lun, &task2);
+	CU_ASSERT(initiator_port1.num_tasks == 2);
+	CU_ASSERT(spdk_scsi_lun_has_pending_tasks(lun, &initiator_port1) == true);
+
+	/* Nothing was queued through the other port, so no list is walked for it. */
+	CU_ASSERT(initiator_port2.num_tasks == 0);
+	CU_ASSERT(spdk_scsi_lun_has_pending_tasks(lun, &initiator_port2) == false);
+
+	spdk_scsi_lun_execute_tasks(lun);
+	spdk_scsi_lun_complete_task(lun, &task1);
+	CU_ASSERT(initiator_port1.num_tasks == 1);
+	spdk_scsi_lun_complete_task(lun, &task2);
+	CU_ASSERT(initiator_port1.num_tasks == 0);
+	CU_ASSERT(spdk_scsi_lun_has_pending_tasks(lun, &initiator_port1) == false);
+
+	ut_init_task(&mgmt_task);
+	mgmt_task.lun = lun;
+	mgmt_task.initiator_port = &initiator_port2;
+	mgmt_task.function = SPDK_SCSI_TASK_FUNC_ABORT_TASK;
+
+	spdk_scsi_lun_append_mgmt_task(lun, &mgmt_task);
+	CU_ASSERT(initiator_port2.num_mgmt_tasks == 1);
+	CU_ASSERT(spdk_scsi_lun_has_pending_mgmt_tasks(lun, &initiator_port2) == true);
+	CU_ASSERT(spdk_scsi_lun_has_pending_mgmt_tasks(lun, &initiator_port1) == false);
+
+	spdk_scsi_lun_execute_mgmt_task(lun);
+	CU_ASSERT(initiator_port2.num_mgmt_tasks == 0);
+	CU_ASSERT(spdk_scsi_lun_has_pending_mgmt_tasks(lun, &initiator_port2) == false);
+
+	lun_destruct(lun);
+
+	CU_ASSERT_EQUAL(g_task_count, 0);
+}
+
 static void
 abort_pending_mgmt_tasks_when_lun_is_removed(void)
 {
@@ -777,6 +843,8 @@ main(int argc, char **argv)
 			       lun_reset_task_suspend_scsi_task) == NULL
 		|| CU_add_test(suite, "check pending tasks only for specific initiator",
 			       lun_check_pending_tasks_only_for_specific_initiator) == NULL
+		|| CU_add_test(suite, "count tasks per initiator",
+			       lun_count_tasks_per_initiator) == NULL
 		|| CU_add_test(suite, "abort_pending_mgmt_tasks_when_lun_is_removed",
 			       abort_pending_mgmt_tasks_when_lun_is_removed) == NULL
 	) {
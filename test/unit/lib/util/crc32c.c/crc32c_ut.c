@@ -121,6 +121,49 @@ test_crc32c(void)
 	CU_ASSERT(crc == 0x6087809A);
 }
 
+static void
+test_crc32c_multi(void)
+{
+	uint8_t data[7][100];
+	const void *bufs[7];
+	size_t lens[7];
+	uint32_t crcs[7], expected[7];
+	int i, j;
+
+	for (i = 0; i < 7; i++) {
+		for (j = 0; j < 100; j++) {
+			data[i][j] = i * 100 + j;
+		}
+		bufs[i] = data[i];
+		/* Differing lengths, some shorter than one 8-byte block */
+		lens[i] = (i * 37) % 100;
+		crcs[i] = 0xFFFFFFFFu - i;
+		expected[i] = spdk_crc32c_update(bufs[i], lens[i], crcs[i]);
+	}
+
+	spdk_crc32c_update_multi(bufs, lens, crcs, 7);
+	for (i = 0; i < 7; i++) {
+		CU_ASSERT(crcs[i] == expected[i]);
+	}
+
+	/* No buffers at all */
+	spdk_crc32c_update_multi(bufs, lens, crcs, 0);
+	for (i = 0; i < 7; i++) {
+		CU_ASSERT(crcs[i] == expected[i]);
+	}
+
+	/* Known result for every lane */
+	for (i = 0; i < 3; i++) {
+		bufs[i] = "Hello world!";
+		lens[i] = strlen("Hello world!");
+		crcs[i] = 0xFFFFFFFFu;
+	}
+	spdk_crc32c_update_multi(bufs, lens, crcs, 3);
+	for (i = 0; i < 3; i++) {
+		CU_ASSERT((crcs[i] ^ 0xFFFFFFFFu) == 0x7b98e751);
+	}
+}
+
 int
 main(int argc, char **argv)
 {
@@ -138,7 +181,8 @@ main(int argc, char **argv)
 	}
 
 	if (
-		CU_add_test(suite, "test_crc32c", test_crc32c) == NULL) {
+		CU_add_test(suite, "test_crc32c", test_crc32c) == NULL ||
+		CU_add_test(suite, "test_crc32c_multi", test_crc32c_multi) == NULL) {
 		CU_cleanup_registry();
 		return CU_get_error();
 	}
@@ -37,7 +37,7 @@
 #include "spdk_cunit.h"
 #include "spdk/thread.h"
 #include "spdk_internal/mock.h"
-#include "common/lib/test_env.c"
+#include "common/lib/ut_multithread.c"
 #include "unit/lib/json_mock.c"
 
 #include "vhost/vhost.c"
@@ -402,6 +402,159 @@ vq_avail_ring_get_test(void)
 	}
 }
 
+static void
+vq_packed_ring_test(void)
+{
+	struct spdk_vhost_session vsession = {};
+	struct spdk_vhost_virtqueue *vq = &vsession.virtqueue[0];
+	struct vring_packed_desc descs[4] = {};
+	uint16_t buffer_id, num_descs;
+
+	vq->vring.desc_packed = descs;
+	vq->vring.size = 4;
+	vq->packed.packed_ring = true;
+	vq->packed.avail_phase = 1;
+	vq->packed.used_phase = 1;
+	vq->last_avail_idx = 3;
+	vq->last_used_idx = 3;
+
+	/* Nothing available yet */
+	CU_ASSERT(!vhost_vq_packed_ring_is_avail(vq));
+
+	/* Two descriptor chain wrapping around the end of the ring. The second
+	 * descriptor belongs to the next lap and carries the buffer id.
+	 */
+	descs[3].flags = VRING_DESC_F_AVAIL | VRING_DESC_F_NEXT;
+	descs[0].flags = VRING_DESC_F_USED | VRING_DESC_F_WRITE;
+	descs[0].id = 2;
+	CU_ASSERT(vhost_vq_packed_ring_is_avail(vq));
+
+	buffer_id = vhost_vq_packed_ring_get_buffer_id(vq, &num_descs);
+	CU_ASSERT(buffer_id == 2);
+	CU_ASSERT(num_descs == 2);
+	CU_ASSERT(vq->last_avail_idx == 1);
+	CU_ASSERT(vq->packed.avail_phase == 0);
+	CU_ASSERT(!vhost_vq_packed_ring_is_avail(vq));
+
+	/* The used descriptor is written at the head of the chain */
+	vhost_vq_packed_ring_enqueue(&vsession, vq, num_descs, buffer_id, 512);
+	CU_ASSERT(descs[3].id == 2);
+	CU_ASSERT(descs[3].len == 512);
+	CU_ASSERT((descs[3].flags & VRING_DESC_F_AVAIL_USED) == VRING_DESC_F_AVAIL_USED);
+	CU_ASSERT((descs[3].flags & VRING_DESC_F_WRITE) != 0);
+	CU_ASSERT(vq->last_used_idx == 1);
+	CU_ASSERT(vq->packed.used_phase == 0);
+	CU_ASSERT(vq->used_req_cnt == 1);
+
+	/* In the next lap a used descriptor has both flags cleared */
+	descs[1].flags = VRING_DESC_F_USED;
+	descs[1].id = 0;
+	CU_ASSERT(vhost_vq_packed_ring_is_avail(vq));
+	buffer_id = vhost_vq_packed_ring_get_buffer_id(vq, &num_descs);
+	CU_ASSERT(buffer_id == 0);
+	CU_ASSERT(num_descs == 1);
+	vhost_vq_packed_ring_enqueue(&vsession, vq, num_descs, buffer_id, 0);
+	CU_ASSERT((descs[1].flags & (VRING_DESC_F_AVAIL_USED | VRING_DESC_F_WRITE)) == 0);
+	CU_ASSERT(vq->last_used_idx == 2);
+	CU_ASSERT(vq->used_req_cnt == 2);
+}
+
+static int
+test_vq_poller(void *arg)
+{
+	return 0;
+}
+
+static void
+poller_intr_test(void)
+{
+	struct spdk_vhost_session vsession = {};
+	struct spdk_vhost_virtqueue *vq = &vsession.virtqueue[0];
+	struct vring_avail avail = {};
+	struct vring_used used = {};
+	struct vhost_poll_group pg = {};
+	struct vhost_poller_intr intr = {};
+	struct spdk_poller *poller;
+	uint64_t val = 1;
+	int kickfd;
+
+	allocate_threads(1);
+	set_thread(0);
+
+	pg.thread = spdk_get_thread();
+	pg.epfd = epoll_create1(0);
+	SPDK_CU_ASSERT_FATAL(pg.epfd >= 0);
+	kickfd = eventfd(0, EFD_NONBLOCK);
+	SPDK_CU_ASSERT_FATAL(kickfd >= 0);
+
+	vsession.name = "vhost.0";
+	vsession.max_queues = 1;
+	vq->vring.avail = &avail;
+	vq->vring.used = &used;
+	vq->vring.kickfd = kickfd;
+	used.flags = VRING_USED_F_NO_NOTIFY;
+
+	poller = spdk_poller_register(test_vq_poller, NULL, 0);
+	vhost_poller_intr_init(&intr, &vsession, &pg, poller, 0, 1);
+	spdk_delay_us(1);
+
+	/* A busy poller is never suspended */
+	vhost_poller_intr_update(&intr, false);
+	spdk_delay_us(SPDK_VHOST_IDLE_TIMEOUT_US);
+	vhost_poller_intr_update(&intr, false);
+	CU_ASSERT(!intr.suspended);
+
+	/* Idle, but not long enough */
+	vhost_poller_intr_update(&intr, true);
+	spdk_delay_us(SPDK_VHOST_IDLE_TIMEOUT_US - 1);
+	vhost_poller_intr_update(&intr, true);
+	CU_ASSERT(!intr.suspended);
+
+	/* A request has been made available before the notifications got enabled */
+	avail.idx = 1;
+	spdk_delay_us(1);
+	vhost_poller_intr_update(&intr, true);
+	CU_ASSERT(!intr.suspended);
+	CU_ASSERT(used.flags == VRING_USED_F_NO_NOTIFY);
+	vq->last_avail_idx = 1;
+
+	spdk_delay_us(SPDK_VHOST_IDLE_TIMEOUT_US);
+	vhost_poller_intr_update(&intr, true);
+	CU_ASSERT(intr.suspended);
+	CU_ASSERT(used.flags == 0);
+	CU_ASSERT(vq->intr == &intr);
+	CU_ASSERT(pg.kick_poller != NULL);
+
+	/* Nothing happens until the guest kicks the queue */
+	spdk_delay_us(SPDK_VHOST_KICK_CHECK_PERIOD_US);
+	poll_threads();
+	CU_ASSERT(intr.suspended);
+
+	CU_ASSERT(write(kickfd, &val, sizeof(val)) == sizeof(val));
+	spdk_delay_us(SPDK_VHOST_KICK_CHECK_PERIOD_US);
+	poll_threads();
+	CU_ASSERT(!intr.suspended);
+	CU_ASSERT(used.flags == VRING_USED_F_NO_NOTIFY);
+	CU_ASSERT(vq->intr == NULL);
+	CU_ASSERT(pg.kick_poller == NULL);
+	/* The kick has been consumed */
+	CU_ASSERT(read(kickfd, &val, sizeof(val)) < 0 && errno == EAGAIN);
+
+	/* Suspend once again and make sure the poller can be safely unregistered */
+	vhost_poller_intr_update(&intr, true);
+	spdk_delay_us(SPDK_VHOST_IDLE_TIMEOUT_US);
+	vhost_poller_intr_update(&intr, true);
+	CU_ASSERT(intr.suspended);
+	vhost_poller_intr_fini(&intr);
+	CU_ASSERT(!intr.suspended);
+	CU_ASSERT(pg.kick_poller == NULL);
+	spdk_poller_unregister(&poller);
+
+	close(kickfd);
+	close(pg.epfd);
+	free_threads();
+}
+
 int
 main(int argc, char **argv)
 {
@@ -423,7 +576,9 @@ main(int argc, char **argv)
 		CU_add_test(suite, "create_controller", create_controller_test) == NULL ||
 		CU_add_test(suite, "session_find_by_vid", session_find_by_vid_test) == NULL ||
 		CU_add_test(suite, "remove_controller", remove_controller_test) == NULL ||
-		CU_add_test(suite, "vq_avail_ring_get", vq_avail_ring_get_test) == NULL
+		CU_add_test(suite, "vq_avail_ring_get", vq_avail_ring_get_test) == NULL ||
+		CU_add_test(suite, "vq_packed_ring", vq_packed_ring_test) == NULL ||
+		CU_add_test(suite, "poller_intr", poller_intr_test) == NULL
 	) {
 		CU_cleanup_registry();
 		return CU_get_error();